@@ -0,0 +1,85 @@
+#ifndef TATAMI_CHUNKED_BENCHMARKS_LIST_LRU_SLAB_CACHE_HPP
+#define TATAMI_CHUNKED_BENCHMARKS_LIST_LRU_SLAB_CACHE_HPP
+
+#include <unordered_map>
+#include <list>
+#include <iterator>
+#include <cstddef>
+
+// Previous implementation of tatami_chunked::LruSlabCache, based on a std::list and std::unordered_map.
+// This is kept around for comparison with the current implementation.
+template<typename Id_, class Slab_> 
+class ListLruSlabCache {
+private:
+    typedef std::pair<Slab_, Id_> Element;
+    typedef std::list<Element> SlabPool;
+
+    typename SlabPool::size_type my_max_slabs;
+    SlabPool my_cache_data;
+    std::unordered_map<Id_, typename std::list<Element>::iterator> my_cache_exists;
+
+    Id_ my_last_id = 0;
+    Slab_* my_last_slab = NULL;
+
+public:
+    template<typename Index_>
+    ListLruSlabCache(Index_ max_slabs) : my_max_slabs(max_slabs) {}
+
+    ListLruSlabCache(const ListLruSlabCache&) = delete;
+
+    ListLruSlabCache& operator=(const ListLruSlabCache&) = delete;
+
+    // Iterators are guaranteed to be valid after move, see Notes in
+    // https://en.cppreference.com/w/cpp/container/list/list
+    // https://en.cppreference.com/w/cpp/container/list/operator%3D
+    ListLruSlabCache& operator=(ListLruSlabCache&&) = default; 
+    ListLruSlabCache(ListLruSlabCache&&) = default;
+
+    // Might as well define this.
+    ~ListLruSlabCache() = default;
+
+public:
+    template<class Cfunction_, class Pfunction_>
+    const Slab_& find(Id_ id, Cfunction_ create, Pfunction_ populate) {
+        if (id == my_last_id && my_last_slab) {
+            return *my_last_slab;
+        }
+        my_last_id = id;
+
+        auto it = my_cache_exists.find(id);
+        if (it != my_cache_exists.end()) {
+            auto chosen = it->second;
+            my_cache_data.splice(my_cache_data.end(), my_cache_data, chosen); // move to end.
+            my_last_slab = &(chosen->first);
+            return chosen->first;
+        } 
+
+        typename std::list<Element>::iterator location;
+        if (my_cache_data.size() < my_max_slabs) {
+            my_cache_data.emplace_back(create(), id);
+            location = std::prev(my_cache_data.end());
+        } else {
+            location = my_cache_data.begin();
+            my_cache_exists.erase(location->second);
+            location->second = id;
+            my_cache_data.splice(my_cache_data.end(), my_cache_data, location); // move to end.
+        }
+        my_cache_exists[id] = location;
+
+        auto& slab = location->first;
+        populate(id, slab);
+        my_last_slab = &slab;
+        return slab;
+    }
+
+public:
+    auto get_max_slabs() const {
+        return my_max_slabs;
+    }
+
+    auto get_num_slabs() const {
+        return my_cache_data.size();
+    }
+};
+
+#endif
@@ -0,0 +1,114 @@
+#include "tatami_chunked/OracularSlabCache.hpp"
+#include "tatami_chunked/OracularBeladySlabCache.hpp"
+#include "tatami/tatami.hpp"
+
+#include "utils.hpp"
+
+#include <vector>
+#include <string>
+#include <memory>
+#include <numeric>
+#include <iostream>
+#include <iomanip>
+#include <cstddef>
+
+// Comparing the number of slabs that are read by the OracularSlabCache and the OracularBeladySlabCache.
+// Each slab read is assumed to be expensive (e.g., decompression from file), so the number of reads is the main quantity of interest;
+// we also report the time spent in the caches with a cheap populate() function, to show the cost of the extra bookkeeping.
+
+constexpr int extent = 20000;
+constexpr int chunk_length = 20;
+constexpr std::size_t slab_size = 256;
+constexpr std::size_t num_requests = 200000;
+
+typedef std::vector<double> Slab;
+
+inline std::pair<int, int> identify(int i) {
+    return std::make_pair(i / chunk_length, i % chunk_length);
+}
+
+// Random subset of rows in a random order, e.g., for bootstrapping or for processing cells in a random order.
+std::vector<int> shuffled_subset_pattern(int extent, std::size_t length, unsigned long long seed) {
+    std::mt19937_64 rng(seed);
+    std::vector<int> all(extent);
+    std::iota(all.begin(), all.end(), 0);
+    std::vector<int> output;
+    output.reserve(length);
+    while (output.size() < length) {
+        std::shuffle(all.begin(), all.end(), rng);
+        auto take = std::min(length - output.size(), static_cast<std::size_t>(extent / 4));
+        output.insert(output.end(), all.begin(), all.begin() + take);
+    }
+    return output;
+}
+
+// Repeatedly sweeping over a small working set of rows with some random excursions, e.g., for iterative algorithms on a subset of features.
+std::vector<int> working_set_pattern(int extent, std::size_t length, int working_set, unsigned long long seed) {
+    std::mt19937_64 rng(seed);
+    std::vector<int> output;
+    output.reserve(length);
+    while (output.size() < length) {
+        for (int w = 0; w < working_set && output.size() < length; ++w) {
+            output.push_back(rng() % 8 == 0 ? rng() % extent : (w * 37) % extent);
+        }
+    }
+    return output;
+}
+
+template<class Cache_>
+std::size_t run_cache(Cache_& cache, std::size_t num_predictions) {
+    std::size_t num_reads = 0;
+    double sum = 0;
+    for (std::size_t i = 0; i < num_predictions; ++i) {
+        auto out = cache.next(
+            identify,
+            []() -> Slab { return Slab(slab_size); },
+            [&](std::vector<std::pair<int, Slab*> >& to_populate) -> void {
+                for (auto& x : to_populate) {
+                    std::fill(x.second->begin(), x.second->end(), x.first);
+                }
+                num_reads += to_populate.size();
+            }
+        );
+        sum += (*(out.first))[out.second];
+    }
+    volatile double sink = sum;
+    (void)sink;
+    return num_reads;
+}
+
+void report_reads(const std::string& group, const std::string& name, std::size_t reads, double time) {
+    std::cout << std::left << std::setw(30) << group << std::setw(40) << name << std::right << std::setw(12) << reads << " reads" << std::setw(12) << std::fixed << std::setprecision(3) << time << " ms" << std::endl;
+}
+
+int main() {
+    std::vector<NamedPattern> patterns;
+    patterns.push_back({ "sequential", sequential_pattern(extent, num_requests) });
+    patterns.push_back({ "random", random_pattern(extent, num_requests, 1234) });
+    patterns.push_back({ "shuffled subset", shuffled_subset_pattern(extent, num_requests, 2345) });
+    patterns.push_back({ "blocky", blocky_pattern(extent, num_requests, 50, 5678) });
+    patterns.push_back({ "working set", working_set_pattern(extent, num_requests, 2000, 6789) });
+
+    for (int max_slabs : { 16, 64, 256 }) {
+        std::string suffix = " (" + std::to_string(max_slabs) + " slabs)";
+        for (const auto& p : patterns) {
+            auto oracle = std::make_shared<tatami::FixedViewOracle<int> >(p.pattern.data(), p.pattern.size());
+
+            std::size_t reads = 0;
+            double time = time_benchmark([&]() -> void {
+                tatami_chunked::OracularSlabCache<int, int, Slab, false, true> cache(oracle, max_slabs, extent / chunk_length);
+                reads = run_cache(cache, p.pattern.size());
+            });
+            report_reads("OracularSlabCache", p.name + suffix, reads, time);
+
+            std::size_t breads = 0;
+            double btime = time_benchmark([&]() -> void {
+                tatami_chunked::OracularBeladySlabCache<int, int, Slab, true> cache(oracle, max_slabs, extent / chunk_length);
+                breads = run_cache(cache, p.pattern.size());
+            });
+            report_reads("OracularBeladySlabCache", p.name + suffix, breads, btime);
+        }
+    }
+
+    return 0;
+}
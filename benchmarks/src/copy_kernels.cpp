@@ -0,0 +1,97 @@
+#include "tatami_chunked/copy_kernels.hpp"
+
+#include "utils.hpp"
+
+#include <vector>
+#include <string>
+#include <iostream>
+#include <iomanip>
+#include <cstdint>
+#include <cstddef>
+
+// Benchmarks for the conversion and gather kernels at each instruction set supported by the current machine.
+// Throughput is reported as the number of bytes read from the source and written to the destination per second.
+
+constexpr std::size_t length = 4096; // typical size of a slab row, small enough to stay in cache.
+constexpr std::size_t iterations = 20000;
+
+inline void report_throughput(const std::string& group, const std::string& name, std::size_t bytes_per_call, double time) {
+    double gb_per_sec = static_cast<double>(bytes_per_call) * static_cast<double>(iterations) / (time / 1000) / 1e9;
+    std::cout << std::left << std::setw(30) << group << std::setw(40) << name << std::right << std::setw(12) << std::fixed << std::setprecision(2) << gb_per_sec << " GB/s" << std::endl;
+}
+
+inline std::string level_name(tatami_chunked::SimdLevel level) {
+    switch (level) {
+        case tatami_chunked::SimdLevel::AVX2:
+            return "AVX2";
+        case tatami_chunked::SimdLevel::AVX512:
+            return "AVX-512";
+        default:
+            return "scalar";
+    }
+}
+
+inline std::vector<tatami_chunked::SimdLevel> available_levels() {
+    std::vector<tatami_chunked::SimdLevel> output{ tatami_chunked::SimdLevel::NONE };
+    auto max_level = tatami_chunked::get_simd_level();
+    if (max_level >= tatami_chunked::SimdLevel::AVX2) {
+        output.push_back(tatami_chunked::SimdLevel::AVX2);
+    }
+    if (max_level >= tatami_chunked::SimdLevel::AVX512) {
+        output.push_back(tatami_chunked::SimdLevel::AVX512);
+    }
+    return output;
+}
+
+template<typename In_, typename Out_>
+void benchmark_convert(const std::string& name) {
+    std::vector<In_> src(length);
+    for (std::size_t i = 0; i < length; ++i) {
+        src[i] = static_cast<In_>(i % 1000);
+    }
+    std::vector<Out_> dest(length);
+
+    for (auto level : available_levels()) {
+        double time = time_benchmark([&]() -> void {
+            for (std::size_t it = 0; it < iterations; ++it) {
+                tatami_chunked::convert_copy_n(src.data(), length, dest.data(), level);
+            }
+            volatile Out_ sink = dest[length / 2];
+            (void)sink;
+        });
+        report_throughput("convert_copy_n", name + " (" + level_name(level) + ")", length * (sizeof(In_) + sizeof(Out_)), time);
+    }
+}
+
+template<typename Value_>
+void benchmark_gather(const std::string& name) {
+    std::vector<Value_> src(length * 4);
+    for (std::size_t i = 0; i < src.size(); ++i) {
+        src[i] = static_cast<Value_>(i % 1000);
+    }
+    std::vector<int> indices(length);
+    for (std::size_t i = 0; i < length; ++i) {
+        indices[i] = (i * 37) % src.size(); // spread out, as for a sparse subset of the non-target dimension.
+    }
+    std::vector<Value_> dest(length);
+
+    double time = time_benchmark([&]() -> void {
+        for (std::size_t it = 0; it < iterations; ++it) {
+            tatami_chunked::gather_copy_n(src.data(), indices.data(), length, dest.data());
+        }
+        volatile Value_ sink = dest[length / 2];
+        (void)sink;
+    });
+    report_throughput("gather_copy_n", name, length * (2 * sizeof(Value_) + sizeof(int)), time);
+}
+
+int main() {
+    benchmark_convert<float, double>("float to double");
+    benchmark_convert<std::int32_t, double>("int32 to double");
+    benchmark_convert<double, double>("double to double");
+    benchmark_convert<std::uint16_t, double>("uint16 to double");
+
+    benchmark_gather<double>("double");
+    benchmark_gather<float>("float");
+    return 0;
+}
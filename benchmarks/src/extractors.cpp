@@ -0,0 +1,156 @@
+#include "tatami_chunked/CustomDenseChunkedMatrix.hpp"
+#include "tatami_chunked/CustomSparseChunkedMatrix.hpp"
+#include "tatami/tatami.hpp"
+
+#include "utils.hpp"
+#include "mock_managers.hpp"
+
+#include <vector>
+#include <string>
+#include <memory>
+#include <cstddef>
+
+// Benchmarks for full/block/index extraction from the chunked matrices, along either dimension, with and without an oracle.
+// The mock managers are held in memory so that the timings mostly reflect the overhead of the chunked extractors and their caches.
+
+struct Selection {
+    std::string name;
+    int start, length; // for blocks.
+    std::shared_ptr<const std::vector<int> > indices; // for indices.
+};
+
+inline std::vector<Selection> standard_selections(int extent) {
+    std::vector<Selection> output;
+    output.push_back({ "full", 0, extent, nullptr });
+    output.push_back({ "block", extent / 4, extent / 2, nullptr });
+
+    auto indices = std::make_shared<std::vector<int> >();
+    for (int i = 0; i < extent; i += 3) {
+        indices->push_back(i);
+    }
+    output.push_back({ "index", 0, 0, std::move(indices) });
+    return output;
+}
+
+template<bool oracle_>
+auto create_dense(const tatami::Matrix<double, int>& mat, bool row, const Selection& sel) {
+    std::shared_ptr<const tatami::Oracle<int> > oracle;
+    if constexpr(oracle_) {
+        oracle = std::make_shared<tatami::ConsecutiveOracle<int> >(0, row ? mat.nrow() : mat.ncol());
+    }
+
+    auto create = [&](auto... args) {
+        if constexpr(oracle_) {
+            return mat.dense(row, oracle, args..., tatami::Options());
+        } else {
+            return mat.dense(row, args..., tatami::Options());
+        }
+    };
+
+    if (sel.name == "full") {
+        return create();
+    } else if (sel.name == "block") {
+        return create(sel.start, sel.length);
+    } else {
+        return create(sel.indices);
+    }
+}
+
+template<bool oracle_>
+auto create_sparse(const tatami::Matrix<double, int>& mat, bool row, const Selection& sel) {
+    std::shared_ptr<const tatami::Oracle<int> > oracle;
+    if constexpr(oracle_) {
+        oracle = std::make_shared<tatami::ConsecutiveOracle<int> >(0, row ? mat.nrow() : mat.ncol());
+    }
+
+    auto create = [&](auto... args) {
+        if constexpr(oracle_) {
+            return mat.sparse(row, oracle, args..., tatami::Options());
+        } else {
+            return mat.sparse(row, args..., tatami::Options());
+        }
+    };
+
+    if (sel.name == "full") {
+        return create();
+    } else if (sel.name == "block") {
+        return create(sel.start, sel.length);
+    } else {
+        return create(sel.indices);
+    }
+}
+
+template<bool oracle_>
+double benchmark_dense(const tatami::Matrix<double, int>& mat, bool row, const Selection& sel) {
+    int extent = (row ? mat.nrow() : mat.ncol());
+    int other = (row ? mat.ncol() : mat.nrow());
+    std::vector<double> buffer(other);
+
+    return time_benchmark([&]() -> void {
+        auto ext = create_dense<oracle_>(mat, row, sel);
+        double sum = 0;
+        for (int i = 0; i < extent; ++i) {
+            auto ptr = ext->fetch(i, buffer.data());
+            sum += ptr[0];
+        }
+        volatile double sink = sum;
+        (void)sink;
+    });
+}
+
+template<bool oracle_>
+double benchmark_sparse(const tatami::Matrix<double, int>& mat, bool row, const Selection& sel) {
+    int extent = (row ? mat.nrow() : mat.ncol());
+    int other = (row ? mat.ncol() : mat.nrow());
+    std::vector<double> vbuffer(other);
+    std::vector<int> ibuffer(other);
+
+    return time_benchmark([&]() -> void {
+        auto ext = create_sparse<oracle_>(mat, row, sel);
+        std::size_t total = 0;
+        for (int i = 0; i < extent; ++i) {
+            auto range = ext->fetch(i, vbuffer.data(), ibuffer.data());
+            total += range.number;
+        }
+        volatile std::size_t sink = total;
+        (void)sink;
+    });
+}
+
+template<class Benchmark_>
+void run_all(const std::string& group, const tatami::Matrix<double, int>& mat, Benchmark_ bench) {
+    for (bool row : { true, false }) {
+        auto selections = standard_selections(row ? mat.ncol() : mat.nrow());
+        for (const auto& sel : selections) {
+            std::string name = std::string(row ? "row" : "column") + ", " + sel.name;
+            report_benchmark(group, name + ", myopic", bench(mat, row, sel, std::false_type()));
+            report_benchmark(group, name + ", oracular", bench(mat, row, sel, std::true_type()));
+        }
+    }
+}
+
+int main() {
+    {
+        auto manager = std::make_shared<MockDenseManager>(simulate_dense_chunks(5000, 1000, 50, 50, 42));
+        tatami_chunked::CustomDenseChunkedMatrixOptions opt;
+        opt.maximum_cache_size = 20000000;
+        tatami_chunked::CustomDenseChunkedMatrix<double, int, double, MockDenseManager> mat(std::move(manager), opt);
+
+        run_all("CustomDenseChunkedMatrix", mat, [](const tatami::Matrix<double, int>& mat, bool row, const Selection& sel, auto oracle) -> double {
+            return benchmark_dense<decltype(oracle)::value>(mat, row, sel);
+        });
+    }
+
+    {
+        auto manager = std::make_shared<MockSparseManager>(simulate_sparse_chunks(20000, 2000, 100, 100, 0.05, 69));
+        tatami_chunked::CustomSparseChunkedMatrixOptions opt;
+        opt.maximum_cache_size = 20000000;
+        tatami_chunked::CustomSparseChunkedMatrix<double, int, double, MockSparseManager> mat(std::move(manager), opt);
+
+        run_all("CustomSparseChunkedMatrix", mat, [](const tatami::Matrix<double, int>& mat, bool row, const Selection& sel, auto oracle) -> double {
+            return benchmark_sparse<decltype(oracle)::value>(mat, row, sel);
+        });
+    }
+
+    return 0;
+}
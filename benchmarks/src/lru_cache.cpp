@@ -0,0 +1,78 @@
+#include "tatami_chunked/LruSlabCache.hpp"
+#include "ListLruSlabCache.hpp"
+
+#include <chrono>
+#include <random>
+#include <vector>
+#include <string>
+#include <iostream>
+#include <cstddef>
+
+// Compares the flat LruSlabCache against the previous list-based implementation.
+// Slabs are deliberately small so that the cost of the cache bookkeeping dominates.
+
+template<class Cache_>
+double run(const std::vector<int>& accesses, int max_slabs, std::size_t& checksum) {
+    Cache_ cache(max_slabs);
+    auto start = std::chrono::steady_clock::now();
+    for (auto id : accesses) {
+        const auto& slab = cache.find(
+            id,
+            []() -> std::vector<int> {
+                return std::vector<int>(4);
+            },
+            [](int i, std::vector<int>& contents) -> void {
+                contents[0] = i;
+            }
+        );
+        checksum += slab[0];
+    }
+    auto end = std::chrono::steady_clock::now();
+    return std::chrono::duration<double, std::milli>(end - start).count();
+}
+
+void compare(const std::string& name, const std::vector<int>& accesses, int max_slabs) {
+    std::size_t checksum_list = 0, checksum_flat = 0;
+    double time_list = run<ListLruSlabCache<int, std::vector<int> > >(accesses, max_slabs, checksum_list);
+    double time_flat = run<tatami_chunked::LruSlabCache<int, std::vector<int> > >(accesses, max_slabs, checksum_flat);
+    if (checksum_list != checksum_flat) {
+        std::cerr << "checksums differ for '" << name << "'" << std::endl;
+    }
+    std::cout << name << " (" << max_slabs << " slabs): list = " << time_list << " ms, flat = " << time_flat << " ms" << std::endl;
+}
+
+int main() {
+    constexpr std::size_t num_accesses = 10000000;
+    std::mt19937_64 rng(42);
+
+    for (int max_slabs : { 4, 32, 256 }) {
+        // Random jumps within a working set that slightly exceeds the cache, so there is a mix of hits and misses.
+        {
+            std::vector<int> accesses(num_accesses);
+            for (auto& a : accesses) {
+                a = rng() % (max_slabs + max_slabs / 4 + 1);
+            }
+            compare("random", accesses, max_slabs);
+        }
+
+        // Cycling through a working set that fits inside the cache, so every access is a hit after warm-up.
+        {
+            std::vector<int> accesses(num_accesses);
+            for (std::size_t i = 0; i < num_accesses; ++i) {
+                accesses[i] = i % max_slabs;
+            }
+            compare("cyclic hits", accesses, max_slabs);
+        }
+
+        // Cycling through a working set that is one larger than the cache, so every access is a miss.
+        {
+            std::vector<int> accesses(num_accesses);
+            for (std::size_t i = 0; i < num_accesses; ++i) {
+                accesses[i] = i % (max_slabs + 1);
+            }
+            compare("cyclic misses", accesses, max_slabs);
+        }
+    }
+
+    return 0;
+}
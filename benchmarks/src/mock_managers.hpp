@@ -0,0 +1,305 @@
+#ifndef TATAMI_CHUNKED_BENCHMARKS_MOCK_MANAGERS_HPP
+#define TATAMI_CHUNKED_BENCHMARKS_MOCK_MANAGERS_HPP
+
+#include "tatami_chunked/CustomDenseChunkedMatrix.hpp"
+#include "tatami_chunked/CustomSparseChunkedMatrix.hpp"
+
+#include <vector>
+#include <memory>
+#include <random>
+#include <cstddef>
+
+// In-memory chunk managers for benchmarking the chunked matrices.
+// Each chunk is stored in row-major format, so extraction of rows is cheaper than columns.
+
+/*******************
+ *** Dense chunks ***
+ *******************/
+
+struct MockDenseData {
+    tatami_chunked::ChunkDimensionStats<int> row_stats, col_stats;
+    std::vector<std::vector<double> > chunks;
+};
+
+inline MockDenseData simulate_dense_chunks(int nrow, int ncol, int chunk_nrow, int chunk_ncol, unsigned long long seed) {
+    MockDenseData data;
+    data.row_stats = tatami_chunked::ChunkDimensionStats<int>(nrow, chunk_nrow);
+    data.col_stats = tatami_chunked::ChunkDimensionStats<int>(ncol, chunk_ncol);
+
+    std::mt19937_64 rng(seed);
+    std::uniform_real_distribution<double> dist;
+    data.chunks.resize(static_cast<std::size_t>(data.row_stats.num_chunks) * static_cast<std::size_t>(data.col_stats.num_chunks));
+    for (auto& chunk : data.chunks) {
+        chunk.resize(static_cast<std::size_t>(chunk_nrow) * static_cast<std::size_t>(chunk_ncol));
+        for (auto& x : chunk) {
+            x = dist(rng);
+        }
+    }
+    return data;
+}
+
+class MockDenseWorkspace final : public tatami_chunked::CustomDenseChunkedMatrixWorkspace<double, int> {
+public:
+    MockDenseWorkspace(const MockDenseData& data) : my_data(data) {}
+
+private:
+    const MockDenseData& my_data;
+
+    template<class Target_, class NonTarget_>
+    void copy(int chunk_row_id, int chunk_column_id, bool row, int num_target, Target_ target, int num_non_target, NonTarget_ non_target, double* output, int stride) {
+        const auto& chunk = my_data.chunks[static_cast<std::size_t>(chunk_row_id) * static_cast<std::size_t>(my_data.col_stats.num_chunks) + chunk_column_id];
+        std::size_t chunk_stride = my_data.col_stats.chunk_length;
+        for (int p = 0; p < num_target; ++p) {
+            std::size_t t = target(p);
+            auto out = output + t * static_cast<std::size_t>(stride);
+            if (row) {
+                auto src = chunk.data() + t * chunk_stride;
+                for (int q = 0; q < num_non_target; ++q) {
+                    out[q] = src[non_target(q)];
+                }
+            } else {
+                auto src = chunk.data() + t;
+                for (int q = 0; q < num_non_target; ++q) {
+                    out[q] = src[static_cast<std::size_t>(non_target(q)) * chunk_stride];
+                }
+            }
+        }
+    }
+
+public:
+    void extract(int chunk_row_id, int chunk_column_id, bool row, int target_start, int target_length, int non_target_start, int non_target_length, double* output, int stride) {
+        copy(chunk_row_id, chunk_column_id, row, target_length, [&](int p) -> int { return target_start + p; }, non_target_length, [&](int q) -> int { return non_target_start + q; }, output, stride);
+    }
+
+    void extract(int chunk_row_id, int chunk_column_id, bool row, int target_start, int target_length, const std::vector<int>& non_target_indices, double* output, int stride) {
+        copy(chunk_row_id, chunk_column_id, row, target_length, [&](int p) -> int { return target_start + p; }, non_target_indices.size(), [&](int q) -> int { return non_target_indices[q]; }, output, stride);
+    }
+
+    void extract(int chunk_row_id, int chunk_column_id, bool row, const std::vector<int>& target_indices, int non_target_start, int non_target_length, double* output, int stride) {
+        copy(chunk_row_id, chunk_column_id, row, target_indices.size(), [&](int p) -> int { return target_indices[p]; }, non_target_length, [&](int q) -> int { return non_target_start + q; }, output, stride);
+    }
+
+    void extract(int chunk_row_id, int chunk_column_id, bool row, const std::vector<int>& target_indices, const std::vector<int>& non_target_indices, double* output, int stride) {
+        copy(chunk_row_id, chunk_column_id, row, target_indices.size(), [&](int p) -> int { return target_indices[p]; }, non_target_indices.size(), [&](int q) -> int { return non_target_indices[q]; }, output, stride);
+    }
+};
+
+class MockDenseManager final : public tatami_chunked::CustomDenseChunkedMatrixManager<double, int> {
+public:
+    MockDenseManager(MockDenseData data) : my_data(std::move(data)) {}
+
+private:
+    MockDenseData my_data;
+
+public:
+    std::unique_ptr<tatami_chunked::CustomDenseChunkedMatrixWorkspace<double, int> > new_workspace() const {
+        return std::make_unique<MockDenseWorkspace>(my_data);
+    }
+
+    bool prefer_rows() const {
+        return true;
+    }
+
+    const tatami_chunked::ChunkDimensionStats<int>& row_stats() const {
+        return my_data.row_stats;
+    }
+
+    const tatami_chunked::ChunkDimensionStats<int>& column_stats() const {
+        return my_data.col_stats;
+    }
+};
+
+/********************
+ *** Sparse chunks ***
+ ********************/
+
+// Each chunk is stored in compressed sparse row format.
+struct MockSparseChunk {
+    std::vector<double> values;
+    std::vector<int> indices;
+    std::vector<std::size_t> pointers;
+};
+
+struct MockSparseData {
+    tatami_chunked::ChunkDimensionStats<int> row_stats, col_stats;
+    std::vector<MockSparseChunk> chunks;
+};
+
+inline MockSparseData simulate_sparse_chunks(int nrow, int ncol, int chunk_nrow, int chunk_ncol, double density, unsigned long long seed) {
+    MockSparseData data;
+    data.row_stats = tatami_chunked::ChunkDimensionStats<int>(nrow, chunk_nrow);
+    data.col_stats = tatami_chunked::ChunkDimensionStats<int>(ncol, chunk_ncol);
+
+    std::mt19937_64 rng(seed);
+    std::uniform_real_distribution<double> dist;
+    data.chunks.resize(static_cast<std::size_t>(data.row_stats.num_chunks) * static_cast<std::size_t>(data.col_stats.num_chunks));
+    for (auto& chunk : data.chunks) {
+        chunk.pointers.push_back(0);
+        for (int r = 0; r < chunk_nrow; ++r) {
+            for (int c = 0; c < chunk_ncol; ++c) {
+                if (dist(rng) < density) {
+                    chunk.values.push_back(dist(rng));
+                    chunk.indices.push_back(c);
+                }
+            }
+            chunk.pointers.push_back(chunk.values.size());
+        }
+    }
+    return data;
+}
+
+class MockSparseWorkspace final : public tatami_chunked::CustomSparseChunkedMatrixWorkspace<double, int> {
+public:
+    MockSparseWorkspace(const MockSparseData& data) : my_data(data), my_row_mask(data.row_stats.chunk_length), my_column_mask(data.col_stats.chunk_length) {}
+
+private:
+    const MockSparseData& my_data;
+    std::vector<unsigned char> my_row_mask, my_column_mask;
+
+    static void store(int p, double value, int index, const std::vector<double*>& output_values, const std::vector<int*>& output_indices, int* output_number) {
+        auto& count = output_number[p];
+        if (!output_values.empty()) {
+            output_values[p][count] = value;
+        }
+        if (!output_indices.empty()) {
+            output_indices[p][count] = index;
+        }
+        ++count;
+    }
+
+    // 'targets' and 'non_targets' are vectors of the selected indices, while the masks indicate whether each index of the chunk was selected.
+    void fill(
+        int chunk_row_id,
+        int chunk_column_id,
+        bool row,
+        const std::vector<int>& targets,
+        const std::vector<int>& non_targets,
+        const std::vector<unsigned char>& target_mask,
+        const std::vector<unsigned char>& non_target_mask,
+        const std::vector<double*>& output_values,
+        const std::vector<int*>& output_indices,
+        int* output_number,
+        int shift
+    ) {
+        const auto& chunk = my_data.chunks[static_cast<std::size_t>(chunk_row_id) * static_cast<std::size_t>(my_data.col_stats.num_chunks) + chunk_column_id];
+        if (row) {
+            for (auto p : targets) {
+                for (auto i = chunk.pointers[p], end = chunk.pointers[p + 1]; i < end; ++i) {
+                    auto c = chunk.indices[i];
+                    if (non_target_mask[c]) {
+                        store(p, chunk.values[i], c + shift, output_values, output_indices, output_number);
+                    }
+                }
+            }
+        } else {
+            // Iterating over rows in increasing order, so the reported indices are sorted within each column.
+            for (auto r : non_targets) {
+                for (auto i = chunk.pointers[r], end = chunk.pointers[r + 1]; i < end; ++i) {
+                    auto c = chunk.indices[i];
+                    if (target_mask[c]) {
+                        store(c, chunk.values[i], r + shift, output_values, output_indices, output_number);
+                    }
+                }
+            }
+        }
+    }
+
+    std::vector<int> my_target_buffer, my_non_target_buffer;
+
+    const std::vector<int>& set_block(std::vector<int>& buffer, std::vector<unsigned char>& mask, int start, int length) {
+        buffer.resize(length);
+        for (int i = 0; i < length; ++i) {
+            buffer[i] = start + i;
+            mask[start + i] = 1;
+        }
+        return buffer;
+    }
+
+    const std::vector<int>& set_index(std::vector<unsigned char>& mask, const std::vector<int>& indices) {
+        for (auto i : indices) {
+            mask[i] = 1;
+        }
+        return indices;
+    }
+
+    static void reset(std::vector<unsigned char>& mask, const std::vector<int>& indices) {
+        for (auto i : indices) {
+            mask[i] = 0;
+        }
+    }
+
+    template<class TargetSetter_, class NonTargetSetter_>
+    void dispatch(int chunk_row_id, int chunk_column_id, bool row, TargetSetter_ set_target, NonTargetSetter_ set_non_target, const std::vector<double*>& output_values, const std::vector<int*>& output_indices, int* output_number, int shift) {
+        auto& target_mask = (row ? my_row_mask : my_column_mask);
+        auto& non_target_mask = (row ? my_column_mask : my_row_mask);
+        const auto& targets = set_target(target_mask);
+        const auto& non_targets = set_non_target(non_target_mask);
+        fill(chunk_row_id, chunk_column_id, row, targets, non_targets, target_mask, non_target_mask, output_values, output_indices, output_number, shift);
+        reset(target_mask, targets);
+        reset(non_target_mask, non_targets);
+    }
+
+public:
+    void extract(int chunk_row_id, int chunk_column_id, bool row, int target_start, int target_length, int non_target_start, int non_target_length, const std::vector<double*>& output_values, const std::vector<int*>& output_indices, int* output_number, int shift) {
+        dispatch(
+            chunk_row_id, chunk_column_id, row,
+            [&](std::vector<unsigned char>& mask) -> const std::vector<int>& { return set_block(my_target_buffer, mask, target_start, target_length); },
+            [&](std::vector<unsigned char>& mask) -> const std::vector<int>& { return set_block(my_non_target_buffer, mask, non_target_start, non_target_length); },
+            output_values, output_indices, output_number, shift
+        );
+    }
+
+    void extract(int chunk_row_id, int chunk_column_id, bool row, int target_start, int target_length, const std::vector<int>& non_target_indices, const std::vector<double*>& output_values, const std::vector<int*>& output_indices, int* output_number, int shift) {
+        dispatch(
+            chunk_row_id, chunk_column_id, row,
+            [&](std::vector<unsigned char>& mask) -> const std::vector<int>& { return set_block(my_target_buffer, mask, target_start, target_length); },
+            [&](std::vector<unsigned char>& mask) -> const std::vector<int>& { return set_index(mask, non_target_indices); },
+            output_values, output_indices, output_number, shift
+        );
+    }
+
+    void extract(int chunk_row_id, int chunk_column_id, bool row, const std::vector<int>& target_indices, int non_target_start, int non_target_length, const std::vector<double*>& output_values, const std::vector<int*>& output_indices, int* output_number, int shift) {
+        dispatch(
+            chunk_row_id, chunk_column_id, row,
+            [&](std::vector<unsigned char>& mask) -> const std::vector<int>& { return set_index(mask, target_indices); },
+            [&](std::vector<unsigned char>& mask) -> const std::vector<int>& { return set_block(my_non_target_buffer, mask, non_target_start, non_target_length); },
+            output_values, output_indices, output_number, shift
+        );
+    }
+
+    void extract(int chunk_row_id, int chunk_column_id, bool row, const std::vector<int>& target_indices, const std::vector<int>& non_target_indices, const std::vector<double*>& output_values, const std::vector<int*>& output_indices, int* output_number, int shift) {
+        dispatch(
+            chunk_row_id, chunk_column_id, row,
+            [&](std::vector<unsigned char>& mask) -> const std::vector<int>& { return set_index(mask, target_indices); },
+            [&](std::vector<unsigned char>& mask) -> const std::vector<int>& { return set_index(mask, non_target_indices); },
+            output_values, output_indices, output_number, shift
+        );
+    }
+};
+
+class MockSparseManager final : public tatami_chunked::CustomSparseChunkedMatrixManager<double, int> {
+public:
+    MockSparseManager(MockSparseData data) : my_data(std::move(data)) {}
+
+private:
+    MockSparseData my_data;
+
+public:
+    std::unique_ptr<tatami_chunked::CustomSparseChunkedMatrixWorkspace<double, int> > new_workspace() const {
+        return std::make_unique<MockSparseWorkspace>(my_data);
+    }
+
+    bool prefer_rows() const {
+        return true;
+    }
+
+    const tatami_chunked::ChunkDimensionStats<int>& row_stats() const {
+        return my_data.row_stats;
+    }
+
+    const tatami_chunked::ChunkDimensionStats<int>& column_stats() const {
+        return my_data.col_stats;
+    }
+};
+
+#endif
@@ -0,0 +1,148 @@
+#include "tatami_chunked/LruSlabCache.hpp"
+#include "tatami_chunked/OracularSlabCache.hpp"
+#include "tatami_chunked/OracularSubsettedSlabCache.hpp"
+#include "tatami_chunked/OracularVariableSlabCache.hpp"
+#include "tatami/tatami.hpp"
+
+#include "utils.hpp"
+
+#include <vector>
+#include <string>
+#include <memory>
+#include <cstddef>
+
+// Benchmarks for the slab caches in isolation, using cheap populate() functions so that the cache bookkeeping is a noticeable fraction of the runtime.
+// Each slab corresponds to 'chunk_length' consecutive elements of the target dimension.
+
+constexpr int extent = 100000;
+constexpr int chunk_length = 20;
+constexpr std::size_t slab_size = 256;
+constexpr std::size_t num_requests = 2000000;
+
+typedef std::vector<double> Slab;
+
+inline std::pair<int, int> identify(int i) {
+    return std::make_pair(i / chunk_length, i % chunk_length);
+}
+
+inline void fill_slab(int id, Slab& slab) {
+    std::fill(slab.begin(), slab.end(), id);
+}
+
+double benchmark_lru(const std::vector<int>& pattern, int max_slabs) {
+    return time_benchmark([&]() -> void {
+        tatami_chunked::LruSlabCache<int, Slab, true> cache(max_slabs, extent / chunk_length);
+        double sum = 0;
+        for (auto p : pattern) {
+            auto info = identify(p);
+            const auto& slab = cache.find(info.first, []() -> Slab { return Slab(slab_size); }, fill_slab);
+            sum += slab[info.second];
+        }
+        volatile double sink = sum;
+        (void)sink;
+    });
+}
+
+double benchmark_oracular(const std::vector<int>& pattern, int max_slabs) {
+    return time_benchmark([&]() -> void {
+        tatami_chunked::OracularSlabCache<int, int, Slab, false, true> cache(
+            std::make_shared<tatami::FixedViewOracle<int> >(pattern.data(), pattern.size()),
+            max_slabs,
+            extent / chunk_length
+        );
+        double sum = 0;
+        for (std::size_t i = 0; i < pattern.size(); ++i) {
+            auto out = cache.next(
+                identify,
+                []() -> Slab { return Slab(slab_size); },
+                [](std::vector<std::pair<int, Slab*> >& to_populate) -> void {
+                    for (auto& x : to_populate) {
+                        fill_slab(x.first, *(x.second));
+                    }
+                }
+            );
+            sum += (*(out.first))[out.second];
+        }
+        volatile double sink = sum;
+        (void)sink;
+    });
+}
+
+double benchmark_subsetted(const std::vector<int>& pattern, int max_slabs) {
+    return time_benchmark([&]() -> void {
+        tatami_chunked::OracularSubsettedSlabCache<int, int, Slab, true> cache(
+            std::make_shared<tatami::FixedViewOracle<int> >(pattern.data(), pattern.size()),
+            max_slabs,
+            extent / chunk_length
+        );
+        double sum = 0;
+        for (std::size_t i = 0; i < pattern.size(); ++i) {
+            auto out = cache.next(
+                identify,
+                []() -> Slab { return Slab(slab_size); },
+                [](std::vector<std::tuple<int, Slab*, const tatami_chunked::OracularSubsettedSlabCacheSelectionDetails<int>*> >& to_populate) -> void {
+                    for (auto& x : to_populate) {
+                        fill_slab(std::get<0>(x), *(std::get<1>(x)));
+                    }
+                }
+            );
+            sum += (*(out.first))[out.second];
+        }
+        volatile double sink = sum;
+        (void)sink;
+    });
+}
+
+double benchmark_variable(const std::vector<int>& pattern, int max_slabs) {
+    // Slab sizes vary from 1 to 4 units, so the cache holds 'max_slabs' slabs on average.
+    auto slab_units = [](int id) -> int {
+        return id % 4 + 1;
+    };
+
+    return time_benchmark([&]() -> void {
+        tatami_chunked::OracularVariableSlabCache<int, int, Slab, int, true> cache(
+            std::make_shared<tatami::FixedViewOracle<int> >(pattern.data(), pattern.size()),
+            max_slabs * 5 / 2,
+            extent / chunk_length
+        );
+        double sum = 0;
+        for (std::size_t i = 0; i < pattern.size(); ++i) {
+            auto out = cache.next(
+                identify,
+                slab_units,
+                [&](int id, const Slab&) -> int { return slab_units(id); },
+                []() -> Slab { return Slab(slab_size); },
+                [](std::vector<std::pair<int, std::size_t> >& to_populate, std::vector<std::pair<int, std::size_t> >&, std::vector<Slab>& all_slabs) -> void {
+                    for (auto& x : to_populate) {
+                        fill_slab(x.first, all_slabs[x.second]);
+                    }
+                }
+            );
+            sum += (*(out.first))[out.second];
+        }
+        volatile double sink = sum;
+        (void)sink;
+    });
+}
+
+int main() {
+    auto patterns = standard_patterns(extent, num_requests);
+
+    for (int max_slabs : { 4, 64 }) {
+        std::string suffix = " (" + std::to_string(max_slabs) + " slabs)";
+        for (const auto& p : patterns) {
+            report_benchmark("LruSlabCache", p.name + suffix, benchmark_lru(p.pattern, max_slabs));
+        }
+        for (const auto& p : patterns) {
+            report_benchmark("OracularSlabCache", p.name + suffix, benchmark_oracular(p.pattern, max_slabs));
+        }
+        for (const auto& p : patterns) {
+            report_benchmark("OracularSubsettedSlabCache", p.name + suffix, benchmark_subsetted(p.pattern, max_slabs));
+        }
+        for (const auto& p : patterns) {
+            report_benchmark("OracularVariableSlabCache", p.name + suffix, benchmark_variable(p.pattern, max_slabs));
+        }
+    }
+
+    return 0;
+}
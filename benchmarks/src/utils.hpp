@@ -0,0 +1,111 @@
+#ifndef TATAMI_CHUNKED_BENCHMARKS_UTILS_HPP
+#define TATAMI_CHUNKED_BENCHMARKS_UTILS_HPP
+
+#include <chrono>
+#include <vector>
+#include <string>
+#include <random>
+#include <algorithm>
+#include <iostream>
+#include <iomanip>
+#include <cstddef>
+
+// Self-contained timing harness, so that the benchmarks don't need any external dependencies.
+// Each benchmark is run several times and the median time is reported to reduce the effect of outliers.
+
+struct BenchmarkOptions {
+    int repeats = 5;
+    int warmup = 1;
+};
+
+template<class Function_>
+double time_benchmark(Function_ fun, const BenchmarkOptions& options = BenchmarkOptions()) {
+    for (int w = 0; w < options.warmup; ++w) {
+        fun();
+    }
+
+    std::vector<double> times;
+    times.reserve(options.repeats);
+    for (int r = 0; r < options.repeats; ++r) {
+        auto start = std::chrono::steady_clock::now();
+        fun();
+        auto end = std::chrono::steady_clock::now();
+        times.push_back(std::chrono::duration<double, std::milli>(end - start).count());
+    }
+
+    std::sort(times.begin(), times.end());
+    return times[times.size() / 2];
+}
+
+inline void report_benchmark(const std::string& group, const std::string& name, double time) {
+    std::cout << std::left << std::setw(30) << group << std::setw(40) << name << std::right << std::setw(12) << std::fixed << std::setprecision(3) << time << " ms" << std::endl;
+}
+
+template<class Function_>
+void run_benchmark(const std::string& group, const std::string& name, Function_ fun, const BenchmarkOptions& options = BenchmarkOptions()) {
+    report_benchmark(group, name, time_benchmark(std::move(fun), options));
+}
+
+// Access patterns that are commonly encountered in applications.
+// Each pattern contains 'length' requests for elements in [0, extent).
+
+inline std::vector<int> sequential_pattern(int extent, std::size_t length) {
+    std::vector<int> output(length);
+    for (std::size_t i = 0; i < length; ++i) {
+        output[i] = i % extent;
+    }
+    return output;
+}
+
+inline std::vector<int> strided_pattern(int extent, std::size_t length, int stride) {
+    std::vector<int> output(length);
+    std::size_t position = 0, offset = 0;
+    for (std::size_t i = 0; i < length; ++i) {
+        output[i] = position;
+        position += stride;
+        if (position >= static_cast<std::size_t>(extent)) {
+            offset = (offset + 1) % stride;
+            position = offset;
+        }
+    }
+    return output;
+}
+
+inline std::vector<int> random_pattern(int extent, std::size_t length, unsigned long long seed) {
+    std::mt19937_64 rng(seed);
+    std::vector<int> output(length);
+    for (auto& o : output) {
+        o = rng() % extent;
+    }
+    return output;
+}
+
+// Runs of consecutive elements starting at random positions, e.g., for processing random subsets of contiguous features.
+inline std::vector<int> blocky_pattern(int extent, std::size_t length, int block_size, unsigned long long seed) {
+    std::mt19937_64 rng(seed);
+    std::vector<int> output;
+    output.reserve(length);
+    while (output.size() < length) {
+        int start = rng() % extent;
+        for (int b = 0; b < block_size && output.size() < length; ++b) {
+            output.push_back((start + b) % extent);
+        }
+    }
+    return output;
+}
+
+struct NamedPattern {
+    std::string name;
+    std::vector<int> pattern;
+};
+
+inline std::vector<NamedPattern> standard_patterns(int extent, std::size_t length) {
+    std::vector<NamedPattern> output;
+    output.push_back({ "sequential", sequential_pattern(extent, length) });
+    output.push_back({ "strided", strided_pattern(extent, length, 7) });
+    output.push_back({ "random", random_pattern(extent, length, 1234) });
+    output.push_back({ "blocky", blocky_pattern(extent, length, 50, 5678) });
+    return output;
+}
+
+#endif
@@ -0,0 +1,574 @@
+#ifndef TATAMI_CHUNKED_ACCESS_TRACE_HPP
+#define TATAMI_CHUNKED_ACCESS_TRACE_HPP
+
+#include "SlabCacheCounters.hpp"
+#include "utils.hpp"
+
+#include <vector>
+#include <string>
+#include <memory>
+#include <mutex>
+#include <fstream>
+#include <chrono>
+#include <stdexcept>
+#include <algorithm>
+#include <utility>
+#include <cstdint>
+#include <cstddef>
+#include <cstring>
+
+#include "tatami/tatami.hpp"
+#include "sanisizer/sanisizer.hpp"
+
+/**
+ * @file AccessTrace.hpp
+ * @brief Record and replay the access pattern for a matrix.
+ */
+
+namespace tatami_chunked {
+
+/**
+ * Selection of the non-target dimension for each extractor in an `AccessTrace`.
+ */
+enum class AccessTraceSelection : unsigned char { FULL, BLOCK, INDEX };
+
+/**
+ * @brief Record of a single extractor in an `AccessTrace`.
+ * @tparam Index_ Integer type of the row/column indices.
+ */
+template<typename Index_>
+struct AccessTraceExtractor {
+    /**
+     * Whether the rows are the target dimension.
+     */
+    bool row = true;
+
+    /**
+     * Whether the extractor was sparse.
+     */
+    bool sparse = false;
+
+    /**
+     * Whether the extractor was created with an oracle.
+     */
+    bool oracle = false;
+
+    /**
+     * Selection of the non-target dimension.
+     */
+    AccessTraceSelection selection = AccessTraceSelection::FULL;
+
+    /**
+     * Start of the contiguous block along the non-target dimension.
+     * Only used if `selection = AccessTraceSelection::BLOCK`.
+     */
+    Index_ block_start = 0;
+
+    /**
+     * Length of the contiguous block along the non-target dimension.
+     * Only used if `selection = AccessTraceSelection::BLOCK`.
+     */
+    Index_ block_length = 0;
+
+    /**
+     * Sorted and unique indices of the non-target dimension.
+     * Only used if `selection = AccessTraceSelection::INDEX`.
+     */
+    std::vector<Index_> indices;
+
+    /**
+     * Indices of the elements of the target dimension that were fetched, in the order of the calls to `fetch()`.
+     * For extractors with an oracle, these are the predictions that were used by each `fetch()`.
+     */
+    std::vector<Index_> fetches;
+};
+
+/**
+ * @brief Record of a single chunk read in an `AccessTrace`.
+ * @tparam Index_ Integer type of the row/column indices.
+ */
+template<typename Index_>
+struct AccessTraceChunkRead {
+    /**
+     * Row of the chunk grid containing the chunk that was read.
+     */
+    Index_ chunk_row_id = 0;
+
+    /**
+     * Column of the chunk grid containing the chunk that was read.
+     */
+    Index_ chunk_column_id = 0;
+
+    /**
+     * Whether the chunk was read for extraction of rows, i.e., the rows were the target dimension.
+     */
+    bool row = true;
+};
+
+/**
+ * @brief Trace of the access pattern for a matrix.
+ *
+ * This is usually created by an `AccessRecorder` and can be saved to file with `save_access_trace()`.
+ * It can then be replayed against a matrix with `replay_access_trace()`, e.g., to compare different cache settings.
+ *
+ * @tparam Index_ Integer type of the row/column indices.
+ */
+template<typename Index_>
+struct AccessTrace {
+    /**
+     * Number of rows in the matrix.
+     */
+    Index_ nrow = 0;
+
+    /**
+     * Number of columns in the matrix.
+     */
+    Index_ ncol = 0;
+
+    /**
+     * Extractors in the order of their creation.
+     */
+    std::vector<AccessTraceExtractor<Index_> > extractors;
+
+    /**
+     * Chunk reads in the order of the calls to each workspace's `extract()`.
+     */
+    std::vector<AccessTraceChunkRead<Index_> > chunk_reads;
+};
+
+/**
+ * @brief Thread-safe recorder for an `AccessTrace`.
+ *
+ * This is used by the `RecordedMatrix` to record each extractor and by the `RecordedDenseChunkedMatrixManager` and `RecordedSparseChunkedMatrixManager` to record each chunk read.
+ * The same recorder can be shared by a `RecordedMatrix` and its underlying manager so that all information is stored in a single trace.
+ *
+ * @tparam Index_ Integer type of the row/column indices.
+ */
+template<typename Index_>
+class AccessRecorder {
+public:
+    /**
+     * @param nrow Number of rows in the matrix.
+     * @param ncol Number of columns in the matrix.
+     */
+    AccessRecorder(Index_ nrow, Index_ ncol) {
+        my_trace.nrow = nrow;
+        my_trace.ncol = ncol;
+    }
+
+private:
+    mutable std::mutex my_mutex;
+    AccessTrace<Index_> my_trace;
+
+public:
+    /**
+     * @param details Details of the extractor, excluding `AccessTraceExtractor::fetches`.
+     * @return Identifier for this extractor, to be passed to `finish_extractor()`.
+     */
+    std::size_t add_extractor(AccessTraceExtractor<Index_> details) {
+        std::lock_guard<std::mutex> lck(my_mutex);
+        my_trace.extractors.push_back(std::move(details));
+        return my_trace.extractors.size() - 1;
+    }
+
+    /**
+     * @param id Identifier for the extractor, as returned by `add_extractor()`.
+     * @param fetches Indices of the target dimension elements that were fetched by this extractor.
+     */
+    void finish_extractor(std::size_t id, std::vector<Index_> fetches) {
+        std::lock_guard<std::mutex> lck(my_mutex);
+        my_trace.extractors[id].fetches = std::move(fetches);
+    }
+
+    /**
+     * @param chunk_row_id Row of the chunk grid containing the chunk that was read.
+     * @param chunk_column_id Column of the chunk grid containing the chunk that was read.
+     * @param row Whether the chunk was read for extraction of rows.
+     */
+    void add_chunk_read(Index_ chunk_row_id, Index_ chunk_column_id, bool row) {
+        std::lock_guard<std::mutex> lck(my_mutex);
+        AccessTraceChunkRead<Index_> current;
+        current.chunk_row_id = chunk_row_id;
+        current.chunk_column_id = chunk_column_id;
+        current.row = row;
+        my_trace.chunk_reads.push_back(current);
+    }
+
+    /**
+     * @return Number of chunk reads that have been recorded.
+     */
+    std::size_t get_num_chunk_reads() const {
+        std::lock_guard<std::mutex> lck(my_mutex);
+        return my_trace.chunk_reads.size();
+    }
+
+    /**
+     * @return Copy of the trace.
+     * Fetches are only reported for extractors that have been destroyed, as each extractor buffers its fetches until `finish_extractor()` is called.
+     */
+    AccessTrace<Index_> get_trace() const {
+        std::lock_guard<std::mutex> lck(my_mutex);
+        return my_trace;
+    }
+
+    /**
+     * Clear all extractors and chunk reads from the trace.
+     * This should only be called when no extractors from the associated `RecordedMatrix` are alive.
+     */
+    void clear() {
+        std::lock_guard<std::mutex> lck(my_mutex);
+        my_trace.extractors.clear();
+        my_trace.chunk_reads.clear();
+    }
+};
+
+/**
+ * @cond
+ */
+namespace AccessTrace_internal {
+
+constexpr char magic[8] = { 'T', 'A', 'T', 'A', 'M', 'I', 'C', 'T' };
+constexpr std::uint32_t version = 1;
+
+inline void write_integer(std::ofstream& output, std::uint64_t value) {
+    output.write(reinterpret_cast<const char*>(&value), sizeof(value));
+}
+
+inline std::uint64_t read_integer(std::ifstream& input) {
+    std::uint64_t value;
+    input.read(reinterpret_cast<char*>(&value), sizeof(value));
+    if (!input) {
+        throw std::runtime_error("unexpected end of the access trace file");
+    }
+    return value;
+}
+
+template<typename Index_>
+Index_ read_index(std::ifstream& input) {
+    return sanisizer::cast<Index_>(read_integer(input));
+}
+
+// Sequences of indices are stored as runs of consecutive values, which is much more compact for the common case of consecutive access.
+template<typename Index_>
+void write_sequence(std::ofstream& output, const std::vector<Index_>& sequence) {
+    std::vector<std::pair<Index_, Index_> > runs;
+    for (auto x : sequence) {
+        if (!runs.empty() && runs.back().first + runs.back().second == x) {
+            ++(runs.back().second);
+        } else {
+            runs.emplace_back(x, 1);
+        }
+    }
+
+    write_integer(output, runs.size());
+    for (const auto& r : runs) {
+        write_integer(output, r.first);
+        write_integer(output, r.second);
+    }
+}
+
+template<typename Index_>
+std::vector<Index_> read_sequence(std::ifstream& input) {
+    std::vector<Index_> output;
+    auto num_runs = read_integer(input);
+    for (std::uint64_t r = 0; r < num_runs; ++r) {
+        auto start = read_index<Index_>(input);
+        auto length = read_index<Index_>(input);
+        for (Index_ i = 0; i < length; ++i) {
+            output.push_back(start + i);
+        }
+    }
+    return output;
+}
+
+template<typename Value_, typename Index_>
+void replay_fetches(tatami::MyopicDenseExtractor<Value_, Index_>& ext, const std::vector<Index_>& fetches, std::vector<Value_>& vbuffer, std::vector<Index_>&) {
+    for (auto i : fetches) {
+        ext.fetch(i, vbuffer.data());
+    }
+}
+
+template<typename Value_, typename Index_>
+void replay_fetches(tatami::OracularDenseExtractor<Value_, Index_>& ext, const std::vector<Index_>& fetches, std::vector<Value_>& vbuffer, std::vector<Index_>&) {
+    for (I<decltype(fetches.size())> f = 0, end = fetches.size(); f < end; ++f) {
+        ext.fetch(vbuffer.data());
+    }
+}
+
+template<typename Value_, typename Index_>
+void replay_fetches(tatami::MyopicSparseExtractor<Value_, Index_>& ext, const std::vector<Index_>& fetches, std::vector<Value_>& vbuffer, std::vector<Index_>& ibuffer) {
+    for (auto i : fetches) {
+        ext.fetch(i, vbuffer.data(), ibuffer.data());
+    }
+}
+
+template<typename Value_, typename Index_>
+void replay_fetches(tatami::OracularSparseExtractor<Value_, Index_>& ext, const std::vector<Index_>& fetches, std::vector<Value_>& vbuffer, std::vector<Index_>& ibuffer) {
+    for (I<decltype(fetches.size())> f = 0, end = fetches.size(); f < end; ++f) {
+        ext.fetch(vbuffer.data(), ibuffer.data());
+    }
+}
+
+}
+/**
+ * @endcond
+ */
+
+/**
+ * Save an `AccessTrace` to a compact binary file.
+ * The file starts with the magic string `TATAMICT` and a 32-bit unsigned integer specifying the format version, currently 1.
+ * All subsequent integers are stored as 64-bit unsigned integers with the native endianness of the machine.
+ * Sequences of indices are stored as runs of consecutive values, so a trace of consecutive access only requires a few bytes for each extractor.
+ *
+ * @tparam Index_ Integer type of the row/column indices.
+ * @param trace Trace to be saved.
+ * @param path Path to the output file.
+ */
+template<typename Index_>
+void save_access_trace(const AccessTrace<Index_>& trace, const std::string& path) {
+    namespace ai = AccessTrace_internal;
+    std::ofstream output(path, std::ios::binary | std::ios::trunc);
+    if (!output) {
+        throw std::runtime_error("failed to open '" + path + "' for writing");
+    }
+
+    output.write(ai::magic, sizeof(ai::magic));
+    output.write(reinterpret_cast<const char*>(&ai::version), sizeof(ai::version));
+    ai::write_integer(output, trace.nrow);
+    ai::write_integer(output, trace.ncol);
+
+    ai::write_integer(output, trace.extractors.size());
+    for (const auto& ex : trace.extractors) {
+        unsigned char flags = static_cast<unsigned char>(ex.row) | (static_cast<unsigned char>(ex.sparse) << 1) | (static_cast<unsigned char>(ex.oracle) << 2);
+        output.put(static_cast<char>(flags));
+        output.put(static_cast<char>(ex.selection));
+        if (ex.selection == AccessTraceSelection::BLOCK) {
+            ai::write_integer(output, ex.block_start);
+            ai::write_integer(output, ex.block_length);
+        } else if (ex.selection == AccessTraceSelection::INDEX) {
+            ai::write_sequence(output, ex.indices);
+        }
+        ai::write_sequence(output, ex.fetches);
+    }
+
+    ai::write_integer(output, trace.chunk_reads.size());
+    for (const auto& read : trace.chunk_reads) {
+        ai::write_integer(output, read.chunk_row_id);
+        ai::write_integer(output, read.chunk_column_id);
+        output.put(static_cast<char>(read.row));
+    }
+
+    output.close();
+    if (!output) {
+        throw std::runtime_error("failed to write the access trace to '" + path + "'");
+    }
+}
+
+/**
+ * @tparam Index_ Integer type of the row/column indices.
+ * @param path Path to a file created by `save_access_trace()`.
+ * @return The trace stored in `path`.
+ */
+template<typename Index_>
+AccessTrace<Index_> load_access_trace(const std::string& path) {
+    namespace ai = AccessTrace_internal;
+    std::ifstream input(path, std::ios::binary);
+    if (!input) {
+        throw std::runtime_error("failed to open '" + path + "' for reading");
+    }
+
+    char magic[sizeof(ai::magic)];
+    std::uint32_t version = 0;
+    input.read(magic, sizeof(magic));
+    input.read(reinterpret_cast<char*>(&version), sizeof(version));
+    if (!input || std::memcmp(magic, ai::magic, sizeof(magic)) != 0) {
+        throw std::runtime_error("'" + path + "' is not an access trace file");
+    }
+    if (version != ai::version) {
+        throw std::runtime_error("unsupported version of the access trace file");
+    }
+
+    AccessTrace<Index_> trace;
+    trace.nrow = ai::read_index<Index_>(input);
+    trace.ncol = ai::read_index<Index_>(input);
+
+    auto get_byte = [&]() -> unsigned char {
+        char c;
+        if (!input.get(c)) {
+            throw std::runtime_error("unexpected end of the access trace file");
+        }
+        return static_cast<unsigned char>(c);
+    };
+
+    auto num_extractors = ai::read_integer(input);
+    for (std::uint64_t e = 0; e < num_extractors; ++e) {
+        AccessTraceExtractor<Index_> ex;
+        auto flags = get_byte();
+        ex.row = flags & 1;
+        ex.sparse = flags & 2;
+        ex.oracle = flags & 4;
+
+        auto selection = get_byte();
+        if (selection > static_cast<unsigned char>(AccessTraceSelection::INDEX)) {
+            throw std::runtime_error("invalid selection in the access trace file");
+        }
+        ex.selection = static_cast<AccessTraceSelection>(selection);
+        if (ex.selection == AccessTraceSelection::BLOCK) {
+            ex.block_start = ai::read_index<Index_>(input);
+            ex.block_length = ai::read_index<Index_>(input);
+        } else if (ex.selection == AccessTraceSelection::INDEX) {
+            ex.indices = ai::read_sequence<Index_>(input);
+        }
+        ex.fetches = ai::read_sequence<Index_>(input);
+        trace.extractors.push_back(std::move(ex));
+    }
+
+    auto num_reads = ai::read_integer(input);
+    for (std::uint64_t r = 0; r < num_reads; ++r) {
+        AccessTraceChunkRead<Index_> read;
+        read.chunk_row_id = ai::read_index<Index_>(input);
+        read.chunk_column_id = ai::read_index<Index_>(input);
+        read.row = get_byte();
+        trace.chunk_reads.push_back(read);
+    }
+
+    return trace;
+}
+
+/**
+ * @brief Result of `replay_access_trace()`.
+ */
+struct AccessTraceReplayResult {
+    /**
+     * Total time spent creating the extractors and calling `fetch()`, in nanoseconds.
+     */
+    std::uint64_t nanoseconds = 0;
+
+    /**
+     * Total number of calls to `fetch()`.
+     */
+    std::size_t num_fetches = 0;
+
+    /**
+     * Sum of the counters across all extractors that implement the `SlabCacheCountersReporter` interface.
+     */
+    SlabCacheCounters counters;
+
+    /**
+     * Number of chunk reads.
+     * This is only reported by `replay_dense_chunked_access_trace()` and `replay_sparse_chunked_access_trace()`, and is zero otherwise.
+     */
+    std::size_t num_chunk_reads = 0;
+};
+
+/**
+ * Replay an `AccessTrace` against a matrix.
+ * Each extractor in the trace is recreated in turn, with the same selection of the non-target dimension and the same calls to `fetch()`.
+ * If the original extractor had an oracle, the replayed extractor uses a `tatami::FixedVectorOracle` containing the recorded fetches.
+ *
+ * @tparam Value_ Numeric type of the matrix values.
+ * @tparam Index_ Integer type of the row/column indices.
+ *
+ * @param trace Trace of the access pattern.
+ * @param matrix Matrix to be accessed.
+ * This should have the same dimensions as the matrix in `trace`.
+ *
+ * @return Timings and counters for the replay.
+ */
+template<typename Value_, typename Index_>
+AccessTraceReplayResult replay_access_trace(const AccessTrace<Index_>& trace, const tatami::Matrix<Value_, Index_>& matrix) {
+    if (trace.nrow != matrix.nrow() || trace.ncol != matrix.ncol()) {
+        throw std::runtime_error("dimensions of the matrix and the access trace are not the same");
+    }
+
+    AccessTraceReplayResult output;
+    std::vector<Value_> vbuffer;
+    std::vector<Index_> ibuffer;
+
+    auto fetch_all = [&](auto& ext, const std::vector<Index_>& fetches) -> void {
+        AccessTrace_internal::replay_fetches(*ext, fetches, vbuffer, ibuffer);
+        if (auto reporter = dynamic_cast<const SlabCacheCountersReporter*>(ext.get())) {
+            output.counters += reporter->get_slab_cache_counters();
+        }
+    };
+
+    for (const auto& ex : trace.extractors) {
+        Index_ extent = (ex.row ? trace.ncol : trace.nrow);
+        if (ex.selection == AccessTraceSelection::BLOCK) {
+            extent = ex.block_length;
+        } else if (ex.selection == AccessTraceSelection::INDEX) {
+            extent = sanisizer::cast<Index_>(ex.indices.size());
+        }
+        vbuffer.resize(extent);
+        ibuffer.resize(extent);
+
+        // Constructing the oracle and indices outside of the timed section.
+        std::shared_ptr<const tatami::Oracle<Index_> > oracle;
+        if (ex.oracle) {
+            oracle = std::make_shared<tatami::FixedVectorOracle<Index_> >(ex.fetches);
+        }
+        tatami::VectorPtr<Index_> indices;
+        if (ex.selection == AccessTraceSelection::INDEX) {
+            indices = std::make_shared<std::vector<Index_> >(ex.indices);
+        }
+
+        auto start = std::chrono::steady_clock::now();
+        if (ex.sparse) {
+            if (ex.oracle) {
+                auto ext = [&]{
+                    if (ex.selection == AccessTraceSelection::BLOCK) {
+                        return matrix.sparse(ex.row, std::move(oracle), ex.block_start, ex.block_length, tatami::Options());
+                    } else if (ex.selection == AccessTraceSelection::INDEX) {
+                        return matrix.sparse(ex.row, std::move(oracle), std::move(indices), tatami::Options());
+                    } else {
+                        return matrix.sparse(ex.row, std::move(oracle), tatami::Options());
+                    }
+                }();
+                fetch_all(ext, ex.fetches);
+            } else {
+                auto ext = [&]{
+                    if (ex.selection == AccessTraceSelection::BLOCK) {
+                        return matrix.sparse(ex.row, ex.block_start, ex.block_length, tatami::Options());
+                    } else if (ex.selection == AccessTraceSelection::INDEX) {
+                        return matrix.sparse(ex.row, std::move(indices), tatami::Options());
+                    } else {
+                        return matrix.sparse(ex.row, tatami::Options());
+                    }
+                }();
+                fetch_all(ext, ex.fetches);
+            }
+        } else {
+            if (ex.oracle) {
+                auto ext = [&]{
+                    if (ex.selection == AccessTraceSelection::BLOCK) {
+                        return matrix.dense(ex.row, std::move(oracle), ex.block_start, ex.block_length, tatami::Options());
+                    } else if (ex.selection == AccessTraceSelection::INDEX) {
+                        return matrix.dense(ex.row, std::move(oracle), std::move(indices), tatami::Options());
+                    } else {
+                        return matrix.dense(ex.row, std::move(oracle), tatami::Options());
+                    }
+                }();
+                fetch_all(ext, ex.fetches);
+            } else {
+                auto ext = [&]{
+                    if (ex.selection == AccessTraceSelection::BLOCK) {
+                        return matrix.dense(ex.row, ex.block_start, ex.block_length, tatami::Options());
+                    } else if (ex.selection == AccessTraceSelection::INDEX) {
+                        return matrix.dense(ex.row, std::move(indices), tatami::Options());
+                    } else {
+                        return matrix.dense(ex.row, tatami::Options());
+                    }
+                }();
+                fetch_all(ext, ex.fetches);
+            }
+        }
+        output.nanoseconds += std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start).count();
+        output.num_fetches += ex.fetches.size();
+    }
+
+    return output;
+}
+
+}
+
+#endif
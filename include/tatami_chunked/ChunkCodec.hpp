@@ -0,0 +1,223 @@
+#ifndef TATAMI_CHUNKED_CHUNK_CODEC_HPP
+#define TATAMI_CHUNKED_CHUNK_CODEC_HPP
+
+#include "utils.hpp"
+
+#include <vector>
+#include <string>
+#include <stdexcept>
+#include <algorithm>
+#include <cstddef>
+
+#include "sanisizer/sanisizer.hpp"
+
+#ifdef TATAMI_CHUNKED_USE_ZLIB
+#include "zlib.h"
+#endif
+
+#ifdef TATAMI_CHUNKED_USE_ZSTD
+#include "zstd.h"
+#endif
+
+#ifdef TATAMI_CHUNKED_USE_LZ4
+#include "lz4.h"
+#endif
+
+/**
+ * @file ChunkCodec.hpp
+ * @brief Codecs for compressed chunks.
+ */
+
+namespace tatami_chunked {
+
+/**
+ * @brief Interface for a chunk compression codec.
+ *
+ * Each codec converts the serialized contents of a chunk to and from a compressed byte stream,
+ * see `CompressedDenseChunkedMatrixManager` and `CompressedSparseChunkedMatrixManager` for usage.
+ * Implementations should be stateless so that the same instance can be used from multiple threads.
+ */
+class ChunkCodec {
+public:
+    /**
+     * @cond
+     */
+    ChunkCodec() = default;
+    ChunkCodec(const ChunkCodec&) = default;
+    ChunkCodec(ChunkCodec&&) = default;
+    ChunkCodec& operator=(const ChunkCodec&) = default;
+    ChunkCodec& operator=(ChunkCodec&&) = default;
+    virtual ~ChunkCodec() = default;
+    /**
+     * @endcond
+     */
+
+    /**
+     * @param input Pointer to the uncompressed bytes.
+     * @param input_size Number of uncompressed bytes.
+     * @param[out] output Vector to which the compressed bytes should be appended.
+     */
+    virtual void compress(const unsigned char* input, std::size_t input_size, std::vector<unsigned char>& output) const = 0;
+
+    /**
+     * @param input Pointer to the compressed bytes.
+     * @param input_size Number of compressed bytes.
+     * @param[out] output Pointer to an array in which to store the uncompressed bytes.
+     * @param output_size Number of uncompressed bytes, as originally supplied to `compress()`.
+     *
+     * This should throw an error if the decompressed data does not have the expected size.
+     */
+    virtual void decompress(const unsigned char* input, std::size_t input_size, unsigned char* output, std::size_t output_size) const = 0;
+};
+
+/**
+ * @brief Codec that stores chunks without any compression.
+ *
+ * This is mostly useful for testing and as a baseline for the other codecs.
+ */
+class UncompressedChunkCodec final : public ChunkCodec {
+public:
+    /**
+     * @cond
+     */
+    void compress(const unsigned char* input, std::size_t input_size, std::vector<unsigned char>& output) const {
+        output.insert(output.end(), input, input + input_size);
+    }
+
+    void decompress(const unsigned char* input, std::size_t input_size, unsigned char* output, std::size_t output_size) const {
+        if (input_size != output_size) {
+            throw std::runtime_error("unexpected size of an uncompressed chunk");
+        }
+        std::copy_n(input, input_size, output);
+    }
+    /**
+     * @endcond
+     */
+};
+
+#ifdef TATAMI_CHUNKED_USE_ZLIB
+/**
+ * @brief Codec for DEFLATE compression with zlib.
+ *
+ * Only available if `TATAMI_CHUNKED_USE_ZLIB` is defined, see the `TATAMI_CHUNKED_USE_ZLIB` CMake option.
+ */
+class ZlibChunkCodec final : public ChunkCodec {
+public:
+    /**
+     * @param level Compression level, from 0 to 9.
+     */
+    ZlibChunkCodec(int level = Z_DEFAULT_COMPRESSION) : my_level(level) {}
+
+private:
+    int my_level;
+
+public:
+    /**
+     * @cond
+     */
+    void compress(const unsigned char* input, std::size_t input_size, std::vector<unsigned char>& output) const {
+        auto bound = compressBound(sanisizer::cast<uLong>(input_size));
+        auto old_size = output.size();
+        output.resize(sanisizer::sum<I<decltype(output.size())> >(old_size, bound));
+        uLongf compressed_size = bound;
+        if (compress2(output.data() + old_size, &compressed_size, input, sanisizer::cast<uLong>(input_size), my_level) != Z_OK) {
+            throw std::runtime_error("failed to compress a chunk with zlib");
+        }
+        output.resize(old_size + compressed_size);
+    }
+
+    void decompress(const unsigned char* input, std::size_t input_size, unsigned char* output, std::size_t output_size) const {
+        uLongf decompressed_size = sanisizer::cast<uLongf>(output_size);
+        if (uncompress(output, &decompressed_size, input, sanisizer::cast<uLong>(input_size)) != Z_OK || decompressed_size != output_size) {
+            throw std::runtime_error("failed to decompress a chunk with zlib");
+        }
+    }
+    /**
+     * @endcond
+     */
+};
+#endif
+
+#ifdef TATAMI_CHUNKED_USE_ZSTD
+/**
+ * @brief Codec for Zstandard compression.
+ *
+ * Only available if `TATAMI_CHUNKED_USE_ZSTD` is defined, see the `TATAMI_CHUNKED_USE_ZSTD` CMake option.
+ */
+class ZstdChunkCodec final : public ChunkCodec {
+public:
+    /**
+     * @param level Compression level, see the Zstandard documentation for details.
+     */
+    ZstdChunkCodec(int level = 3) : my_level(level) {}
+
+private:
+    int my_level;
+
+public:
+    /**
+     * @cond
+     */
+    void compress(const unsigned char* input, std::size_t input_size, std::vector<unsigned char>& output) const {
+        auto bound = ZSTD_compressBound(input_size);
+        auto old_size = output.size();
+        output.resize(sanisizer::sum<I<decltype(output.size())> >(old_size, bound));
+        auto compressed_size = ZSTD_compress(output.data() + old_size, bound, input, input_size, my_level);
+        if (ZSTD_isError(compressed_size)) {
+            throw std::runtime_error(std::string("failed to compress a chunk with Zstandard: ") + ZSTD_getErrorName(compressed_size));
+        }
+        output.resize(old_size + compressed_size);
+    }
+
+    void decompress(const unsigned char* input, std::size_t input_size, unsigned char* output, std::size_t output_size) const {
+        auto decompressed_size = ZSTD_decompress(output, output_size, input, input_size);
+        if (ZSTD_isError(decompressed_size) || decompressed_size != output_size) {
+            throw std::runtime_error("failed to decompress a chunk with Zstandard");
+        }
+    }
+    /**
+     * @endcond
+     */
+};
+#endif
+
+#ifdef TATAMI_CHUNKED_USE_LZ4
+/**
+ * @brief Codec for LZ4 compression.
+ *
+ * Only available if `TATAMI_CHUNKED_USE_LZ4` is defined, see the `TATAMI_CHUNKED_USE_LZ4` CMake option.
+ * This trades a lower compression ratio for much faster decompression than the other codecs.
+ */
+class Lz4ChunkCodec final : public ChunkCodec {
+public:
+    /**
+     * @cond
+     */
+    void compress(const unsigned char* input, std::size_t input_size, std::vector<unsigned char>& output) const {
+        int in_size = sanisizer::cast<int>(input_size);
+        int bound = LZ4_compressBound(in_size);
+        auto old_size = output.size();
+        output.resize(sanisizer::sum<I<decltype(output.size())> >(old_size, bound));
+        int compressed_size = LZ4_compress_default(reinterpret_cast<const char*>(input), reinterpret_cast<char*>(output.data() + old_size), in_size, bound);
+        if (compressed_size <= 0 && in_size > 0) {
+            throw std::runtime_error("failed to compress a chunk with LZ4");
+        }
+        output.resize(old_size + static_cast<std::size_t>(compressed_size));
+    }
+
+    void decompress(const unsigned char* input, std::size_t input_size, unsigned char* output, std::size_t output_size) const {
+        int out_size = sanisizer::cast<int>(output_size);
+        int decompressed_size = LZ4_decompress_safe(reinterpret_cast<const char*>(input), reinterpret_cast<char*>(output), sanisizer::cast<int>(input_size), out_size);
+        if (decompressed_size != out_size) {
+            throw std::runtime_error("failed to decompress a chunk with LZ4");
+        }
+    }
+    /**
+     * @endcond
+     */
+};
+#endif
+
+}
+
+#endif
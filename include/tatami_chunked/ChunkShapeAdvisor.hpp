@@ -0,0 +1,325 @@
+#ifndef TATAMI_CHUNKED_CHUNK_SHAPE_ADVISOR_HPP
+#define TATAMI_CHUNKED_CHUNK_SHAPE_ADVISOR_HPP
+
+#include "ChunkDimensionStats.hpp"
+#include "SlabCacheStats.hpp"
+#include "SlabCacheAdvisor.hpp"
+
+#include <vector>
+#include <memory>
+#include <optional>
+#include <algorithm>
+#include <stdexcept>
+#include <cmath>
+#include <cstddef>
+
+#include "tatami/tatami.hpp"
+#include "sanisizer/sanisizer.hpp"
+
+/**
+ * @file ChunkShapeAdvisor.hpp
+ * @brief Choose the chunk dimensions for an access workload.
+ */
+
+namespace tatami_chunked {
+
+/**
+ * @brief A single pass of a workload for `advise_chunk_shape()`.
+ *
+ * Each pass corresponds to a single extractor from a `tatami::Matrix`, which accesses a sequence of elements along the target dimension.
+ * For each element of the target dimension, the extractor retrieves the same selection of elements along the non-target dimension.
+ *
+ * @tparam Index_ Integer type of the row/column indices.
+ */
+template<typename Index_>
+struct ChunkShapeWorkloadPass {
+    /**
+     * Whether the rows are the target dimension.
+     */
+    bool row = true;
+
+    /**
+     * Sequence of accesses along the target dimension.
+     * This should not be `NULL`.
+     */
+    std::shared_ptr<const tatami::Oracle<Index_> > oracle;
+
+    /**
+     * Sorted and unique indices of the elements of the non-target dimension to be extracted.
+     * If not set, a contiguous block is extracted, as defined by `non_target_block_start` and `non_target_block_length`.
+     */
+    std::optional<std::vector<Index_> > non_target_indices;
+
+    /**
+     * Start of the contiguous block along the non-target dimension.
+     * Ignored if `non_target_indices` is set.
+     */
+    Index_ non_target_block_start = 0;
+
+    /**
+     * Length of the contiguous block along the non-target dimension.
+     * If not set, the block extends to the end of the non-target dimension.
+     * Ignored if `non_target_indices` is set.
+     */
+    std::optional<Index_> non_target_block_length;
+
+    /**
+     * Weight of this pass, e.g., the number of times that this pass is performed for each execution of the workload.
+     */
+    double weight = 1;
+};
+
+/**
+ * @brief Options for `compute_chunk_shape_cost()` and `advise_chunk_shape()`.
+ */
+struct ChunkShapeAdvisorOptions {
+    /**
+     * Size of the in-memory cache in bytes, see `CustomDenseChunkedMatrixOptions::maximum_cache_size`.
+     */
+    std::size_t maximum_cache_size = sanisizer::cap<std::size_t>(100000000);
+
+    /**
+     * Whether to enforce a minimum size for the cache, see `CustomDenseChunkedMatrixOptions::require_minimum_cache`.
+     * If `true`, a chunk shape may have a cache footprint that is larger than `maximum_cache_size`.
+     */
+    bool require_minimum_cache = true;
+
+    /**
+     * Size of each data element in bytes, in the cache and in each chunk.
+     */
+    std::size_t element_size = sizeof(double);
+
+    /**
+     * Fixed cost of each call to `CustomDenseChunkedMatrixWorkspace::extract()`, in terms of the equivalent number of bytes read.
+     * This accounts for the overhead of locating, decompressing and copying each chunk, independent of its size.
+     * Larger values will favor larger chunks.
+     */
+    double extract_overhead = 4096;
+};
+
+/**
+ * @brief Cost of a chunk shape for a workload.
+ * @tparam Index_ Integer type of the row/column indices.
+ */
+template<typename Index_>
+struct ChunkShapeCost {
+    /**
+     * Number of rows in each chunk.
+     */
+    Index_ chunk_nrow = 0;
+
+    /**
+     * Number of columns in each chunk.
+     */
+    Index_ chunk_ncol = 0;
+
+    /**
+     * Weighted number of calls to `CustomDenseChunkedMatrixWorkspace::extract()`, i.e., the number of chunks that are read.
+     */
+    double num_extract_calls = 0;
+
+    /**
+     * Weighted number of bytes that are read from the chunks.
+     * Each chunk is assumed to be read in its entirety, so each call to `CustomDenseChunkedMatrixWorkspace::extract()` reads `chunk_nrow * chunk_ncol` elements.
+     */
+    double bytes_read = 0;
+
+    /**
+     * Largest cache footprint in bytes across all passes of the workload, as determined by `SlabCacheStats`.
+     */
+    std::size_t cache_footprint = 0;
+
+    /**
+     * Total cost, defined as `bytes_read + num_extract_calls * ChunkShapeAdvisorOptions::extract_overhead`.
+     */
+    double cost = 0;
+};
+
+/**
+ * Compute the cost of a chunk shape for a workload.
+ * For each pass, we compute the size of each slab and the number of slabs in the cache with `SlabCacheStats`,
+ * and then we compute the number of slabs that need to be extracted with `SlabCacheAdvisor`.
+ * Each slab extraction requires one call to `CustomDenseChunkedMatrixWorkspace::extract()` for each chunk that overlaps the non-target selection.
+ *
+ * This cost model is exact for the number of chunks read by `CustomDenseChunkedMatrix` extractors without an oracle, which use a `LruSlabCache`.
+ * It is a reasonable approximation for extractors with an oracle, which usually read the same or fewer chunks.
+ *
+ * @tparam Index_ Integer type of the row/column indices.
+ *
+ * @param nrow Number of rows in the matrix.
+ * @param ncol Number of columns in the matrix.
+ * @param chunk_nrow Number of rows in each chunk.
+ * This should be positive if `nrow` is positive.
+ * @param chunk_ncol Number of columns in each chunk.
+ * This should be positive if `ncol` is positive.
+ * @param workload Passes of the workload.
+ * @param options Further options.
+ *
+ * @return Cost of the chunk shape.
+ */
+template<typename Index_>
+ChunkShapeCost<Index_> compute_chunk_shape_cost(
+    Index_ nrow,
+    Index_ ncol,
+    Index_ chunk_nrow,
+    Index_ chunk_ncol,
+    const std::vector<ChunkShapeWorkloadPass<Index_> >& workload,
+    const ChunkShapeAdvisorOptions& options)
+{
+    if ((nrow > 0 && chunk_nrow <= 0) || (ncol > 0 && chunk_ncol <= 0)) {
+        throw std::runtime_error("chunk dimensions should be positive for a non-empty matrix");
+    }
+
+    ChunkShapeCost<Index_> output;
+    output.chunk_nrow = chunk_nrow;
+    output.chunk_ncol = chunk_ncol;
+
+    ChunkDimensionStats<Index_> row_stats(nrow, chunk_nrow), col_stats(ncol, chunk_ncol);
+    double chunk_bytes = static_cast<double>(chunk_nrow) * static_cast<double>(chunk_ncol) * static_cast<double>(options.element_size);
+    std::size_t cache_size_in_elements = (options.element_size ? options.maximum_cache_size / options.element_size : 0);
+
+    for (const auto& pass : workload) {
+        const auto& target_stats = (pass.row ? row_stats : col_stats);
+        const auto& non_target_stats = (pass.row ? col_stats : row_stats);
+
+        // Counting the number of non-target elements and the number of chunks that they overlap.
+        Index_ non_target_length = 0;
+        Index_ num_overlapping = 0;
+        if (pass.non_target_indices.has_value()) {
+            const auto& indices = *(pass.non_target_indices);
+            non_target_length = sanisizer::cast<Index_>(indices.size());
+            Index_ last_chunk = 0;
+            for (auto i : indices) {
+                Index_ current = i / non_target_stats.chunk_length;
+                if (num_overlapping == 0 || current != last_chunk) {
+                    ++num_overlapping;
+                    last_chunk = current;
+                }
+            }
+        } else {
+            Index_ start = pass.non_target_block_start;
+            non_target_length = (pass.non_target_block_length.has_value() ? *(pass.non_target_block_length) : non_target_stats.dimension_extent - start);
+            if (non_target_length > 0) {
+                Index_ last = start + non_target_length - 1;
+                num_overlapping = last / non_target_stats.chunk_length - start / non_target_stats.chunk_length + 1;
+            }
+        }
+
+        SlabCacheStats<Index_> slab_stats(
+            target_stats.chunk_length,
+            non_target_length,
+            target_stats.num_chunks,
+            cache_size_in_elements,
+            options.require_minimum_cache
+        );
+        auto footprint = sanisizer::product<std::size_t>(sanisizer::product<std::size_t>(slab_stats.slab_size_in_elements, slab_stats.max_slabs_in_cache), options.element_size);
+        output.cache_footprint = std::max(output.cache_footprint, footprint);
+
+        // All predictions must be scanned, otherwise the number of slabs read would be underestimated for long passes.
+        SlabCacheAdvisorOptions advisor_options;
+        advisor_options.maximum_predictions = 0;
+        SlabCacheAdvisor<Index_> advisor(*(pass.oracle), target_stats, advisor_options);
+        double num_requests = advisor.get_num_requests();
+        double num_slabs_read = num_requests - std::round(advisor.get_hit_rate(slab_stats.max_slabs_in_cache) * num_requests);
+
+        double num_calls = num_slabs_read * static_cast<double>(num_overlapping) * pass.weight;
+        output.num_extract_calls += num_calls;
+        output.bytes_read += num_calls * chunk_bytes;
+    }
+
+    output.cost = output.bytes_read + output.num_extract_calls * options.extract_overhead;
+    return output;
+}
+
+/**
+ * @cond
+ */
+namespace ChunkShapeAdvisor_internal {
+
+template<typename Index_>
+std::vector<Index_> default_candidates(Index_ extent) {
+    std::vector<Index_> output;
+    Index_ current = 1;
+    while (current < extent) {
+        output.push_back(current);
+        if (current > extent / 2) {
+            break;
+        }
+        current *= 2;
+    }
+    output.push_back(extent);
+    return output;
+}
+
+}
+/**
+ * @endcond
+ */
+
+/**
+ * Recommend chunk dimensions for a workload by computing the cost of each candidate shape with `compute_chunk_shape_cost()`.
+ * The recommended shape is the one with the lowest cost among all shapes with a cache footprint no greater than `ChunkShapeAdvisorOptions::maximum_cache_size`,
+ * where ties are broken by choosing the shape with the smaller footprint.
+ * If no shape satisfies the cache constraint, the shape with the smallest footprint is recommended instead.
+ *
+ * @tparam Index_ Integer type of the row/column indices.
+ *
+ * @param nrow Number of rows in the matrix.
+ * @param ncol Number of columns in the matrix.
+ * @param candidate_chunk_nrow Candidate numbers of rows in each chunk.
+ * If empty, all powers of 2 less than `nrow` are used, along with `nrow` itself.
+ * @param candidate_chunk_ncol Candidate numbers of columns in each chunk.
+ * If empty, all powers of 2 less than `ncol` are used, along with `ncol` itself.
+ * @param workload Passes of the workload.
+ * @param options Further options.
+ *
+ * @return Cost of the recommended chunk shape.
+ * This contains the recommended chunk dimensions in `ChunkShapeCost::chunk_nrow` and `ChunkShapeCost::chunk_ncol`.
+ */
+template<typename Index_>
+ChunkShapeCost<Index_> advise_chunk_shape(
+    Index_ nrow,
+    Index_ ncol,
+    std::vector<Index_> candidate_chunk_nrow,
+    std::vector<Index_> candidate_chunk_ncol,
+    const std::vector<ChunkShapeWorkloadPass<Index_> >& workload,
+    const ChunkShapeAdvisorOptions& options)
+{
+    if (candidate_chunk_nrow.empty()) {
+        candidate_chunk_nrow = ChunkShapeAdvisor_internal::default_candidates(nrow);
+    }
+    if (candidate_chunk_ncol.empty()) {
+        candidate_chunk_ncol = ChunkShapeAdvisor_internal::default_candidates(ncol);
+    }
+
+    std::optional<ChunkShapeCost<Index_> > best;
+    bool best_fits = false;
+    for (auto cr : candidate_chunk_nrow) {
+        for (auto cc : candidate_chunk_ncol) {
+            auto current = compute_chunk_shape_cost(nrow, ncol, cr, cc, workload, options);
+            bool current_fits = current.cache_footprint <= options.maximum_cache_size;
+
+            bool replace = false;
+            if (!best.has_value()) {
+                replace = true;
+            } else if (current_fits != best_fits) {
+                replace = current_fits;
+            } else if (current_fits) {
+                replace = current.cost < best->cost || (current.cost == best->cost && current.cache_footprint < best->cache_footprint);
+            } else {
+                replace = current.cache_footprint < best->cache_footprint || (current.cache_footprint == best->cache_footprint && current.cost < best->cost);
+            }
+
+            if (replace) {
+                best = current;
+                best_fits = current_fits;
+            }
+        }
+    }
+
+    return *best;
+}
+
+}
+
+#endif
@@ -0,0 +1,179 @@
+#ifndef TATAMI_CHUNKED_COMPACT_SPARSE_SLAB_FACTORY_HPP
+#define TATAMI_CHUNKED_COMPACT_SPARSE_SLAB_FACTORY_HPP
+
+#include "SparseSlabFactory.hpp"
+#include "utils.hpp"
+
+#include <vector>
+#include <algorithm>
+#include <cstddef>
+
+#include "sanisizer/sanisizer.hpp"
+
+/**
+ * @file CompactSparseSlabFactory.hpp
+ * @brief Factory for compact sparse slabs.
+ */
+
+namespace tatami_chunked {
+
+/**
+ * @brief Factory for compact sparse slabs.
+ *
+ * Each slab stores the structural non-zeros for all elements of the target dimension in contiguous arrays,
+ * in a compressed sparse format where the non-zeros for each target element are located with a prefix sum of the counts.
+ * This is more cache-friendly than the `SparseSlabFactory` format, where the array for each target element is padded to the extent of the non-target dimension;
+ * it also avoids allocating vectors of pointers for each slab.
+ *
+ * As the number of non-zeros is not known in advance, each slab is first extracted into a padded buffer (see `get_buffer()`) and then copied into its final storage with `compact()`.
+ * The storage for each slab is re-used across populate cycles and only grows if a slab contains more non-zeros than previously seen for that slab.
+ * Such growth involves a reallocation inside `compact()`, which can be avoided by supplying an upper bound on the number of non-zeros in each slab as `slab_capacity` in the constructor.
+ * The memory usage of each slab is thus proportional to its number of non-zeros (or to `slab_capacity`, if supplied),
+ * plus the memory required for one padded buffer per populating thread.
+ *
+ * @tparam Value_ Type of the data in each slab.
+ * @tparam Index_ Integer type of the dimension extent and the type of the indices in each slab.
+ * @tparam Count_ Integer type for counting structural non-zeros in the padded buffer.
+ * This should be large enough to store the extent of the non-target dimension of the slab.
+ */
+template<typename Value_, typename Index_, typename Count_ = Index_>
+class CompactSparseSlabFactory {
+private:
+    Index_ my_target_dim;
+    bool my_needs_value, my_needs_index;
+    std::size_t my_slab_capacity;
+    SparseSlabFactory<Value_, Index_, Count_> my_buffer_factory;
+
+public:
+    /**
+     * Type of the padded buffer, see `SparseSlabFactory::Slab`.
+     */
+    typedef typename SparseSlabFactory<Value_, Index_, Count_>::Slab Buffer;
+
+private:
+    std::vector<Buffer> my_buffers;
+
+public:
+    /**
+     * @param target_dim Extent of the target dimension of the slab.
+     * @param non_target_dim Extent of the non-target dimension of the slab.
+     * @param needs_value Whether the values of the structural non-zeros should be cached.
+     * @param needs_index Whether the indices of the structural non-zeros should be cached.
+     * @param num_buffers Number of padded buffers, typically equal to the number of threads used to populate the slabs.
+     * This should be positive.
+     * @param slab_capacity Upper bound on the number of structural non-zeros in any slab.
+     * If positive, the storage for each slab is reserved in `create()` so that `compact()` never needs to reallocate.
+     * If zero, the storage is allocated on demand in `compact()`.
+     */
+    CompactSparseSlabFactory(Index_ target_dim, Index_ non_target_dim, bool needs_value, bool needs_index, Index_ num_buffers = 1, std::size_t slab_capacity = 0) :
+        my_target_dim(target_dim),
+        my_needs_value(needs_value),
+        my_needs_index(needs_index),
+        my_slab_capacity(slab_capacity),
+        my_buffer_factory(target_dim, non_target_dim, num_buffers, needs_value, needs_index)
+    {
+        my_buffers.reserve(num_buffers);
+        for (Index_ b = 0; b < num_buffers; ++b) {
+            my_buffers.push_back(my_buffer_factory.create());
+        }
+    }
+
+    /**
+     * @cond
+     */
+    // Delete the copy constructors as the buffers hold pointers into the buffer factory.
+    CompactSparseSlabFactory(const CompactSparseSlabFactory&) = delete;
+    CompactSparseSlabFactory& operator=(const CompactSparseSlabFactory&) = delete;
+
+    // Move constructors are okay though.
+    CompactSparseSlabFactory(CompactSparseSlabFactory&&) = default;
+    CompactSparseSlabFactory& operator=(CompactSparseSlabFactory&&) = default;
+    /**
+     * @endcond
+     */
+
+public:
+    /**
+     * @brief Compact sparse slab.
+     */
+    struct Slab {
+        /**
+         * Values of the structural non-zeros for all elements of the target dimension.
+         * The values for target element `p` are stored from `pointers[p]` to `pointers[p + 1]`.
+         *
+         * Alternatively, this vector may be empty if `needs_value = false` in the `CompactSparseSlabFactory` constructor.
+         */
+        std::vector<Value_> values;
+
+        /**
+         * Indices of the structural non-zeros for all elements of the target dimension, in the same layout as `values`.
+         *
+         * Alternatively, this vector may be empty if `needs_index = false` in the `CompactSparseSlabFactory` constructor.
+         */
+        std::vector<Index_> indices;
+
+        /**
+         * Vector of length equal to `target_dim + 1`, containing the prefix sum of the number of non-zeros for each element of the target dimension.
+         * On creation, all entries of this vector are set to zero.
+         */
+        std::vector<std::size_t> pointers;
+    };
+
+    /**
+     * @return A new slab with no non-zeros.
+     * If `slab_capacity` was supplied in the constructor, the slab has already reserved enough storage for that number of non-zeros.
+     */
+    Slab create() const {
+        Slab output;
+        output.pointers.resize(sanisizer::sum<I<decltype(output.pointers.size())> >(my_target_dim, 1));
+        if (my_needs_value) {
+            output.values.reserve(my_slab_capacity);
+        }
+        if (my_needs_index) {
+            output.indices.reserve(my_slab_capacity);
+        }
+        return output;
+    }
+
+    /**
+     * @param i Index of the buffer, less than `num_buffers` in the constructor.
+     * @return Padded buffer in which to extract the contents of a slab.
+     * Each buffer should only be used by one thread at a time.
+     */
+    Buffer& get_buffer(Index_ i) {
+        return my_buffers[i];
+    }
+
+    /**
+     * Copy the contents of a populated buffer into a slab.
+     * The buffer can be re-used for extraction of another slab after this method returns.
+     *
+     * @param buffer Buffer from `get_buffer()`, filled with the contents of the slab.
+     * @param[out] slab Slab created by `create()`.
+     * On output, this contains the contents of `buffer` in a compact format.
+     */
+    void compact(const Buffer& buffer, Slab& slab) const {
+        auto& pointers = slab.pointers;
+        for (Index_ p = 0; p < my_target_dim; ++p) {
+            pointers[p + 1] = pointers[p] + buffer.number[p];
+        }
+
+        auto total = pointers[my_target_dim];
+        if (my_needs_value) {
+            slab.values.resize(total);
+            for (Index_ p = 0; p < my_target_dim; ++p) {
+                std::copy_n(buffer.values[p], buffer.number[p], slab.values.data() + pointers[p]);
+            }
+        }
+        if (my_needs_index) {
+            slab.indices.resize(total);
+            for (Index_ p = 0; p < my_target_dim; ++p) {
+                std::copy_n(buffer.indices[p], buffer.number[p], slab.indices.data() + pointers[p]);
+            }
+        }
+    }
+};
+
+}
+
+#endif
@@ -0,0 +1,667 @@
+#ifndef TATAMI_CHUNKED_COMPRESSED_CHUNKED_MATRIX_MANAGER_HPP
+#define TATAMI_CHUNKED_COMPRESSED_CHUNKED_MATRIX_MANAGER_HPP
+
+#include "CustomDenseChunkedMatrix.hpp"
+#include "CustomSparseChunkedMatrix.hpp"
+#include "ChunkDimensionStats.hpp"
+#include "ChunkCodec.hpp"
+#include "rechunk.hpp"
+#include "copy_kernels.hpp"
+#include "utils.hpp"
+
+#include <vector>
+#include <memory>
+#include <stdexcept>
+#include <algorithm>
+#include <cstddef>
+#include <cstring>
+
+#include "tatami/tatami.hpp"
+#include "sanisizer/sanisizer.hpp"
+
+/**
+ * @file CompressedChunkedMatrixManager.hpp
+ * @brief Chunk managers for compressed chunks.
+ */
+
+namespace tatami_chunked {
+
+/**
+ * @brief Store of compressed chunks.
+ *
+ * @tparam Index_ Integer type of the row/column indices.
+ *
+ * Chunks are stored in row-major order of the chunk grid, i.e., the chunk at `(chunk_row_id, chunk_column_id)` has index `chunk_row_id * column_stats.num_chunks + chunk_column_id`.
+ * The compressed bytes of each chunk are concatenated in `data`, and the offset table in `offsets` allows random access to each chunk.
+ * This is usually created by `compress_dense_chunks()` or `compress_sparse_chunks()`.
+ */
+template<typename Index_>
+struct CompressedChunkStore {
+    /**
+     * Statistics for the rows.
+     */
+    ChunkDimensionStats<Index_> row_stats;
+
+    /**
+     * Statistics for the columns.
+     */
+    ChunkDimensionStats<Index_> column_stats;
+
+    /**
+     * Compressed bytes for all chunks.
+     */
+    std::vector<unsigned char> data;
+
+    /**
+     * Offset table, of length equal to the number of chunks plus 1.
+     * The compressed bytes for chunk `i` are stored in `data` from `offsets[i]` to `offsets[i + 1]`.
+     */
+    std::vector<std::size_t> offsets;
+
+    /**
+     * Size of the uncompressed bytes for each chunk.
+     */
+    std::vector<std::size_t> sizes;
+
+    /**
+     * Number of structural non-zeros in each chunk, for sparse chunks created by `compress_sparse_chunks()`.
+     * This may be empty, otherwise it should have length equal to the number of chunks.
+     * If non-empty, the counts are reported by `CompressedSparseChunkedMatrixManager::chunk_nonzeros()`.
+     */
+    std::vector<std::size_t> nonzeros;
+};
+
+/**
+ * @cond
+ */
+namespace CompressedChunkedMatrix_internal {
+
+template<typename Index_>
+std::size_t chunk_id(const CompressedChunkStore<Index_>& store, Index_ chunk_row_id, Index_ chunk_column_id) {
+    return static_cast<std::size_t>(chunk_row_id) * static_cast<std::size_t>(store.column_stats.num_chunks) + static_cast<std::size_t>(chunk_column_id);
+}
+
+template<typename Index_>
+std::size_t check_store(const CompressedChunkStore<Index_>& store) {
+    auto num_chunks = sanisizer::product<std::size_t>(store.row_stats.num_chunks, store.column_stats.num_chunks);
+    if (store.offsets.size() != sanisizer::sum<std::size_t>(num_chunks, 1)) {
+        throw std::runtime_error("length of 'offsets' should be equal to the number of chunks plus 1");
+    }
+    if (store.sizes.size() != num_chunks) {
+        throw std::runtime_error("length of 'sizes' should be equal to the number of chunks");
+    }
+    if (!store.nonzeros.empty() && store.nonzeros.size() != num_chunks) {
+        throw std::runtime_error("length of 'nonzeros' should be zero or equal to the number of chunks");
+    }
+    if (store.offsets.front() != 0 || !std::is_sorted(store.offsets.begin(), store.offsets.end()) || store.offsets.back() != store.data.size()) {
+        throw std::runtime_error("'offsets' should be sorted and span the entirety of 'data'");
+    }
+    return num_chunks;
+}
+
+template<typename Index_>
+void append_chunk(CompressedChunkStore<Index_>& store, const ChunkCodec& codec, const unsigned char* bytes, std::size_t num_bytes) {
+    codec.compress(bytes, num_bytes, store.data);
+    store.offsets.push_back(store.data.size());
+    store.sizes.push_back(num_bytes);
+}
+
+// Column indices of a contiguous block or an arbitrary subset within a chunk.
+template<typename Index_>
+struct BlockSelection {
+    Index_ start, length;
+};
+
+template<typename Index_, class Function_>
+void for_each_selected(const BlockSelection<Index_>& selection, Function_ fun) {
+    for (Index_ i = 0; i < selection.length; ++i) {
+        fun(selection.start + i, i);
+    }
+}
+
+template<typename Index_, class Function_>
+void for_each_selected(const std::vector<Index_>& selection, Function_ fun) {
+    Index_ num = selection.size();
+    for (Index_ i = 0; i < num; ++i) {
+        fun(selection[i], i);
+    }
+}
+
+// Copying the selected values from a contiguous source, i.e., a single row of a row-major chunk.
+template<typename Value_, typename Index_>
+void copy_selected(const Value_* src, const BlockSelection<Index_>& selection, Value_* output) {
+    std::copy_n(src + selection.start, selection.length, output);
+}
+
+template<typename Value_, typename Index_>
+void copy_selected(const Value_* src, const std::vector<Index_>& selection, Value_* output) {
+    gather_copy_n(src, selection.data(), selection.size(), output);
+}
+
+}
+/**
+ * @endcond
+ */
+
+/**
+ * Compress the contents of a `tatami::Matrix` into dense chunks.
+ * Each chunk is serialized as a row-major array of `ChunkValue_` with `chunk_nrow * chunk_ncol` elements,
+ * where chunks at the edges of the matrix are padded with zeros.
+ *
+ * @tparam ChunkValue_ Numeric type of the data values in each chunk.
+ * @tparam Value_ Numeric type of the matrix values.
+ * @tparam Index_ Integer type of the row/column indices.
+ *
+ * @param matrix Matrix to be compressed.
+ * @param chunk_nrow Number of rows in each chunk.
+ * This should be positive if `matrix` has a non-zero number of rows.
+ * @param chunk_ncol Number of columns in each chunk.
+ * This should be positive if `matrix` has a non-zero number of columns.
+ * @param codec Codec to use for compression.
+ *
+ * @return Store of compressed chunks, to be used in a `CompressedDenseChunkedMatrixManager`.
+ */
+template<typename ChunkValue_, typename Value_, typename Index_>
+CompressedChunkStore<Index_> compress_dense_chunks(const tatami::Matrix<Value_, Index_>& matrix, Index_ chunk_nrow, Index_ chunk_ncol, const ChunkCodec& codec) {
+    namespace ci = CompressedChunkedMatrix_internal;
+    Index_ NR = matrix.nrow(), NC = matrix.ncol();
+    rechunk_internal::check_chunk_dimensions(NR, NC, chunk_nrow, chunk_ncol);
+
+    CompressedChunkStore<Index_> store;
+    store.row_stats = ChunkDimensionStats<Index_>(NR, chunk_nrow);
+    store.column_stats = ChunkDimensionStats<Index_>(NC, chunk_ncol);
+    store.offsets.push_back(0);
+
+    auto chunk_bytes = sanisizer::product<std::size_t>(chunk_nrow, chunk_ncol, sizeof(ChunkValue_));
+    rechunk_dense<ChunkValue_>(
+        matrix,
+        chunk_nrow,
+        chunk_ncol,
+        [&](Index_, Index_, const ChunkValue_* chunk) -> void {
+            ci::append_chunk(store, codec, reinterpret_cast<const unsigned char*>(chunk), chunk_bytes);
+        },
+        RechunkDenseOptions()
+    );
+
+    return store;
+}
+
+/**
+ * Compress the contents of a `tatami::Matrix` into sparse chunks.
+ * Each chunk is serialized in a compressed sparse row format, consisting of:
+ *
+ * - an array of `std::size_t` pointers of length equal to the number of rows in the chunk plus 1.
+ * - an array of `Index_` column indices for all non-zero elements, relative to the start of the chunk.
+ * - an array of `ChunkValue_` values for all non-zero elements.
+ *
+ * Unlike `compress_dense_chunks()`, chunks at the edges of the matrix are not padded.
+ *
+ * @tparam ChunkValue_ Numeric type of the data values in each chunk.
+ * @tparam Value_ Numeric type of the matrix values.
+ * @tparam Index_ Integer type of the row/column indices.
+ *
+ * @param matrix Matrix to be compressed.
+ * @param chunk_nrow Number of rows in each chunk.
+ * This should be positive if `matrix` has a non-zero number of rows.
+ * @param chunk_ncol Number of columns in each chunk.
+ * This should be positive if `matrix` has a non-zero number of columns.
+ * @param codec Codec to use for compression.
+ *
+ * @return Store of compressed chunks, to be used in a `CompressedSparseChunkedMatrixManager`.
+ */
+template<typename ChunkValue_, typename Value_, typename Index_>
+CompressedChunkStore<Index_> compress_sparse_chunks(const tatami::Matrix<Value_, Index_>& matrix, Index_ chunk_nrow, Index_ chunk_ncol, const ChunkCodec& codec) {
+    namespace ci = CompressedChunkedMatrix_internal;
+    Index_ NR = matrix.nrow(), NC = matrix.ncol();
+    rechunk_internal::check_chunk_dimensions(NR, NC, chunk_nrow, chunk_ncol);
+
+    CompressedChunkStore<Index_> store;
+    store.row_stats = ChunkDimensionStats<Index_>(NR, chunk_nrow);
+    store.column_stats = ChunkDimensionStats<Index_>(NC, chunk_ncol);
+    store.offsets.push_back(0);
+
+    std::vector<unsigned char> serialized;
+    rechunk_sparse<ChunkValue_>(
+        matrix,
+        chunk_nrow,
+        chunk_ncol,
+        [&](Index_, Index_, const std::vector<std::size_t>& pointers, const std::vector<Index_>& indices, const std::vector<ChunkValue_>& values) -> void {
+            std::size_t pointer_bytes = sanisizer::product<std::size_t>(pointers.size(), sizeof(std::size_t));
+            std::size_t index_bytes = sanisizer::product<std::size_t>(indices.size(), sizeof(Index_));
+            std::size_t value_bytes = sanisizer::product<std::size_t>(values.size(), sizeof(ChunkValue_));
+            serialized.resize(sanisizer::sum<std::size_t>(pointer_bytes, index_bytes, value_bytes));
+            std::memcpy(serialized.data(), pointers.data(), pointer_bytes);
+            std::memcpy(serialized.data() + pointer_bytes, indices.data(), index_bytes);
+            std::memcpy(serialized.data() + pointer_bytes + index_bytes, values.data(), value_bytes);
+            ci::append_chunk(store, codec, serialized.data(), serialized.size());
+            store.nonzeros.push_back(values.size());
+        },
+        RechunkSparseOptions()
+    );
+
+    return store;
+}
+
+/**
+ * @brief Workspace for extracting data from a `CompressedDenseChunkedMatrixManager`.
+ * @tparam ChunkValue_ Numeric type of the data values in each chunk.
+ * @tparam Index_ Integer type of the row/column indices.
+ */
+template<typename ChunkValue_, typename Index_>
+class CompressedDenseChunkedMatrixWorkspace final : public CustomDenseChunkedMatrixWorkspace<ChunkValue_, Index_> {
+public:
+    /**
+     * @cond
+     */
+    CompressedDenseChunkedMatrixWorkspace(const CompressedChunkStore<Index_>& store, const ChunkCodec& codec) :
+        my_store(store),
+        my_codec(codec),
+        my_buffer(sanisizer::product<typename std::vector<ChunkValue_>::size_type>(store.row_stats.chunk_length, store.column_stats.chunk_length))
+    {}
+    /**
+     * @endcond
+     */
+
+private:
+    const CompressedChunkStore<Index_>& my_store;
+    const ChunkCodec& my_codec;
+    std::vector<ChunkValue_> my_buffer;
+
+    // Consecutive calls often refer to the same chunk, e.g., for the rows in a band of the chunk grid, so we avoid decompressing it again.
+    bool my_decoded = false;
+    std::size_t my_last_id = 0;
+
+    void decode(Index_ chunk_row_id, Index_ chunk_column_id) {
+        auto id = CompressedChunkedMatrix_internal::chunk_id(my_store, chunk_row_id, chunk_column_id);
+        if (my_decoded && id == my_last_id) {
+            return;
+        }
+        auto start = my_store.offsets[id];
+        my_decoded = false; // in case the decompression throws.
+        my_codec.decompress(my_store.data.data() + start, my_store.offsets[id + 1] - start, reinterpret_cast<unsigned char*>(my_buffer.data()), my_store.sizes[id]);
+        my_decoded = true;
+        my_last_id = id;
+    }
+
+    template<class Target_, class NonTarget_>
+    void copy(Index_ chunk_row_id, Index_ chunk_column_id, bool row, const Target_& target, const NonTarget_& non_target, ChunkValue_* output, Index_ stride) {
+        namespace ci = CompressedChunkedMatrix_internal;
+        decode(chunk_row_id, chunk_column_id);
+        std::size_t chunk_ncol = my_store.column_stats.chunk_length;
+        ci::for_each_selected(target, [&](Index_ t, Index_) -> void {
+            auto out = output + static_cast<std::size_t>(t) * static_cast<std::size_t>(stride);
+            if (row) {
+                auto src = my_buffer.data() + static_cast<std::size_t>(t) * chunk_ncol;
+                ci::copy_selected(src, non_target, out);
+            } else {
+                auto src = my_buffer.data() + t;
+                ci::for_each_selected(non_target, [&](Index_ n, Index_ q) -> void { out[q] = src[static_cast<std::size_t>(n) * chunk_ncol]; });
+            }
+        });
+    }
+
+public:
+    /**
+     * @cond
+     */
+    void extract(Index_ chunk_row_id, Index_ chunk_column_id, bool row, Index_ target_start, Index_ target_length, Index_ non_target_start, Index_ non_target_length, ChunkValue_* output, Index_ stride) {
+        typedef CompressedChunkedMatrix_internal::BlockSelection<Index_> Block;
+        copy(chunk_row_id, chunk_column_id, row, Block{ target_start, target_length }, Block{ non_target_start, non_target_length }, output, stride);
+    }
+
+    void extract(Index_ chunk_row_id, Index_ chunk_column_id, bool row, Index_ target_start, Index_ target_length, const std::vector<Index_>& non_target_indices, ChunkValue_* output, Index_ stride) {
+        typedef CompressedChunkedMatrix_internal::BlockSelection<Index_> Block;
+        copy(chunk_row_id, chunk_column_id, row, Block{ target_start, target_length }, non_target_indices, output, stride);
+    }
+
+    void extract(Index_ chunk_row_id, Index_ chunk_column_id, bool row, const std::vector<Index_>& target_indices, Index_ non_target_start, Index_ non_target_length, ChunkValue_* output, Index_ stride) {
+        typedef CompressedChunkedMatrix_internal::BlockSelection<Index_> Block;
+        copy(chunk_row_id, chunk_column_id, row, target_indices, Block{ non_target_start, non_target_length }, output, stride);
+    }
+
+    void extract(Index_ chunk_row_id, Index_ chunk_column_id, bool row, const std::vector<Index_>& target_indices, const std::vector<Index_>& non_target_indices, ChunkValue_* output, Index_ stride) {
+        copy(chunk_row_id, chunk_column_id, row, target_indices, non_target_indices, output, stride);
+    }
+
+    // A zero stride means that the values for the single target element are stored at the start of 'output'.
+    bool supports_extract_single() const {
+        return true;
+    }
+
+    void extract_single(Index_ chunk_row_id, Index_ chunk_column_id, bool row, Index_ target, Index_ non_target_start, Index_ non_target_length, ChunkValue_* output) {
+        typedef CompressedChunkedMatrix_internal::BlockSelection<Index_> Block;
+        copy(chunk_row_id, chunk_column_id, row, Block{ target, 1 }, Block{ non_target_start, non_target_length }, output, 0);
+    }
+
+    void extract_single(Index_ chunk_row_id, Index_ chunk_column_id, bool row, Index_ target, const std::vector<Index_>& non_target_indices, ChunkValue_* output) {
+        typedef CompressedChunkedMatrix_internal::BlockSelection<Index_> Block;
+        copy(chunk_row_id, chunk_column_id, row, Block{ target, 1 }, non_target_indices, output, 0);
+    }
+    /**
+     * @endcond
+     */
+};
+
+/**
+ * @brief Manager of compressed dense chunks.
+ *
+ * @tparam ChunkValue_ Numeric type of the data values in each chunk.
+ * @tparam Index_ Integer type of the row/column indices.
+ *
+ * This class implements a `CustomDenseChunkedMatrixManager` for chunks that were compressed by `compress_dense_chunks()`.
+ * Each workspace decompresses the requested chunk into its own scratch buffer, so multiple workspaces can be used in parallel.
+ * The same chunk is not decompressed twice in a row, but users should still set a reasonable `CustomDenseChunkedMatrixOptions::maximum_cache_size` to avoid repeated decompression of the same chunks.
+ */
+template<typename ChunkValue_, typename Index_>
+class CompressedDenseChunkedMatrixManager final : public CustomDenseChunkedMatrixManager<ChunkValue_, Index_> {
+public:
+    /**
+     * @param codec Codec that was used to compress the chunks.
+     * @param store Store of compressed chunks, typically created by `compress_dense_chunks()` with the same `ChunkValue_`.
+     */
+    CompressedDenseChunkedMatrixManager(std::shared_ptr<const ChunkCodec> codec, CompressedChunkStore<Index_> store) : my_codec(std::move(codec)), my_store(std::move(store)) {
+        CompressedChunkedMatrix_internal::check_store(my_store);
+        auto expected = sanisizer::product<std::size_t>(my_store.row_stats.chunk_length, my_store.column_stats.chunk_length, sizeof(ChunkValue_));
+        for (auto s : my_store.sizes) {
+            if (s != expected) {
+                throw std::runtime_error("all dense chunks should have an uncompressed size equal to the number of bytes in a full chunk");
+            }
+        }
+    }
+
+private:
+    std::shared_ptr<const ChunkCodec> my_codec;
+    CompressedChunkStore<Index_> my_store;
+
+public:
+    /**
+     * @cond
+     */
+    std::unique_ptr<CustomDenseChunkedMatrixWorkspace<ChunkValue_, Index_> > new_workspace() const {
+        return new_workspace_exact();
+    }
+
+    std::unique_ptr<CompressedDenseChunkedMatrixWorkspace<ChunkValue_, Index_> > new_workspace_exact() const {
+        return std::make_unique<CompressedDenseChunkedMatrixWorkspace<ChunkValue_, Index_> >(my_store, *my_codec);
+    }
+
+    bool prefer_rows() const {
+        return true;
+    }
+
+    const ChunkDimensionStats<Index_>& row_stats() const {
+        return my_store.row_stats;
+    }
+
+    const ChunkDimensionStats<Index_>& column_stats() const {
+        return my_store.column_stats;
+    }
+    /**
+     * @endcond
+     */
+};
+
+/**
+ * @brief Workspace for extracting data from a `CompressedSparseChunkedMatrixManager`.
+ * @tparam ChunkValue_ Numeric type of the data values in each chunk.
+ * @tparam Index_ Integer type of the row/column indices.
+ */
+template<typename ChunkValue_, typename Index_>
+class CompressedSparseChunkedMatrixWorkspace final : public CustomSparseChunkedMatrixWorkspace<ChunkValue_, Index_> {
+public:
+    /**
+     * @cond
+     */
+    CompressedSparseChunkedMatrixWorkspace(const CompressedChunkStore<Index_>& store, const ChunkCodec& codec) : my_store(store), my_codec(codec) {}
+    /**
+     * @endcond
+     */
+
+private:
+    const CompressedChunkStore<Index_>& my_store;
+    const ChunkCodec& my_codec;
+
+    std::vector<unsigned char> my_buffer;
+    std::vector<std::size_t> my_pointers;
+    std::vector<Index_> my_indices;
+    std::vector<ChunkValue_> my_values;
+
+    bool my_decoded = false;
+    std::size_t my_last_id = 0;
+
+    void decode(Index_ chunk_row_id, Index_ chunk_column_id) {
+        auto id = CompressedChunkedMatrix_internal::chunk_id(my_store, chunk_row_id, chunk_column_id);
+        if (my_decoded && id == my_last_id) {
+            return;
+        }
+
+        auto start = my_store.offsets[id];
+        auto size = my_store.sizes[id];
+        my_decoded = false; // in case the decompression throws.
+        my_buffer.resize(size);
+        my_codec.decompress(my_store.data.data() + start, my_store.offsets[id + 1] - start, my_buffer.data(), size);
+
+        // Unpacking into typed arrays to avoid any issues with alignment.
+        std::size_t num_pointers = get_chunk_length(my_store.row_stats, chunk_row_id);
+        num_pointers += 1;
+        std::size_t pointer_bytes = num_pointers * sizeof(std::size_t);
+        if (size < pointer_bytes) {
+            throw std::runtime_error("decompressed sparse chunk is too small for its pointers");
+        }
+        my_pointers.resize(num_pointers);
+        std::memcpy(my_pointers.data(), my_buffer.data(), pointer_bytes);
+
+        std::size_t nnz = my_pointers.back();
+        if ((size - pointer_bytes) / (sizeof(Index_) + sizeof(ChunkValue_)) != nnz || (size - pointer_bytes) % (sizeof(Index_) + sizeof(ChunkValue_)) != 0) {
+            throw std::runtime_error("decompressed sparse chunk has an unexpected size");
+        }
+        my_indices.resize(nnz);
+        std::memcpy(my_indices.data(), my_buffer.data() + pointer_bytes, nnz * sizeof(Index_));
+        my_values.resize(nnz);
+        std::memcpy(my_values.data(), my_buffer.data() + pointer_bytes + nnz * sizeof(Index_), nnz * sizeof(ChunkValue_));
+
+        my_decoded = true;
+        my_last_id = id;
+    }
+
+    // Iterate over the non-zero elements of chunk row 'r' in the selected columns, in ascending order of the column index.
+    template<class Function_>
+    void for_each_in_row(Index_ r, const CompressedChunkedMatrix_internal::BlockSelection<Index_>& columns, Function_ fun) const {
+        auto iStart = my_indices.begin() + my_pointers[r], iEnd = my_indices.begin() + my_pointers[r + 1];
+        iStart = std::lower_bound(iStart, iEnd, columns.start);
+        Index_ column_end = columns.start + columns.length;
+        for (; iStart != iEnd && *iStart < column_end; ++iStart) {
+            fun(*iStart, my_values[iStart - my_indices.begin()]);
+        }
+    }
+
+    template<class Function_>
+    void for_each_in_row(Index_ r, const std::vector<Index_>& columns, Function_ fun) const {
+        auto iStart = my_indices.begin() + my_pointers[r], iEnd = my_indices.begin() + my_pointers[r + 1];
+        auto cIt = columns.begin(), cEnd = columns.end();
+        while (iStart != iEnd && cIt != cEnd) {
+            if (*iStart < *cIt) {
+                ++iStart;
+            } else if (*cIt < *iStart) {
+                ++cIt;
+            } else {
+                fun(*iStart, my_values[iStart - my_indices.begin()]);
+                ++iStart;
+                ++cIt;
+            }
+        }
+    }
+
+    template<class Target_, class NonTarget_>
+    void fill(
+        Index_ chunk_row_id,
+        Index_ chunk_column_id,
+        bool row,
+        const Target_& target,
+        const NonTarget_& non_target,
+        const std::vector<ChunkValue_*>& output_values,
+        const std::vector<Index_*>& output_indices,
+        Index_* output_number,
+        Index_ shift)
+    {
+        namespace ci = CompressedChunkedMatrix_internal;
+        decode(chunk_row_id, chunk_column_id);
+
+        auto store = [&](Index_ p, Index_ i, ChunkValue_ v) -> void {
+            auto& num = output_number[p];
+            if (!output_values.empty()) {
+                output_values[p][num] = v;
+            }
+            if (!output_indices.empty()) {
+                output_indices[p][num] = i + shift;
+            }
+            ++num;
+        };
+
+        if (row) {
+            ci::for_each_selected(target, [&](Index_ r, Index_) -> void {
+                for_each_in_row(r, non_target, [&](Index_ c, ChunkValue_ v) -> void { store(r, c, v); });
+            });
+        } else {
+            // Rows are visited in ascending order so that the indices for each target column are also sorted.
+            ci::for_each_selected(non_target, [&](Index_ r, Index_) -> void {
+                for_each_in_row(r, target, [&](Index_ c, ChunkValue_ v) -> void { store(c, r, v); });
+            });
+        }
+    }
+
+public:
+    /**
+     * @cond
+     */
+    void extract(
+        Index_ chunk_row_id,
+        Index_ chunk_column_id,
+        bool row,
+        Index_ target_start,
+        Index_ target_length,
+        Index_ non_target_start,
+        Index_ non_target_length,
+        const std::vector<ChunkValue_*>& output_values,
+        const std::vector<Index_*>& output_indices,
+        Index_* output_number,
+        Index_ shift)
+    {
+        typedef CompressedChunkedMatrix_internal::BlockSelection<Index_> Block;
+        fill(chunk_row_id, chunk_column_id, row, Block{ target_start, target_length }, Block{ non_target_start, non_target_length }, output_values, output_indices, output_number, shift);
+    }
+
+    void extract(
+        Index_ chunk_row_id,
+        Index_ chunk_column_id,
+        bool row,
+        Index_ target_start,
+        Index_ target_length,
+        const std::vector<Index_>& non_target_indices,
+        const std::vector<ChunkValue_*>& output_values,
+        const std::vector<Index_*>& output_indices,
+        Index_* output_number,
+        Index_ shift)
+    {
+        typedef CompressedChunkedMatrix_internal::BlockSelection<Index_> Block;
+        fill(chunk_row_id, chunk_column_id, row, Block{ target_start, target_length }, non_target_indices, output_values, output_indices, output_number, shift);
+    }
+
+    void extract(
+        Index_ chunk_row_id,
+        Index_ chunk_column_id,
+        bool row,
+        const std::vector<Index_>& target_indices,
+        Index_ non_target_start,
+        Index_ non_target_length,
+        const std::vector<ChunkValue_*>& output_values,
+        const std::vector<Index_*>& output_indices,
+        Index_* output_number,
+        Index_ shift)
+    {
+        typedef CompressedChunkedMatrix_internal::BlockSelection<Index_> Block;
+        fill(chunk_row_id, chunk_column_id, row, target_indices, Block{ non_target_start, non_target_length }, output_values, output_indices, output_number, shift);
+    }
+
+    void extract(
+        Index_ chunk_row_id,
+        Index_ chunk_column_id,
+        bool row,
+        const std::vector<Index_>& target_indices,
+        const std::vector<Index_>& non_target_indices,
+        const std::vector<ChunkValue_*>& output_values,
+        const std::vector<Index_*>& output_indices,
+        Index_* output_number,
+        Index_ shift)
+    {
+        fill(chunk_row_id, chunk_column_id, row, target_indices, non_target_indices, output_values, output_indices, output_number, shift);
+    }
+    /**
+     * @endcond
+     */
+};
+
+/**
+ * @brief Manager of compressed sparse chunks.
+ *
+ * @tparam ChunkValue_ Numeric type of the data values in each chunk.
+ * @tparam Index_ Integer type of the row/column indices.
+ *
+ * This class implements a `CustomSparseChunkedMatrixManager` for chunks that were compressed by `compress_sparse_chunks()`.
+ * Each workspace decompresses the requested chunk into its own scratch buffers, so multiple workspaces can be used in parallel.
+ * As each chunk is stored in a compressed sparse row format, row extraction is more efficient than column extraction.
+ */
+template<typename ChunkValue_, typename Index_>
+class CompressedSparseChunkedMatrixManager final : public CustomSparseChunkedMatrixManager<ChunkValue_, Index_> {
+public:
+    /**
+     * @param codec Codec that was used to compress the chunks.
+     * @param store Store of compressed chunks, typically created by `compress_sparse_chunks()` with the same `ChunkValue_` and `Index_`.
+     */
+    CompressedSparseChunkedMatrixManager(std::shared_ptr<const ChunkCodec> codec, CompressedChunkStore<Index_> store) : my_codec(std::move(codec)), my_store(std::move(store)) {
+        CompressedChunkedMatrix_internal::check_store(my_store);
+    }
+
+private:
+    std::shared_ptr<const ChunkCodec> my_codec;
+    CompressedChunkStore<Index_> my_store;
+
+public:
+    /**
+     * @cond
+     */
+    std::unique_ptr<CustomSparseChunkedMatrixWorkspace<ChunkValue_, Index_> > new_workspace() const {
+        return new_workspace_exact();
+    }
+
+    std::unique_ptr<CompressedSparseChunkedMatrixWorkspace<ChunkValue_, Index_> > new_workspace_exact() const {
+        return std::make_unique<CompressedSparseChunkedMatrixWorkspace<ChunkValue_, Index_> >(my_store, *my_codec);
+    }
+
+    bool prefer_rows() const {
+        return true;
+    }
+
+    const ChunkDimensionStats<Index_>& row_stats() const {
+        return my_store.row_stats;
+    }
+
+    const ChunkDimensionStats<Index_>& column_stats() const {
+        return my_store.column_stats;
+    }
+
+    bool has_chunk_nonzeros() const {
+        return !my_store.nonzeros.empty();
+    }
+
+    std::size_t chunk_nonzeros(Index_ chunk_row_id, Index_ chunk_column_id) const {
+        return my_store.nonzeros[CompressedChunkedMatrix_internal::chunk_id(my_store, chunk_row_id, chunk_column_id)];
+    }
+    /**
+     * @endcond
+     */
+};
+
+}
+
+#endif
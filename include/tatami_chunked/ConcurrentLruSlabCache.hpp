@@ -0,0 +1,347 @@
+#ifndef TATAMI_CHUNKED_CONCURRENT_LRU_SLAB_CACHE_HPP
+#define TATAMI_CHUNKED_CONCURRENT_LRU_SLAB_CACHE_HPP
+
+#include "utils.hpp"
+
+#include <unordered_map>
+#include <list>
+#include <vector>
+#include <mutex>
+#include <condition_variable>
+#include <functional>
+#include <memory>
+#include <cstddef>
+
+#include "sanisizer/sanisizer.hpp"
+
+/**
+ * @file ConcurrentLruSlabCache.hpp
+ * @brief Create a thread-safe LRU cache of slabs.
+ */
+
+namespace tatami_chunked {
+
+/**
+ * @tparam Id_ Type of cache identifier, typically integer.
+ * @tparam Slab_ Class for a single slab.
+ *
+ * @brief Thread-safe least-recently-used cache for slabs.
+ *
+ * This is a variant of `LruSlabCache` that can be shared across multiple threads, e.g., to share decoded chunks between workers of `tatami::parallelize()`.
+ * The slab pool is split into several shards, each of which has its own mutex and LRU ordering.
+ * Each slab identifier is assigned to a shard based on its hash, so threads that request slabs in different shards do not contend with each other.
+ *
+ * If multiple threads request the same missing slab at the same time, only one of them will call `populate()` while the others wait for it to finish.
+ * Slabs are returned as a `Handle` that prevents the slab from being evicted while the handle is alive.
+ * If all slabs in a shard are held by `Handle`s when a new slab is required, the shard temporarily creates an extra slab beyond its share of `max_slabs`;
+ * this is released once it is no longer held by any `Handle`.
+ * Callers should destroy each `Handle` as soon as they are done with the slab to avoid exceeding the maximum number of slabs.
+ */
+template<typename Id_, class Slab_>
+class ConcurrentLruSlabCache {
+private:
+    struct Element {
+        Element(Slab_ s, Id_ i) : slab(std::move(s)), id(i) {}
+        Slab_ slab;
+        Id_ id;
+        std::size_t pins = 0;
+        bool ready = false;
+        bool indexed = false;
+    };
+
+    typedef std::list<Element> SlabPool;
+
+    struct Shard {
+        std::mutex mutex;
+        std::condition_variable cv;
+        typename SlabPool::size_type max_slabs = 0;
+        SlabPool cache_data;
+        std::unordered_map<Id_, typename SlabPool::iterator> cache_exists;
+    };
+
+    typename SlabPool::size_type my_max_slabs;
+    std::vector<std::unique_ptr<Shard> > my_shards;
+
+public:
+    /**
+     * @tparam Index_ Integer type of the maximum number of slabs, see the template parameter of the same name in `SlabCacheStats`.
+     * @param max_slabs Maximum number of slabs to store in the cache.
+     * @param num_shards Number of shards in the cache.
+     * This is capped at `max_slabs`, as each shard should be able to hold at least one slab.
+     */
+    template<typename Index_>
+    ConcurrentLruSlabCache(Index_ max_slabs, int num_shards = 16) : my_max_slabs(sanisizer::cast<I<decltype(my_max_slabs)> >(max_slabs)) {
+        typename SlabPool::size_type nshards = 1;
+        if (num_shards > 1) {
+            nshards = sanisizer::cast<I<decltype(nshards)> >(num_shards);
+        }
+        if (nshards > my_max_slabs && my_max_slabs > 0) {
+            nshards = my_max_slabs;
+        }
+
+        my_shards.reserve(nshards);
+        auto per_shard = my_max_slabs / nshards, leftover = my_max_slabs % nshards;
+        for (I<decltype(nshards)> s = 0; s < nshards; ++s) {
+            my_shards.emplace_back(new Shard);
+            my_shards.back()->max_slabs = per_shard + (s < leftover);
+        }
+    }
+
+    /**
+     * Deleted as the cache holds persistent iterators.
+     */
+    ConcurrentLruSlabCache(const ConcurrentLruSlabCache&) = delete;
+
+    /**
+     * Deleted as the cache holds persistent iterators.
+     */
+    ConcurrentLruSlabCache& operator=(const ConcurrentLruSlabCache&) = delete;
+
+    /**
+     * @cond
+     */
+    // Shards are heap-allocated so moving is safe, as long as there are no outstanding handles.
+    ConcurrentLruSlabCache& operator=(ConcurrentLruSlabCache&&) = default;
+    ConcurrentLruSlabCache(ConcurrentLruSlabCache&&) = default;
+    ~ConcurrentLruSlabCache() = default;
+    /**
+     * @endcond
+     */
+
+private:
+    // Removes the least recently used slabs that are not held by any handle, until the shard is back under its limit.
+    // This should be called while holding the shard's lock.
+    static void trim(Shard& shard) {
+        auto it = shard.cache_data.begin();
+        while (shard.cache_data.size() > shard.max_slabs && it != shard.cache_data.end()) {
+            if (it->pins) {
+                ++it;
+                continue;
+            }
+            if (it->indexed) {
+                shard.cache_exists.erase(it->id);
+            }
+            it = shard.cache_data.erase(it);
+        }
+    }
+
+public:
+    /**
+     * @brief Handle to a slab in the cache.
+     *
+     * The slab will not be evicted or modified while the handle is alive.
+     * Handles can be moved but not copied.
+     */
+    class Handle {
+    public:
+        /**
+         * @cond
+         */
+        Handle() = default;
+        Handle(Shard* shard, typename SlabPool::iterator location) : my_shard(shard), my_location(location) {}
+
+        Handle(const Handle&) = delete;
+        Handle& operator=(const Handle&) = delete;
+
+        Handle(Handle&& other) noexcept : my_shard(other.my_shard), my_location(other.my_location) {
+            other.my_shard = NULL;
+        }
+
+        Handle& operator=(Handle&& other) noexcept {
+            if (this != &other) {
+                release();
+                my_shard = other.my_shard;
+                my_location = other.my_location;
+                other.my_shard = NULL;
+            }
+            return *this;
+        }
+
+        ~Handle() {
+            release();
+        }
+        /**
+         * @endcond
+         */
+
+    private:
+        Shard* my_shard = NULL;
+        typename SlabPool::iterator my_location;
+
+    public:
+        /**
+         * Release the slab, allowing it to be evicted from the cache.
+         * After this method is called, the handle is empty and no longer refers to a slab.
+         */
+        void release() {
+            if (my_shard) {
+                std::lock_guard<std::mutex> lck(my_shard->mutex);
+                --(my_location->pins);
+                if (my_location->pins == 0 && my_shard->cache_data.size() > my_shard->max_slabs) {
+                    trim(*my_shard);
+                }
+                my_shard = NULL;
+            }
+        }
+
+        /**
+         * @return Reference to the slab.
+         * This should only be called if the handle is not empty.
+         */
+        const Slab_& operator*() const {
+            return my_location->slab;
+        }
+
+        /**
+         * @return Pointer to the slab.
+         * This should only be called if the handle is not empty.
+         */
+        const Slab_* operator->() const {
+            return &(my_location->slab);
+        }
+
+        /**
+         * @return Whether the handle refers to a slab.
+         */
+        explicit operator bool() const {
+            return my_shard != NULL;
+        }
+    };
+
+public:
+    /**
+     * This method should only be called if `m > 0` in the constructor.
+     * It can be safely called from multiple threads.
+     *
+     * @tparam Cfunction_ Function to create a new `Slab_` object.
+     * @tparam Pfunction_ Function to populate a `Slab_` object with the contents of a slab.
+     *
+     * @param id Identifier for the cached slab.
+     * This is typically defined as the index of the slab on the target dimension.
+     * For example, if each chunk takes up 10 rows, attempting to access row 21 would require retrieval of slab 2.
+     * @param create Function that accepts no arguments and returns a `Slab_` object.
+     * This is called while holding the lock for the shard, so it should be cheap.
+     * @param populate Function that accepts a slab ID and a reference to a `Slab_` object,
+     * and populates the latter with the contents of the former.
+     * This is called without holding any lock, so other threads can continue to use the cache in the meantime.
+     * If it throws an exception, the exception is propagated to the caller, and the slab is considered to be missing for future calls to `find()`.
+     *
+     * @return Handle to a slab.
+     * If the slab already exists in the cache, it is returned directly.
+     * If the slab is being populated by another thread, this method waits for it to finish and returns it.
+     * If the slab does not exist and there is still space in the shard, a new slab is created and populated with the contents of slab `id`.
+     * If the slab does not exist and there is no space in the shard, the least recently used slab that is not held by any `Handle` is evicted and its `Slab_` is populated with the contents of slab `id`.
+     */
+    template<class Cfunction_, class Pfunction_>
+    Handle find(Id_ id, Cfunction_ create, Pfunction_ populate) {
+        auto& shard = *(my_shards[std::hash<Id_>{}(id) % my_shards.size()]);
+        std::unique_lock<std::mutex> lck(shard.mutex);
+
+        while (true) {
+            auto it = shard.cache_exists.find(id);
+            if (it == shard.cache_exists.end()) {
+                break;
+            }
+
+            auto chosen = it->second;
+            shard.cache_data.splice(shard.cache_data.end(), shard.cache_data, chosen); // move to end.
+            ++(chosen->pins);
+            if (chosen->ready) {
+                return Handle(&shard, chosen);
+            }
+
+            // Another thread is populating this slab, so we wait for it to finish.
+            shard.cv.wait(lck, [&]() -> bool { return chosen->ready || !(chosen->indexed); });
+            if (chosen->ready) {
+                return Handle(&shard, chosen);
+            }
+
+            // Population failed in the other thread, so we try again ourselves.
+            --(chosen->pins);
+            if (chosen->pins == 0 && shard.cache_data.size() > shard.max_slabs) {
+                trim(shard);
+            }
+        }
+
+        typename SlabPool::iterator location = shard.cache_data.end();
+        if (!shard.cache_data.empty() && shard.cache_data.front().pins == 0 && !(shard.cache_data.front().indexed)) {
+            location = shard.cache_data.begin(); // re-using a slab from a failed population.
+        } else if (shard.cache_data.size() >= shard.max_slabs) {
+            for (auto it = shard.cache_data.begin(); it != shard.cache_data.end(); ++it) {
+                if (it->pins == 0) {
+                    location = it;
+                    break;
+                }
+            }
+        }
+
+        if (location == shard.cache_data.end()) {
+            shard.cache_data.emplace_back(create(), id);
+            location = std::prev(shard.cache_data.end());
+        } else {
+            if (location->indexed) {
+                shard.cache_exists.erase(location->id);
+            }
+            location->id = id;
+            location->ready = false;
+            shard.cache_data.splice(shard.cache_data.end(), shard.cache_data, location); // move to end.
+        }
+        location->indexed = true;
+        location->pins = 1;
+        shard.cache_exists[id] = location;
+
+        Handle output(&shard, location);
+        lck.unlock();
+
+        try {
+            populate(id, location->slab);
+        } catch (...) {
+            lck.lock();
+            shard.cache_exists.erase(id);
+            location->indexed = false;
+            shard.cache_data.splice(shard.cache_data.begin(), shard.cache_data, location); // move to start for re-use.
+            shard.cv.notify_all();
+            lck.unlock();
+            throw; // handle is released on unwinding.
+        }
+
+        lck.lock();
+        location->ready = true;
+        shard.cv.notify_all();
+        return output;
+    }
+
+public:
+    /**
+     * @return Maximum number of slabs in the cache.
+     * The type is an unsigned integer of the same type as that returned by `get_num_slabs()`.
+     */
+    auto get_max_slabs() const {
+        return my_max_slabs;
+    }
+
+    /**
+     * @return Number of slabs currently in the cache.
+     * The type is an unsigned integer of the same type as that returned by `get_max_slabs()`.
+     * This may exceed `get_max_slabs()` if many slabs are held by `Handle`s.
+     */
+    auto get_num_slabs() const {
+        typename SlabPool::size_type output = 0;
+        for (const auto& shard : my_shards) {
+            std::lock_guard<std::mutex> lck(shard->mutex);
+            output += shard->cache_data.size();
+        }
+        return output;
+    }
+
+    /**
+     * @return Number of shards in the cache.
+     */
+    auto get_num_shards() const {
+        return my_shards.size();
+    }
+};
+
+}
+
+#endif
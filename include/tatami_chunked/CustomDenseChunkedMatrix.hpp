@@ -3,13 +3,20 @@
 
 #include "custom_internals.hpp"
 #include "SlabCacheStats.hpp"
+#include "SlabCacheCounters.hpp"
 #include "DenseSlabFactory.hpp"
 #include "LruSlabCache.hpp"
 #include "OracularSlabCache.hpp"
 #include "OracularSubsettedSlabCache.hpp"
+#include "OracularAsyncSlabCache.hpp"
+#include "ConcurrentLruSlabCache.hpp"
+#include "copy_kernels.hpp"
 
 #include <type_traits>
+#include <algorithm>
 #include <vector>
+#include <memory>
+#include <stdexcept>
 #include <cstddef>
 
 #include "tatami/tatami.hpp"
@@ -45,6 +52,67 @@ struct CustomDenseChunkedMatrixOptions {
      * This involves more overhead to determine which elements are needed but may improve access speed for chunking strategies that support partial extraction.
      */
     bool cache_subset = false;
+
+    /**
+     * Whether to populate the cache in a background thread when an oracle is available, see `OracularAsyncSlabCache` for details.
+     * This allows the chunks for the next populate cycle to be loaded while the caller is processing the current cycle.
+     * If `true`, each `CustomDenseChunkedMatrixWorkspace` may be used in a different thread from the one that created the extractor, though never concurrently.
+     * This is ignored if `cache_subset = true` or if the cache cannot hold at least one slab.
+     */
+    bool async_populate = false;
+
+    /**
+     * Number of threads to use for populating the cache when an oracle is available.
+     * Each thread uses its own `CustomDenseChunkedMatrixWorkspace` to extract the chunks for a subset of the slabs in each populate cycle.
+     * Parallelization is performed with `tatami::parallelize()`, so the threading mechanism can be customized by defining `TATAMI_CUSTOM_PARALLEL`.
+     * This is only useful if the cache can hold multiple slabs, and has no effect for extraction without an oracle.
+     */
+    int num_populate_threads = 1;
+
+    /**
+     * Whether to evict slabs from the cache with Belady's optimal policy when an oracle is available, see `OracularBeladySlabCache` for details.
+     * This minimizes the number of slabs that are extracted for oracles that revisit slabs in a non-monotonic order, e.g., random subsets of rows/columns.
+     * This is ignored if `cache_subset = true` or `async_populate = true`, or if the cache cannot hold at least one slab.
+     */
+    bool belady_eviction = false;
+
+    /**
+     * Maximum number of runs of predictions to scan ahead when `belady_eviction = true`, see the `max_lookahead` argument of the `OracularBeladySlabCache` constructor.
+     * Each run is a consecutive sequence of predictions for the same slab, and each stored run requires an `Index_` and a `tatami::PredictionIndex`, so the default setting uses no more than a few megabytes per extractor.
+     * Larger values improve the approximation to Belady's optimal policy when slabs are revisited after a long gap.
+     * If zero, the lookahead is unlimited, which requires memory proportional to the number of predictions in the oracle.
+     */
+    tatami::PredictionIndex belady_max_lookahead = 100000;
+
+    /**
+     * Size of the shared chunk cache in bytes.
+     * If positive, the `CustomDenseChunkedMatrix` owns a thread-safe cache of fully extracted chunks that is shared by all of its extractors,
+     * e.g., when each thread in `tatami::parallelize()` creates its own extractor.
+     * Each extractor consults this cache before calling `CustomDenseChunkedMatrixWorkspace::extract()`,
+     * which avoids repeated extraction of the same chunk across extractors.
+     * Users may wish to reduce `maximum_cache_size` when this is set, as the per-extractor caches are still used.
+     * If the shared cache cannot hold a single chunk, it is not used.
+     */
+    std::size_t shared_cache_size = 0;
+
+    /**
+     * Whether to record counters for each extractor's cache, see `SlabCacheCounters`.
+     * If `true`, each extractor implements the `SlabCacheCountersReporter` interface.
+     * If `false`, no counters are stored or updated during extraction.
+     */
+    bool record_cache_counters = false;
+
+    /**
+     * Whether to shrink the cache for extractors with an oracle, see `SlabCacheAdvisor` for details.
+     * If `true`, the oracle's predictions are scanned when the extractor is constructed, 
+     * and the cache is reduced to the smallest number of slabs that achieves the same hit rate as the cache size implied by `maximum_cache_size`.
+     * This avoids allocating memory for slabs that will never be reused, e.g., when iterating over consecutive rows/columns. 
+     * Only the first `SlabCacheAdvisorOptions::maximum_predictions` predictions are scanned, to bound the cost of constructing the extractor.
+     *
+     * The shrunken cache always holds at least 2 slabs, or `num_populate_threads` slabs if this is larger.
+     * This ensures that the cache can still populate multiple slabs in each cycle, e.g., to prefetch slabs with `async_populate = true`, to populate slabs in parallel, or to request the chunks for multiple slabs in a single call to `CustomDenseChunkedMatrixWorkspace::extract_many()`.
+     */
+    bool shrink_cache_with_oracle = false;
 };
 
 /**
@@ -68,6 +136,51 @@ public:
      * @endcond
      */
 
+    /**
+     * @brief Request for a contiguous block of a single chunk, see `extract_many()`.
+     */
+    struct ChunkRequest {
+        /**
+         * Row of the chunk grid containing the chunk of interest.
+         */
+        Index_ chunk_row_id;
+
+        /**
+         * Column of the chunk grid containing the chunk of interest.
+         */
+        Index_ chunk_column_id;
+
+        /**
+         * Index of the first element on the target dimension to be extracted.
+         */
+        Index_ target_start;
+
+        /**
+         * Number of elements on the target dimension to be extracted.
+         */
+        Index_ target_length;
+
+        /**
+         * Index of the start of the contiguous block of the non-target dimension to be extracted.
+         */
+        Index_ non_target_start;
+
+        /**
+         * Length of the contiguous block of the non-target dimension to be extracted.
+         */
+        Index_ non_target_length;
+
+        /**
+         * Pointer to the output array.
+         */
+        ChunkValue_* output;
+
+        /**
+         * Distance between corresponding values from adjacent elements of the target dimension when they are being stored in `output`.
+         */
+        Index_ stride;
+    };
+
     /**
      * @param chunk_row_id Row of the chunk grid containing the chunk of interest.
      * This considers the grid of chunks that is obtained by partitioning each dimension of the matrix. 
@@ -224,6 +337,101 @@ public:
         ChunkValue_* output,
         Index_ stride
     ) = 0;
+
+    /**
+     * @param row Whether to extract rows from each chunk, i.e., the rows are the target dimension.
+     * @param requests Vector of requests, each of which specifies a chunk and the contiguous blocks to be extracted from it.
+     * This is guaranteed to be non-empty.
+     *
+     * This method extracts a contiguous block on both the target and non-target dimensions from each of several chunks.
+     * Each request should be handled as if its fields were passed to the corresponding `extract()` overload.
+     * The default implementation simply calls `extract()` for each request in turn.
+     *
+     * `CustomDenseChunkedMatrix` uses this method to extract all chunks that are needed to populate a slab (or all slabs in a populate cycle, when an oracle is available) in a single call.
+     * Subclasses may override this method to coalesce the requests into fewer reads from the underlying storage,
+     * e.g., a single hyperslab selection in a HDF5 file or a single ranged read from a remote store.
+     * The `output` arrays of different requests do not overlap.
+     */
+    virtual void extract_many(bool row, const std::vector<ChunkRequest>& requests) {
+        for (const auto& req : requests) {
+            extract(
+                req.chunk_row_id,
+                req.chunk_column_id,
+                row,
+                req.target_start,
+                req.target_length,
+                req.non_target_start,
+                req.non_target_length,
+                req.output,
+                req.stride
+            );
+        }
+    }
+
+    /**
+     * @return Whether `extract_single()` is supported by this workspace.
+     *
+     * The default implementation returns `false`.
+     * Subclasses should override this and `extract_single()` if they can cheaply extract a single element of the target dimension into a contiguous array.
+     */
+    virtual bool supports_extract_single() const {
+        return false;
+    }
+
+    /**
+     * @param chunk_row_id Row of the chunk grid containing the chunk of interest.
+     * @param chunk_column_id Column of the chunk grid containing the chunk of interest.
+     * @param row Whether to extract a row from the chunk, i.e., the rows are the target dimension.
+     * @param target Index of the element of the target dimension to be extracted.
+     * If `row = true`, this is the row, otherwise it is the column.
+     * @param non_target_start Index of the start of the contiguous block of the non-target dimension to be extracted.
+     * @param non_target_length Length of the contiguous block of the non-target dimension to be extracted.
+     * This is guaranteed to be positive.
+     * @param[out] output Pointer to an output array of length no less than `non_target_length`.
+     *
+     * For the non-target dimension index `non_target_start + q`, the value from the chunk should be stored in `output[q]`.
+     * This is equivalent to calling `extract()` with `target_start = target`, `target_length = 1` and `stride = non_target_length`,
+     * except that the values are stored at the start of `output` rather than at an offset of `target * stride`.
+     *
+     * `CustomDenseChunkedMatrix` uses this method when no slabs fit in the cache (see `CustomDenseChunkedMatrixOptions::maximum_cache_size`),
+     * allowing the values from each chunk to be written directly to their final location without a temporary buffer.
+     * This method is only called if `supports_extract_single()` returns `true`; the default implementation throws an error.
+     */
+    virtual void extract_single(
+        [[maybe_unused]] Index_ chunk_row_id,
+        [[maybe_unused]] Index_ chunk_column_id,
+        [[maybe_unused]] bool row,
+        [[maybe_unused]] Index_ target,
+        [[maybe_unused]] Index_ non_target_start,
+        [[maybe_unused]] Index_ non_target_length,
+        [[maybe_unused]] ChunkValue_* output
+    ) {
+        throw std::runtime_error("extract_single() is not supported by this workspace");
+    }
+
+    /**
+     * @param chunk_row_id Row of the chunk grid containing the chunk of interest.
+     * @param chunk_column_id Column of the chunk grid containing the chunk of interest.
+     * @param row Whether to extract a row from the chunk, i.e., the rows are the target dimension.
+     * @param target Index of the element of the target dimension to be extracted.
+     * If `row = true`, this is the row, otherwise it is the column.
+     * @param non_target_indices Indexed subset of the non-target dimension to be extracted.
+     * This is guaranteed to be non-empty with unique and sorted indices.
+     * @param[out] output Pointer to an output array of length no less than `non_target_indices.size()`.
+     *
+     * For the non-target dimension index `non_target_indices[q]`, the value from the chunk should be stored in `output[q]`.
+     * This is otherwise the same as the other `extract_single()` overload.
+     */
+    virtual void extract_single(
+        [[maybe_unused]] Index_ chunk_row_id,
+        [[maybe_unused]] Index_ chunk_column_id,
+        [[maybe_unused]] bool row,
+        [[maybe_unused]] Index_ target,
+        [[maybe_unused]] const std::vector<Index_>& non_target_indices,
+        [[maybe_unused]] ChunkValue_* output
+    ) {
+        throw std::runtime_error("extract_single() is not supported by this workspace");
+    }
 };
 
 /**
@@ -281,6 +489,38 @@ public:
      * In all calls to `CustomDenseChunkedMatrixManager::extract()`, each `chunk_column_id` will be less than the `ChunkDimensionsStats::num_chunks` of the return value.
      */
     virtual const ChunkDimensionStats<Index_>& column_stats() const = 0;
+
+    /**
+     * @param row Whether to extract rows from each chunk, i.e., the rows are the target dimension.
+     * @return Whether `chunk_data()` can be called for any chunk with this value of `row`.
+     *
+     * The default implementation returns `false`.
+     * Subclasses may override this for managers where each chunk's contents are already decoded in memory, e.g., in-memory stores or memory-mapped files.
+     */
+    virtual bool supports_chunk_data([[maybe_unused]] bool row) const {
+        return false;
+    }
+
+    /**
+     * @param chunk_row_id Row of the chunk grid containing the chunk of interest.
+     * @param chunk_column_id Column of the chunk grid containing the chunk of interest.
+     * @param row Whether to extract rows from the chunk, i.e., the rows are the target dimension.
+     * @return Pointer to the contents of the chunk.
+     * If `row = true`, the chunk should be stored in row-major order, i.e., the value at row `p` and column `q` of the chunk is stored at `p * CC + q` where `CC` is the `ChunkDimensionStats::chunk_length` of `column_stats()`.
+     * If `row = false`, the chunk should be stored in column-major order, i.e., the value at row `q` and column `p` of the chunk is stored at `p * CR + q` where `CR` is the `ChunkDimensionStats::chunk_length` of `row_stats()`.
+     * This layout is used even for chunks that are truncated at the edges of the matrix, though the values beyond the matrix boundaries are never accessed.
+     *
+     * This method is only called if `supports_chunk_data()` returns `true` for the same `row`.
+     * It may be called concurrently from multiple threads, and the returned pointer should remain valid for the lifetime of this manager.
+     *
+     * The `CustomDenseChunkedMatrix` uses this method to avoid copying data for full or block extraction when the requested block of the non-target dimension lies within a single chunk.
+     * In such cases, the extractor's `fetch()` method returns a pointer into the chunk's contents directly,
+     * skipping the usual extraction into the slab cache and the subsequent copy into the user-supplied buffer.
+     * The default implementation returns a null pointer.
+     */
+    virtual const ChunkValue_* chunk_data([[maybe_unused]] Index_ chunk_row_id, [[maybe_unused]] Index_ chunk_column_id, [[maybe_unused]] bool row) const {
+        return NULL;
+    }
 };
 
 /**
@@ -288,6 +528,139 @@ public:
  */
 namespace CustomChunkedMatrix_internal {
 
+/**************************
+ **** Shared chunk cache ***
+ **************************/
+
+// Thread-safe LRU cache of fully extracted chunks, shared across all extractors from the same matrix.
+// Each chunk is stored in row-major format with a stride equal to the (non-truncated) chunk width.
+template<typename ChunkValue_, typename Index_>
+class SharedDenseChunkCache {
+public:
+    SharedDenseChunkCache(const ChunkDimensionStats<Index_>& row_stats, const ChunkDimensionStats<Index_>& col_stats, std::size_t max_chunks) :
+        my_row_stats(row_stats),
+        my_col_stats(col_stats),
+        my_chunk_size(sanisizer::product<std::size_t>(row_stats.chunk_length, col_stats.chunk_length)),
+        my_cache(max_chunks)
+    {}
+
+private:
+    ChunkDimensionStats<Index_> my_row_stats, my_col_stats;
+    std::size_t my_chunk_size;
+    ConcurrentLruSlabCache<std::size_t, std::vector<ChunkValue_> > my_cache;
+
+public:
+    Index_ get_chunk_ncol() const {
+        return my_col_stats.chunk_length;
+    }
+
+    // 'use' should accept a pointer to the chunk's contents and is called exactly once.
+    // If multiple threads request the same missing chunk, it is only extracted once by the first thread's 'workspace'.
+    template<class Workspace_, class Use_>
+    void use(Index_ chunk_row_id, Index_ chunk_column_id, Workspace_& workspace, Use_ use) {
+        std::size_t id = static_cast<std::size_t>(chunk_row_id) * static_cast<std::size_t>(my_col_stats.num_chunks) + static_cast<std::size_t>(chunk_column_id); // cast is safe as this must be less than the total number of chunks.
+        auto handle = my_cache.find(
+            id,
+            [&]() -> std::vector<ChunkValue_> {
+                return std::vector<ChunkValue_>(my_chunk_size);
+            },
+            [&](std::size_t, std::vector<ChunkValue_>& chunk) -> void {
+                workspace.extract(
+                    chunk_row_id,
+                    chunk_column_id,
+                    true,
+                    0,
+                    get_chunk_length(my_row_stats, chunk_row_id),
+                    0,
+                    get_chunk_length(my_col_stats, chunk_column_id),
+                    chunk.data(),
+                    my_col_stats.chunk_length
+                );
+            }
+        );
+        use(handle->data());
+    }
+};
+
+// Workspace that consults the shared cache before extracting the full chunk with the underlying workspace.
+template<typename ChunkValue_, typename Index_, class WorkspacePtr_>
+class SharedCacheDenseWorkspace final : public CustomDenseChunkedMatrixWorkspace<ChunkValue_, Index_> {
+public:
+    SharedCacheDenseWorkspace(WorkspacePtr_ workspace, SharedDenseChunkCache<ChunkValue_, Index_>& cache) :
+        my_workspace(std::move(workspace)),
+        my_cache(cache)
+    {}
+
+private:
+    WorkspacePtr_ my_workspace;
+    SharedDenseChunkCache<ChunkValue_, Index_>& my_cache;
+
+    // 'target' and 'non_target' are functions that return the chunk index of the p-th target or q-th non-target element.
+    // 'copy_row' should copy all non-target elements from a row of the chunk into the output, which allows the callers to use the copy kernels for contiguous or indexed runs.
+    template<class Target_, class NonTarget_, class CopyRow_>
+    void copy(Index_ chunk_row_id, Index_ chunk_column_id, bool row, Index_ num_target, Target_ target, Index_ num_non_target, NonTarget_ non_target, CopyRow_ copy_row, ChunkValue_* output, Index_ stride) {
+        my_cache.use(chunk_row_id, chunk_column_id, *my_workspace, [&](const ChunkValue_* chunk) -> void {
+            std::size_t chunk_stride = my_cache.get_chunk_ncol();
+            if (row) {
+                for (Index_ p = 0; p < num_target; ++p) {
+                    std::size_t t = target(p);
+                    copy_row(chunk + t * chunk_stride, output + t * static_cast<std::size_t>(stride));
+                }
+            } else {
+                // Iterating over the chunk's rows in the outer loop so that the reads from the chunk are contiguous.
+                for (Index_ q = 0; q < num_non_target; ++q) {
+                    auto src = chunk + static_cast<std::size_t>(non_target(q)) * chunk_stride;
+                    for (Index_ p = 0; p < num_target; ++p) {
+                        std::size_t t = target(p);
+                        output[t * static_cast<std::size_t>(stride) + static_cast<std::size_t>(q)] = src[t];
+                    }
+                }
+            }
+        });
+    }
+
+public:
+    void extract(Index_ chunk_row_id, Index_ chunk_column_id, bool row, Index_ target_start, Index_ target_length, Index_ non_target_start, Index_ non_target_length, ChunkValue_* output, Index_ stride) {
+        copy(
+            chunk_row_id, chunk_column_id, row,
+            target_length, [&](Index_ p) -> Index_ { return target_start + p; },
+            non_target_length, [&](Index_ q) -> Index_ { return non_target_start + q; },
+            [&](const ChunkValue_* src, ChunkValue_* out) -> void { convert_copy_n(src + non_target_start, static_cast<std::size_t>(non_target_length), out); },
+            output, stride
+        );
+    }
+
+    void extract(Index_ chunk_row_id, Index_ chunk_column_id, bool row, Index_ target_start, Index_ target_length, const std::vector<Index_>& non_target_indices, ChunkValue_* output, Index_ stride) {
+        copy(
+            chunk_row_id, chunk_column_id, row,
+            target_length, [&](Index_ p) -> Index_ { return target_start + p; },
+            non_target_indices.size(), [&](Index_ q) -> Index_ { return non_target_indices[q]; },
+            [&](const ChunkValue_* src, ChunkValue_* out) -> void { gather_copy_n(src, non_target_indices.data(), non_target_indices.size(), out); },
+            output, stride
+        );
+    }
+
+    void extract(Index_ chunk_row_id, Index_ chunk_column_id, bool row, const std::vector<Index_>& target_indices, Index_ non_target_start, Index_ non_target_length, ChunkValue_* output, Index_ stride) {
+        copy(
+            chunk_row_id, chunk_column_id, row,
+            target_indices.size(), [&](Index_ p) -> Index_ { return target_indices[p]; },
+            non_target_length, [&](Index_ q) -> Index_ { return non_target_start + q; },
+            [&](const ChunkValue_* src, ChunkValue_* out) -> void { convert_copy_n(src + non_target_start, static_cast<std::size_t>(non_target_length), out); },
+            output, stride
+        );
+    }
+
+    void extract(Index_ chunk_row_id, Index_ chunk_column_id, bool row, const std::vector<Index_>& target_indices, const std::vector<Index_>& non_target_indices, ChunkValue_* output, Index_ stride) {
+        copy(
+            chunk_row_id, chunk_column_id, row,
+            target_indices.size(), [&](Index_ p) -> Index_ { return target_indices[p]; },
+            non_target_indices.size(), [&](Index_ q) -> Index_ { return non_target_indices[q]; },
+            [&](const ChunkValue_* src, ChunkValue_* out) -> void { gather_copy_n(src, non_target_indices.data(), non_target_indices.size(), out); },
+            output, stride
+        );
+    }
+};
+
 /*********************
  **** Base classes ***
  *********************/
@@ -309,37 +682,54 @@ private:
     // across chunks but only for the requested dimension element. Both cases
     // are likely to be much smaller than a full Slab, so we're already more
     // memory-efficient than 'require_minimum_cache = true`. 
+    //
+    // tmp_solo is left empty if the workspace can extract directly into
+    // final_solo, and final_solo is not allocated if it can just point to the
+    // user-supplied buffer, i.e., if the types are the same.
     DenseSingleWorkspace<ChunkValue_> my_tmp_solo;
     Slab my_final_solo;
 
+    static constexpr bool direct_buffer = std::is_same<Value_, ChunkValue_>::value;
+
     typedef I<decltype(my_tmp_solo.size())> TmpSize;
 
 public:
     SoloDenseCore(
-        WorkspacePtr_ chunk_workspace,
+        std::vector<WorkspacePtr_> chunk_workspaces,
         const ChunkCoordinator<false, ChunkValue_, Index_>& coordinator, 
         [[maybe_unused]] const SlabCacheStats<Index_>& slab_stats, // for consistency with the other base classes.
+        [[maybe_unused]] bool row,
         tatami::MaybeOracle<oracle_, Index_> oracle,
         Index_ non_target_length
     ) :
-        my_chunk_workspace(std::move(chunk_workspace)),
+        my_chunk_workspace(std::move(chunk_workspaces.front())),
         my_coordinator(coordinator),
         my_oracle(std::move(oracle)),
-        my_factory(non_target_length, 1), // non_target_length must fit in a size_t, as per the tatami contract; no need for a protected cast here.
-        my_tmp_solo(sanisizer::product<TmpSize>(my_coordinator.get_chunk_nrow(), my_coordinator.get_chunk_ncol())),
+        my_factory(non_target_length, static_cast<int>(!direct_buffer)), // non_target_length must fit in a size_t, as per the tatami contract; no need for a protected cast here.
         my_final_solo(my_factory.create())
-    {}
+    {
+        if (!my_chunk_workspace->supports_extract_single()) {
+            my_tmp_solo.resize(sanisizer::product<TmpSize>(my_coordinator.get_chunk_nrow(), my_coordinator.get_chunk_ncol()));
+        }
+    }
 
     template<typename ... Args_>
-    std::pair<const Slab*, Index_> fetch_raw(bool row, Index_ i, Args_&& ... args) {
+    std::pair<const Slab*, Index_> fetch_raw(bool row, Index_ i, [[maybe_unused]] Value_* buffer, Args_&& ... args) {
         if constexpr(oracle_) {
             i = my_oracle->get(my_counter++);
         }
+        if constexpr(direct_buffer) {
+            my_final_solo.data = buffer;
+        }
         return my_coordinator.fetch_single(row, i, std::forward<Args_>(args)..., *my_chunk_workspace, my_tmp_solo, my_final_solo);
     }
+
+    SlabCacheCounters get_counters() const {
+        return SlabCacheCounters(); // no cache, so nothing to report.
+    }
 };
 
-template<typename Value_, typename Index_, typename ChunkValue_, class WorkspacePtr_>
+template<bool record_counters_, typename Value_, typename Index_, typename ChunkValue_, class WorkspacePtr_>
 class MyopicDenseCore {
 private:
     WorkspacePtr_ my_chunk_workspace;
@@ -348,69 +738,87 @@ private:
     DenseSlabFactory<ChunkValue_> my_factory;
     typedef typename I<decltype(my_factory)>::Slab Slab;
 
-    LruSlabCache<Index_, Slab> my_cache;
+    LruSlabCache<Index_, Slab, true, record_counters_> my_cache;
+
+    // Re-used across calls to avoid an allocation for each slab.
+    std::vector<typename CustomDenseChunkedMatrixWorkspace<ChunkValue_, Index_>::ChunkRequest> my_request_buffer;
 
 public:
     MyopicDenseCore(
-        WorkspacePtr_ chunk_workspace,
+        std::vector<WorkspacePtr_> chunk_workspaces,
         const ChunkCoordinator<false, ChunkValue_, Index_>& coordinator,
         const SlabCacheStats<Index_>& slab_stats, 
+        bool row,
         [[maybe_unused]] tatami::MaybeOracle<false, Index_> ora, // for consistency with the other base classes
         [[maybe_unused]] Index_ non_target_length
     ) :
-        my_chunk_workspace(std::move(chunk_workspace)),
+        my_chunk_workspace(std::move(chunk_workspaces.front())),
         my_coordinator(coordinator),
         my_factory(slab_stats),
-        my_cache(slab_stats.max_slabs_in_cache)
+        my_cache(slab_stats.max_slabs_in_cache, coordinator.get_target_num_chunks(row))
     {}
 
     template<typename ... Args_>
-    std::pair<const Slab*, Index_> fetch_raw(bool row, Index_ i, Args_&& ... args) {
-        return my_coordinator.fetch_myopic(row, i, std::forward<Args_>(args)..., *my_chunk_workspace, my_cache, my_factory);
+    std::pair<const Slab*, Index_> fetch_raw(bool row, Index_ i, [[maybe_unused]] Value_* buffer, Args_&& ... args) {
+        return my_coordinator.fetch_myopic(row, i, std::forward<Args_>(args)..., *my_chunk_workspace, my_cache, my_factory, &my_request_buffer);
+    }
+
+    SlabCacheCounters get_counters() const {
+        return my_cache.get_counters();
     }
 };
 
-template<bool use_subset_, typename Value_, typename Index_, typename ChunkValue_, class WorkspacePtr_>
+template<OracularMode oracular_mode_, bool record_counters_, typename Value_, typename Index_, typename ChunkValue_, class WorkspacePtr_>
 class OracularDenseCore {
 private:
-    WorkspacePtr_ my_chunk_workspace;
+    std::vector<WorkspacePtr_> my_chunk_workspaces;
     const ChunkCoordinator<false, ChunkValue_, Index_>& my_coordinator;
 
     DenseSlabFactory<ChunkValue_> my_factory;
     typedef typename I<decltype(my_factory)>::Slab Slab;
 
-    typename std::conditional<use_subset_, OracularSubsettedSlabCache<Index_, Index_, Slab>, OracularSlabCache<Index_, Index_, Slab> >::type my_cache;
+    // One buffer for each workspace, as each workspace may be used by a different thread during population.
+    // This is declared before the cache so that it outlives any asynchronous population, see OracularAsyncSlabCache.
+    std::vector<std::vector<typename CustomDenseChunkedMatrixWorkspace<ChunkValue_, Index_>::ChunkRequest> > my_request_buffers;
+
+    OracularCache<oracular_mode_, Index_, Slab, record_counters_> my_cache;
 
 public:
     OracularDenseCore(
-        WorkspacePtr_ chunk_workspace,
+        std::vector<WorkspacePtr_> chunk_workspaces,
         const ChunkCoordinator<false, ChunkValue_, Index_>& coordinator,
         const SlabCacheStats<Index_>& slab_stats,
+        bool row,
         tatami::MaybeOracle<true, Index_> oracle, 
         [[maybe_unused]] Index_ non_target_length
     ) :
-        my_chunk_workspace(std::move(chunk_workspace)),
+        my_chunk_workspaces(std::move(chunk_workspaces)),
         my_coordinator(coordinator), 
         my_factory(slab_stats),
-        my_cache(std::move(oracle), slab_stats.max_slabs_in_cache)
+        my_request_buffers(my_chunk_workspaces.size()),
+        my_cache(create_oracular_cache<oracular_mode_, Index_, Slab, record_counters_>(std::move(oracle), slab_stats.max_slabs_in_cache, coordinator.get_target_num_chunks(row), coordinator.get_belady_max_lookahead()))
     {}
 
     template<typename ... Args_>
-    std::pair<const Slab*, Index_> fetch_raw(bool row, [[maybe_unused]] Index_ i, Args_&& ... args) {
-        if constexpr(use_subset_) {
-            return my_coordinator.fetch_oracular_subsetted(row, std::forward<Args_>(args)..., *my_chunk_workspace, my_cache, my_factory);
+    std::pair<const Slab*, Index_> fetch_raw(bool row, [[maybe_unused]] Index_ i, [[maybe_unused]] Value_* buffer, Args_&& ... args) {
+        if constexpr(oracular_mode_ == OracularMode::SUBSETTED) {
+            return my_coordinator.fetch_oracular_subsetted(row, std::forward<Args_>(args)..., my_chunk_workspaces, my_cache, my_factory, &my_request_buffers);
         } else {
-            return my_coordinator.fetch_oracular(row, std::forward<Args_>(args)..., *my_chunk_workspace, my_cache, my_factory);
+            return my_coordinator.fetch_oracular(row, std::forward<Args_>(args)..., my_chunk_workspaces, my_cache, my_factory, &my_request_buffers);
         }
     }
+
+    SlabCacheCounters get_counters() const {
+        return my_cache.get_counters();
+    }
 };
 
-template<bool solo_, bool oracle_, bool use_subset_, typename Value_, typename Index_, typename ChunkValue_, class WorkspacePtr_>
+template<bool solo_, bool oracle_, OracularMode oracular_mode_, bool record_counters_, typename Value_, typename Index_, typename ChunkValue_, class WorkspacePtr_>
 using DenseCore = typename std::conditional<solo_, 
       SoloDenseCore<oracle_, Value_, Index_, ChunkValue_, WorkspacePtr_>,
       typename std::conditional<oracle_,
-          OracularDenseCore<use_subset_, Value_, Index_, ChunkValue_, WorkspacePtr_>,
-          MyopicDenseCore<Value_, Index_, ChunkValue_, WorkspacePtr_>
+          OracularDenseCore<oracular_mode_, record_counters_, Value_, Index_, ChunkValue_, WorkspacePtr_>,
+          MyopicDenseCore<record_counters_, Value_, Index_, ChunkValue_, WorkspacePtr_>
       >::type
 >::type;
 
@@ -421,15 +829,20 @@ using DenseCore = typename std::conditional<solo_,
 template<class Slab_, typename Index_, typename Value_>
 const Value_* process_dense_slab(const std::pair<const Slab_*, Index_>& fetched, Value_* buffer, Index_ non_target_length) {
     auto ptr = fetched.first->data + static_cast<std::size_t>(fetched.second) * static_cast<std::size_t>(non_target_length); // cast to size_t to avoid overflow.
-    std::copy_n(ptr, non_target_length, buffer);
+    if constexpr(std::is_same<I<decltype(*ptr)>, Value_>::value) {
+        if (ptr == buffer) { // solo extraction already wrote to the buffer.
+            return buffer;
+        }
+    }
+    convert_copy_n(ptr, static_cast<std::size_t>(non_target_length), buffer);
     return buffer;
 }
 
-template<bool solo_, bool oracle_, bool use_subset_, typename Value_, typename Index_, typename ChunkValue_, class WorkspacePtr_>
-class DenseFull : public tatami::DenseExtractor<oracle_, Value_, Index_> {
+template<bool solo_, bool oracle_, OracularMode oracular_mode_, bool record_counters_, typename Value_, typename Index_, typename ChunkValue_, class WorkspacePtr_>
+class DenseFull : public tatami::DenseExtractor<oracle_, Value_, Index_>, public MaybeSlabCacheCountersReporter<record_counters_> {
 public:
     DenseFull(
-        WorkspacePtr_ chunk_workspace,
+        std::vector<WorkspacePtr_> chunk_workspaces,
         const ChunkCoordinator<false, ChunkValue_, Index_>& coordinator, 
         const SlabCacheStats<Index_>& slab_stats,
         bool row,
@@ -438,30 +851,35 @@ public:
         my_row(row),
         my_non_target_dim(coordinator.get_non_target_dim(row)),
         my_core(
-            std::move(chunk_workspace),
+            std::move(chunk_workspaces),
             coordinator,
             slab_stats,
+            row,
             std::move(oracle),
             my_non_target_dim
         )
     {}
 
     const Value_* fetch(Index_ i, Value_* buffer) {
-        auto fetched = my_core.fetch_raw(my_row, i, 0, my_non_target_dim);
+        auto fetched = my_core.fetch_raw(my_row, i, buffer, 0, my_non_target_dim);
         return process_dense_slab(fetched, buffer, my_non_target_dim);
     }
 
+    SlabCacheCounters get_slab_cache_counters() const {
+        return my_core.get_counters();
+    }
+
 private:
     bool my_row;
     Index_ my_non_target_dim;
-    DenseCore<solo_, oracle_, use_subset_, Value_, Index_, ChunkValue_, WorkspacePtr_> my_core;
+    DenseCore<solo_, oracle_, oracular_mode_, record_counters_, Value_, Index_, ChunkValue_, WorkspacePtr_> my_core;
 };
 
-template<bool solo_, bool oracle_, bool use_subset_, typename Value_, typename Index_, typename ChunkValue_, class WorkspacePtr_>
-class DenseBlock : public tatami::DenseExtractor<oracle_, Value_, Index_> {
+template<bool solo_, bool oracle_, OracularMode oracular_mode_, bool record_counters_, typename Value_, typename Index_, typename ChunkValue_, class WorkspacePtr_>
+class DenseBlock : public tatami::DenseExtractor<oracle_, Value_, Index_>, public MaybeSlabCacheCountersReporter<record_counters_> {
 public:
     DenseBlock(
-        WorkspacePtr_ chunk_workspace,
+        std::vector<WorkspacePtr_> chunk_workspaces,
         const ChunkCoordinator<false, ChunkValue_, Index_>& coordinator, 
         const SlabCacheStats<Index_>& slab_stats,
         bool row,
@@ -473,30 +891,35 @@ public:
         my_block_start(block_start),
         my_block_length(block_length),
         my_core(
-            std::move(chunk_workspace),
+            std::move(chunk_workspaces),
             coordinator, 
             slab_stats,
+            row,
             std::move(ora),
             block_length
         )
     {}
 
     const Value_* fetch(Index_ i, Value_* buffer) {
-        auto fetched = my_core.fetch_raw(my_row, i, my_block_start, my_block_length);
+        auto fetched = my_core.fetch_raw(my_row, i, buffer, my_block_start, my_block_length);
         return process_dense_slab(fetched, buffer, my_block_length);
     }
 
+    SlabCacheCounters get_slab_cache_counters() const {
+        return my_core.get_counters();
+    }
+
 private:
     bool my_row;
     Index_ my_block_start, my_block_length;
-    DenseCore<solo_, oracle_, use_subset_, Value_, Index_, ChunkValue_, WorkspacePtr_> my_core;
+    DenseCore<solo_, oracle_, oracular_mode_, record_counters_, Value_, Index_, ChunkValue_, WorkspacePtr_> my_core;
 };
 
-template<bool solo_, bool oracle_, bool use_subset_, typename Value_, typename Index_, typename ChunkValue_, class WorkspacePtr_>
-class DenseIndex : public tatami::DenseExtractor<oracle_, Value_, Index_> {
+template<bool solo_, bool oracle_, OracularMode oracular_mode_, bool record_counters_, typename Value_, typename Index_, typename ChunkValue_, class WorkspacePtr_>
+class DenseIndex : public tatami::DenseExtractor<oracle_, Value_, Index_>, public MaybeSlabCacheCountersReporter<record_counters_> {
 public:
     DenseIndex(
-        WorkspacePtr_ chunk_workspace,
+        std::vector<WorkspacePtr_> chunk_workspaces,
         const ChunkCoordinator<false, ChunkValue_, Index_>& coordinator, 
         const SlabCacheStats<Index_>& slab_stats,
         bool row,
@@ -505,24 +928,90 @@ public:
         my_row(row),
         my_indices_ptr(std::move(indices_ptr)),
         my_core(
-            std::move(chunk_workspace),
+            std::move(chunk_workspaces),
             coordinator, 
             slab_stats,
+            row,
             std::move(oracle),
             my_indices_ptr->size()
         )
     {}
 
     const Value_* fetch(Index_ i, Value_* buffer) {
-        auto fetched = my_core.fetch_raw(my_row, i, *my_indices_ptr, my_tmp_indices);
+        auto fetched = my_core.fetch_raw(my_row, i, buffer, *my_indices_ptr, my_tmp_indices);
         return process_dense_slab(fetched, buffer, static_cast<Index_>(my_indices_ptr->size()));
     }
 
+    SlabCacheCounters get_slab_cache_counters() const {
+        return my_core.get_counters();
+    }
+
 private:
     bool my_row;
     tatami::VectorPtr<Index_> my_indices_ptr;
     std::vector<Index_> my_tmp_indices;
-    DenseCore<solo_, oracle_, use_subset_, Value_, Index_, ChunkValue_, WorkspacePtr_> my_core;
+    DenseCore<solo_, oracle_, oracular_mode_, record_counters_, Value_, Index_, ChunkValue_, WorkspacePtr_> my_core;
+};
+
+// Returns pointers directly into the manager's chunks, if the requested block of the non-target dimension lies within a single chunk.
+template<bool oracle_, bool record_counters_, typename Value_, typename Index_, class Manager_>
+class DenseDirect final : public tatami::DenseExtractor<oracle_, Value_, Index_>, public MaybeSlabCacheCountersReporter<record_counters_> {
+public:
+    DenseDirect(
+        const Manager_& manager,
+        bool row,
+        tatami::MaybeOracle<oracle_, Index_> oracle,
+        Index_ target_chunkdim,
+        Index_ non_target_chunkdim,
+        Index_ non_target_chunk_id,
+        Index_ non_target_chunk_offset
+    ) :
+        my_manager(manager),
+        my_row(row),
+        my_oracle(std::move(oracle)),
+        my_target_chunkdim(target_chunkdim),
+        my_non_target_chunkdim(non_target_chunkdim),
+        my_non_target_chunk_id(non_target_chunk_id),
+        my_non_target_chunk_offset(non_target_chunk_offset)
+    {}
+
+private:
+    const Manager_& my_manager;
+    bool my_row;
+    tatami::MaybeOracle<oracle_, Index_> my_oracle;
+    typename std::conditional<oracle_, tatami::PredictionIndex, bool>::type my_counter = 0;
+
+    Index_ my_target_chunkdim;
+    Index_ my_non_target_chunkdim;
+    Index_ my_non_target_chunk_id;
+    Index_ my_non_target_chunk_offset;
+
+    const Value_* my_chunk = NULL;
+    Index_ my_chunk_id = 0;
+
+public:
+    const Value_* fetch(Index_ i, [[maybe_unused]] Value_* buffer) {
+        if constexpr(oracle_) {
+            i = my_oracle->get(my_counter++);
+        }
+
+        Index_ target_chunk_id = i / my_target_chunkdim;
+        if (my_chunk == NULL || target_chunk_id != my_chunk_id) {
+            if (my_row) {
+                my_chunk = my_manager.chunk_data(target_chunk_id, my_non_target_chunk_id, true);
+            } else {
+                my_chunk = my_manager.chunk_data(my_non_target_chunk_id, target_chunk_id, false);
+            }
+            my_chunk_id = target_chunk_id;
+        }
+
+        Index_ target_chunk_offset = i % my_target_chunkdim;
+        return my_chunk + sanisizer::product_unsafe<std::size_t>(target_chunk_offset, my_non_target_chunkdim) + static_cast<std::size_t>(my_non_target_chunk_offset);
+    }
+
+    SlabCacheCounters get_slab_cache_counters() const {
+        return SlabCacheCounters(); // no cache, so nothing to report.
+    }
 };
 
 }
@@ -530,6 +1019,179 @@ private:
  * @endcond
  */
 
+/**
+ * @brief View of a dense slab from a `CustomDenseChunkedMatrix`.
+ *
+ * @tparam Value_ Numeric type for the matrix value.
+ * @tparam Index_ Integer type for the row/column indices.
+ *
+ * A slab contains all elements of the target dimension that belong to a single chunk, i.e., a contiguous run of rows or columns.
+ * For target dimension element `target_start + p` and non-target dimension element `non_target_start + q`, the value is stored at `data[p * stride + q]`.
+ */
+template<typename Value_, typename Index_>
+struct CustomDenseChunkedMatrixSlab {
+    /**
+     * Index of the first element of the target dimension in this slab.
+     */
+    Index_ target_start = 0;
+
+    /**
+     * Number of elements of the target dimension in this slab.
+     */
+    Index_ target_length = 0;
+
+    /**
+     * Index of the first element of the non-target dimension in this slab.
+     */
+    Index_ non_target_start = 0;
+
+    /**
+     * Number of elements of the non-target dimension in this slab.
+     */
+    Index_ non_target_length = 0;
+
+    /**
+     * Pointer to the slab contents.
+     */
+    const Value_* data = NULL;
+
+    /**
+     * Distance between the values of consecutive elements of the target dimension in `data`.
+     * This is no less than `non_target_length`.
+     */
+    std::size_t stride = 0;
+};
+
+/**
+ * @brief Extract entire dense slabs from a `CustomDenseChunkedMatrix`.
+ *
+ * @tparam Value_ Numeric type for the matrix value.
+ * @tparam Index_ Integer type for the row/column indices.
+ * @tparam ChunkValue_ Numeric type of the values in each chunk.
+ * @tparam Manager_ Class that implements the `CustomDenseChunkedMatrixManager` interface.
+ *
+ * Instances of this class should be created with `CustomDenseChunkedMatrix::dense_slabs()`.
+ * Each call to `fetch()` returns all elements of the target dimension in one chunk, allowing callers to process a run of rows or columns in a single pass
+ * without the per-element virtual dispatch and copies of a `tatami::DenseExtractor`.
+ * No slabs are cached, so callers should request each slab only once.
+ */
+template<typename Value_, typename Index_, typename ChunkValue_, class Manager_ = CustomDenseChunkedMatrixManager<ChunkValue_, Index_> >
+class CustomDenseChunkedMatrixSlabExtractor {
+public:
+    /**
+     * @cond
+     */
+    CustomDenseChunkedMatrixSlabExtractor(
+        const Manager_& manager,
+        const CustomChunkedMatrix_internal::ChunkCoordinator<false, ChunkValue_, Index_>& coordinator,
+        std::unique_ptr<CustomDenseChunkedMatrixWorkspace<ChunkValue_, Index_> > chunk_workspace,
+        bool row,
+        Index_ block_start,
+        Index_ block_length
+    ) :
+        my_manager(manager),
+        my_coordinator(coordinator),
+        my_chunk_workspace(std::move(chunk_workspace)),
+        my_row(row),
+        my_block_start(block_start),
+        my_block_length(block_length)
+    {
+        if constexpr(std::is_same<Value_, ChunkValue_>::value) {
+            // Pointing directly into the manager's chunks if the block lies within a single chunk.
+            if (my_block_length > 0 && my_manager.supports_chunk_data(my_row)) {
+                auto non_target_chunkdim = my_coordinator.get_non_target_chunkdim(my_row);
+                my_non_target_chunk_id = my_block_start / non_target_chunkdim;
+                if ((my_block_start + (my_block_length - 1)) / non_target_chunkdim == my_non_target_chunk_id) {
+                    my_direct = true;
+                    return;
+                }
+            }
+        }
+
+        auto slab_size = sanisizer::product<I<decltype(my_buffer.size())> >(my_coordinator.get_target_chunkdim(my_row), my_block_length);
+        my_buffer.resize(slab_size);
+        my_slab.data = my_buffer.data();
+        if constexpr(!std::is_same<Value_, ChunkValue_>::value) {
+            my_converted.resize(sanisizer::cast<I<decltype(my_converted.size())> >(slab_size));
+        }
+    }
+    /**
+     * @endcond
+     */
+
+private:
+    const Manager_& my_manager;
+    const CustomChunkedMatrix_internal::ChunkCoordinator<false, ChunkValue_, Index_>& my_coordinator;
+    std::unique_ptr<CustomDenseChunkedMatrixWorkspace<ChunkValue_, Index_> > my_chunk_workspace;
+    bool my_row;
+    Index_ my_block_start, my_block_length;
+
+    bool my_direct = false;
+    Index_ my_non_target_chunk_id = 0;
+
+    std::vector<ChunkValue_> my_buffer;
+    typename DenseSlabFactory<ChunkValue_>::Slab my_slab;
+    std::vector<Value_> my_converted;
+    std::vector<typename CustomDenseChunkedMatrixWorkspace<ChunkValue_, Index_>::ChunkRequest> my_request_buffer;
+
+public:
+    /**
+     * @return Number of slabs, i.e., the number of chunks along the target dimension.
+     */
+    Index_ num_slabs() const {
+        return my_coordinator.get_target_num_chunks(my_row);
+    }
+
+    /**
+     * @param slab_id Index of the slab, i.e., the chunk along the target dimension.
+     * This should be less than `num_slabs()`.
+     * @return View of the slab. 
+     * The pointer in the view is only valid until the next call to `fetch()` or the destruction of this extractor.
+     *
+     * If `Value_` and `ChunkValue_` are the same and the manager supports `CustomDenseChunkedMatrixManager::chunk_data()`,
+     * the view points directly into the chunk when the non-target block lies within a single chunk.
+     * Otherwise, the chunks are extracted into an internal buffer that is referenced by the view.
+     */
+    CustomDenseChunkedMatrixSlab<Value_, Index_> fetch(Index_ slab_id) {
+        CustomDenseChunkedMatrixSlab<Value_, Index_> output;
+        auto target_chunkdim = my_coordinator.get_target_chunkdim(my_row);
+        output.target_start = slab_id * target_chunkdim;
+        output.target_length = my_coordinator.get_target_chunkdim(my_row, slab_id);
+        output.non_target_start = my_block_start;
+        output.non_target_length = my_block_length;
+
+        if constexpr(std::is_same<Value_, ChunkValue_>::value) {
+            if (my_direct) {
+                auto non_target_chunkdim = my_coordinator.get_non_target_chunkdim(my_row);
+                const Value_* chunk;
+                if (my_row) {
+                    chunk = my_manager.chunk_data(slab_id, my_non_target_chunk_id, true);
+                } else {
+                    chunk = my_manager.chunk_data(my_non_target_chunk_id, slab_id, false);
+                }
+                output.data = chunk + static_cast<std::size_t>(my_block_start % non_target_chunkdim);
+                output.stride = non_target_chunkdim;
+                return output;
+            }
+        }
+
+        output.stride = my_block_length;
+        if (my_block_length == 0) {
+            return output;
+        }
+
+        my_coordinator.fetch_whole_slab(my_row, slab_id, my_block_start, my_block_length, my_slab, *my_chunk_workspace, my_request_buffer);
+        if constexpr(std::is_same<Value_, ChunkValue_>::value) {
+            output.data = my_slab.data;
+        } else {
+            auto num_values = sanisizer::product_unsafe<std::size_t>(output.target_length, my_block_length);
+            convert_copy_n(my_slab.data, num_values, my_converted.data());
+            output.data = my_converted.data();
+        }
+        return output;
+    }
+};
+
 /**
  * @brief Matrix of custom dense chunks.
  *
@@ -554,11 +1216,24 @@ public:
      */
     CustomDenseChunkedMatrix(std::shared_ptr<Manager_> manager, const CustomDenseChunkedMatrixOptions& opt) : 
         my_manager(std::move(manager)),
-        my_coordinator(my_manager->row_stats(), my_manager->column_stats()),
+        my_coordinator(my_manager->row_stats(), my_manager->column_stats(), std::vector<std::size_t>(), opt.belady_max_lookahead),
         my_cache_size_in_elements(opt.maximum_cache_size / sizeof(ChunkValue_)),
         my_require_minimum_cache(opt.require_minimum_cache),
-        my_cache_subset(opt.cache_subset)
-    {}
+        my_cache_subset(opt.cache_subset),
+        my_async_populate(opt.async_populate),
+        my_num_populate_threads(opt.num_populate_threads),
+        my_belady_eviction(opt.belady_eviction),
+        my_record_cache_counters(opt.record_cache_counters),
+        my_shrink_cache_with_oracle(opt.shrink_cache_with_oracle)
+    {
+        std::size_t chunk_size = sanisizer::product<std::size_t>(my_coordinator.get_chunk_nrow(), my_coordinator.get_chunk_ncol());
+        if (chunk_size) {
+            auto max_chunks = opt.shared_cache_size / sizeof(ChunkValue_) / chunk_size;
+            if (max_chunks) {
+                my_shared_cache.reset(new CustomChunkedMatrix_internal::SharedDenseChunkCache<ChunkValue_, Index_>(my_manager->row_stats(), my_manager->column_stats(), max_chunks));
+            }
+        }
+    }
 
 private:
     std::shared_ptr<Manager_> my_manager;
@@ -566,6 +1241,12 @@ private:
     std::size_t my_cache_size_in_elements;
     bool my_require_minimum_cache;
     bool my_cache_subset;
+    bool my_async_populate;
+    int my_num_populate_threads;
+    bool my_belady_eviction;
+    bool my_record_cache_counters;
+    bool my_shrink_cache_with_oracle;
+    std::shared_ptr<CustomChunkedMatrix_internal::SharedDenseChunkCache<ChunkValue_, Index_> > my_shared_cache;
 
 public:
     Index_ nrow() const { 
@@ -604,8 +1285,8 @@ public:
      *** Myopic dense ***
      ********************/
 private:
-    template<bool oracle_, template<bool, bool, bool, typename, typename, typename, class> class Extractor_, typename ... Args_>
-    std::unique_ptr<tatami::DenseExtractor<oracle_, Value_, Index_> > raw_dense_internal(bool row, Index_ non_target_length, Args_&& ... args) const {
+    template<bool oracle_, template<bool, bool, CustomChunkedMatrix_internal::OracularMode, bool, typename, typename, typename, class> class Extractor_, typename ... Args_>
+    std::unique_ptr<tatami::DenseExtractor<oracle_, Value_, Index_> > raw_dense_internal(bool row, Index_ non_target_length, tatami::MaybeOracle<oracle_, Index_> oracle, Args_&& ... args) const {
         auto stats = [&]{
             if (row) {
                 // Remember, the num_chunks_per_column is the number of slabs needed to divide up all the *rows* of the matrix.
@@ -628,23 +1309,102 @@ private:
             }
         }(); 
 
-        auto wrk = my_manager->new_workspace_exact();
+        if constexpr(oracle_) {
+            if (my_shrink_cache_with_oracle) {
+                my_coordinator.shrink_slab_cache(row, *oracle, sanisizer::cast<Index_>(std::max(my_num_populate_threads, 2)), stats);
+            }
+        }
+
+        if (my_shared_cache) {
+            typedef std::unique_ptr<CustomDenseChunkedMatrixWorkspace<ChunkValue_, Index_> > WorkspacePtr;
+            auto wrks = create_workspaces<oracle_>(stats, [&]() -> WorkspacePtr {
+                auto wrk = my_manager->new_workspace_exact();
+                return std::make_unique<CustomChunkedMatrix_internal::SharedCacheDenseWorkspace<ChunkValue_, Index_, I<decltype(wrk)> > >(std::move(wrk), *my_shared_cache);
+            });
+            return dispatch_dense_internal<oracle_, Extractor_>(std::move(wrks), stats, row, std::move(oracle), std::forward<Args_>(args)...);
+        } else {
+            auto wrks = create_workspaces<oracle_>(stats, [&]() -> auto {
+                return my_manager->new_workspace_exact();
+            });
+            return dispatch_dense_internal<oracle_, Extractor_>(std::move(wrks), stats, row, std::move(oracle), std::forward<Args_>(args)...);
+        }
+    }
+
+    template<bool oracle_, class Create_>
+    auto create_workspaces(const SlabCacheStats<Index_>& stats, Create_ create) const {
+        std::vector<I<decltype(create())> > wrks;
+        wrks.push_back(create());
+        if constexpr(oracle_) {
+            if (stats.max_slabs_in_cache > 1) {
+                auto num_threads = std::min(sanisizer::cast<I<decltype(stats.max_slabs_in_cache)> >(std::max(my_num_populate_threads, 1)), stats.max_slabs_in_cache);
+                for (I<decltype(num_threads)> t = 1; t < num_threads; ++t) {
+                    wrks.push_back(create());
+                }
+            }
+        }
+        return wrks;
+    }
+
+    template<bool oracle_, template<bool, bool, CustomChunkedMatrix_internal::OracularMode, bool, typename, typename, typename, class> class Extractor_, class WorkspacePtr_, typename ... Args_>
+    std::unique_ptr<tatami::DenseExtractor<oracle_, Value_, Index_> > dispatch_dense_internal(std::vector<WorkspacePtr_> wrks, const SlabCacheStats<Index_>& stats, bool row, Args_&& ... args) const {
+        if (my_record_cache_counters) {
+            return create_dense_internal<oracle_, true, Extractor_>(std::move(wrks), stats, row, std::forward<Args_>(args)...);
+        } else {
+            return create_dense_internal<oracle_, false, Extractor_>(std::move(wrks), stats, row, std::forward<Args_>(args)...);
+        }
+    }
+
+    template<bool oracle_, bool record_counters_, template<bool, bool, CustomChunkedMatrix_internal::OracularMode, bool, typename, typename, typename, class> class Extractor_, class WorkspacePtr_, typename ... Args_>
+    std::unique_ptr<tatami::DenseExtractor<oracle_, Value_, Index_> > create_dense_internal(std::vector<WorkspacePtr_> wrks, const SlabCacheStats<Index_>& stats, bool row, Args_&& ... args) const {
+        typedef CustomChunkedMatrix_internal::OracularMode OracularMode;
         if (stats.max_slabs_in_cache == 0) {
-            return std::make_unique<Extractor_<true, oracle_, false, Value_, Index_, ChunkValue_, I<decltype(wrk)> > >(std::move(wrk), my_coordinator, stats, row, std::forward<Args_>(args)...);
+            return std::make_unique<Extractor_<true, oracle_, OracularMode::REGULAR, record_counters_, Value_, Index_, ChunkValue_, WorkspacePtr_> >(std::move(wrks), my_coordinator, stats, row, std::forward<Args_>(args)...);
         } else if constexpr(oracle_) {
             if (my_cache_subset) {
-                return std::make_unique<Extractor_<false, true, true, Value_, Index_, ChunkValue_, I<decltype(wrk)> > >(std::move(wrk), my_coordinator, stats, row, std::forward<Args_>(args)...);
+                return std::make_unique<Extractor_<false, true, OracularMode::SUBSETTED, record_counters_, Value_, Index_, ChunkValue_, WorkspacePtr_> >(std::move(wrks), my_coordinator, stats, row, std::forward<Args_>(args)...);
+            } else if (my_async_populate) {
+                return std::make_unique<Extractor_<false, true, OracularMode::ASYNC, record_counters_, Value_, Index_, ChunkValue_, WorkspacePtr_> >(std::move(wrks), my_coordinator, stats, row, std::forward<Args_>(args)...);
+            } else if (my_belady_eviction) {
+                return std::make_unique<Extractor_<false, true, OracularMode::BELADY, record_counters_, Value_, Index_, ChunkValue_, WorkspacePtr_> >(std::move(wrks), my_coordinator, stats, row, std::forward<Args_>(args)...);
             } else {
-                return std::make_unique<Extractor_<false, true, false, Value_, Index_, ChunkValue_, I<decltype(wrk)> > >(std::move(wrk), my_coordinator, stats, row, std::forward<Args_>(args)...);
+                return std::make_unique<Extractor_<false, true, OracularMode::REGULAR, record_counters_, Value_, Index_, ChunkValue_, WorkspacePtr_> >(std::move(wrks), my_coordinator, stats, row, std::forward<Args_>(args)...);
             }
         } else {
-            return std::make_unique<Extractor_<false, false, false, Value_, Index_, ChunkValue_, I<decltype(wrk)> > >(std::move(wrk), my_coordinator, stats, row, std::forward<Args_>(args)...);
+            return std::make_unique<Extractor_<false, false, OracularMode::REGULAR, record_counters_, Value_, Index_, ChunkValue_, WorkspacePtr_> >(std::move(wrks), my_coordinator, stats, row, std::forward<Args_>(args)...);
         }
     }
 
+    template<bool oracle_>
+    std::unique_ptr<tatami::DenseExtractor<oracle_, Value_, Index_> > direct_dense_internal(bool row, const tatami::MaybeOracle<oracle_, Index_>& oracle, Index_ block_start, Index_ block_length) const {
+        if constexpr(std::is_same<Value_, ChunkValue_>::value) {
+            if (block_length > 0 && my_manager->supports_chunk_data(row)) {
+                Index_ non_target_chunkdim = my_coordinator.get_non_target_chunkdim(row);
+                Index_ non_target_chunk_id = block_start / non_target_chunkdim;
+                if ((block_start + (block_length - 1)) / non_target_chunkdim == non_target_chunk_id) {
+                    Index_ target_chunkdim = my_coordinator.get_target_chunkdim(row);
+                    Index_ non_target_chunk_offset = block_start % non_target_chunkdim;
+                    if (my_record_cache_counters) {
+                        return std::make_unique<CustomChunkedMatrix_internal::DenseDirect<oracle_, true, Value_, Index_, Manager_> >(
+                            *my_manager, row, oracle, target_chunkdim, non_target_chunkdim, non_target_chunk_id, non_target_chunk_offset
+                        );
+                    } else {
+                        return std::make_unique<CustomChunkedMatrix_internal::DenseDirect<oracle_, false, Value_, Index_, Manager_> >(
+                            *my_manager, row, oracle, target_chunkdim, non_target_chunkdim, non_target_chunk_id, non_target_chunk_offset
+                        );
+                    }
+                }
+            }
+        }
+        return nullptr;
+    }
+
     template<bool oracle_>
     std::unique_ptr<tatami::DenseExtractor<oracle_, Value_, Index_> > dense_internal(bool row, tatami::MaybeOracle<oracle_, Index_> oracle, const tatami::Options&) const {
         auto non_target = (row ? my_coordinator.get_ncol() : my_coordinator.get_nrow());
+        auto direct = direct_dense_internal<oracle_>(row, oracle, 0, non_target);
+        if (direct) {
+            return direct;
+        }
         return raw_dense_internal<oracle_, CustomChunkedMatrix_internal::DenseFull>(row, non_target, std::move(oracle));
     }
 
@@ -656,6 +1416,10 @@ private:
         Index_ block_length, 
         const tatami::Options&) 
     const {
+        auto direct = direct_dense_internal<oracle_>(row, oracle, block_start, block_length);
+        if (direct) {
+            return direct;
+        }
         return raw_dense_internal<oracle_, CustomChunkedMatrix_internal::DenseBlock>(row, block_length, std::move(oracle), block_start, block_length);
     }
 
@@ -714,6 +1478,37 @@ public:
         return dense_internal<true>(row, std::move(oracle), std::move(indices_ptr), opt);
     }
 
+    /*******************
+     *** Dense slabs ***
+     *******************/
+public:
+    /**
+     * @param row Whether to extract slabs of rows, i.e., the rows are the target dimension.
+     * @param block_start Index of the first element of the non-target dimension to be extracted.
+     * @param block_length Number of elements of the non-target dimension to be extracted.
+     * @return Extractor for entire slabs, each of which contains a contiguous run of rows (or columns) belonging to a single chunk.
+     */
+    std::unique_ptr<CustomDenseChunkedMatrixSlabExtractor<Value_, Index_, ChunkValue_, Manager_> > dense_slabs(bool row, Index_ block_start, Index_ block_length) const {
+        typedef std::unique_ptr<CustomDenseChunkedMatrixWorkspace<ChunkValue_, Index_> > WorkspacePtr;
+        WorkspacePtr wrk;
+        if (my_shared_cache) {
+            auto raw = my_manager->new_workspace_exact();
+            wrk.reset(new CustomChunkedMatrix_internal::SharedCacheDenseWorkspace<ChunkValue_, Index_, I<decltype(raw)> >(std::move(raw), *my_shared_cache));
+        } else {
+            wrk = my_manager->new_workspace_exact();
+        }
+        return std::make_unique<CustomDenseChunkedMatrixSlabExtractor<Value_, Index_, ChunkValue_, Manager_> >(*my_manager, my_coordinator, std::move(wrk), row, block_start, block_length);
+    }
+
+    /**
+     * @param row Whether to extract slabs of rows, i.e., the rows are the target dimension.
+     * @return Extractor for entire slabs, each of which contains a contiguous run of rows (or columns) belonging to a single chunk.
+     * All elements of the non-target dimension are extracted.
+     */
+    std::unique_ptr<CustomDenseChunkedMatrixSlabExtractor<Value_, Index_, ChunkValue_, Manager_> > dense_slabs(bool row) const {
+        return dense_slabs(row, 0, my_coordinator.get_non_target_dim(row));
+    }
+
     /*********************
      *** Myopic sparse ***
      *********************/
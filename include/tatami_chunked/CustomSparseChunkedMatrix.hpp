@@ -4,9 +4,15 @@
 #include "custom_internals.hpp"
 #include "SparseSlabFactory.hpp"
 #include "SlabCacheStats.hpp"
+#include "SlabCacheCounters.hpp"
 #include "LruSlabCache.hpp"
 #include "OracularSlabCache.hpp"
 #include "OracularSubsettedSlabCache.hpp"
+#include "OracularAsyncSlabCache.hpp"
+#include "OracularVariableSlabCache.hpp"
+#include "VariableSlabFactory.hpp"
+#include "CompactSparseSlabFactory.hpp"
+#include "copy_kernels.hpp"
 #include "utils.hpp"
 
 #include <vector>
@@ -45,6 +51,96 @@ struct CustomSparseChunkedMatrixOptions {
      * This involves more overhead to determine which elements are needed but may improve access speed for chunking strategies that support partial extraction.
      */
     bool cache_subset = false;
+
+    /**
+     * Whether to populate the cache in a background thread when an oracle is available, see `OracularAsyncSlabCache` for details.
+     * This allows the chunks for the next populate cycle to be loaded while the caller is processing the current cycle.
+     * If `true`, each `CustomSparseChunkedMatrixWorkspace` may be used in a different thread from the one that created the extractor, though never concurrently.
+     * This is ignored if `cache_subset = true` or if the cache cannot hold at least one slab.
+     */
+    bool async_populate = false;
+
+    /**
+     * Number of threads to use for populating the cache when an oracle is available.
+     * Each thread uses its own `CustomSparseChunkedMatrixWorkspace` to extract the chunks for a subset of the slabs in each populate cycle.
+     * Parallelization is performed with `tatami::parallelize()`, so the threading mechanism can be customized by defining `TATAMI_CUSTOM_PARALLEL`.
+     * This is only useful if the cache can hold multiple slabs, and has no effect for extraction without an oracle.
+     */
+    int num_populate_threads = 1;
+
+    /**
+     * Whether to evict slabs from the cache with Belady's optimal policy when an oracle is available, see `OracularBeladySlabCache` for details.
+     * This minimizes the number of slabs that are extracted for oracles that revisit slabs in a non-monotonic order, e.g., random subsets of rows/columns.
+     * This is ignored if `cache_subset = true` or `async_populate = true`, or if the cache cannot hold at least one slab.
+     */
+    bool belady_eviction = false;
+
+    /**
+     * Maximum number of runs of predictions to scan ahead when `belady_eviction = true`, see the `max_lookahead` argument of the `OracularBeladySlabCache` constructor.
+     * Each run is a consecutive sequence of predictions for the same slab, and each stored run requires an `Index_` and a `tatami::PredictionIndex`, so the default setting uses no more than a few megabytes per extractor.
+     * Larger values improve the approximation to Belady's optimal policy when slabs are revisited after a long gap.
+     * If zero, the lookahead is unlimited, which requires memory proportional to the number of predictions in the oracle.
+     */
+    tatami::PredictionIndex belady_max_lookahead = 100000;
+
+    /**
+     * Whether to size each slab by its number of structural non-zeros when an oracle is available, see `OracularVariableSlabCache` for details.
+     * Slabs are stored in a single pool with the same memory usage as the fixed-size slabs implied by `maximum_cache_size`, see `SparseVariableSlabFactory`. 
+     * Newly extracted slabs are still allocated with space for every element of the non-target dimension, 
+     * but each slab is compacted to its actual number of non-zeros if it is re-used in a subsequent populate cycle.
+     * If `CustomSparseChunkedMatrixManager::has_chunk_nonzeros()` is true, new slabs are instead allocated with space for the number of non-zeros in the overlapping chunks.
+     * This allows more slabs to be cached for sparse chunks where the oracle revisits the same slabs.
+     *
+     * This option only applies to extraction with an oracle.
+     * Extractors without an oracle always use fixed-size slabs in a least-recently-used cache, as if `variable_slab_size = false`.
+     *
+     * If `CustomSparseChunkedMatrixManager::has_chunk_nonzeros()` is false, the size of a new slab is not known until it is extracted,
+     * so the first populate cycle reserves space for every element of the non-target dimension in each slab.
+     * The first cycle therefore holds no more slabs than the fixed-size cache, and the benefit only appears in later cycles that re-use the compacted slabs.
+     *
+     * The number of slabs is still determined from `maximum_cache_size` as if each slab were padded.
+     * If the cache cannot hold a single padded slab (i.e., `require_minimum_cache = false` and `maximum_cache_size` is too small), 
+     * the extractor falls back to reading the chunks for each element of the target dimension without any caching,
+     * even if the non-zeros for a slab would have fit within `maximum_cache_size`.
+     *
+     * This is ignored if `cache_subset = true`, `async_populate = true` or `belady_eviction = true`.
+     */
+    bool variable_slab_size = false;
+
+    /**
+     * Whether to store each cached slab in a compact format, see `CompactSparseSlabFactory` for details.
+     * Each slab is extracted into a padded buffer and then copied into contiguous arrays of values and indices,
+     * such that the memory used by each slab is proportional to its number of non-zeros.
+     *
+     * The padded buffers count towards `maximum_cache_size`, i.e., one buffer for extraction without an oracle, or one buffer per thread in `num_populate_threads` with an oracle.
+     * The remaining space is divided between the compact slabs.
+     * If `CustomSparseChunkedMatrixManager::has_chunk_nonzeros()` is true, each slab is budgeted by the largest number of non-zeros in the chunks spanned by any slab,
+     * so that more slabs can fit in the cache for sparse chunks; the storage for each slab is also reserved up front so that no allocations are performed during extraction.
+     * Otherwise, each slab is budgeted as if it were padded, and its storage is grown on demand whenever a slab contains more non-zeros than any previous slab stored in the same space.
+     *
+     * If the cache cannot hold the padded buffers and at least one compact slab, the usual padded slabs are used instead, as if `compact_slabs = false`.
+     * This is also ignored if `cache_subset = true`, `async_populate = true`, `belady_eviction = true` or `variable_slab_size = true` for extraction with an oracle.
+     */
+    bool compact_slabs = false;
+
+    /**
+     * Whether to record counters for each extractor's cache, see `SlabCacheCounters`.
+     * If `true`, each extractor implements the `SlabCacheCountersReporter` interface.
+     * If `false`, no counters are stored or updated during extraction.
+     */
+    bool record_cache_counters = false;
+
+    /**
+     * Whether to shrink the cache for extractors with an oracle, see `SlabCacheAdvisor` for details.
+     * If `true`, the oracle's predictions are scanned when the extractor is constructed, 
+     * and the cache is reduced to the smallest number of slabs that achieves the same hit rate as the cache size implied by `maximum_cache_size`.
+     * This avoids allocating memory for slabs that will never be reused, e.g., when iterating over consecutive rows/columns. 
+     * Only the first `SlabCacheAdvisorOptions::maximum_predictions` predictions are scanned, to bound the cost of constructing the extractor.
+     *
+     * The shrunken cache always holds at least 2 slabs, or `num_populate_threads` slabs if this is larger.
+     * This ensures that the cache can still populate multiple slabs in each cycle, e.g., to prefetch slabs with `async_populate = true` or to populate slabs in parallel.
+     */
+    bool shrink_cache_with_oracle = false;
 };
 
 /**
@@ -86,11 +182,13 @@ public:
      * This is guaranteed to be positive.
      * @param[out] output_values Vector of pointers in which to store the values of non-zero elements.
      * This has length equal to the extent of the target dimension for this chunk.
-     * Each pointer corresponds to an element of the target dimension and refers to an array of length no less than the extent of the non-target dimension of the chunk.
+     * Each pointer corresponds to an element of the target dimension and refers to an array of length no less than the extent of the non-target dimension of the chunk,
+     * unless the manager reports its per-chunk non-zero counts (see below).
      * Alternatively, this vector may be empty, in which case no values should be stored.
      * @param[out] output_indices Vector of vectors in which to store the indices of the non-zero elements along the non-target dimension.
      * This has length equal to the extent of the target dimension for this chunk.
-     * Each pointer corresponds to an element of the target dimension and refers to an array of length no less than the extent of the non-target dimension of the chunk.
+     * Each pointer corresponds to an element of the target dimension and refers to an array of length no less than the extent of the non-target dimension of the chunk,
+     * unless the manager reports its per-chunk non-zero counts (see below).
      * Alternatively, this vector may be empty, in which case no indices should be stored.
      * @param[in,out] output_number Pointer to an array of length equal to the extent of the target dimension.
      * Each entry `i` specifies the number of non-zero elements that are already present in `output_values[i]` and `output_indices[i]`.
@@ -107,6 +205,11 @@ public:
      *   This ensures that the values/indices from the same target dimension element are contiguous for easier fetching in the `CustomSparseChunkedMatrix`.
      * - `p` should lie in `[target_start, target_start + target_length)`, not `[0, target_length)`.
      *   This difference is deliberate and enables easy extraction of the target dimension element of interest.
+     * - If `CustomSparseChunkedMatrixManager::has_chunk_nonzeros()` is true, the slabs may be allocated from the reported counts, see `CustomSparseChunkedMatrixOptions::variable_slab_size`.
+     *   In that case, the space after `output_number[p]` in `output_values[p]` and `output_indices[p]` is only guaranteed to hold this chunk's reported number of non-zeros from `CustomSparseChunkedMatrixManager::chunk_nonzeros()`,
+     *   or the number of requested non-target elements if this is smaller.
+     *   Nothing should be written beyond the stored non-zeros, e.g., these arrays cannot be used as scratch space to decode a dense row/column,
+     *   as this may overwrite the non-zeros for the next target dimension element or the next slab.
      */
     virtual void extract(
         Index_ chunk_row_id,
@@ -138,11 +241,13 @@ public:
      * This is guaranteed to be non-empty with unique and sorted indices.
      * @param[out] output_values Vector of pointers in which to store the values of non-zero elements.
      * This has length equal to the extent of the target dimension for this chunk.
-     * Each pointer corresponds to an element of the target dimension and refers to an array of length no less than the extent of the non-target dimension of the chunk.
+     * Each pointer corresponds to an element of the target dimension and refers to an array of length no less than the extent of the non-target dimension of the chunk,
+     * unless the manager reports its per-chunk non-zero counts (see below).
      * Alternatively, this vector may be empty, in which case no values should be stored.
      * @param[out] output_indices Vector of vectors in which to store the indices of the non-zero elements along the non-target dimension.
      * This has length equal to the extent of the target dimension for this chunk.
-     * Each pointer corresponds to an element of the target dimension and refers to an array of length no less than the extent of the non-target dimension of the chunk.
+     * Each pointer corresponds to an element of the target dimension and refers to an array of length no less than the extent of the non-target dimension of the chunk,
+     * unless the manager reports its per-chunk non-zero counts (see below).
      * Alternatively, this vector may be empty, in which case no indices should be stored.
      * @param[in,out] output_number Pointer to an array of length equal to the extent of the target dimension.
      * Each entry `i` specifies the number of non-zero elements that are already present in `output_values[i]` and `output_indices[i]`.
@@ -159,6 +264,11 @@ public:
      *   This ensures that the values/indices from the same target dimension element are contiguous for easier fetching in the `CustomSparseChunkedMatrix`.
      * - `p` should lie in `[target_start, target_start + target_length)`, not `[0, target_length)`.
      *   This difference is deliberate and enables easy extraction of the target dimension element of interest.
+     * - If `CustomSparseChunkedMatrixManager::has_chunk_nonzeros()` is true, the slabs may be allocated from the reported counts, see `CustomSparseChunkedMatrixOptions::variable_slab_size`.
+     *   In that case, the space after `output_number[p]` in `output_values[p]` and `output_indices[p]` is only guaranteed to hold this chunk's reported number of non-zeros from `CustomSparseChunkedMatrixManager::chunk_nonzeros()`,
+     *   or the number of requested non-target elements if this is smaller.
+     *   Nothing should be written beyond the stored non-zeros, e.g., these arrays cannot be used as scratch space to decode a dense row/column,
+     *   as this may overwrite the non-zeros for the next target dimension element or the next slab.
      */
     virtual void extract(
         Index_ chunk_row_id,
@@ -188,11 +298,13 @@ public:
      * This is guaranteed to be positive.
      * @param[out] output_values Vector of pointers in which to store the values of non-zero elements.
      * This has length equal to the extent of the target dimension for this chunk.
-     * Each pointer corresponds to an element of the target dimension and refers to an array of length no less than the extent of the non-target dimension of the chunk.
+     * Each pointer corresponds to an element of the target dimension and refers to an array of length no less than the extent of the non-target dimension of the chunk,
+     * unless the manager reports its per-chunk non-zero counts (see below).
      * Alternatively, this vector may be empty, in which case no values should be stored.
      * @param[out] output_indices Vector of vectors in which to store the indices of the non-zero elements along the non-target dimension.
      * This has length equal to the extent of the target dimension for this chunk.
-     * Each pointer corresponds to an element of the target dimension and refers to an array of length no less than the extent of the non-target dimension of the chunk.
+     * Each pointer corresponds to an element of the target dimension and refers to an array of length no less than the extent of the non-target dimension of the chunk,
+     * unless the manager reports its per-chunk non-zero counts (see below).
      * Alternatively, this vector may be empty, in which case no indices should be stored.
      * @param[in,out] output_number Pointer to an array of length equal to the extent of the target dimension.
      * Each entry `i` specifies the number of non-zero elements that are already present in `output_values[i]` and `output_indices[i]`.
@@ -209,6 +321,11 @@ public:
      *   This ensures that the values/indices from the same target dimension element are contiguous for easier fetching in the `CustomSparseChunkedMatrix`.
      * - `p` should be a value in `target_indices`, not `[0, target_indices.size())`.
      *   This difference is deliberate and enables easy extraction of the target dimension element of interest.
+     * - If `CustomSparseChunkedMatrixManager::has_chunk_nonzeros()` is true, the slabs may be allocated from the reported counts, see `CustomSparseChunkedMatrixOptions::variable_slab_size`.
+     *   In that case, the space after `output_number[p]` in `output_values[p]` and `output_indices[p]` is only guaranteed to hold this chunk's reported number of non-zeros from `CustomSparseChunkedMatrixManager::chunk_nonzeros()`,
+     *   or the number of requested non-target elements if this is smaller.
+     *   Nothing should be written beyond the stored non-zeros, e.g., these arrays cannot be used as scratch space to decode a dense row/column,
+     *   as this may overwrite the non-zeros for the next target dimension element or the next slab.
      */
     virtual void extract(
         Index_ chunk_row_id,
@@ -237,11 +354,13 @@ public:
      * This is guaranteed to be non-empty with unique and sorted indices.
      * @param[out] output_values Vector of pointers in which to store the values of non-zero elements.
      * This has length equal to the extent of the target dimension for this chunk.
-     * Each pointer corresponds to an element of the target dimension and refers to an array of length no less than the extent of the non-target dimension of the chunk.
+     * Each pointer corresponds to an element of the target dimension and refers to an array of length no less than the extent of the non-target dimension of the chunk,
+     * unless the manager reports its per-chunk non-zero counts (see below).
      * Alternatively, this vector may be empty, in which case no values should be stored.
      * @param[out] output_indices Vector of vectors in which to store the indices of the non-zero elements along the non-target dimension.
      * This has length equal to the extent of the target dimension for this chunk.
-     * Each pointer corresponds to an element of the target dimension and refers to an array of length no less than the extent of the non-target dimension of the chunk.
+     * Each pointer corresponds to an element of the target dimension and refers to an array of length no less than the extent of the non-target dimension of the chunk,
+     * unless the manager reports its per-chunk non-zero counts (see below).
      * Alternatively, this vector may be empty, in which case no indices should be stored.
      * @param[in,out] output_number Pointer to an array of length equal to the extent of the target dimension.
      * Each entry `i` specifies the number of non-zero elements that are already present in `output_values[i]` and `output_indices[i]`.
@@ -258,6 +377,11 @@ public:
      *   This ensures that the values/indices from the same target dimension element are contiguous for easier fetching in the `CustomSparseChunkedMatrix`.
      * - `p` should be a value in `target_indices`, not `[0, target_indices.size())`.
      *   This difference is deliberate and enables easy extraction of the target dimension element of interest.
+     * - If `CustomSparseChunkedMatrixManager::has_chunk_nonzeros()` is true, the slabs may be allocated from the reported counts, see `CustomSparseChunkedMatrixOptions::variable_slab_size`.
+     *   In that case, the space after `output_number[p]` in `output_values[p]` and `output_indices[p]` is only guaranteed to hold this chunk's reported number of non-zeros from `CustomSparseChunkedMatrixManager::chunk_nonzeros()`,
+     *   or the number of requested non-target elements if this is smaller.
+     *   Nothing should be written beyond the stored non-zeros, e.g., these arrays cannot be used as scratch space to decode a dense row/column,
+     *   as this may overwrite the non-zeros for the next target dimension element or the next slab.
      */
     virtual void extract(
         Index_ chunk_row_id,
@@ -327,6 +451,35 @@ public:
      * In all calls to `CustomSparseChunkedMatrixManager::extract()`, each `chunk_column_id` will be less than the `ChunkDimensionsStats::num_chunks` of the return value.
      */
     virtual const ChunkDimensionStats<Index_>& column_stats() const = 0;
+
+    /**
+     * @return Whether the number of structural non-zeros in each chunk is available from `chunk_nonzeros()`.
+     * This defaults to `false` but may be overridden in subclasses that store such metadata.
+     */
+    virtual bool has_chunk_nonzeros() const {
+        return false;
+    }
+
+    /**
+     * @param chunk_row_id Row of the chunk grid containing the chunk of interest, see `extract()`.
+     * @param chunk_column_id Column of the chunk grid containing the chunk of interest, see `extract()`.
+     * @return Number of structural non-zeros in the chunk, or an upper bound thereof.
+     *
+     * This is only called if `has_chunk_nonzeros()` returns `true`, in which case it is called once for each chunk during construction of the `CustomSparseChunkedMatrix`.
+     * The counts are used in two ways:
+     *
+     * - A count of zero indicates that the chunk is truly empty.
+     *   `CustomSparseChunkedMatrixWorkspace::extract()` is never called for such a chunk, and all of its elements are treated as zero.
+     *   Implementations should not return zero for a chunk that contains any structural non-zeros, otherwise those non-zeros will be silently dropped.
+     * - A non-zero count is used to size the slabs more precisely when `CustomSparseChunkedMatrixOptions::variable_slab_size = true` or `CustomSparseChunkedMatrixOptions::compact_slabs = true`.
+     *   This must be an upper bound on the number of structural non-zeros in the chunk, as the slabs may not have space for any additional non-zeros.
+     *   It does not need to be exact, e.g., an empty chunk can report a non-zero count, in which case `extract()` is still called for that chunk.
+     * .
+     * The default implementation returns the total number of elements in the chunk.
+     */
+    virtual std::size_t chunk_nonzeros(Index_ chunk_row_id, Index_ chunk_column_id) const {
+        return sanisizer::product<std::size_t>(get_chunk_length(row_stats(), chunk_row_id), get_chunk_length(column_stats(), chunk_column_id));
+    }
 };
 
 /**
@@ -359,7 +512,7 @@ class SoloSparseCore {
 
 public:
     SoloSparseCore(
-        WorkspacePtr_ chunk_workspace,
+        std::vector<WorkspacePtr_> chunk_workspaces,
         const ChunkCoordinator<true, ChunkValue_, Index_>& coordinator, 
         [[maybe_unused]] const SlabCacheStats<Index_>& slab_stats, // for consistency with the other base classes.
         bool row,
@@ -368,7 +521,7 @@ public:
         bool needs_value,
         bool needs_index
     ) :
-        my_chunk_workspace(std::move(chunk_workspace)),
+        my_chunk_workspace(std::move(chunk_workspaces.front())),
         my_coordinator(coordinator),
         my_oracle(std::move(oracle)),
         my_factory(1, non_target_length, 1, needs_value, needs_index),
@@ -388,9 +541,13 @@ public:
         }
         return my_coordinator.fetch_single(row, i, std::forward<Args_>(args)..., *my_chunk_workspace, my_tmp_solo, my_final_solo);
     }
+
+    SlabCacheCounters get_counters() const {
+        return SlabCacheCounters(); // no cache, so nothing to report.
+    }
 };
 
-template<typename Value_, typename Index_, typename ChunkValue_, class WorkspacePtr_>
+template<bool record_counters_, typename Value_, typename Index_, typename ChunkValue_, class WorkspacePtr_>
 class MyopicSparseCore {
     WorkspacePtr_ my_chunk_workspace;
     const ChunkCoordinator<true, ChunkValue_, Index_>& my_coordinator;
@@ -398,11 +555,11 @@ class MyopicSparseCore {
     SparseSlabFactory<ChunkValue_, Index_, Index_> my_factory;
     typedef typename I<decltype(my_factory)>::Slab Slab;
 
-    LruSlabCache<Index_, Slab> my_cache;
+    LruSlabCache<Index_, Slab, true, record_counters_> my_cache;
 
 public:
     MyopicSparseCore(
-        WorkspacePtr_ chunk_workspace,
+        std::vector<WorkspacePtr_> chunk_workspaces,
         const ChunkCoordinator<true, ChunkValue_, Index_>& coordinator,
         const SlabCacheStats<Index_>& slab_stats, 
         bool row,
@@ -411,32 +568,36 @@ public:
         bool needs_value,
         bool needs_index
     ) : 
-        my_chunk_workspace(std::move(chunk_workspace)),
+        my_chunk_workspace(std::move(chunk_workspaces.front())),
         my_coordinator(coordinator),
         my_factory(coordinator.get_target_chunkdim(row), non_target_length, slab_stats, needs_value, needs_index),
-        my_cache(slab_stats.max_slabs_in_cache) 
+        my_cache(slab_stats.max_slabs_in_cache, coordinator.get_target_num_chunks(row)) 
     {}
 
     template<typename ... Args_>
     std::pair<const Slab*, Index_> fetch_raw(Index_ i, bool row, Args_&& ... args) {
         return my_coordinator.fetch_myopic(row, i, std::forward<Args_>(args)..., *my_chunk_workspace, my_cache, my_factory);
     }
+
+    SlabCacheCounters get_counters() const {
+        return my_cache.get_counters();
+    }
 };
 
-template<bool use_subset_, typename Value_, typename Index_, typename ChunkValue_, class WorkspacePtr_>
+template<OracularMode oracular_mode_, bool record_counters_, typename Value_, typename Index_, typename ChunkValue_, class WorkspacePtr_>
 class OracularSparseCore {
 protected:
-    WorkspacePtr_ my_chunk_workspace;
+    std::vector<WorkspacePtr_> my_chunk_workspaces;
     const ChunkCoordinator<true, ChunkValue_, Index_>& my_coordinator;
 
     SparseSlabFactory<ChunkValue_, Index_, Index_> my_factory;
     typedef typename I<decltype(my_factory)>::Slab Slab;
 
-    typename std::conditional<use_subset_, OracularSubsettedSlabCache<Index_, Index_, Slab>, OracularSlabCache<Index_, Index_, Slab> >::type my_cache;
+    OracularCache<oracular_mode_, Index_, Slab, record_counters_> my_cache;
 
 public:
     OracularSparseCore(
-        WorkspacePtr_ chunk_workspace,
+        std::vector<WorkspacePtr_> chunk_workspaces,
         const ChunkCoordinator<true, ChunkValue_, Index_>& coordinator,
         const SlabCacheStats<Index_>& slab_stats,
         bool row,
@@ -445,28 +606,182 @@ public:
         bool needs_value,
         bool needs_index
     ) : 
-        my_chunk_workspace(std::move(chunk_workspace)),
+        my_chunk_workspaces(std::move(chunk_workspaces)),
         my_coordinator(coordinator), 
         my_factory(coordinator.get_target_chunkdim(row), non_target_length, slab_stats, needs_value, needs_index),
-        my_cache(std::move(oracle), slab_stats.max_slabs_in_cache) 
+        my_cache(create_oracular_cache<oracular_mode_, Index_, Slab, record_counters_>(std::move(oracle), slab_stats.max_slabs_in_cache, coordinator.get_target_num_chunks(row), coordinator.get_belady_max_lookahead()))
     {}
 
     template<typename ... Args_>
     std::pair<const Slab*, Index_> fetch_raw([[maybe_unused]] Index_ i, bool row, Args_&& ... args) {
-        if constexpr(use_subset_) {
-            return my_coordinator.fetch_oracular_subsetted(row, std::forward<Args_>(args)..., *my_chunk_workspace, my_cache, my_factory);
+        if constexpr(oracular_mode_ == OracularMode::SUBSETTED) {
+            return my_coordinator.fetch_oracular_subsetted(row, std::forward<Args_>(args)..., my_chunk_workspaces, my_cache, my_factory);
         } else {
-            return my_coordinator.fetch_oracular(row, std::forward<Args_>(args)..., *my_chunk_workspace, my_cache, my_factory);
+            return my_coordinator.fetch_oracular(row, std::forward<Args_>(args)..., my_chunk_workspaces, my_cache, my_factory);
         }
     }
+
+    SlabCacheCounters get_counters() const {
+        return my_cache.get_counters();
+    }
+};
+
+template<bool record_counters_, typename Value_, typename Index_, typename ChunkValue_, class WorkspacePtr_>
+class VariableOracularSparseCore {
+protected:
+    std::vector<WorkspacePtr_> my_chunk_workspaces;
+    const ChunkCoordinator<true, ChunkValue_, Index_>& my_coordinator;
+
+    SparseVariableSlabFactory<ChunkValue_, Index_, std::size_t, Index_> my_factory;
+    typedef typename I<decltype(my_factory)>::Slab Slab;
+
+    OracularVariableSlabCache<Index_, Index_, Slab, std::size_t, true, record_counters_> my_cache;
+
+public:
+    VariableOracularSparseCore(
+        std::vector<WorkspacePtr_> chunk_workspaces,
+        const ChunkCoordinator<true, ChunkValue_, Index_>& coordinator,
+        const SlabCacheStats<Index_>& slab_stats,
+        bool row,
+        tatami::MaybeOracle<true, Index_> oracle,
+        [[maybe_unused]] Index_ non_target_length, // for consistency with the other base classes, as the upper size is determined from each request.
+        bool needs_value,
+        bool needs_index
+    ) : 
+        my_chunk_workspaces(std::move(chunk_workspaces)),
+        my_coordinator(coordinator), 
+        // Same memory usage as the equivalent number of fixed-size slabs.
+        my_factory(coordinator.get_target_chunkdim(row), sanisizer::product<std::size_t>(slab_stats.slab_size_in_elements, slab_stats.max_slabs_in_cache), needs_value, needs_index),
+        my_cache(std::move(oracle), sanisizer::product_unsafe<std::size_t>(slab_stats.slab_size_in_elements, slab_stats.max_slabs_in_cache), coordinator.get_target_num_chunks(row)) 
+    {}
+
+    template<typename ... Args_>
+    std::pair<const Slab*, Index_> fetch_raw([[maybe_unused]] Index_ i, bool row, Args_&& ... args) {
+        return my_coordinator.fetch_oracular_variable(row, std::forward<Args_>(args)..., my_chunk_workspaces, my_cache, my_factory);
+    }
+
+    SlabCacheCounters get_counters() const {
+        return my_cache.get_counters();
+    }
 };
 
-template<bool solo_, bool oracle_, bool use_subset_, typename Value_, typename Index_, typename ChunkValue_, class WorkspacePtr_>
+// Upper bound on the number of non-zeros in each compact slab, or zero if the chunk counts are not available.
+template<typename ChunkValue_, typename Index_>
+std::size_t get_compact_slab_capacity(const ChunkCoordinator<true, ChunkValue_, Index_>& coordinator, bool row, Index_ non_target_length) {
+    if (!coordinator.has_chunk_nonzeros()) {
+        return 0;
+    }
+    auto padded = sanisizer::product_unsafe<std::size_t>(coordinator.get_target_chunkdim(row), non_target_length); // already checked when computing the SlabCacheStats.
+    return std::min(padded, coordinator.get_max_slab_nonzeros(row));
+}
+
+// Compact slabs only need space for their non-zeros, but the padded buffers used to extract each slab also count towards the cache size.
+// Without the chunk counts, we have to assume that each compact slab is as large as a padded slab.
+// This returns false if the cache cannot hold the buffers and at least one compact slab, in which case the regular padded slabs should be used instead.
+template<typename ChunkValue_, typename Index_>
+bool fit_compact_slab_cache(
+    const ChunkCoordinator<true, ChunkValue_, Index_>& coordinator,
+    bool row,
+    Index_ non_target_length,
+    std::size_t cache_size_in_bytes,
+    std::size_t element_size,
+    Index_ num_buffers,
+    SlabCacheStats<Index_>& stats)
+{
+    if (stats.max_slabs_in_cache == 0) {
+        return false;
+    }
+    if (element_size == 0) { // nothing is stored in the slabs or buffers, so the stats don't need to change.
+        return true;
+    }
+
+    std::size_t cache_size_in_elements = cache_size_in_bytes / element_size;
+    auto buffer_size_in_elements = sanisizer::product<std::size_t>(stats.slab_size_in_elements, num_buffers);
+    if (cache_size_in_elements <= buffer_size_in_elements) {
+        return false;
+    }
+
+    std::size_t slab_size_in_elements = (coordinator.has_chunk_nonzeros() ? get_compact_slab_capacity(coordinator, row, non_target_length) : stats.slab_size_in_elements);
+    auto max_slabs = compute_max_slabs_in_cache(slab_size_in_elements, coordinator.get_target_num_chunks(row), cache_size_in_elements - buffer_size_in_elements, false);
+    if (max_slabs == 0) {
+        return false;
+    }
+
+    stats.max_slabs_in_cache = max_slabs;
+    return true;
+}
+
+template<bool oracle_, bool record_counters_, typename Value_, typename Index_, typename ChunkValue_, class WorkspacePtr_>
+class CompactSparseCore {
+protected:
+    std::vector<WorkspacePtr_> my_chunk_workspaces;
+    const ChunkCoordinator<true, ChunkValue_, Index_>& my_coordinator;
+
+    CompactSparseSlabFactory<ChunkValue_, Index_, Index_> my_factory;
+    typedef typename I<decltype(my_factory)>::Slab Slab;
+
+    typename std::conditional<oracle_,
+        OracularCache<OracularMode::REGULAR, Index_, Slab, record_counters_>,
+        LruSlabCache<Index_, Slab, true, record_counters_>
+    >::type my_cache;
+
+public:
+    CompactSparseCore(
+        std::vector<WorkspacePtr_> chunk_workspaces,
+        const ChunkCoordinator<true, ChunkValue_, Index_>& coordinator,
+        const SlabCacheStats<Index_>& slab_stats,
+        bool row,
+        [[maybe_unused]] tatami::MaybeOracle<oracle_, Index_> oracle, // only used for the oracular cache.
+        Index_ non_target_length,
+        bool needs_value,
+        bool needs_index
+    ) : 
+        my_chunk_workspaces(std::move(chunk_workspaces)),
+        my_coordinator(coordinator), 
+        // Myopic extraction only ever uses the first workspace, so only one buffer is needed.
+        my_factory(
+            coordinator.get_target_chunkdim(row),
+            non_target_length,
+            needs_value,
+            needs_index,
+            (oracle_ ? static_cast<Index_>(my_chunk_workspaces.size()) : 1),
+            get_compact_slab_capacity(coordinator, row, non_target_length)
+        ),
+        my_cache([&]() {
+            if constexpr(oracle_) {
+                return I<decltype(my_cache)>(std::move(oracle), slab_stats.max_slabs_in_cache, coordinator.get_target_num_chunks(row));
+            } else {
+                return I<decltype(my_cache)>(slab_stats.max_slabs_in_cache, coordinator.get_target_num_chunks(row));
+            }
+        }())
+    {}
+
+    template<typename ... Args_>
+    std::pair<const Slab*, Index_> fetch_raw([[maybe_unused]] Index_ i, bool row, Args_&& ... args) {
+        if constexpr(oracle_) {
+            return my_coordinator.fetch_oracular(row, std::forward<Args_>(args)..., my_chunk_workspaces, my_cache, my_factory);
+        } else {
+            return my_coordinator.fetch_myopic(row, i, std::forward<Args_>(args)..., *(my_chunk_workspaces.front()), my_cache, my_factory);
+        }
+    }
+
+    SlabCacheCounters get_counters() const {
+        return my_cache.get_counters();
+    }
+};
+
+template<bool solo_, bool oracle_, OracularMode oracular_mode_, bool record_counters_, typename Value_, typename Index_, typename ChunkValue_, class WorkspacePtr_>
 using SparseCore = typename std::conditional<solo_, 
       SoloSparseCore<oracle_, Value_, Index_, ChunkValue_, WorkspacePtr_>,
-      typename std::conditional<oracle_,
-          OracularSparseCore<use_subset_, Value_, Index_, ChunkValue_, WorkspacePtr_>,
-          MyopicSparseCore<Value_, Index_, ChunkValue_, WorkspacePtr_>
+      typename std::conditional<oracular_mode_ == OracularMode::COMPACT,
+          CompactSparseCore<oracle_, record_counters_, Value_, Index_, ChunkValue_, WorkspacePtr_>,
+          typename std::conditional<oracle_,
+              typename std::conditional<oracular_mode_ == OracularMode::VARIABLE,
+                  VariableOracularSparseCore<record_counters_, Value_, Index_, ChunkValue_, WorkspacePtr_>,
+                  OracularSparseCore<oracular_mode_, record_counters_, Value_, Index_, ChunkValue_, WorkspacePtr_>
+              >::type,
+              MyopicSparseCore<record_counters_, Value_, Index_, ChunkValue_, WorkspacePtr_>
+          >::type
       >::type
 >::type;
 
@@ -474,19 +789,64 @@ using SparseCore = typename std::conditional<solo_,
  **** Sparse classes ***
  ***********************/
 
+// Counts are stored in row-major order of the chunk grid, or are empty if the manager does not report them.
+template<class Manager_>
+std::vector<std::size_t> collect_chunk_nonzeros(const Manager_& manager) {
+    std::vector<std::size_t> output;
+    if (manager.has_chunk_nonzeros()) {
+        const auto& rstats = manager.row_stats();
+        const auto& cstats = manager.column_stats();
+        output.reserve(sanisizer::product<std::size_t>(rstats.num_chunks, cstats.num_chunks));
+        for (decltype(rstats.num_chunks) r = 0; r < rstats.num_chunks; ++r) {
+            for (decltype(cstats.num_chunks) c = 0; c < cstats.num_chunks; ++c) {
+                output.push_back(manager.chunk_nonzeros(r, c));
+            }
+        }
+    }
+    return output;
+}
+
+// Access the contents of the 'i'-th element of the target dimension, for both the pointer-based and compact slab formats.
+template<class Slab_, typename Index_>
+Index_ get_slab_number(const Slab_& slab, Index_ i) {
+    if constexpr(IsCompactSlab<Slab_>::value) {
+        return static_cast<Index_>(slab.pointers[i + 1] - slab.pointers[i]);
+    } else {
+        return slab.number[i];
+    }
+}
+
+template<class Slab_, typename Index_>
+auto get_slab_values(const Slab_& slab, Index_ i) {
+    if constexpr(IsCompactSlab<Slab_>::value) {
+        return slab.values.data() + slab.pointers[i];
+    } else {
+        return slab.values[i];
+    }
+}
+
+template<class Slab_, typename Index_>
+auto get_slab_indices(const Slab_& slab, Index_ i) {
+    if constexpr(IsCompactSlab<Slab_>::value) {
+        return slab.indices.data() + slab.pointers[i];
+    } else {
+        return slab.indices[i];
+    }
+}
+
 template<class Slab_, typename Index_, typename Value_>
 tatami::SparseRange<Value_, Index_> process_sparse_slab(const std::pair<const Slab_*, Index_>& fetched, Value_* value_buffer, Index_* index_buffer, bool needs_value, bool needs_index) {
-    auto num = fetched.first->number[fetched.second];
+    auto num = get_slab_number(*(fetched.first), fetched.second);
 
     if (needs_value) {
-        auto vptr = fetched.first->values[fetched.second];
-        std::copy_n(vptr, num, value_buffer);
+        auto vptr = get_slab_values(*(fetched.first), fetched.second);
+        convert_copy_n(vptr, static_cast<std::size_t>(num), value_buffer);
     } else {
         value_buffer = NULL;
     }
 
     if (needs_index) {
-        auto iptr = fetched.first->indices[fetched.second];
+        auto iptr = get_slab_indices(*(fetched.first), fetched.second);
         std::copy_n(iptr, num, index_buffer);
     } else {
         index_buffer = NULL;
@@ -495,11 +855,11 @@ tatami::SparseRange<Value_, Index_> process_sparse_slab(const std::pair<const Sl
     return tatami::SparseRange<Value_, Index_>(num, value_buffer, index_buffer);
 }
 
-template<bool solo_, bool oracle_, bool use_subset_, typename Value_, typename Index_, typename ChunkValue_, class WorkspacePtr_>
-class SparseFull : public tatami::SparseExtractor<oracle_, Value_, Index_> {
+template<bool solo_, bool oracle_, OracularMode oracular_mode_, bool record_counters_, typename Value_, typename Index_, typename ChunkValue_, class WorkspacePtr_>
+class SparseFull : public tatami::SparseExtractor<oracle_, Value_, Index_>, public MaybeSlabCacheCountersReporter<record_counters_> {
 public:
     SparseFull(
-        WorkspacePtr_ chunk_workspace,
+        std::vector<WorkspacePtr_> chunk_workspaces,
         const ChunkCoordinator<true, ChunkValue_, Index_>& coordinator, 
         const SlabCacheStats<Index_>& slab_stats,
         bool row,
@@ -511,7 +871,7 @@ public:
         my_needs_value(opt.sparse_extract_value),
         my_needs_index(opt.sparse_extract_index),
         my_core(
-            std::move(chunk_workspace),
+            std::move(chunk_workspaces),
             coordinator, 
             slab_stats,
             row,
@@ -527,18 +887,22 @@ public:
         return process_sparse_slab(fetched, value_buffer, index_buffer, my_needs_value, my_needs_index); 
     }
 
+    SlabCacheCounters get_slab_cache_counters() const {
+        return my_core.get_counters();
+    }
+
 private:
     bool my_row;
     Index_ my_non_target_dim;
     bool my_needs_value, my_needs_index;
-    SparseCore<solo_, oracle_, use_subset_, Value_, Index_, ChunkValue_, WorkspacePtr_> my_core;
+    SparseCore<solo_, oracle_, oracular_mode_, record_counters_, Value_, Index_, ChunkValue_, WorkspacePtr_> my_core;
 };
 
-template<bool solo_, bool oracle_, bool use_subset_, typename Value_, typename Index_, typename ChunkValue_, class WorkspacePtr_>
-class SparseBlock : public tatami::SparseExtractor<oracle_, Value_, Index_> {
+template<bool solo_, bool oracle_, OracularMode oracular_mode_, bool record_counters_, typename Value_, typename Index_, typename ChunkValue_, class WorkspacePtr_>
+class SparseBlock : public tatami::SparseExtractor<oracle_, Value_, Index_>, public MaybeSlabCacheCountersReporter<record_counters_> {
 public:
     SparseBlock(
-        WorkspacePtr_ chunk_workspace,
+        std::vector<WorkspacePtr_> chunk_workspaces,
         const ChunkCoordinator<true, ChunkValue_, Index_>& coordinator, 
         const SlabCacheStats<Index_>& slab_stats,
         bool row,
@@ -553,7 +917,7 @@ public:
         my_needs_value(opt.sparse_extract_value),
         my_needs_index(opt.sparse_extract_index),
         my_core(
-            std::move(chunk_workspace),
+            std::move(chunk_workspaces),
             coordinator,
             slab_stats,
             row,
@@ -569,18 +933,22 @@ public:
         return process_sparse_slab(fetched, value_buffer, index_buffer, my_needs_value, my_needs_index);
     }
 
+    SlabCacheCounters get_slab_cache_counters() const {
+        return my_core.get_counters();
+    }
+
 private:
     bool my_row;
     Index_ my_block_start, my_block_length;
     bool my_needs_value, my_needs_index;
-    SparseCore<solo_, oracle_, use_subset_, Value_, Index_, ChunkValue_, WorkspacePtr_> my_core;
+    SparseCore<solo_, oracle_, oracular_mode_, record_counters_, Value_, Index_, ChunkValue_, WorkspacePtr_> my_core;
 };
 
-template<bool solo_, bool oracle_, bool use_subset_, typename Value_, typename Index_, typename ChunkValue_, class WorkspacePtr_>
-class SparseIndex : public tatami::SparseExtractor<oracle_, Value_, Index_> {
+template<bool solo_, bool oracle_, OracularMode oracular_mode_, bool record_counters_, typename Value_, typename Index_, typename ChunkValue_, class WorkspacePtr_>
+class SparseIndex : public tatami::SparseExtractor<oracle_, Value_, Index_>, public MaybeSlabCacheCountersReporter<record_counters_> {
 public:
     SparseIndex(
-        WorkspacePtr_ chunk_workspace,
+        std::vector<WorkspacePtr_> chunk_workspaces,
         const ChunkCoordinator<true, ChunkValue_, Index_>& coordinator, 
         const SlabCacheStats<Index_>& slab_stats,
         bool row,
@@ -593,7 +961,7 @@ public:
         my_needs_value(opt.sparse_extract_value),
         my_needs_index(opt.sparse_extract_index),
         my_core(
-            std::move(chunk_workspace),
+            std::move(chunk_workspaces),
             coordinator, 
             slab_stats,
             row,
@@ -609,23 +977,27 @@ public:
         return process_sparse_slab(fetched, value_buffer, index_buffer, my_needs_value, my_needs_index);
     }
 
+    SlabCacheCounters get_slab_cache_counters() const {
+        return my_core.get_counters();
+    }
+
 private:
     bool my_row;
     tatami::VectorPtr<Index_> my_indices_ptr;
     std::vector<Index_> my_tmp_indices;
     bool my_needs_value, my_needs_index;
-    SparseCore<solo_, oracle_, use_subset_, Value_, Index_, ChunkValue_, WorkspacePtr_> my_core;
+    SparseCore<solo_, oracle_, oracular_mode_, record_counters_, Value_, Index_, ChunkValue_, WorkspacePtr_> my_core;
 };
 
 /**************************
  **** Densified classes ***
  **************************/
 
-template<bool solo_, bool oracle_, bool use_subset_, typename Value_, typename Index_, typename ChunkValue_, class WorkspacePtr_>
-class DensifiedFull : public tatami::DenseExtractor<oracle_, Value_, Index_> {
+template<bool solo_, bool oracle_, OracularMode oracular_mode_, bool record_counters_, typename Value_, typename Index_, typename ChunkValue_, class WorkspacePtr_>
+class DensifiedFull : public tatami::DenseExtractor<oracle_, Value_, Index_>, public MaybeSlabCacheCountersReporter<record_counters_> {
 public:
     DensifiedFull(
-        WorkspacePtr_ chunk_workspace,
+        std::vector<WorkspacePtr_> chunk_workspaces,
         const ChunkCoordinator<true, ChunkValue_, Index_>& coordinator, 
         const SlabCacheStats<Index_>& slab_stats,
         bool row,
@@ -635,7 +1007,7 @@ public:
         my_row(row),
         my_non_target_dim(coordinator.get_non_target_dim(row)),
         my_core(
-            std::move(chunk_workspace),
+            std::move(chunk_workspaces),
             coordinator,
             slab_stats,
             row,
@@ -649,9 +1021,9 @@ public:
     const Value_* fetch(Index_ i, Value_* buffer) {
         auto contents = my_core.fetch_raw(i, my_row, 0, my_non_target_dim);
 
-        Index_ num = contents.first->number[contents.second];
-        auto vptr = contents.first->values[contents.second];
-        auto iptr = contents.first->indices[contents.second];
+        Index_ num = get_slab_number(*(contents.first), contents.second);
+        auto vptr = get_slab_values(*(contents.first), contents.second);
+        auto iptr = get_slab_indices(*(contents.first), contents.second);
 
         std::fill_n(buffer, my_non_target_dim, 0);
         for (Index_ x = 0; x < num; ++x, ++iptr, ++vptr) {
@@ -660,17 +1032,21 @@ public:
         return buffer;
     }
 
+    SlabCacheCounters get_slab_cache_counters() const {
+        return my_core.get_counters();
+    }
+
 private:
     bool my_row;
     Index_ my_non_target_dim;
-    SparseCore<solo_, oracle_, use_subset_, Value_, Index_, ChunkValue_, WorkspacePtr_> my_core;
+    SparseCore<solo_, oracle_, oracular_mode_, record_counters_, Value_, Index_, ChunkValue_, WorkspacePtr_> my_core;
 };
 
-template<bool solo_, bool oracle_, bool use_subset_, typename Value_, typename Index_, typename ChunkValue_, class WorkspacePtr_>
-class DensifiedBlock : public tatami::DenseExtractor<oracle_, Value_, Index_> {
+template<bool solo_, bool oracle_, OracularMode oracular_mode_, bool record_counters_, typename Value_, typename Index_, typename ChunkValue_, class WorkspacePtr_>
+class DensifiedBlock : public tatami::DenseExtractor<oracle_, Value_, Index_>, public MaybeSlabCacheCountersReporter<record_counters_> {
 public:
     DensifiedBlock(
-        WorkspacePtr_ chunk_workspace,
+        std::vector<WorkspacePtr_> chunk_workspaces,
         const ChunkCoordinator<true, ChunkValue_, Index_>& coordinator, 
         const SlabCacheStats<Index_>& slab_stats,
         bool row,
@@ -683,7 +1059,7 @@ public:
         my_block_start(block_start),
         my_block_length(block_length),
         my_core(
-            std::move(chunk_workspace),
+            std::move(chunk_workspaces),
             coordinator,
             slab_stats,
             row,
@@ -697,9 +1073,9 @@ public:
     const Value_* fetch(Index_ i, Value_* buffer) {
         auto contents = my_core.fetch_raw(i, my_row, my_block_start, my_block_length);
 
-        auto vptr = contents.first->values[contents.second];
-        auto iptr = contents.first->indices[contents.second];
-        auto num = contents.first->number[contents.second];
+        auto vptr = get_slab_values(*(contents.first), contents.second);
+        auto iptr = get_slab_indices(*(contents.first), contents.second);
+        auto num = get_slab_number(*(contents.first), contents.second);
 
         std::fill_n(buffer, my_block_length, 0);
         for (Index_ x = 0; x < num; ++x, ++iptr, ++vptr) {
@@ -708,17 +1084,21 @@ public:
         return buffer;
     }
 
+    SlabCacheCounters get_slab_cache_counters() const {
+        return my_core.get_counters();
+    }
+
 private:
     bool my_row;
     Index_ my_block_start, my_block_length;
-    SparseCore<solo_, oracle_, use_subset_, Value_, Index_, ChunkValue_, WorkspacePtr_> my_core;
+    SparseCore<solo_, oracle_, oracular_mode_, record_counters_, Value_, Index_, ChunkValue_, WorkspacePtr_> my_core;
 };
 
-template<bool solo_, bool oracle_, bool use_subset_, typename Value_, typename Index_, typename ChunkValue_, class WorkspacePtr_>
-class DensifiedIndex : public tatami::DenseExtractor<oracle_, Value_, Index_> {
+template<bool solo_, bool oracle_, OracularMode oracular_mode_, bool record_counters_, typename Value_, typename Index_, typename ChunkValue_, class WorkspacePtr_>
+class DensifiedIndex : public tatami::DenseExtractor<oracle_, Value_, Index_>, public MaybeSlabCacheCountersReporter<record_counters_> {
 public:
     DensifiedIndex(
-        WorkspacePtr_ chunk_workspace,
+        std::vector<WorkspacePtr_> chunk_workspaces,
         const ChunkCoordinator<true, ChunkValue_, Index_>& coordinator, 
         const SlabCacheStats<Index_>& slab_stats,
         bool row,
@@ -729,7 +1109,7 @@ public:
         my_row(row),
         my_indices_ptr(std::move(indices_ptr)),
         my_core(
-            std::move(chunk_workspace),
+            std::move(chunk_workspaces),
             coordinator, 
             slab_stats,
             row,
@@ -755,9 +1135,9 @@ public:
     const Value_* fetch(Index_ i, Value_* buffer) {
         auto contents = my_core.fetch_raw(i, my_row, *my_indices_ptr, my_tmp_indices);
 
-        auto vptr = contents.first->values[contents.second];
-        auto iptr = contents.first->indices[contents.second];
-        auto num = contents.first->number[contents.second];
+        auto vptr = get_slab_values(*(contents.first), contents.second);
+        auto iptr = get_slab_indices(*(contents.first), contents.second);
+        auto num = get_slab_number(*(contents.first), contents.second);
 
         auto nidx = my_indices_ptr->size();
         std::fill_n(buffer, nidx, 0);
@@ -767,13 +1147,17 @@ public:
         return buffer;
     }
 
+    SlabCacheCounters get_slab_cache_counters() const {
+        return my_core.get_counters();
+    }
+
 private:
     bool my_row;
     tatami::VectorPtr<Index_> my_indices_ptr;
     Index_ my_remap_offset = 0;
     std::vector<Index_> my_remap;
     std::vector<Index_> my_tmp_indices;
-    SparseCore<solo_, oracle_, use_subset_, Value_, Index_, ChunkValue_, WorkspacePtr_> my_core;
+    SparseCore<solo_, oracle_, oracular_mode_, record_counters_, Value_, Index_, ChunkValue_, WorkspacePtr_> my_core;
 };
 
 }
@@ -805,10 +1189,17 @@ public:
      */
     CustomSparseChunkedMatrix(std::shared_ptr<Manager_> manager, const CustomSparseChunkedMatrixOptions& opt) : 
         my_manager(std::move(manager)),
-        my_coordinator(my_manager->row_stats(), my_manager->column_stats()),
+        my_coordinator(my_manager->row_stats(), my_manager->column_stats(), CustomChunkedMatrix_internal::collect_chunk_nonzeros(*my_manager), opt.belady_max_lookahead),
         my_cache_size_in_bytes(opt.maximum_cache_size),
         my_require_minimum_cache(opt.require_minimum_cache),
-        my_cache_subset(opt.cache_subset)
+        my_cache_subset(opt.cache_subset),
+        my_async_populate(opt.async_populate),
+        my_num_populate_threads(opt.num_populate_threads),
+        my_belady_eviction(opt.belady_eviction),
+        my_variable_slab_size(opt.variable_slab_size),
+        my_compact_slabs(opt.compact_slabs),
+        my_record_cache_counters(opt.record_cache_counters),
+        my_shrink_cache_with_oracle(opt.shrink_cache_with_oracle)
     {}
 
 private:
@@ -817,6 +1208,13 @@ private:
     std::size_t my_cache_size_in_bytes;
     bool my_require_minimum_cache;
     bool my_cache_subset;
+    bool my_async_populate;
+    int my_num_populate_threads;
+    bool my_belady_eviction;
+    bool my_variable_slab_size;
+    bool my_compact_slabs;
+    bool my_record_cache_counters;
+    bool my_shrink_cache_with_oracle;
 
 public:
     Index_ nrow() const { 
@@ -858,10 +1256,10 @@ private:
     template<
         template<bool, typename, typename> class Interface_, 
         bool oracle_, 
-        template<bool, bool, bool, typename, typename, typename, class> class Extractor_,
+        template<bool, bool, CustomChunkedMatrix_internal::OracularMode, bool, typename, typename, typename, class> class Extractor_,
         typename ... Args_
     >
-    std::unique_ptr<Interface_<oracle_, Value_, Index_> > raw_internal(bool row, Index_ non_target_length, const tatami::Options& opt, Args_&& ... args) const {
+    std::unique_ptr<Interface_<oracle_, Value_, Index_> > raw_internal(bool row, Index_ non_target_length, const tatami::Options& opt, tatami::MaybeOracle<oracle_, Index_> oracle, Args_&& ... args) const {
         std::size_t element_size = (opt.sparse_extract_value ? sizeof(ChunkValue_) : 0) + (opt.sparse_extract_index ? sizeof(Index_) : 0);
         auto stats = [&]{
             if (row) {
@@ -887,17 +1285,72 @@ private:
             }
         }();
 
-        auto wrk = my_manager->new_workspace_exact();
+        // Compact slabs are only used if no other oracular mode takes precedence, see create_internal().
+        bool compact_slabs = my_compact_slabs;
+        if constexpr(oracle_) {
+            compact_slabs = compact_slabs && !my_cache_subset && !my_async_populate && !my_belady_eviction && !my_variable_slab_size;
+        }
+        if (compact_slabs) {
+            // Myopic extraction only needs one padded buffer, while oracular extraction needs up to one buffer per populating thread.
+            Index_ num_buffers = (oracle_ ? sanisizer::cast<Index_>(std::max(my_num_populate_threads, 1)) : 1);
+            compact_slabs = CustomChunkedMatrix_internal::fit_compact_slab_cache(my_coordinator, row, non_target_length, my_cache_size_in_bytes, element_size, num_buffers, stats);
+        }
+
+        if constexpr(oracle_) {
+            if (my_shrink_cache_with_oracle) {
+                my_coordinator.shrink_slab_cache(row, *oracle, sanisizer::cast<Index_>(std::max(my_num_populate_threads, 2)), stats);
+            }
+        }
+
+        typedef I<decltype(my_manager->new_workspace_exact())> WorkspacePtr;
+        std::vector<WorkspacePtr> wrks;
+        wrks.push_back(my_manager->new_workspace_exact());
+        if constexpr(oracle_) {
+            if (stats.max_slabs_in_cache > 1) {
+                auto num_threads = std::min(sanisizer::cast<I<decltype(stats.max_slabs_in_cache)> >(std::max(my_num_populate_threads, 1)), stats.max_slabs_in_cache);
+                for (I<decltype(num_threads)> t = 1; t < num_threads; ++t) {
+                    wrks.push_back(my_manager->new_workspace_exact());
+                }
+            }
+        }
+
+        if (my_record_cache_counters) {
+            return create_internal<Interface_, oracle_, true, Extractor_>(std::move(wrks), stats, compact_slabs, row, std::move(oracle), std::forward<Args_>(args)...);
+        } else {
+            return create_internal<Interface_, oracle_, false, Extractor_>(std::move(wrks), stats, compact_slabs, row, std::move(oracle), std::forward<Args_>(args)...);
+        }
+    }
+
+    template<
+        template<bool, typename, typename> class Interface_, 
+        bool oracle_, 
+        bool record_counters_,
+        template<bool, bool, CustomChunkedMatrix_internal::OracularMode, bool, typename, typename, typename, class> class Extractor_,
+        class WorkspacePtr_,
+        typename ... Args_
+    >
+    std::unique_ptr<Interface_<oracle_, Value_, Index_> > create_internal(std::vector<WorkspacePtr_> wrks, const SlabCacheStats<Index_>& stats, bool compact_slabs, bool row, Args_&& ... args) const {
+        typedef CustomChunkedMatrix_internal::OracularMode OracularMode;
         if (stats.max_slabs_in_cache == 0) {
-            return std::make_unique<Extractor_<true, oracle_, false, Value_, Index_, ChunkValue_, I<decltype(wrk)> > >(std::move(wrk), my_coordinator, stats, row, std::forward<Args_>(args)...);
+            return std::make_unique<Extractor_<true, oracle_, OracularMode::REGULAR, record_counters_, Value_, Index_, ChunkValue_, WorkspacePtr_> >(std::move(wrks), my_coordinator, stats, row, std::forward<Args_>(args)...);
         } else if constexpr(oracle_) {
             if (my_cache_subset) {
-                return std::make_unique<Extractor_<false, true, true, Value_, Index_, ChunkValue_, I<decltype(wrk)> > >(std::move(wrk), my_coordinator, stats, row, std::forward<Args_>(args)...);
+                return std::make_unique<Extractor_<false, true, OracularMode::SUBSETTED, record_counters_, Value_, Index_, ChunkValue_, WorkspacePtr_> >(std::move(wrks), my_coordinator, stats, row, std::forward<Args_>(args)...);
+            } else if (my_async_populate) {
+                return std::make_unique<Extractor_<false, true, OracularMode::ASYNC, record_counters_, Value_, Index_, ChunkValue_, WorkspacePtr_> >(std::move(wrks), my_coordinator, stats, row, std::forward<Args_>(args)...);
+            } else if (my_belady_eviction) {
+                return std::make_unique<Extractor_<false, true, OracularMode::BELADY, record_counters_, Value_, Index_, ChunkValue_, WorkspacePtr_> >(std::move(wrks), my_coordinator, stats, row, std::forward<Args_>(args)...);
+            } else if (my_variable_slab_size) {
+                return std::make_unique<Extractor_<false, true, OracularMode::VARIABLE, record_counters_, Value_, Index_, ChunkValue_, WorkspacePtr_> >(std::move(wrks), my_coordinator, stats, row, std::forward<Args_>(args)...);
+            } else if (compact_slabs) {
+                return std::make_unique<Extractor_<false, true, OracularMode::COMPACT, record_counters_, Value_, Index_, ChunkValue_, WorkspacePtr_> >(std::move(wrks), my_coordinator, stats, row, std::forward<Args_>(args)...);
             } else {
-                return std::make_unique<Extractor_<false, true, false, Value_, Index_, ChunkValue_, I<decltype(wrk)> > >(std::move(wrk), my_coordinator, stats, row, std::forward<Args_>(args)...);
+                return std::make_unique<Extractor_<false, true, OracularMode::REGULAR, record_counters_, Value_, Index_, ChunkValue_, WorkspacePtr_> >(std::move(wrks), my_coordinator, stats, row, std::forward<Args_>(args)...);
             }
+        } else if (compact_slabs) {
+            return std::make_unique<Extractor_<false, false, OracularMode::COMPACT, record_counters_, Value_, Index_, ChunkValue_, WorkspacePtr_> >(std::move(wrks), my_coordinator, stats, row, std::forward<Args_>(args)...);
         } else {
-            return std::make_unique<Extractor_<false, false, false, Value_, Index_, ChunkValue_, I<decltype(wrk)> > >(std::move(wrk), my_coordinator, stats, row, std::forward<Args_>(args)...);
+            return std::make_unique<Extractor_<false, false, OracularMode::REGULAR, record_counters_, Value_, Index_, ChunkValue_, WorkspacePtr_> >(std::move(wrks), my_coordinator, stats, row, std::forward<Args_>(args)...);
         }
     }
 
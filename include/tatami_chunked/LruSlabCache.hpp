@@ -2,9 +2,11 @@
 #define TATAMI_CHUNKED_LRU_SLAB_CACHE_HPP
 
 #include "utils.hpp"
+#include "SlabCacheCounters.hpp"
 
-#include <unordered_map>
-#include <list>
+#include <vector>
+#include <functional>
+#include <cstdint>
 #include <cstddef>
 
 #include "sanisizer/sanisizer.hpp"
@@ -19,6 +21,11 @@ namespace tatami_chunked {
 /**
  * @tparam Id_ Type of cache identifier, typically integer.
  * @tparam Slab_ Class for a single slab.
+ * @tparam direct_ids_ Whether to look up slabs by indexing a dense array with their identifiers, instead of using a hash table.
+ * This avoids hashing but requires all identifiers to be non-negative integers less than the `num_ids` used in the constructor.
+ * The memory usage of the dense array is proportional to `num_ids`.
+ * @tparam record_counters_ Whether to record the cache's activity in a `SlabCacheCounters`, see `get_counters()`.
+ * If `false`, no counters are stored or updated.
  *
  * @brief Least-recently-used cache for slabs.
  *
@@ -26,44 +33,81 @@ namespace tatami_chunked {
  * Each slab is defined as the set of chunks required to read an element of the target dimension (or a contiguous block/indexed subset thereof) from a `tatami::Matrix`.
  * The LRU cache can be used for chunked `tatami::Matrix` representations where the data is costly to load (e.g., from file) and no oracle is provided to predict future accesses on the target dimension.
  * In such cases, chunks of data can be loaded and cached such that any possible future request for an already-loaded slab will just fetch it from cache.
+ *
+ * The slabs, the links for the recency ordering and the hash table for the slab identifiers are all stored in contiguous arrays that are allocated upon construction.
+ * No further allocations are performed by the cache itself, other than those in the user-supplied `create()` function.
  */
-template<typename Id_, class Slab_> 
+template<typename Id_, class Slab_, bool direct_ids_ = false, bool record_counters_ = false> 
 class LruSlabCache {
 private:
-    typedef std::pair<Slab_, Id_> Element;
-    typedef std::list<Element> SlabPool;
+    typedef std::vector<Slab_> SlabPool;
+    typedef typename SlabPool::size_type Size;
+
+    Size my_max_slabs;
+    SlabPool my_slabs;
+    std::vector<Id_> my_ids;
+
+    // Doubly-linked list of slab positions, from least to most recently used.
+    // 'my_max_slabs' is used as the null position.
+    std::vector<Size> my_prev, my_next;
+    Size my_head, my_tail;
 
-    typename SlabPool::size_type my_max_slabs;
-    SlabPool my_cache_data;
-    std::unordered_map<Id_, typename std::list<Element>::iterator> my_cache_exists;
+    // Open-addressing hash table with linear probing, mapping each slab identifier to its position in 'my_slabs'.
+    // Empty buckets are marked with 'my_max_slabs'. If 'direct_ids_ = true', each identifier is its own bucket.
+    std::vector<Size> my_table;
+    Size my_table_mask = 0;
 
     Id_ my_last_id = 0;
     Slab_* my_last_slab = NULL;
 
+    MaybeSlabCacheCounters<record_counters_> my_counters;
+
 public:
     /**
      * @tparam Index_ Integer type of the maximum number of slabs, see the template parameter of the same name in `SlabCacheStats`.
      * @param max_slabs Maximum number of slabs to store in the cache.
+     * @param num_ids Upper bound on the slab identifiers.
+     * This is only used if `direct_ids_ = true`, in which case all identifiers passed to `find()` should be less than `num_ids`.
      */
     template<typename Index_>
-    LruSlabCache(Index_ max_slabs) : my_max_slabs(sanisizer::cast<I<decltype(my_max_slabs)> >(max_slabs)) {}
+    LruSlabCache(Index_ max_slabs, Id_ num_ids = 0) : 
+        my_max_slabs(sanisizer::cast<Size>(max_slabs)),
+        my_head(my_max_slabs),
+        my_tail(my_max_slabs)
+    {
+        my_slabs.reserve(my_max_slabs);
+        my_ids.reserve(my_max_slabs);
+        my_prev.reserve(my_max_slabs);
+        my_next.reserve(my_max_slabs);
+
+        if constexpr(direct_ids_) {
+            my_table.resize(sanisizer::cast<Size>(num_ids), my_max_slabs);
+            return;
+        }
+
+        // Keeping the load factor at or below 0.5 to ensure that probe sequences are short.
+        Size table_size = 1;
+        while (table_size / 2 < my_max_slabs) {
+            table_size = sanisizer::product<Size>(table_size, 2);
+        }
+        my_table.resize(table_size, my_max_slabs);
+        my_table_mask = table_size - 1;
+    }
 
     /**
-     * Deleted as the cache holds persistent iterators.
+     * Deleted as the cache holds persistent pointers.
      */
     LruSlabCache(const LruSlabCache&) = delete;
 
     /**
-     * Deleted as the cache holds persistent iterators.
+     * Deleted as the cache holds persistent pointers.
      */
     LruSlabCache& operator=(const LruSlabCache&) = delete;
 
     /**
      * @cond
      */
-    // Iterators are guaranteed to be valid after move, see Notes in
-    // https://en.cppreference.com/w/cpp/container/list/list
-    // https://en.cppreference.com/w/cpp/container/list/operator%3D
+    // Pointers are guaranteed to be valid after move, as the vector's buffer is transferred.
     LruSlabCache& operator=(LruSlabCache&&) = default; 
     LruSlabCache(LruSlabCache&&) = default;
 
@@ -73,6 +117,76 @@ public:
      * @endcond
      */
 
+private:
+    Size bucket(Id_ id) const {
+        if constexpr(direct_ids_) {
+            return id;
+        }
+
+        // Fibonacci hashing to spread out consecutive integer identifiers.
+        std::uint64_t h = std::hash<Id_>{}(id);
+        h *= 11400714819323198485ull;
+        return static_cast<Size>(h ^ (h >> 32)) & my_table_mask;
+    }
+
+    // Returns the bucket that contains 'id', or an empty bucket where 'id' could be inserted.
+    Size probe(Id_ id) const {
+        if constexpr(direct_ids_) {
+            return id;
+        }
+
+        auto b = bucket(id);
+        while (my_table[b] != my_max_slabs && my_ids[my_table[b]] != id) {
+            b = (b + 1) & my_table_mask;
+        }
+        return b;
+    }
+
+    // Backward-shift deletion, so that there is no need for tombstones.
+    void erase(Size b) {
+        if constexpr(direct_ids_) {
+            my_table[b] = my_max_slabs;
+            return;
+        }
+
+        auto next = (b + 1) & my_table_mask;
+        while (my_table[next] != my_max_slabs) {
+            auto desired = bucket(my_ids[my_table[next]]);
+            // Moving the entry at 'next' into the hole at 'b' if 'b' lies cyclically within [desired, next).
+            if (((next - desired) & my_table_mask) >= ((next - b) & my_table_mask)) {
+                my_table[b] = my_table[next];
+                b = next;
+            }
+            next = (next + 1) & my_table_mask;
+        }
+        my_table[b] = my_max_slabs;
+    }
+
+    void unlink(Size pos) {
+        auto prev = my_prev[pos], next = my_next[pos];
+        if (prev == my_max_slabs) {
+            my_head = next;
+        } else {
+            my_next[prev] = next;
+        }
+        if (next == my_max_slabs) {
+            my_tail = prev;
+        } else {
+            my_prev[next] = prev;
+        }
+    }
+
+    void append(Size pos) {
+        my_prev[pos] = my_tail;
+        my_next[pos] = my_max_slabs;
+        if (my_tail == my_max_slabs) {
+            my_head = pos;
+        } else {
+            my_next[my_tail] = pos;
+        }
+        my_tail = pos;
+    }
+
 public:
     /**
      * This method should only be called if `m > 0` in the constructor.
@@ -95,32 +209,55 @@ public:
     template<class Cfunction_, class Pfunction_>
     const Slab_& find(Id_ id, Cfunction_ create, Pfunction_ populate) {
         if (id == my_last_id && my_last_slab) {
+            if constexpr(record_counters_) {
+                ++my_counters.hits;
+            }
             return *my_last_slab;
         }
         my_last_id = id;
 
-        auto it = my_cache_exists.find(id);
-        if (it != my_cache_exists.end()) {
-            auto chosen = it->second;
-            my_cache_data.splice(my_cache_data.end(), my_cache_data, chosen); // move to end.
-            my_last_slab = &(chosen->first);
-            return chosen->first;
+        auto b = probe(id);
+        auto found = my_table[b];
+        if (found != my_max_slabs) {
+            if constexpr(record_counters_) {
+                ++my_counters.hits;
+            }
+            if (found != my_tail) {
+                unlink(found);
+                append(found); // move to end.
+            }
+            auto& slab = my_slabs[found];
+            my_last_slab = &slab;
+            return slab;
         } 
 
-        typename std::list<Element>::iterator location;
-        if (my_cache_data.size() < my_max_slabs) {
-            my_cache_data.emplace_back(create(), id);
-            location = std::prev(my_cache_data.end());
+        Size location;
+        if (my_slabs.size() < my_max_slabs) {
+            // We reserved everything so further push_backs() should not
+            // trigger any reallocation or invalidation of the pointers.
+            location = my_slabs.size();
+            my_slabs.push_back(create());
+            my_ids.push_back(id);
+            my_prev.push_back(my_max_slabs);
+            my_next.push_back(my_max_slabs);
         } else {
-            location = my_cache_data.begin();
-            my_cache_exists.erase(location->second);
-            location->second = id;
-            my_cache_data.splice(my_cache_data.end(), my_cache_data, location); // move to end.
+            location = my_head;
+            erase(probe(my_ids[location]));
+            unlink(location);
+            my_ids[location] = id;
+            b = probe(id); // need to re-probe as the erasure may have shifted entries.
+            if constexpr(record_counters_) {
+                ++my_counters.evictions;
+            }
         }
-        my_cache_exists[id] = location;
+        append(location);
+        my_table[b] = location;
 
-        auto& slab = location->first;
-        populate(id, slab);
+        auto& slab = my_slabs[location];
+        if constexpr(record_counters_) {
+            ++my_counters.misses;
+        }
+        record_populate<record_counters_>(my_counters, 1, [&]() -> void { populate(id, slab); });
         my_last_slab = &slab;
         return slab;
     }
@@ -139,7 +276,16 @@ public:
      * The type is an unsigned integer of the same type as that returned by `get_max_slabs()`. 
      */
     auto get_num_slabs() const {
-        return my_cache_data.size();
+        return my_slabs.size();
+    }
+
+    /**
+     * This method should only be called if `record_counters_ = true`.
+     * @return Counters for the activity of this cache.
+     */
+    const SlabCacheCounters& get_counters() const {
+        static_assert(record_counters_, "counters are only available if 'record_counters_ = true'");
+        return my_counters;
     }
 };
 
@@ -0,0 +1,489 @@
+#ifndef TATAMI_CHUNKED_MMAP_DENSE_CHUNKED_MATRIX_MANAGER_HPP
+#define TATAMI_CHUNKED_MMAP_DENSE_CHUNKED_MATRIX_MANAGER_HPP
+
+#include "CustomDenseChunkedMatrix.hpp"
+#include "ChunkDimensionStats.hpp"
+#include "rechunk.hpp"
+
+#include <string>
+#include <vector>
+#include <memory>
+#include <fstream>
+#include <stdexcept>
+#include <algorithm>
+#include <cstdint>
+#include <cstddef>
+#include <cstring>
+
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+
+#include "tatami/tatami.hpp"
+#include "sanisizer/sanisizer.hpp"
+
+/**
+ * @file MmapDenseChunkedMatrixManager.hpp
+ * @brief Memory-mapped dense chunk store.
+ *
+ * This file requires POSIX memory mapping and is not included by the umbrella header.
+ */
+
+namespace tatami_chunked {
+
+/**
+ * @cond
+ */
+namespace MmapDenseChunkedMatrix_internal {
+
+constexpr std::size_t header_size = 64;
+constexpr char magic[8] = { 'T', 'A', 'T', 'A', 'M', 'I', 'C', 'D' };
+constexpr std::uint32_t version = 1;
+
+// Positions of each field in the header.
+constexpr std::size_t version_offset = 8;
+constexpr std::size_t value_size_offset = 12;
+constexpr std::size_t nrow_offset = 16;
+constexpr std::size_t ncol_offset = 24;
+constexpr std::size_t chunk_nrow_offset = 32;
+constexpr std::size_t chunk_ncol_offset = 40;
+constexpr std::size_t row_major_chunks_offset = 48;
+constexpr std::size_t row_major_contents_offset = 49;
+
+template<typename Type_>
+Type_ read_field(const unsigned char* header, std::size_t offset) {
+    Type_ output;
+    std::memcpy(&output, header + offset, sizeof(Type_));
+    return output;
+}
+
+template<typename Type_>
+void write_field(unsigned char* header, std::size_t offset, Type_ value) {
+    std::memcpy(header + offset, &value, sizeof(Type_));
+}
+
+// Locates each chunk in the memory-mapped file.
+template<typename ChunkValue_, typename Index_>
+struct ChunkLocator {
+    const ChunkValue_* start = NULL;
+    bool row_major_chunks = true;
+    std::size_t chunk_size = 0;
+    Index_ num_chunks_per_row = 0, num_chunks_per_column = 0;
+
+    const ChunkValue_* get(Index_ chunk_row_id, Index_ chunk_column_id) const {
+        std::size_t index;
+        if (row_major_chunks) {
+            index = static_cast<std::size_t>(chunk_row_id) * static_cast<std::size_t>(num_chunks_per_row) + static_cast<std::size_t>(chunk_column_id);
+        } else {
+            index = static_cast<std::size_t>(chunk_column_id) * static_cast<std::size_t>(num_chunks_per_column) + static_cast<std::size_t>(chunk_row_id);
+        }
+        return start + index * chunk_size; // no overflow, as the file size was already checked.
+    }
+};
+
+}
+/**
+ * @endcond
+ */
+
+/**
+ * @brief Options for writing a memory-mappable dense chunk file.
+ */
+struct MmapDenseChunkedFileOptions {
+    /**
+     * Whether the chunks are stored in row-major order in the file, i.e., all chunks in the first row of the chunk grid, then all chunks in the second row, and so on.
+     * If `false`, chunks are stored in column-major order.
+     * Row-major order is more efficient for row extraction as the chunks for each slab are contiguous in the file, and vice versa.
+     */
+    bool row_major_chunks = true;
+
+    /**
+     * Whether the contents of each chunk are stored in row-major order.
+     * If `false`, the contents are stored in column-major order.
+     * `MmapDenseChunkedMatrixManager::supports_chunk_data()` only returns `true` for the target dimension that matches this layout.
+     */
+    bool row_major_contents = true;
+};
+
+/**
+ * Write a `tatami::Matrix` to a file that can be used by the `MmapDenseChunkedMatrixManager`.
+ *
+ * The file starts with a 64-byte header containing:
+ *
+ * - 8 bytes for the magic string `TATAMICD`.
+ * - a 32-bit unsigned integer specifying the format version, currently 1.
+ * - a 32-bit unsigned integer containing `sizeof(ChunkValue_)`.
+ * - 64-bit unsigned integers for the number of rows, number of columns, number of rows in each chunk, and number of columns in each chunk.
+ * - an 8-bit unsigned integer specifying whether the chunks are stored in row-major order, see `MmapDenseChunkedFileOptions::row_major_chunks`.
+ * - an 8-bit unsigned integer specifying whether the chunk contents are stored in row-major order, see `MmapDenseChunkedFileOptions::row_major_contents`.
+ * - zero padding to 64 bytes.
+ *
+ * This is followed by the contents of each chunk.
+ * All chunks have the same size in the file, i.e., chunks at the edges of the matrix are padded with zeros.
+ * All integers and values are stored with the native endianness of the machine.
+ *
+ * The matrix is streamed into the file with `rechunk_dense()`, so only a single strip of chunks is held in memory at any time.
+ *
+ * @tparam ChunkValue_ Numeric type of the data values in each chunk.
+ * @tparam Value_ Numeric type of the matrix values.
+ * @tparam Index_ Integer type of the row/column indices.
+ *
+ * @param path Path to the output file.
+ * @param matrix Matrix to be written.
+ * @param chunk_nrow Number of rows in each chunk.
+ * This should be positive if `matrix` has a non-zero number of rows.
+ * @param chunk_ncol Number of columns in each chunk.
+ * This should be positive if `matrix` has a non-zero number of columns.
+ * @param options Further options.
+ */
+template<typename ChunkValue_, typename Value_, typename Index_>
+void write_mmap_dense_chunked_file(
+    const std::string& path,
+    const tatami::Matrix<Value_, Index_>& matrix,
+    Index_ chunk_nrow,
+    Index_ chunk_ncol,
+    const MmapDenseChunkedFileOptions& options)
+{
+    namespace mi = MmapDenseChunkedMatrix_internal;
+    Index_ NR = matrix.nrow(), NC = matrix.ncol();
+    rechunk_internal::check_chunk_dimensions(NR, NC, chunk_nrow, chunk_ncol);
+
+    std::ofstream output(path, std::ios::binary | std::ios::trunc);
+    if (!output) {
+        throw std::runtime_error("failed to open '" + path + "' for writing");
+    }
+
+    unsigned char header[mi::header_size] = {};
+    std::copy_n(mi::magic, sizeof(mi::magic), header);
+    mi::write_field<std::uint32_t>(header, mi::version_offset, mi::version);
+    mi::write_field<std::uint32_t>(header, mi::value_size_offset, sizeof(ChunkValue_));
+    mi::write_field<std::uint64_t>(header, mi::nrow_offset, sanisizer::cast<std::uint64_t>(NR));
+    mi::write_field<std::uint64_t>(header, mi::ncol_offset, sanisizer::cast<std::uint64_t>(NC));
+    mi::write_field<std::uint64_t>(header, mi::chunk_nrow_offset, sanisizer::cast<std::uint64_t>(chunk_nrow));
+    mi::write_field<std::uint64_t>(header, mi::chunk_ncol_offset, sanisizer::cast<std::uint64_t>(chunk_ncol));
+    header[mi::row_major_chunks_offset] = options.row_major_chunks;
+    header[mi::row_major_contents_offset] = options.row_major_contents;
+    output.write(reinterpret_cast<const char*>(header), mi::header_size);
+
+    auto chunk_bytes = sanisizer::product<std::streamsize>(sanisizer::product<std::size_t>(chunk_nrow, chunk_ncol), sizeof(ChunkValue_));
+    RechunkDenseOptions ropt;
+    ropt.row_major_chunks = options.row_major_chunks;
+    ropt.row_major_contents = options.row_major_contents;
+    rechunk_dense<ChunkValue_>(
+        matrix,
+        chunk_nrow,
+        chunk_ncol,
+        [&](Index_, Index_, const ChunkValue_* chunk) -> void {
+            output.write(reinterpret_cast<const char*>(chunk), chunk_bytes);
+        },
+        ropt
+    );
+
+    output.close();
+    if (!output) {
+        throw std::runtime_error("failed to write to '" + path + "'");
+    }
+}
+
+/**
+ * @brief Options for the `MmapDenseChunkedMatrixManager`.
+ */
+struct MmapDenseChunkedMatrixManagerOptions {
+    /**
+     * Whether the chunks will be accessed in a random order.
+     * If `true`, readahead is disabled with `MADV_RANDOM`, which avoids reading unnecessary pages for scattered access to the chunks.
+     * Otherwise, `MADV_NORMAL` is used.
+     */
+    bool random_access = false;
+
+    /**
+     * Whether to ask the kernel to start reading the entire file into memory with `MADV_WILLNEED`.
+     * This is useful when most of the file will be accessed and there is enough memory to hold it.
+     */
+    bool will_need = false;
+};
+
+/**
+ * @brief Workspace for extracting data from a `MmapDenseChunkedMatrixManager`.
+ * @tparam ChunkValue_ Numeric type of the data values in each chunk.
+ * @tparam Index_ Integer type of the row/column indices.
+ */
+template<typename ChunkValue_, typename Index_>
+class MmapDenseChunkedMatrixWorkspace final : public CustomDenseChunkedMatrixWorkspace<ChunkValue_, Index_> {
+public:
+    /**
+     * @cond
+     */
+    MmapDenseChunkedMatrixWorkspace(MmapDenseChunkedMatrix_internal::ChunkLocator<ChunkValue_, Index_> locator, bool row_major_contents, Index_ chunk_nrow, Index_ chunk_ncol) :
+        my_locator(locator),
+        my_row_major_contents(row_major_contents),
+        my_chunk_nrow(chunk_nrow),
+        my_chunk_ncol(chunk_ncol)
+    {}
+    /**
+     * @endcond
+     */
+
+private:
+    MmapDenseChunkedMatrix_internal::ChunkLocator<ChunkValue_, Index_> my_locator;
+    bool my_row_major_contents;
+    Index_ my_chunk_nrow, my_chunk_ncol;
+
+private:
+    // 'target' and 'non_target' are functions that return the chunk index of the p-th target or q-th non-target element.
+    template<class Target_, class NonTarget_>
+    void copy(Index_ chunk_row_id, Index_ chunk_column_id, bool row, Index_ num_target, Target_ target, Index_ num_non_target, NonTarget_ non_target, bool non_target_block, ChunkValue_* output, Index_ stride) const {
+        auto chunk = my_locator.get(chunk_row_id, chunk_column_id);
+        std::size_t inner_stride = (my_row_major_contents ? my_chunk_ncol : my_chunk_nrow);
+
+        if (row == my_row_major_contents) {
+            // Values for each target element are contiguous in the chunk.
+            for (Index_ p = 0; p < num_target; ++p) {
+                std::size_t t = target(p);
+                auto out = output + t * static_cast<std::size_t>(stride);
+                auto src = chunk + t * inner_stride;
+                if (non_target_block) {
+                    std::copy_n(src + non_target(0), num_non_target, out);
+                } else {
+                    for (Index_ q = 0; q < num_non_target; ++q) {
+                        out[q] = src[non_target(q)];
+                    }
+                }
+            }
+        } else {
+            for (Index_ p = 0; p < num_target; ++p) {
+                std::size_t t = target(p);
+                auto out = output + t * static_cast<std::size_t>(stride);
+                auto src = chunk + t;
+                for (Index_ q = 0; q < num_non_target; ++q) {
+                    out[q] = src[static_cast<std::size_t>(non_target(q)) * inner_stride];
+                }
+            }
+        }
+    }
+
+public:
+    /**
+     * @cond
+     */
+    void extract(Index_ chunk_row_id, Index_ chunk_column_id, bool row, Index_ target_start, Index_ target_length, Index_ non_target_start, Index_ non_target_length, ChunkValue_* output, Index_ stride) {
+        copy(
+            chunk_row_id, chunk_column_id, row,
+            target_length, [&](Index_ p) -> Index_ { return target_start + p; },
+            non_target_length, [&](Index_ q) -> Index_ { return non_target_start + q; }, true,
+            output, stride
+        );
+    }
+
+    void extract(Index_ chunk_row_id, Index_ chunk_column_id, bool row, Index_ target_start, Index_ target_length, const std::vector<Index_>& non_target_indices, ChunkValue_* output, Index_ stride) {
+        copy(
+            chunk_row_id, chunk_column_id, row,
+            target_length, [&](Index_ p) -> Index_ { return target_start + p; },
+            non_target_indices.size(), [&](Index_ q) -> Index_ { return non_target_indices[q]; }, false,
+            output, stride
+        );
+    }
+
+    void extract(Index_ chunk_row_id, Index_ chunk_column_id, bool row, const std::vector<Index_>& target_indices, Index_ non_target_start, Index_ non_target_length, ChunkValue_* output, Index_ stride) {
+        copy(
+            chunk_row_id, chunk_column_id, row,
+            target_indices.size(), [&](Index_ p) -> Index_ { return target_indices[p]; },
+            non_target_length, [&](Index_ q) -> Index_ { return non_target_start + q; }, true,
+            output, stride
+        );
+    }
+
+    void extract(Index_ chunk_row_id, Index_ chunk_column_id, bool row, const std::vector<Index_>& target_indices, const std::vector<Index_>& non_target_indices, ChunkValue_* output, Index_ stride) {
+        copy(
+            chunk_row_id, chunk_column_id, row,
+            target_indices.size(), [&](Index_ p) -> Index_ { return target_indices[p]; },
+            non_target_indices.size(), [&](Index_ q) -> Index_ { return non_target_indices[q]; }, false,
+            output, stride
+        );
+    }
+
+    // A zero stride means that the values for the single target element are stored at the start of 'output'.
+    bool supports_extract_single() const {
+        return true;
+    }
+
+    void extract_single(Index_ chunk_row_id, Index_ chunk_column_id, bool row, Index_ target, Index_ non_target_start, Index_ non_target_length, ChunkValue_* output) {
+        copy(
+            chunk_row_id, chunk_column_id, row,
+            1, [&](Index_) -> Index_ { return target; },
+            non_target_length, [&](Index_ q) -> Index_ { return non_target_start + q; }, true,
+            output, 0
+        );
+    }
+
+    void extract_single(Index_ chunk_row_id, Index_ chunk_column_id, bool row, Index_ target, const std::vector<Index_>& non_target_indices, ChunkValue_* output) {
+        copy(
+            chunk_row_id, chunk_column_id, row,
+            1, [&](Index_) -> Index_ { return target; },
+            non_target_indices.size(), [&](Index_ q) -> Index_ { return non_target_indices[q]; }, false,
+            output, 0
+        );
+    }
+    /**
+     * @endcond
+     */
+};
+
+/**
+ * @brief Manager of dense chunks in a memory-mapped file.
+ *
+ * @tparam ChunkValue_ Numeric type of the data values in each chunk.
+ * @tparam Index_ Integer type of the row/column indices.
+ *
+ * This class implements a `CustomDenseChunkedMatrixManager` for a file created by `write_mmap_dense_chunked_file()`.
+ * The file is mapped into memory with `mmap()`, so the chunks are read from disk by the kernel on demand and can be shared across processes.
+ * As the chunks are uncompressed, this manager supports direct access to each chunk via `chunk_data()`,
+ * which allows the `CustomDenseChunkedMatrix` to skip the slab cache when each row/column lies within a single chunk.
+ * Otherwise, users may wish to reduce `CustomDenseChunkedMatrixOptions::maximum_cache_size` as the kernel's page cache already retains recently accessed chunks.
+ */
+template<typename ChunkValue_, typename Index_>
+class MmapDenseChunkedMatrixManager final : public CustomDenseChunkedMatrixManager<ChunkValue_, Index_> {
+public:
+    /**
+     * @param path Path to a file created by `write_mmap_dense_chunked_file()` with the same `ChunkValue_`.
+     * @param options Further options.
+     */
+    MmapDenseChunkedMatrixManager(const std::string& path, const MmapDenseChunkedMatrixManagerOptions& options) {
+        namespace mi = MmapDenseChunkedMatrix_internal;
+
+        int fd = open(path.c_str(), O_RDONLY);
+        if (fd < 0) {
+            throw std::runtime_error("failed to open '" + path + "'");
+        }
+
+        struct stat info;
+        if (fstat(fd, &info) != 0) {
+            close(fd);
+            throw std::runtime_error("failed to obtain the size of '" + path + "'");
+        }
+        my_size = info.st_size;
+        if (my_size < mi::header_size) {
+            close(fd);
+            throw std::runtime_error("'" + path + "' is too small to contain the header");
+        }
+
+        void* mapped = mmap(NULL, my_size, PROT_READ, MAP_SHARED, fd, 0);
+        close(fd); // mapping remains valid after the file descriptor is closed.
+        if (mapped == MAP_FAILED) {
+            throw std::runtime_error("failed to memory-map '" + path + "'");
+        }
+        my_start = static_cast<const unsigned char*>(mapped);
+
+        try {
+            parse_header(path);
+        } catch (...) {
+            munmap(mapped, my_size);
+            throw;
+        }
+
+        // Advice is just a hint, so we don't bother checking for errors.
+        madvise(mapped, my_size, options.random_access ? MADV_RANDOM : MADV_NORMAL);
+        if (options.will_need) {
+            madvise(mapped, my_size, MADV_WILLNEED);
+        }
+    }
+
+    /**
+     * @cond
+     */
+    MmapDenseChunkedMatrixManager(const MmapDenseChunkedMatrixManager&) = delete;
+    MmapDenseChunkedMatrixManager& operator=(const MmapDenseChunkedMatrixManager&) = delete;
+
+    ~MmapDenseChunkedMatrixManager() {
+        munmap(const_cast<unsigned char*>(my_start), my_size);
+    }
+    /**
+     * @endcond
+     */
+
+private:
+    const unsigned char* my_start = NULL;
+    std::size_t my_size = 0;
+    ChunkDimensionStats<Index_> my_row_stats, my_col_stats;
+    bool my_row_major_chunks = true;
+    bool my_row_major_contents = true;
+    MmapDenseChunkedMatrix_internal::ChunkLocator<ChunkValue_, Index_> my_locator;
+
+    void parse_header(const std::string& path) {
+        namespace mi = MmapDenseChunkedMatrix_internal;
+        if (!std::equal(mi::magic, mi::magic + sizeof(mi::magic), my_start)) {
+            throw std::runtime_error("'" + path + "' does not start with the expected magic string");
+        }
+        if (mi::read_field<std::uint32_t>(my_start, mi::version_offset) != mi::version) {
+            throw std::runtime_error("'" + path + "' has an unsupported format version");
+        }
+        if (mi::read_field<std::uint32_t>(my_start, mi::value_size_offset) != sizeof(ChunkValue_)) {
+            throw std::runtime_error("size of the values in '" + path + "' is not consistent with 'ChunkValue_'");
+        }
+
+        auto NR = sanisizer::cast<Index_>(mi::read_field<std::uint64_t>(my_start, mi::nrow_offset));
+        auto NC = sanisizer::cast<Index_>(mi::read_field<std::uint64_t>(my_start, mi::ncol_offset));
+        auto CR = sanisizer::cast<Index_>(mi::read_field<std::uint64_t>(my_start, mi::chunk_nrow_offset));
+        auto CC = sanisizer::cast<Index_>(mi::read_field<std::uint64_t>(my_start, mi::chunk_ncol_offset));
+        my_row_stats = ChunkDimensionStats<Index_>(NR, CR);
+        my_col_stats = ChunkDimensionStats<Index_>(NC, CC);
+        my_row_major_chunks = my_start[mi::row_major_chunks_offset];
+        my_row_major_contents = my_start[mi::row_major_contents_offset];
+
+        auto num_chunks = sanisizer::product<std::size_t>(my_row_stats.num_chunks, my_col_stats.num_chunks);
+        auto chunk_bytes = sanisizer::product<std::size_t>(sanisizer::product<std::size_t>(CR, CC), sizeof(ChunkValue_));
+        auto expected = sanisizer::sum<std::size_t>(mi::header_size, sanisizer::product<std::size_t>(num_chunks, chunk_bytes));
+        if (my_size < expected) {
+            throw std::runtime_error("'" + path + "' is too small to contain all chunks");
+        }
+
+        my_locator.start = reinterpret_cast<const ChunkValue_*>(my_start + mi::header_size);
+        my_locator.row_major_chunks = my_row_major_chunks;
+        my_locator.chunk_size = chunk_bytes / sizeof(ChunkValue_);
+        my_locator.num_chunks_per_row = my_col_stats.num_chunks;
+        my_locator.num_chunks_per_column = my_row_stats.num_chunks;
+    }
+
+public:
+    /**
+     * @return A `MmapDenseChunkedMatrixWorkspace` instance to copy data from each chunk.
+     */
+    std::unique_ptr<MmapDenseChunkedMatrixWorkspace<ChunkValue_, Index_> > new_workspace_exact() const {
+        return std::make_unique<MmapDenseChunkedMatrixWorkspace<ChunkValue_, Index_> >(my_locator, my_row_major_contents, my_row_stats.chunk_length, my_col_stats.chunk_length);
+    }
+
+    /**
+     * @cond
+     */
+    std::unique_ptr<CustomDenseChunkedMatrixWorkspace<ChunkValue_, Index_> > new_workspace() const {
+        return new_workspace_exact();
+    }
+
+    bool prefer_rows() const {
+        return my_row_major_chunks;
+    }
+
+    const ChunkDimensionStats<Index_>& row_stats() const {
+        return my_row_stats;
+    }
+
+    const ChunkDimensionStats<Index_>& column_stats() const {
+        return my_col_stats;
+    }
+
+    bool supports_chunk_data(bool row) const {
+        return row == my_row_major_contents;
+    }
+
+    const ChunkValue_* chunk_data(Index_ chunk_row_id, Index_ chunk_column_id, bool) const {
+        return my_locator.get(chunk_row_id, chunk_column_id);
+    }
+    /**
+     * @endcond
+     */
+};
+
+}
+
+#endif
@@ -0,0 +1,357 @@
+#ifndef TATAMI_CHUNKED_ORACULAR_ASYNC_SLAB_CACHE_HPP
+#define TATAMI_CHUNKED_ORACULAR_ASYNC_SLAB_CACHE_HPP
+
+#include "utils.hpp"
+#include "id_map.hpp"
+#include "SlabCacheCounters.hpp"
+
+#include <unordered_map>
+#include <vector>
+#include <future>
+#include <memory>
+#include <stdexcept>
+#include <cstddef>
+
+#include "tatami/tatami.hpp"
+#include "sanisizer/sanisizer.hpp"
+
+/**
+ * @file OracularAsyncSlabCache.hpp
+ * @brief Create an oracle-aware cache that populates slabs in the background.
+ */
+
+namespace tatami_chunked {
+
+/**
+ * @brief Oracle-aware cache that prefetches slabs in a background thread.
+ *
+ * @tparam Id_ Type of slab identifier, typically integer.
+ * @tparam Index_ Integer type of the dimension extent and the type of row/column index produced by the oracle.
+ * This should also be the type of the maximum number of slabs required to span the relevant dimension, see the template parameter of the same name in `SlabCacheStats`.
+ * @tparam Slab_ Class for a single slab.
+ * @tparam direct_ids_ Whether to look up slabs by indexing a dense array with their identifiers, instead of using a hash map.
+ * This avoids hashing but requires all identifiers to be non-negative integers less than the `num_ids` used in the constructor.
+ * The memory usage of the dense array is proportional to `num_ids`.
+ * @tparam record_counters_ Whether to record the cache's activity in a `SlabCacheCounters`, see `get_counters()`.
+ * If `false`, no counters are stored or updated.
+ *
+ * This is a variant of `OracularSlabCache` where the slabs for the next populate cycle are loaded in a background thread while the caller is still consuming the slabs of the current cycle.
+ * When the caller reaches the end of the current cycle, the slabs for the next cycle are (hopefully) already available, such that the cost of loading data is hidden behind the caller's own computation.
+ *
+ * To achieve this, the cache is split into two halves, one for the slabs of the current cycle and another for the slabs that are being loaded for the next cycle.
+ * Each populate cycle can only involve up to half of the maximum number of slabs, so fewer slabs can be re-used between cycles compared to `OracularSlabCache`.
+ * Slabs that are required in both the current and next cycles are not copied but are shared between the two halves.
+ * If the maximum number of slabs is 1, no prefetching is possible and all slabs are populated synchronously.
+ *
+ * The `populate` function in `next()` is invoked in a separate thread and should only access objects that will not be used concurrently by the caller.
+ * In particular, the caller should not read from or write to a slab that is not part of the current cycle, i.e., has not yet been returned by `next()`.
+ */
+template<typename Id_, typename Index_, class Slab_, bool direct_ids_ = false, bool record_counters_ = false>
+class OracularAsyncSlabCache {
+private:
+    std::shared_ptr<const tatami::Oracle<Index_> > my_oracle;
+    tatami::PredictionIndex my_total;
+    tatami::PredictionIndex my_counter = 0;
+
+    Id_ my_last_slab_id = 0;
+    Slab_* my_last_slab = NULL;
+
+    typedef std::vector<Slab_> SlabPool;
+    typename SlabPool::size_type my_max_slabs, my_cycle_slabs;
+    SlabPool my_all_slabs;
+    std::vector<Slab_*> my_free_slabs;
+
+    IdMap<direct_ids_, Id_, Slab_*> my_current_cache, my_future_cache;
+    std::vector<std::pair<Id_, Slab_*> > my_to_populate;
+    tatami::PredictionIndex my_refresh_point = 0, my_future_refresh_point = 0;
+    bool my_started = false;
+
+    // Set if a populate cycle failed, after which the slab lists are in an inconsistent state.
+    bool my_failed = false;
+
+    // Counters from the background thread are stored separately and only merged after the thread is finished.
+    MaybeSlabCacheCounters<record_counters_> my_counters, my_pending_counters;
+
+    // This should be the last member so that it is destroyed first,
+    // i.e., we wait for the background thread before freeing the slabs.
+    std::future<void> my_pending;
+
+public:
+    /**
+     * @param oracle Pointer to an `tatami::Oracle` to be used for predictions.
+     * @param max_slabs Maximum number of slabs to store in the cache.
+     * @param num_ids Upper bound on the slab identifiers.
+     * This is only used if `direct_ids_ = true`, in which case all identifiers returned by `identify()` should be less than `num_ids`.
+     */
+    OracularAsyncSlabCache(std::shared_ptr<const tatami::Oracle<Index_> > oracle, Index_ max_slabs, Id_ num_ids = 0) :
+        my_oracle(std::move(oracle)),
+        my_total(my_oracle->total()),
+        my_max_slabs(sanisizer::cast<I<decltype(my_max_slabs)> >(max_slabs)),
+        my_cycle_slabs(my_max_slabs > 1 ? my_max_slabs / 2 : my_max_slabs),
+        my_current_cache(create_id_map<direct_ids_, Slab_*>(num_ids)),
+        my_future_cache(create_id_map<direct_ids_, Slab_*>(num_ids))
+    {
+        my_all_slabs.reserve(max_slabs);
+        my_free_slabs.reserve(max_slabs);
+        my_current_cache.reserve(my_cycle_slabs);
+        my_future_cache.reserve(my_cycle_slabs);
+    }
+
+    /**
+     * Deleted as the cache holds persistent pointers.
+     */
+    OracularAsyncSlabCache(const OracularAsyncSlabCache&) = delete;
+
+    /**
+     * Deleted as the cache holds persistent pointers.
+     */
+    OracularAsyncSlabCache& operator=(const OracularAsyncSlabCache&) = delete;
+
+    /**
+     * Deleted as the background thread holds pointers to the cache's members.
+     */
+    OracularAsyncSlabCache(OracularAsyncSlabCache&&) = delete;
+
+    /**
+     * Deleted as the background thread holds pointers to the cache's members.
+     */
+    OracularAsyncSlabCache& operator=(OracularAsyncSlabCache&&) = delete;
+
+    /**
+     * @cond
+     */
+    ~OracularAsyncSlabCache() {
+        if (my_pending.valid()) {
+            my_pending.wait();
+        }
+    }
+    /**
+     * @endcond
+     */
+
+public:
+    /**
+     * This method is intended to be called when `num_slabs = 0`, to provide callers with the oracle predictions for non-cached extraction of data.
+     * Calls to this method should not be intermingled with calls to its overload below; the latter should only be called when `num_slabs > 0`.
+     *
+     * @return The next prediction from the oracle.
+     */
+    Index_ next() {
+        return my_oracle->get(my_counter++);
+    }
+
+private:
+    template<class Ifunction_, class Cfunction_>
+    tatami::PredictionIndex plan(tatami::PredictionIndex start, Ifunction_& identify, Cfunction_& create) {
+        // Any slab that is not in the current cache is either free or not yet
+        // created, so we can populate it without interfering with the caller.
+        I<decltype(my_max_slabs)> used_slabs = 0;
+        bool has_last = false;
+        Id_ last_future_slab_id = 0;
+
+        auto position = start;
+        for (; position < my_total; ++position) {
+            auto future_slab_info = identify(my_oracle->get(position));
+            if (has_last && last_future_slab_id == future_slab_info.first) {
+                continue;
+            }
+
+            has_last = true;
+            last_future_slab_id = future_slab_info.first;
+            if (my_future_cache.find(future_slab_info.first) != my_future_cache.end()) {
+                continue;
+            }
+
+            if (used_slabs == my_cycle_slabs) {
+                break;
+            }
+
+            auto ccIt = my_current_cache.find(future_slab_info.first);
+            if (ccIt != my_current_cache.end()) {
+                my_future_cache[future_slab_info.first] = ccIt->second;
+                if constexpr(record_counters_) {
+                    ++my_counters.slabs_reused;
+                }
+
+            } else {
+                Slab_* slab_ptr;
+                if (!my_free_slabs.empty()) {
+                    slab_ptr = my_free_slabs.back();
+                    my_free_slabs.pop_back();
+                } else if (my_all_slabs.size() < my_max_slabs) {
+                    // We reserved my_all_slabs so further push_backs() should not
+                    // trigger any reallocation or invalidation of the pointers.
+                    my_all_slabs.push_back(create());
+                    slab_ptr = &(my_all_slabs.back());
+                } else {
+                    // This only occurs when max_slabs = 1 and the sole slab is still in use.
+                    break;
+                }
+                my_to_populate.emplace_back(future_slab_info.first, slab_ptr);
+                my_future_cache[future_slab_info.first] = slab_ptr;
+            }
+
+            ++used_slabs;
+        }
+
+        return position;
+    }
+
+    void rotate() {
+        for (const auto& cur : my_current_cache) {
+            if (my_future_cache.find(cur.first) == my_future_cache.end()) {
+                my_free_slabs.push_back(cur.second);
+                if constexpr(record_counters_) {
+                    ++my_counters.evictions;
+                }
+            }
+        }
+        my_current_cache.clear();
+        my_current_cache.swap(my_future_cache);
+        my_to_populate.clear();
+        my_refresh_point = my_future_refresh_point;
+    }
+
+public:
+    /**
+     * Fetch the next slab according to the stream of predictions provided by the `tatami::Oracle`.
+     * This method should only be called if `num_slabs > 0` in the constructor; otherwise, no slabs are actually available and cannot be returned.
+     *
+     * @tparam Ifunction_ Function to identify the slab containing each predicted row/column.
+     * @tparam Cfunction_ Function to create a new slab.
+     * @tparam Pfunction_ Function to populate zero, one or more slabs with their contents.
+     *
+     * @param identify Function that accepts `i`, an `Index_` containing the predicted index of a single element on the target dimension.
+     * This should return a pair containing:
+     * 1. An `Id_`, the identifier of the slab containing `i`.
+     *    This is typically defined as the index of the slab on the target dimension.
+     *    For example, if each chunk takes up 10 rows, attempting to access row 21 would require retrieval of slab 2.
+     * 2. An `Index_`, the index of row/column `i` inside that slab.
+     *    For example, if each chunk takes up 10 rows, attempting to access row 21 would yield an offset of 1.
+     * @param create Function that accepts no arguments and returns a `Slab_` object with sufficient memory to hold a slab's contents when used in `populate()`.
+     * This may also return a default-constructed `Slab_` object if the allocation is done dynamically per slab in `populate()`.
+     * This is always called in the same thread as `next()`.
+     * @param populate Function that accepts a single `std::vector<std::pair<Id_, Slab_*> >&` specifying the slabs to be populated.
+     * The first `Id_` element of each pair contains the slab identifier, i.e., the first element returned by the `identify` function.
+     * The second `Slab_*` element contains a pointer to a `Slab_` returned by `create()`.
+     * This function should iterate over the vector and populate each slab.
+     * The vector is guaranteed to be non-empty but is not guaranteed to be sorted.
+     * The return value is ignored.
+     * A copy of this function may be invoked in a background thread after `next()` returns,
+     * so it should not capture references to any variables that do not outlive the call to `next()`.
+     * Any exceptions thrown by this function are propagated to the caller of `next()` at the start of the next populate cycle.
+     * After such an exception, the cache is no longer usable and all subsequent calls to `next()` will throw an error.
+     *
+     * @return Pair containing (1) a pointer to a slab's contents and (2) the index of the next predicted row/column inside the retrieved slab.
+     */
+    template<class Ifunction_, class Cfunction_, class Pfunction_>
+    std::pair<const Slab_*, Index_> next(Ifunction_ identify, Cfunction_ create, Pfunction_ populate) {
+        if (my_failed) {
+            throw std::runtime_error("cache cannot be used after a failed populate cycle");
+        }
+
+        Index_ index = this->next();
+        auto slab_info = identify(index);
+        if (slab_info.first == my_last_slab_id && my_last_slab) {
+            if constexpr(record_counters_) {
+                ++my_counters.hits;
+            }
+            return std::make_pair(my_last_slab, slab_info.second);
+        }
+        my_last_slab_id = slab_info.first;
+
+        // Updating the cache if we hit the refresh point.
+        if (my_counter - 1 == my_refresh_point) {
+            // If anything fails, we poison the cache as the slab lists might be half-updated,
+            // otherwise later calls could silently return stale slabs.
+            try {
+                if (my_pending.valid()) {
+                    my_pending.get(); // rethrows any exception from the background thread.
+                    if constexpr(record_counters_) {
+                        my_counters += my_pending_counters;
+                        my_pending_counters = SlabCacheCounters();
+                    }
+                    rotate();
+                }
+
+                if (!my_started || my_current_cache.find(slab_info.first) == my_current_cache.end()) {
+                    // Synchronously populating the first cycle, or any cycle that could not be prefetched.
+                    // This requires us to release all slabs in the current cycle as they are no longer needed.
+                    if constexpr(record_counters_) {
+                        ++my_counters.misses;
+                        my_counters.evictions += my_current_cache.size();
+                    }
+                    for (const auto& cur : my_current_cache) {
+                        my_free_slabs.push_back(cur.second);
+                    }
+                    my_current_cache.clear();
+                    my_future_refresh_point = plan(my_refresh_point, identify, create);
+                    if (!my_to_populate.empty()) {
+                        record_populate<record_counters_>(my_counters, my_to_populate.size(), [&]() -> void { populate(my_to_populate); });
+                    }
+                    rotate();
+                    my_started = true;
+                } else if constexpr(record_counters_) {
+                    ++my_counters.hits; // prefetched in the previous cycle.
+                }
+
+                // Launching the background thread to prefetch the next cycle.
+                if (my_refresh_point < my_total) {
+                    my_future_refresh_point = plan(my_refresh_point, identify, create);
+                    if (my_to_populate.empty()) {
+                        // All slabs are shared with the current cycle, so there's nothing to do.
+                        // Still, we create a ready-made future so that we rotate at the next refresh point.
+                        std::promise<void> dummy;
+                        my_pending = dummy.get_future();
+                        dummy.set_value();
+                    } else {
+                        my_pending = std::async(std::launch::async, [this,populate]() mutable -> void {
+                            record_populate<record_counters_>(my_pending_counters, my_to_populate.size(), [&]() -> void { populate(my_to_populate); });
+                        });
+                    }
+                }
+            } catch (...) {
+                my_failed = true;
+                throw;
+            }
+        } else if constexpr(record_counters_) {
+            ++my_counters.hits;
+        }
+
+        // We know it must exist, so no need to check ccIt's validity.
+        auto ccIt = my_current_cache.find(slab_info.first);
+        my_last_slab = ccIt->second;
+        return std::make_pair(my_last_slab, slab_info.second);
+    }
+
+public:
+    /**
+     * @return Maximum number of slabs in the cache.
+     * The type is an unsigned integer defined in `std::vector::size_type`.
+     */
+    auto get_max_slabs() const {
+        return my_max_slabs;
+    }
+
+    /**
+     * @return Number of slabs currently in use for the current populate cycle.
+     * The type is an unsigned integer defined in `std::vector::size_type`.
+     */
+    auto get_num_slabs() const {
+        return my_current_cache.size();
+    }
+
+    /**
+     * This method should only be called if `record_counters_ = true`.
+     * Counters for a populate cycle in the background thread are only included once the caller reaches the start of that cycle.
+     * @return Counters for the activity of this cache.
+     */
+    const SlabCacheCounters& get_counters() const {
+        static_assert(record_counters_, "counters are only available if 'record_counters_ = true'");
+        return my_counters;
+    }
+};
+
+}
+
+#endif
@@ -0,0 +1,373 @@
+#ifndef TATAMI_CHUNKED_ORACULAR_BELADY_SLAB_CACHE_HPP
+#define TATAMI_CHUNKED_ORACULAR_BELADY_SLAB_CACHE_HPP
+
+#include "utils.hpp"
+#include "id_map.hpp"
+#include "SlabCacheCounters.hpp"
+
+#include <vector>
+#include <limits>
+#include <memory>
+#include <cstddef>
+
+#include "tatami/tatami.hpp"
+#include "sanisizer/sanisizer.hpp"
+
+/**
+ * @file OracularBeladySlabCache.hpp
+ * @brief Create an oracle-aware cache for slabs with optimal eviction.
+ */
+
+namespace tatami_chunked {
+
+/**
+ * @brief Oracle-aware cache for slabs with Belady's optimal eviction.
+ *
+ * @tparam Id_ Type of slab identifier, typically integer.
+ * @tparam Index_ Integer type of the dimension extent and the type of row/column index produced by the oracle.
+ * This should also be the type of the maximum number of slabs required to span the relevant dimension, see the template parameter of the same name in `SlabCacheStats`.
+ * @tparam Slab_ Class for a single slab.
+ * @tparam direct_ids_ Whether to look up slabs by indexing a dense array with their identifiers, instead of using a hash map.
+ * This avoids hashing but requires all identifiers to be non-negative integers less than the `num_ids` used in the constructor.
+ * The memory usage of the dense array is proportional to `num_ids`.
+ * @tparam record_counters_ Whether to record the cache's activity in a `SlabCacheCounters`, see `get_counters()`.
+ * If `false`, no counters are stored or updated.
+ *
+ * This is an alternative to `OracularSlabCache` with the same interface.
+ * `OracularSlabCache` fills its cache with the next `max_slabs` distinct slabs at each refresh point and discards all other slabs,
+ * so a slab that is needed just after the end of the window will be discarded and loaded again.
+ * Instead, this class uses Belady's MIN policy where, upon a request for a slab that is not in the cache, we evict the slab whose next use is farthest in the future.
+ * This minimizes the number of slabs that are loaded, which is most beneficial for oracles that revisit slabs in a non-monotonic order, e.g., random subsets of rows.
+ *
+ * While the cache is not yet full, we populate the requested slab together with the next few slabs that are not in the cache, up to the number of free slots.
+ * (This does not change the set of loaded slabs compared to populating each slab as it is requested, as no eviction is performed.)
+ * Once the cache is full, each call to `populate()` involves a single slab, so the cost of each call should not be dominated by a fixed overhead.
+ *
+ * To determine the next use of each slab, this class scans ahead in the oracle's predictions and stores the upcoming runs of predictions for the same slab.
+ * When evicting, the scan continues until the next use of all but one cached slab is known, or until the end of the predictions.
+ * Callers can limit the memory usage of the scan with `max_lookahead`, at the cost of only approximating the MIN policy.
+ * The choice of slab to evict also requires a pass over all cached slabs, so this class is best suited to caches holding no more than a few thousand slabs.
+ *
+ * It is assumed that each slab has the same size such that `Slab_` instances can be effectively reused between slabs without requiring any reallocation of memory.
+ */
+template<typename Id_, typename Index_, class Slab_, bool direct_ids_ = false, bool record_counters_ = false>
+class OracularBeladySlabCache {
+private:
+    std::shared_ptr<const tatami::Oracle<Index_> > my_oracle;
+    tatami::PredictionIndex my_total;
+    tatami::PredictionIndex my_counter = 0;
+
+    Id_ my_last_slab_id = 0;
+    Slab_* my_last_slab = NULL;
+
+    typedef std::vector<Slab_> SlabPool;
+    typename SlabPool::size_type my_max_slabs;
+    SlabPool my_all_slabs;
+
+    // Lookahead for the upcoming runs of predictions for the same slab.
+    // Each run is referenced by its position in the full sequence of runs, where 'my_run_offset' is the position of the first stored run.
+    static constexpr tatami::PredictionIndex no_run = std::numeric_limits<tatami::PredictionIndex>::max();
+    std::vector<Id_> my_run_ids;
+    std::vector<tatami::PredictionIndex> my_run_next;
+    tatami::PredictionIndex my_run_offset = 0;
+    tatami::PredictionIndex my_current_run = no_run;
+    tatami::PredictionIndex my_scan_point = 0;
+    IdMap<direct_ids_, Id_, tatami::PredictionIndex> my_last_run;
+    tatami::PredictionIndex my_max_lookahead;
+
+    struct CacheEntry {
+        Slab_* slab = NULL;
+        tatami::PredictionIndex next_use = no_run;
+    };
+    IdMap<direct_ids_, Id_, CacheEntry> my_cache;
+    std::vector<std::pair<Id_, Slab_*> > my_to_populate;
+
+    MaybeSlabCacheCounters<record_counters_> my_counters;
+
+public:
+    /**
+     * @param oracle Pointer to an `tatami::Oracle` to be used for predictions.
+     * @param max_slabs Maximum number of slabs to store in the cache.
+     * @param num_ids Upper bound on the slab identifiers.
+     * This is only used if `direct_ids_ = true`, in which case all identifiers returned by `identify()` should be less than `num_ids`.
+     * @param max_lookahead Maximum number of runs of predictions to store when determining the next use of each slab.
+     * Each run is a consecutive sequence of predictions for the same slab.
+     * If zero, the lookahead is unlimited so that the MIN policy is exact.
+     */
+    OracularBeladySlabCache(std::shared_ptr<const tatami::Oracle<Index_> > oracle, Index_ max_slabs, Id_ num_ids = 0, tatami::PredictionIndex max_lookahead = 0) :
+        my_oracle(std::move(oracle)),
+        my_total(my_oracle->total()),
+        my_max_slabs(sanisizer::cast<I<decltype(my_max_slabs)> >(max_slabs)),
+        my_last_run(create_id_map<direct_ids_, tatami::PredictionIndex>(num_ids)),
+        my_max_lookahead(max_lookahead),
+        my_cache(create_id_map<direct_ids_, CacheEntry>(num_ids))
+    {
+        my_all_slabs.reserve(max_slabs);
+        my_cache.reserve(max_slabs);
+    }
+
+    /**
+     * Deleted as the cache holds persistent pointers.
+     */
+    OracularBeladySlabCache(const OracularBeladySlabCache&) = delete;
+
+    /**
+     * Deleted as the cache holds persistent pointers.
+     */
+    OracularBeladySlabCache& operator=(const OracularBeladySlabCache&) = delete;
+
+    /**
+     * @cond
+     */
+    // Move operators are still okay as pointers still point to the moved vectors.
+    OracularBeladySlabCache& operator=(OracularBeladySlabCache&&) = default;
+    OracularBeladySlabCache(OracularBeladySlabCache&&) = default;
+
+    ~OracularBeladySlabCache() = default;
+    /**
+     * @endcond
+     */
+
+public:
+    /**
+     * This method is intended to be called when `num_slabs = 0`, to provide callers with the oracle predictions for non-cached extraction of data.
+     * Calls to this method should not be intermingled with calls to its overload below; the latter should only be called when `num_slabs > 0`.
+     *
+     * @return The next prediction from the oracle.
+     */
+    Index_ next() {
+        return my_oracle->get(my_counter++);
+    }
+
+private:
+    tatami::PredictionIndex num_known_runs() const {
+        return my_run_offset + my_run_ids.size();
+    }
+
+    // Scanning the next run of predictions for the same slab, returning false if there are no more predictions.
+    template<class Ifunction_>
+    bool scan_run(Ifunction_& identify) {
+        if (my_scan_point == my_total) {
+            return false;
+        }
+
+        auto id = identify(my_oracle->get(my_scan_point)).first;
+        while (++my_scan_point < my_total) {
+            if (identify(my_oracle->get(my_scan_point)).first != id) {
+                break;
+            }
+        }
+
+        auto run = num_known_runs();
+        auto lrIt = my_last_run.find(id);
+        if (lrIt != my_last_run.end()) {
+            if (lrIt->second >= my_run_offset) {
+                my_run_next[lrIt->second - my_run_offset] = run;
+            }
+            lrIt->second = run;
+        } else {
+            my_last_run[id] = run;
+        }
+        my_run_ids.push_back(id);
+        my_run_next.push_back(no_run);
+
+        // Filling in the next use of a cached slab if it was previously unknown.
+        auto cIt = my_cache.find(id);
+        if (cIt != my_cache.end() && cIt->second.next_use == no_run) {
+            cIt->second.next_use = run;
+        }
+        return true;
+    }
+
+    bool lookahead_full() const {
+        return my_max_lookahead && my_run_ids.size() >= my_max_lookahead;
+    }
+
+    // Discarding runs that precede the current run, as they will never be used again.
+    // We only do so when they occupy more than half of the storage, to avoid quadratic time complexity.
+    void trim_runs() {
+        auto used = my_current_run - my_run_offset;
+        if (used > my_run_ids.size() / 2) {
+            my_run_ids.erase(my_run_ids.begin(), my_run_ids.begin() + used);
+            my_run_next.erase(my_run_next.begin(), my_run_next.begin() + used);
+            my_run_offset = my_current_run;
+        }
+    }
+
+    template<class Ifunction_>
+    Slab_* choose_victim(Ifunction_& identify) {
+        tatami::PredictionIndex num_unknown = 0;
+        for (const auto& entry : my_cache) {
+            num_unknown += (entry.second.next_use == no_run);
+        }
+        while (num_unknown > 1 && !lookahead_full()) {
+            auto previous = num_known_runs();
+            if (!scan_run(identify)) {
+                break;
+            }
+            auto cIt = my_cache.find(my_run_ids.back());
+            if (cIt != my_cache.end() && cIt->second.next_use == previous) {
+                --num_unknown;
+            }
+        }
+
+        auto victim = my_cache.begin();
+        for (auto cIt = my_cache.begin(), end = my_cache.end(); cIt != end; ++cIt) {
+            if (cIt->second.next_use > victim->second.next_use) {
+                victim = cIt;
+            }
+        }
+
+        auto slab_ptr = victim->second.slab;
+        my_cache.erase(victim);
+        if constexpr(record_counters_) {
+            ++my_counters.evictions;
+        }
+        return slab_ptr;
+    }
+
+public:
+    /**
+     * Fetch the next slab according to the stream of predictions provided by the `tatami::Oracle`.
+     * This method should only be called if `num_slabs > 0` in the constructor; otherwise, no slabs are actually available and cannot be returned.
+     *
+     * @tparam Ifunction_ Function to identify the slab containing each predicted row/column.
+     * @tparam Cfunction_ Function to create a new slab.
+     * @tparam Pfunction_ Function to populate zero, one or more slabs with their contents.
+     *
+     * @param identify Function that accepts `i`, an `Index_` containing the predicted index of a single element on the target dimension.
+     * This should return a pair containing:
+     * 1. An `Id_`, the identifier of the slab containing `i`.
+     *    This is typically defined as the index of the slab on the target dimension.
+     *    For example, if each chunk takes up 10 rows, attempting to access row 21 would require retrieval of slab 2.
+     * 2. An `Index_`, the index of row/column `i` inside that slab.
+     *    For example, if each chunk takes up 10 rows, attempting to access row 21 would yield an offset of 1.
+     * @param create Function that accepts no arguments and returns a `Slab_` object with sufficient memory to hold a slab's contents when used in `populate()`.
+     * This may also return a default-constructed `Slab_` object if the allocation is done dynamically per slab in `populate()`.
+     * @param populate Function that accepts a `std::vector<std::pair<Id_, Slab_*> >&` specifying the slabs to be populated.
+     * The first `Id_` element of each pair contains the slab identifier, i.e., the first element returned by the `identify` function.
+     * The second `Slab_*` element contains a pointer to a `Slab_` returned by `create()`.
+     * This function should iterate over the vector and populate each slab.
+     * The vector is guaranteed to be non-empty but is not guaranteed to be sorted.
+     * The return value is ignored.
+     *
+     * @return Pair containing (1) a pointer to a slab's contents and (2) the index of the next predicted row/column inside the retrieved slab.
+     */
+    template<class Ifunction_, class Cfunction_, class Pfunction_>
+    std::pair<const Slab_*, Index_> next(Ifunction_ identify, Cfunction_ create, Pfunction_ populate) {
+        Index_ index = this->next();
+        auto slab_info = identify(index);
+        if (slab_info.first == my_last_slab_id && my_last_slab) {
+            if constexpr(record_counters_) {
+                ++my_counters.hits;
+            }
+            return std::make_pair(my_last_slab, slab_info.second);
+        }
+        my_last_slab_id = slab_info.first;
+
+        // Moving to the next run, which must have the same slab as the current request.
+        my_current_run = (my_current_run == no_run ? 0 : my_current_run + 1);
+        if (my_current_run == num_known_runs()) {
+            scan_run(identify);
+        }
+        trim_runs();
+
+        auto cIt = my_cache.find(slab_info.first);
+        if (cIt != my_cache.end()) {
+            if constexpr(record_counters_) {
+                ++my_counters.hits;
+            }
+            cIt->second.next_use = my_run_next[my_current_run - my_run_offset];
+            my_last_slab = cIt->second.slab;
+            return std::make_pair(my_last_slab, slab_info.second);
+        }
+
+        if constexpr(record_counters_) {
+            ++my_counters.misses;
+        }
+
+        auto get_slab = [&]() -> Slab_* {
+            if (my_all_slabs.size() < my_max_slabs) {
+                // We reserved my_all_slabs so further push_backs() should not
+                // trigger any reallocation or invalidation of the pointers.
+                my_all_slabs.push_back(create());
+                return &(my_all_slabs.back());
+            } else {
+                return choose_victim(identify);
+            }
+        };
+
+        // Evicting before inserting the new entry, so that the latter is not considered as a victim.
+        // This may also scan further ahead, so we only look up the next use of the current slab afterwards.
+        my_last_slab = get_slab();
+        auto& current = my_cache[slab_info.first];
+        current.slab = my_last_slab;
+        current.next_use = my_run_next[my_current_run - my_run_offset];
+        my_to_populate.emplace_back(slab_info.first, my_last_slab);
+
+        // If there are free slots, we also fill them with the upcoming slabs that are not yet in the cache.
+        // We stop after seeing 'max_slabs' distinct slabs, to avoid scanning too far ahead.
+        if (my_all_slabs.size() < my_max_slabs) {
+            I<decltype(my_max_slabs)> num_seen = 1;
+            auto run = my_current_run + 1;
+            while (my_all_slabs.size() < my_max_slabs && num_seen < my_max_slabs) {
+                if (run == num_known_runs() && (lookahead_full() || !scan_run(identify))) {
+                    break;
+                }
+
+                auto future_id = my_run_ids[run - my_run_offset];
+                if (future_id != slab_info.first) {
+                    auto fIt = my_cache.find(future_id);
+                    if (fIt == my_cache.end()) {
+                        auto slab_ptr = get_slab(); // no eviction is performed here as there are free slots.
+                        auto& future = my_cache[future_id];
+                        future.slab = slab_ptr;
+                        future.next_use = run;
+                        my_to_populate.emplace_back(future_id, slab_ptr);
+                        ++num_seen;
+                    } else if (fIt->second.next_use == run) { // i.e., the first time that we see this slab in the lookahead.
+                        ++num_seen;
+                    }
+                }
+                ++run;
+            }
+        }
+
+        record_populate<record_counters_>(my_counters, my_to_populate.size(), [&]() -> void {
+            populate(my_to_populate);
+        });
+        my_to_populate.clear();
+
+        return std::make_pair(my_last_slab, slab_info.second);
+    }
+
+public:
+    /**
+     * @return Maximum number of slabs in the cache.
+     * The type is an unsigned integer defined in `std::vector::size_type`.
+     */
+    auto get_max_slabs() const {
+        return my_max_slabs;
+    }
+
+    /**
+     * @return Number of slabs currently in the cache.
+     * The type is an unsigned integer defined in `std::vector::size_type`.
+     */
+    auto get_num_slabs() const {
+        return my_cache.size();
+    }
+
+    /**
+     * This method should only be called if `record_counters_ = true`.
+     * @return Counters for the activity of this cache.
+     */
+    const SlabCacheCounters& get_counters() const {
+        static_assert(record_counters_, "counters are only available if 'record_counters_ = true'");
+        return my_counters;
+    }
+};
+
+}
+
+#endif
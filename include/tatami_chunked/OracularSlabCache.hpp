@@ -2,6 +2,8 @@
 #define TATAMI_CHUNKED_ORACULAR_SLAB_CACHE_HPP
 
 #include "utils.hpp"
+#include "id_map.hpp"
+#include "SlabCacheCounters.hpp"
 
 #include <unordered_map>
 #include <vector>
@@ -28,6 +30,11 @@ namespace tatami_chunked {
  * This should also be the type of the maximum number of slabs required to span the relevant dimension, see the template parameter of the same name in `SlabCacheStats`.
  * @tparam Slab_ Class for a single slab.
  * @tparam track_reuse_ Whether to track slabs in the cache that are re-used.
+ * @tparam direct_ids_ Whether to look up slabs by indexing a dense array with their identifiers, instead of using a hash map.
+ * This avoids hashing but requires all identifiers to be non-negative integers less than the `num_ids` used in the constructor.
+ * The memory usage of the dense array is proportional to `num_ids`.
+ * @tparam record_counters_ Whether to record the cache's activity in a `SlabCacheCounters`, see `get_counters()`.
+ * If `false`, no counters are stored or updated.
  *
  * Implement an oracle-aware cache for slabs.
  * Each slab is defined as the set of chunks required to read an element of the target dimension (or a contiguous block/indexed subset thereof) from a `tatami::Matrix`.
@@ -37,7 +44,7 @@ namespace tatami_chunked {
  * It is assumed that each slab has the same size such that `Slab_` instances can be effectively reused between slabs without requiring any reallocation of memory.
  * For variable-sized slabs, consider using `OracularVariableSlabCache` instead.
  */
-template<typename Id_, typename Index_, class Slab_, bool track_reuse_ = false> 
+template<typename Id_, typename Index_, class Slab_, bool track_reuse_ = false, bool direct_ids_ = false, bool record_counters_ = false> 
 class OracularSlabCache {
 private:
     std::shared_ptr<const tatami::Oracle<Index_> > my_oracle;
@@ -51,22 +58,28 @@ private:
     typename SlabPool::size_type my_max_slabs;
     SlabPool my_all_slabs;
 
-    std::unordered_map<Id_, Slab_*> my_current_cache, my_future_cache;
+    IdMap<direct_ids_, Id_, Slab_*> my_current_cache, my_future_cache;
     std::vector<std::pair<Id_, Slab_*> > my_to_populate;
     std::vector<Id_> my_in_need;
     tatami::PredictionIndex my_refresh_point = 0;
 
     typename std::conditional<track_reuse_, std::vector<std::pair<Id_, Slab_*> >, bool>::type my_to_reuse;
 
+    MaybeSlabCacheCounters<record_counters_> my_counters;
+
 public:
     /**
      * @param oracle Pointer to an `tatami::Oracle` to be used for predictions.
      * @param max_slabs Maximum number of slabs to store in the cache.
+     * @param num_ids Upper bound on the slab identifiers.
+     * This is only used if `direct_ids_ = true`, in which case all identifiers returned by `identify()` should be less than `num_ids`.
      */
-    OracularSlabCache(std::shared_ptr<const tatami::Oracle<Index_> > oracle, Index_ max_slabs) : 
+    OracularSlabCache(std::shared_ptr<const tatami::Oracle<Index_> > oracle, Index_ max_slabs, Id_ num_ids = 0) : 
         my_oracle(std::move(oracle)), 
         my_total(my_oracle->total()),
-        my_max_slabs(sanisizer::cast<I<decltype(my_max_slabs)> >(max_slabs)) 
+        my_max_slabs(sanisizer::cast<I<decltype(my_max_slabs)> >(max_slabs)),
+        my_current_cache(create_id_map<direct_ids_, Slab_*>(num_ids)),
+        my_future_cache(create_id_map<direct_ids_, Slab_*>(num_ids))
     {
         my_all_slabs.reserve(max_slabs);
         my_current_cache.reserve(max_slabs);
@@ -148,12 +161,19 @@ public:
         Index_ index = this->next(); 
         auto slab_info = identify(index);
         if (slab_info.first == my_last_slab_id && my_last_slab) {
+            if constexpr(record_counters_) {
+                ++my_counters.hits;
+            }
             return std::make_pair(my_last_slab, slab_info.second);
         }
         my_last_slab_id = slab_info.first;
 
         // Updating the cache if we hit the refresh point.
         if (my_counter - 1 == my_refresh_point) {
+            if constexpr(record_counters_) {
+                ++my_counters.misses;
+            }
+
             // Note that, for any given populate cycle, the first prediction's
             // slab cannot already be in the cache, otherwise it would have
             // incorporated into the previous cycle. So we can skip some code.
@@ -191,9 +211,17 @@ public:
                     if constexpr(track_reuse_) {
                         my_to_reuse.emplace_back(future_slab_info.first, slab_ptr);
                     }
+                    if constexpr(record_counters_) {
+                        ++my_counters.slabs_reused;
+                    }
                 }
             }
 
+            // Everything left in the current cache is either repurposed for a new slab or discarded.
+            if constexpr(record_counters_) {
+                my_counters.evictions += my_current_cache.size();
+            }
+
             auto cIt = my_current_cache.begin();
             for (auto a : my_in_need) {
                 if (cIt != my_current_cache.end()) {
@@ -211,11 +239,13 @@ public:
             }
             my_in_need.clear();
 
-            if constexpr(track_reuse_) {
-                populate(my_to_populate, my_to_reuse);
-            } else {
-                populate(my_to_populate);
-            }
+            record_populate<record_counters_>(my_counters, my_to_populate.size(), [&]() -> void {
+                if constexpr(track_reuse_) {
+                    populate(my_to_populate, my_to_reuse);
+                } else {
+                    populate(my_to_populate);
+                }
+            });
 
             my_to_populate.clear();
             if constexpr(track_reuse_) {
@@ -232,6 +262,8 @@ public:
             // we run out of predictions, in which case it doesn't matter.
             my_current_cache.clear();
             my_current_cache.swap(my_future_cache);
+        } else if constexpr(record_counters_) {
+            ++my_counters.hits;
         }
 
         // We know it must exist, so no need to check ccIt's validity.
@@ -256,6 +288,15 @@ public:
     auto get_num_slabs() const {
         return my_current_cache.size();
     }
+
+    /**
+     * This method should only be called if `record_counters_ = true`.
+     * @return Counters for the activity of this cache.
+     */
+    const SlabCacheCounters& get_counters() const {
+        static_assert(record_counters_, "counters are only available if 'record_counters_ = true'");
+        return my_counters;
+    }
 };
 
 }
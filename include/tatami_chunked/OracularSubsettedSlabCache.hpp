@@ -2,6 +2,8 @@
 #define TATAMI_CHUNKED_SUBSETTED_ORACLE_SLAB_CACHE_HPP
 
 #include "utils.hpp"
+#include "id_map.hpp"
+#include "SlabCacheCounters.hpp"
 
 #include <unordered_map>
 #include <vector>
@@ -162,13 +164,18 @@ void finalize_details(OracularSubsettedSlabCacheSelectionDetails<Index_>& detail
  * @tparam Index_ Integer type of the dimension extent and the type of row/column index produced by the oracle.
  * This should also be the type of the maximum number of slabs required to span the relevant dimension, see the template parameter of the same name in `SlabCacheStats`.
  * @tparam Slab_ Class for a single slab.
+ * @tparam direct_ids_ Whether to look up slabs by indexing a dense array with their identifiers, instead of using a hash map.
+ * This avoids hashing but requires all identifiers to be non-negative integers less than the `num_ids` used in the constructor.
+ * The memory usage of the dense array is proportional to `num_ids`.
+ * @tparam record_counters_ Whether to record the cache's activity in a `SlabCacheCounters`, see `get_counters()`.
+ * If `false`, no counters are stored or updated.
  *
  * Implement an oracle-aware cache for slab subsets.
  * Each slab is defined as the set of chunks required to read an element of the target dimension (or a contiguous block/indexed subset thereof) from a `tatami::Matrix`.
  * This cache is similar to the `OracularSlabCache` except that it remembers the subset of elements on the target dimension that were requested for each slab.
  * Slab extractors can use this information to optimize slab loading by ignoring unneeded elements. 
  */
-template<typename Id_, typename Index_, class Slab_> 
+template<typename Id_, typename Index_, class Slab_, bool direct_ids_ = false, bool record_counters_ = false> 
 class OracularSubsettedSlabCache {
 private:
     std::shared_ptr<const tatami::Oracle<Index_> > my_oracle;
@@ -181,11 +188,11 @@ private:
     typedef std::vector<Slab_> SlabPool;
     typename SlabPool::size_type my_max_slabs;
     SlabPool my_all_slabs;
-    std::unordered_map<Id_, Slab_*> my_current_cache, my_future_cache;
+    IdMap<direct_ids_, Id_, Slab_*> my_current_cache, my_future_cache;
 
     std::vector<OracularSubsettedSlabCacheSelectionDetails<Index_> > my_all_subset_details;
     std::vector<OracularSubsettedSlabCacheSelectionDetails<Index_>*> my_free_subset_details;
-    std::unordered_map<Id_, OracularSubsettedSlabCacheSelectionDetails<Index_>*> my_close_future_subset_cache, my_far_future_subset_cache;
+    IdMap<direct_ids_, Id_, OracularSubsettedSlabCacheSelectionDetails<Index_>*> my_close_future_subset_cache, my_far_future_subset_cache;
 
     tatami::PredictionIndex my_close_refresh_point = 0;
     tatami::PredictionIndex my_far_refresh_point = 0;
@@ -195,15 +202,23 @@ private:
     std::vector<std::pair<Id_, OracularSubsettedSlabCacheSelectionDetails<Index_>*> > my_to_reassign;
     std::vector<std::tuple<Id_, Slab_*, const OracularSubsettedSlabCacheSelectionDetails<Index_>*> > my_to_populate;
 
+    MaybeSlabCacheCounters<record_counters_> my_counters;
+
 public:
     /**
      * @param oracle Pointer to an `tatami::Oracle` to be used for predictions.
      * @param max_slabs Maximum number of slabs to store.
+     * @param num_ids Upper bound on the slab identifiers.
+     * This is only used if `direct_ids_ = true`, in which case all identifiers returned by `identify()` should be less than `num_ids`.
      */
-    OracularSubsettedSlabCache(std::shared_ptr<const tatami::Oracle<Index_> > oracle, Index_ max_slabs) :
+    OracularSubsettedSlabCache(std::shared_ptr<const tatami::Oracle<Index_> > oracle, Index_ max_slabs, Id_ num_ids = 0) :
         my_oracle(std::move(oracle)), 
         my_total(my_oracle->total()),
-        my_max_slabs(sanisizer::cast<I<decltype(my_max_slabs)> >(max_slabs))
+        my_max_slabs(sanisizer::cast<I<decltype(my_max_slabs)> >(max_slabs)),
+        my_current_cache(create_id_map<direct_ids_, Slab_*>(num_ids)),
+        my_future_cache(create_id_map<direct_ids_, Slab_*>(num_ids)),
+        my_close_future_subset_cache(create_id_map<direct_ids_, OracularSubsettedSlabCacheSelectionDetails<Index_>*>(num_ids)),
+        my_far_future_subset_cache(create_id_map<direct_ids_, OracularSubsettedSlabCacheSelectionDetails<Index_>*>(num_ids))
     {
         my_all_slabs.reserve(max_slabs);
         my_current_cache.reserve(max_slabs);
@@ -284,12 +299,19 @@ public:
         Index_ index = this->next(); 
         auto slab_info = identify(index);
         if (slab_info.first == my_last_slab_id && my_last_slab) {
+            if constexpr(record_counters_) {
+                ++my_counters.hits;
+            }
             return std::make_pair(my_last_slab, slab_info.second);
         }
         my_last_slab_id = slab_info.first;
 
         // Updating the cache if we hit the refresh point.
         if (my_counter - 1 == my_close_refresh_point) {
+            if constexpr(record_counters_) {
+                ++my_counters.misses;
+            }
+
             if (my_all_slabs.empty()) {
                 // This section only runs once, at the start, to populate the my_close_future_subset_cache.
                 requisition_subset_close(slab_info.first, slab_info.second);
@@ -346,10 +368,16 @@ public:
                 } else {
                     my_future_cache[cf.first] = cIt->second;
                     my_current_cache.erase(cIt);
+                    if constexpr(record_counters_) {
+                        ++my_counters.slabs_reused;
+                    }
                 }
             }
 
             // Creating new slabs for everything that's left.
+            if constexpr(record_counters_) {
+                my_counters.evictions += my_current_cache.size();
+            }
             auto cIt = my_current_cache.begin();
             for (auto a : my_to_reassign) {
                 Slab_* slab_ptr;
@@ -366,7 +394,7 @@ public:
             }
             my_to_reassign.clear();
 
-            populate(my_to_populate);
+            record_populate<record_counters_>(my_counters, my_to_populate.size(), [&]() -> void { populate(my_to_populate); });
             my_to_populate.clear();
 
             // We always fill my_future_cache to the brim so every entry of
@@ -387,6 +415,8 @@ public:
             }
             my_close_future_subset_cache.clear();
             my_close_future_subset_cache.swap(my_far_future_subset_cache);
+        } else if constexpr(record_counters_) {
+            ++my_counters.hits;
         }
 
         // We know it must exist, so no need to check ccIt's validity.
@@ -435,6 +465,15 @@ public:
     auto get_num_slabs() const {
         return my_current_cache.size();
     }
+
+    /**
+     * This method should only be called if `record_counters_ = true`.
+     * @return Counters for the activity of this cache.
+     */
+    const SlabCacheCounters& get_counters() const {
+        static_assert(record_counters_, "counters are only available if 'record_counters_ = true'");
+        return my_counters;
+    }
 };
 
 }
@@ -1,6 +1,9 @@
 #ifndef TATAMI_CHUNKED_ORACULAR_VARIABLE_SLAB_CACHE_HPP
 #define TATAMI_CHUNKED_ORACULAR_VARIABLE_SLAB_CACHE_HPP
 
+#include "id_map.hpp"
+#include "SlabCacheCounters.hpp"
+
 #include <unordered_map>
 #include <vector>
 #include <list>
@@ -24,6 +27,11 @@ namespace tatami_chunked {
  * @tparam Index_ Type of row/column index produced by the oracle.
  * @tparam Slab_ Class for a single slab.
  * @tparam Size_ Numeric type for the maximum cache size.
+ * @tparam direct_ids_ Whether to look up slabs by indexing a dense array with their identifiers, instead of using a hash map.
+ * This avoids hashing but requires all identifiers to be non-negative integers less than the `num_ids` used in the constructor.
+ * The memory usage of the dense array is proportional to `num_ids`.
+ * @tparam record_counters_ Whether to record the cache's activity in a `SlabCacheCounters`, see `get_counters()`.
+ * If `false`, no counters are stored or updated.
  *
  * Implement an oracle-aware cache for variable-size slabs.
  * Each slab is defined as the set of chunks required to read an element of the target dimension (or a contiguous block/indexed subset thereof) from a `tatami::Matrix`.
@@ -41,8 +49,9 @@ namespace tatami_chunked {
  * This guarantees that the actual cache size does not exceed the limit associated with `max_size` when `Slab_` instances are re-used for different slabs.
  * (Otherwise, if each `Slab_` allocates its own memory, re-use of an instance may cause its allocation to increase to the size of the largest encountered slab.)
  * Callers may need to occasionally defragment the pool to ensure that enough memory is available for loading new slabs.
+ * The `DenseVariableSlabFactory` and `SparseVariableSlabFactory` classes implement such a pool, compacting the re-used slabs at the start of each `populate()` call.
  */
-template<typename Id_, typename Index_, class Slab_, typename Size_> 
+template<typename Id_, typename Index_, class Slab_, typename Size_, bool direct_ids_ = false, bool record_counters_ = false> 
 class OracularVariableSlabCache {
 private:
     std::shared_ptr<const tatami::Oracle<Index_> > my_oracle;
@@ -61,22 +70,28 @@ private:
     // We need to hold an offset into 'my_all_slabs' rather than a pointer, as
     // 'my_all_slabs' might be reallocated upon addition of new slabs, given that
     // we don't know the maximum number of slabs ahead of time.
-    std::unordered_map<Id_, SlabIndex> my_current_cache, my_future_cache;
+    IdMap<direct_ids_, Id_, SlabIndex> my_current_cache, my_future_cache;
     std::vector<std::pair<Id_, SlabIndex> > my_to_populate, my_to_reuse;
     std::vector<Id_> my_in_need;
     std::vector<SlabIndex> my_free_pool;
     tatami::PredictionIndex my_refresh_point = 0;
 
+    MaybeSlabCacheCounters<record_counters_> my_counters;
+
 public:
     /**
      * @param oracle Pointer to an `tatami::Oracle` to be used for predictions.
      * @param max_size Total size of all slabs to store in the cache.
      * This may be zero, in which case no caching should be performed.
+     * @param num_ids Upper bound on the slab identifiers.
+     * This is only used if `direct_ids_ = true`, in which case all identifiers returned by `identify()` should be less than `num_ids`.
      */
-    OracularVariableSlabCache(std::shared_ptr<const tatami::Oracle<Index_> > oracle, Size_ max_size) : 
+    OracularVariableSlabCache(std::shared_ptr<const tatami::Oracle<Index_> > oracle, Size_ max_size, Id_ num_ids = 0) : 
         my_oracle(std::move(oracle)), 
         my_total(my_oracle->total()),
-        my_max_size(max_size) 
+        my_max_size(max_size),
+        my_current_cache(create_id_map<direct_ids_, SlabIndex>(num_ids)),
+        my_future_cache(create_id_map<direct_ids_, SlabIndex>(num_ids))
     {} 
 
     /**
@@ -164,12 +179,19 @@ public:
         Index_ index = this->next(); 
         auto slab_info = identify(index);
         if (slab_info.first == my_last_slab_id && my_last_slab_num.has_value()) {
+            if constexpr(record_counters_) {
+                ++my_counters.hits;
+            }
             return std::make_pair(my_all_slabs.data() + *my_last_slab_num, slab_info.second);
         }
         my_last_slab_id = slab_info.first;
 
         // Updating the cache if we hit the refresh point.
         if (my_counter - 1 == my_refresh_point) {
+            if constexpr(record_counters_) {
+                ++my_counters.misses;
+            }
+
             // Note that, for any given populate cycle, the first prediction's
             // slab cannot already be in the cache, otherwise it would have
             // incorporated into the previous cycle. So we can skip some code.
@@ -210,6 +232,12 @@ public:
                 }
             }
 
+            // Everything left in the current cache is either repurposed for a new slab or sent to the free pool.
+            if constexpr(record_counters_) {
+                my_counters.slabs_reused += my_to_reuse.size();
+                my_counters.evictions += my_current_cache.size();
+            }
+
             auto cIt = my_current_cache.begin();
             for (auto a : my_in_need) {
                 if (cIt != my_current_cache.end()) {
@@ -230,12 +258,14 @@ public:
                 my_free_pool.emplace_back(cIt->second);
             }
 
-            populate(my_to_populate, my_to_reuse, my_all_slabs);
+            record_populate<record_counters_>(my_counters, my_to_populate.size(), [&]() -> void { populate(my_to_populate, my_to_reuse, my_all_slabs); });
             my_to_populate.clear();
             my_to_reuse.clear();
 
             my_current_cache.clear();
             my_current_cache.swap(my_future_cache);
+        } else if constexpr(record_counters_) {
+            ++my_counters.hits;
         }
 
         // We know it must exist, so no need to check ccIt's validity.
@@ -281,6 +311,15 @@ public:
     auto get_num_slabs() const {
         return my_current_cache.size();
     }
+
+    /**
+     * This method should only be called if `record_counters_ = true`.
+     * @return Counters for the activity of this cache.
+     */
+    const SlabCacheCounters& get_counters() const {
+        static_assert(record_counters_, "counters are only available if 'record_counters_ = true'");
+        return my_counters;
+    }
 };
 
 }
@@ -0,0 +1,591 @@
+#ifndef TATAMI_CHUNKED_RECORDED_CHUNKED_MATRIX_HPP
+#define TATAMI_CHUNKED_RECORDED_CHUNKED_MATRIX_HPP
+
+#include "AccessTrace.hpp"
+#include "CustomDenseChunkedMatrix.hpp"
+#include "CustomSparseChunkedMatrix.hpp"
+
+#include <vector>
+#include <memory>
+#include <cstddef>
+
+#include "tatami/tatami.hpp"
+
+/**
+ * @file RecordedChunkedMatrix.hpp
+ * @brief Record the access pattern for a chunked matrix.
+ */
+
+namespace tatami_chunked {
+
+/**
+ * @cond
+ */
+namespace RecordedMatrix_internal {
+
+template<bool oracle_, typename Index_>
+class FetchLog {
+public:
+    FetchLog(AccessRecorder<Index_>& recorder, std::size_t id, tatami::MaybeOracle<oracle_, Index_> oracle) :
+        my_recorder(recorder), my_id(id), my_oracle(std::move(oracle)) {}
+
+    FetchLog(const FetchLog&) = delete;
+    FetchLog& operator=(const FetchLog&) = delete;
+
+    ~FetchLog() {
+        my_recorder.finish_extractor(my_id, std::move(my_fetches));
+    }
+
+private:
+    AccessRecorder<Index_>& my_recorder;
+    std::size_t my_id;
+    tatami::MaybeOracle<oracle_, Index_> my_oracle;
+    tatami::PredictionIndex my_used = 0;
+    std::vector<Index_> my_fetches;
+
+public:
+    void add([[maybe_unused]] Index_ i) {
+        if constexpr(oracle_) {
+            my_fetches.push_back(my_oracle->get(my_used++));
+        } else {
+            my_fetches.push_back(i);
+        }
+    }
+};
+
+template<bool oracle_, typename Value_, typename Index_>
+class RecordedDense final : public tatami::DenseExtractor<oracle_, Value_, Index_> {
+public:
+    RecordedDense(std::unique_ptr<tatami::DenseExtractor<oracle_, Value_, Index_> > inner, AccessRecorder<Index_>& recorder, std::size_t id, tatami::MaybeOracle<oracle_, Index_> oracle) :
+        my_inner(std::move(inner)), my_log(recorder, id, std::move(oracle)) {}
+
+    const Value_* fetch(Index_ i, Value_* buffer) {
+        my_log.add(i);
+        return my_inner->fetch(i, buffer);
+    }
+
+private:
+    std::unique_ptr<tatami::DenseExtractor<oracle_, Value_, Index_> > my_inner;
+    FetchLog<oracle_, Index_> my_log;
+};
+
+template<bool oracle_, typename Value_, typename Index_>
+class RecordedSparse final : public tatami::SparseExtractor<oracle_, Value_, Index_> {
+public:
+    RecordedSparse(std::unique_ptr<tatami::SparseExtractor<oracle_, Value_, Index_> > inner, AccessRecorder<Index_>& recorder, std::size_t id, tatami::MaybeOracle<oracle_, Index_> oracle) :
+        my_inner(std::move(inner)), my_log(recorder, id, std::move(oracle)) {}
+
+    tatami::SparseRange<Value_, Index_> fetch(Index_ i, Value_* value_buffer, Index_* index_buffer) {
+        my_log.add(i);
+        return my_inner->fetch(i, value_buffer, index_buffer);
+    }
+
+private:
+    std::unique_ptr<tatami::SparseExtractor<oracle_, Value_, Index_> > my_inner;
+    FetchLog<oracle_, Index_> my_log;
+};
+
+template<typename ChunkValue_, typename Index_>
+class RecordedDenseWorkspace final : public CustomDenseChunkedMatrixWorkspace<ChunkValue_, Index_> {
+public:
+    RecordedDenseWorkspace(std::unique_ptr<CustomDenseChunkedMatrixWorkspace<ChunkValue_, Index_> > inner, AccessRecorder<Index_>& recorder) :
+        my_inner(std::move(inner)), my_recorder(recorder) {}
+
+private:
+    std::unique_ptr<CustomDenseChunkedMatrixWorkspace<ChunkValue_, Index_> > my_inner;
+    AccessRecorder<Index_>& my_recorder;
+
+public:
+    void extract(Index_ chunk_row_id, Index_ chunk_column_id, bool row, Index_ target_start, Index_ target_length, Index_ non_target_start, Index_ non_target_length, ChunkValue_* output, Index_ stride) {
+        my_recorder.add_chunk_read(chunk_row_id, chunk_column_id, row);
+        my_inner->extract(chunk_row_id, chunk_column_id, row, target_start, target_length, non_target_start, non_target_length, output, stride);
+    }
+
+    void extract(Index_ chunk_row_id, Index_ chunk_column_id, bool row, Index_ target_start, Index_ target_length, const std::vector<Index_>& non_target_indices, ChunkValue_* output, Index_ stride) {
+        my_recorder.add_chunk_read(chunk_row_id, chunk_column_id, row);
+        my_inner->extract(chunk_row_id, chunk_column_id, row, target_start, target_length, non_target_indices, output, stride);
+    }
+
+    void extract(Index_ chunk_row_id, Index_ chunk_column_id, bool row, const std::vector<Index_>& target_indices, Index_ non_target_start, Index_ non_target_length, ChunkValue_* output, Index_ stride) {
+        my_recorder.add_chunk_read(chunk_row_id, chunk_column_id, row);
+        my_inner->extract(chunk_row_id, chunk_column_id, row, target_indices, non_target_start, non_target_length, output, stride);
+    }
+
+    void extract(Index_ chunk_row_id, Index_ chunk_column_id, bool row, const std::vector<Index_>& target_indices, const std::vector<Index_>& non_target_indices, ChunkValue_* output, Index_ stride) {
+        my_recorder.add_chunk_read(chunk_row_id, chunk_column_id, row);
+        my_inner->extract(chunk_row_id, chunk_column_id, row, target_indices, non_target_indices, output, stride);
+    }
+
+    // Forwarding to the inner workspace's extract_many() so that any coalescing of requests is preserved.
+    void extract_many(bool row, const std::vector<typename CustomDenseChunkedMatrixWorkspace<ChunkValue_, Index_>::ChunkRequest>& requests) {
+        for (const auto& req : requests) {
+            my_recorder.add_chunk_read(req.chunk_row_id, req.chunk_column_id, row);
+        }
+        my_inner->extract_many(row, requests);
+    }
+
+    bool supports_extract_single() const {
+        return my_inner->supports_extract_single();
+    }
+
+    void extract_single(Index_ chunk_row_id, Index_ chunk_column_id, bool row, Index_ target, Index_ non_target_start, Index_ non_target_length, ChunkValue_* output) {
+        my_recorder.add_chunk_read(chunk_row_id, chunk_column_id, row);
+        my_inner->extract_single(chunk_row_id, chunk_column_id, row, target, non_target_start, non_target_length, output);
+    }
+
+    void extract_single(Index_ chunk_row_id, Index_ chunk_column_id, bool row, Index_ target, const std::vector<Index_>& non_target_indices, ChunkValue_* output) {
+        my_recorder.add_chunk_read(chunk_row_id, chunk_column_id, row);
+        my_inner->extract_single(chunk_row_id, chunk_column_id, row, target, non_target_indices, output);
+    }
+};
+
+template<typename ChunkValue_, typename Index_>
+class RecordedSparseWorkspace final : public CustomSparseChunkedMatrixWorkspace<ChunkValue_, Index_> {
+public:
+    RecordedSparseWorkspace(std::unique_ptr<CustomSparseChunkedMatrixWorkspace<ChunkValue_, Index_> > inner, AccessRecorder<Index_>& recorder) :
+        my_inner(std::move(inner)), my_recorder(recorder) {}
+
+private:
+    std::unique_ptr<CustomSparseChunkedMatrixWorkspace<ChunkValue_, Index_> > my_inner;
+    AccessRecorder<Index_>& my_recorder;
+
+public:
+    void extract(
+        Index_ chunk_row_id,
+        Index_ chunk_column_id,
+        bool row,
+        Index_ target_start,
+        Index_ target_length,
+        Index_ non_target_start,
+        Index_ non_target_length,
+        const std::vector<ChunkValue_*>& output_values,
+        const std::vector<Index_*>& output_indices,
+        Index_* output_number,
+        Index_ shift)
+    {
+        my_recorder.add_chunk_read(chunk_row_id, chunk_column_id, row);
+        my_inner->extract(chunk_row_id, chunk_column_id, row, target_start, target_length, non_target_start, non_target_length, output_values, output_indices, output_number, shift);
+    }
+
+    void extract(
+        Index_ chunk_row_id,
+        Index_ chunk_column_id,
+        bool row,
+        Index_ target_start,
+        Index_ target_length,
+        const std::vector<Index_>& non_target_indices,
+        const std::vector<ChunkValue_*>& output_values,
+        const std::vector<Index_*>& output_indices,
+        Index_* output_number,
+        Index_ shift)
+    {
+        my_recorder.add_chunk_read(chunk_row_id, chunk_column_id, row);
+        my_inner->extract(chunk_row_id, chunk_column_id, row, target_start, target_length, non_target_indices, output_values, output_indices, output_number, shift);
+    }
+
+    void extract(
+        Index_ chunk_row_id,
+        Index_ chunk_column_id,
+        bool row,
+        const std::vector<Index_>& target_indices,
+        Index_ non_target_start,
+        Index_ non_target_length,
+        const std::vector<ChunkValue_*>& output_values,
+        const std::vector<Index_*>& output_indices,
+        Index_* output_number,
+        Index_ shift)
+    {
+        my_recorder.add_chunk_read(chunk_row_id, chunk_column_id, row);
+        my_inner->extract(chunk_row_id, chunk_column_id, row, target_indices, non_target_start, non_target_length, output_values, output_indices, output_number, shift);
+    }
+
+    void extract(
+        Index_ chunk_row_id,
+        Index_ chunk_column_id,
+        bool row,
+        const std::vector<Index_>& target_indices,
+        const std::vector<Index_>& non_target_indices,
+        const std::vector<ChunkValue_*>& output_values,
+        const std::vector<Index_*>& output_indices,
+        Index_* output_number,
+        Index_ shift)
+    {
+        my_recorder.add_chunk_read(chunk_row_id, chunk_column_id, row);
+        my_inner->extract(chunk_row_id, chunk_column_id, row, target_indices, non_target_indices, output_values, output_indices, output_number, shift);
+    }
+};
+
+}
+/**
+ * @endcond
+ */
+
+/**
+ * @brief Record the access pattern for a matrix.
+ *
+ * This wraps an existing `tatami::Matrix` and records each extractor that is created from it in an `AccessRecorder`.
+ * For each extractor, we record the target dimension, the selection on the non-target dimension, whether it was sparse, whether it had an oracle and the sequence of `fetch()` calls.
+ * The resulting `AccessTrace` can be replayed against a matrix with different settings with `replay_access_trace()`, e.g., to tune the cache size for a `CustomDenseChunkedMatrix`.
+ * To also record the chunks that are read, the wrapped matrix should be constructed from a `RecordedDenseChunkedMatrixManager` or `RecordedSparseChunkedMatrixManager` that uses the same recorder.
+ *
+ * Each extractor buffers its own fetches and only passes them to the recorder when it is destroyed, to avoid locking on every `fetch()`.
+ *
+ * @tparam Value_ Numeric type of the matrix values.
+ * @tparam Index_ Integer type of the row/column indices.
+ */
+template<typename Value_, typename Index_>
+class RecordedMatrix final : public tatami::Matrix<Value_, Index_> {
+public:
+    /**
+     * @param matrix Matrix to be wrapped.
+     * @param recorder Recorder for the access pattern.
+     * This should have the same dimensions as `matrix`.
+     */
+    RecordedMatrix(std::shared_ptr<const tatami::Matrix<Value_, Index_> > matrix, std::shared_ptr<AccessRecorder<Index_> > recorder) :
+        my_matrix(std::move(matrix)), my_recorder(std::move(recorder)) {}
+
+private:
+    std::shared_ptr<const tatami::Matrix<Value_, Index_> > my_matrix;
+    std::shared_ptr<AccessRecorder<Index_> > my_recorder;
+
+    std::size_t record(bool row, bool sparse, bool oracle, AccessTraceSelection selection, Index_ block_start, Index_ block_length, const tatami::VectorPtr<Index_>& indices) const {
+        AccessTraceExtractor<Index_> details;
+        details.row = row;
+        details.sparse = sparse;
+        details.oracle = oracle;
+        details.selection = selection;
+        details.block_start = block_start;
+        details.block_length = block_length;
+        if (indices) {
+            details.indices = *indices;
+        }
+        return my_recorder->add_extractor(std::move(details));
+    }
+
+    template<bool oracle_>
+    std::unique_ptr<tatami::DenseExtractor<oracle_, Value_, Index_> > wrap_dense(std::unique_ptr<tatami::DenseExtractor<oracle_, Value_, Index_> > inner, std::size_t id, tatami::MaybeOracle<oracle_, Index_> oracle) const {
+        return std::make_unique<RecordedMatrix_internal::RecordedDense<oracle_, Value_, Index_> >(std::move(inner), *my_recorder, id, std::move(oracle));
+    }
+
+    template<bool oracle_>
+    std::unique_ptr<tatami::SparseExtractor<oracle_, Value_, Index_> > wrap_sparse(std::unique_ptr<tatami::SparseExtractor<oracle_, Value_, Index_> > inner, std::size_t id, tatami::MaybeOracle<oracle_, Index_> oracle) const {
+        return std::make_unique<RecordedMatrix_internal::RecordedSparse<oracle_, Value_, Index_> >(std::move(inner), *my_recorder, id, std::move(oracle));
+    }
+
+public:
+    Index_ nrow() const {
+        return my_matrix->nrow();
+    }
+
+    Index_ ncol() const {
+        return my_matrix->ncol();
+    }
+
+    bool is_sparse() const {
+        return my_matrix->is_sparse();
+    }
+
+    double is_sparse_proportion() const {
+        return my_matrix->is_sparse_proportion();
+    }
+
+    bool prefer_rows() const {
+        return my_matrix->prefer_rows();
+    }
+
+    double prefer_rows_proportion() const {
+        return my_matrix->prefer_rows_proportion();
+    }
+
+    bool uses_oracle(bool row) const {
+        return my_matrix->uses_oracle(row);
+    }
+
+    using tatami::Matrix<Value_, Index_>::dense;
+
+    using tatami::Matrix<Value_, Index_>::sparse;
+
+    /********************
+     *** Myopic dense ***
+     ********************/
+public:
+    std::unique_ptr<tatami::MyopicDenseExtractor<Value_, Index_> > dense(bool row, const tatami::Options& opt) const {
+        auto id = record(row, false, false, AccessTraceSelection::FULL, 0, 0, nullptr);
+        return wrap_dense<false>(my_matrix->dense(row, opt), id, false);
+    }
+
+    std::unique_ptr<tatami::MyopicDenseExtractor<Value_, Index_> > dense(bool row, Index_ block_start, Index_ block_length, const tatami::Options& opt) const {
+        auto id = record(row, false, false, AccessTraceSelection::BLOCK, block_start, block_length, nullptr);
+        return wrap_dense<false>(my_matrix->dense(row, block_start, block_length, opt), id, false);
+    }
+
+    std::unique_ptr<tatami::MyopicDenseExtractor<Value_, Index_> > dense(bool row, tatami::VectorPtr<Index_> indices_ptr, const tatami::Options& opt) const {
+        auto id = record(row, false, false, AccessTraceSelection::INDEX, 0, 0, indices_ptr);
+        return wrap_dense<false>(my_matrix->dense(row, std::move(indices_ptr), opt), id, false);
+    }
+
+    /**********************
+     *** Oracular dense ***
+     **********************/
+public:
+    std::unique_ptr<tatami::OracularDenseExtractor<Value_, Index_> > dense(
+        bool row,
+        std::shared_ptr<const tatami::Oracle<Index_> > oracle,
+        const tatami::Options& opt)
+    const {
+        auto id = record(row, false, true, AccessTraceSelection::FULL, 0, 0, nullptr);
+        return wrap_dense<true>(my_matrix->dense(row, oracle, opt), id, oracle);
+    }
+
+    std::unique_ptr<tatami::OracularDenseExtractor<Value_, Index_> > dense(
+        bool row,
+        std::shared_ptr<const tatami::Oracle<Index_> > oracle,
+        Index_ block_start,
+        Index_ block_length,
+        const tatami::Options& opt)
+    const {
+        auto id = record(row, false, true, AccessTraceSelection::BLOCK, block_start, block_length, nullptr);
+        return wrap_dense<true>(my_matrix->dense(row, oracle, block_start, block_length, opt), id, oracle);
+    }
+
+    std::unique_ptr<tatami::OracularDenseExtractor<Value_, Index_> > dense(
+        bool row,
+        std::shared_ptr<const tatami::Oracle<Index_> > oracle,
+        tatami::VectorPtr<Index_> indices_ptr,
+        const tatami::Options& opt)
+    const {
+        auto id = record(row, false, true, AccessTraceSelection::INDEX, 0, 0, indices_ptr);
+        return wrap_dense<true>(my_matrix->dense(row, oracle, std::move(indices_ptr), opt), id, oracle);
+    }
+
+    /*********************
+     *** Myopic sparse ***
+     *********************/
+public:
+    std::unique_ptr<tatami::MyopicSparseExtractor<Value_, Index_> > sparse(bool row, const tatami::Options& opt) const {
+        auto id = record(row, true, false, AccessTraceSelection::FULL, 0, 0, nullptr);
+        return wrap_sparse<false>(my_matrix->sparse(row, opt), id, false);
+    }
+
+    std::unique_ptr<tatami::MyopicSparseExtractor<Value_, Index_> > sparse(bool row, Index_ block_start, Index_ block_length, const tatami::Options& opt) const {
+        auto id = record(row, true, false, AccessTraceSelection::BLOCK, block_start, block_length, nullptr);
+        return wrap_sparse<false>(my_matrix->sparse(row, block_start, block_length, opt), id, false);
+    }
+
+    std::unique_ptr<tatami::MyopicSparseExtractor<Value_, Index_> > sparse(bool row, tatami::VectorPtr<Index_> indices_ptr, const tatami::Options& opt) const {
+        auto id = record(row, true, false, AccessTraceSelection::INDEX, 0, 0, indices_ptr);
+        return wrap_sparse<false>(my_matrix->sparse(row, std::move(indices_ptr), opt), id, false);
+    }
+
+    /***********************
+     *** Oracular sparse ***
+     ***********************/
+public:
+    std::unique_ptr<tatami::OracularSparseExtractor<Value_, Index_> > sparse(
+        bool row,
+        std::shared_ptr<const tatami::Oracle<Index_> > oracle,
+        const tatami::Options& opt)
+    const {
+        auto id = record(row, true, true, AccessTraceSelection::FULL, 0, 0, nullptr);
+        return wrap_sparse<true>(my_matrix->sparse(row, oracle, opt), id, oracle);
+    }
+
+    std::unique_ptr<tatami::OracularSparseExtractor<Value_, Index_> > sparse(
+        bool row,
+        std::shared_ptr<const tatami::Oracle<Index_> > oracle,
+        Index_ block_start,
+        Index_ block_length,
+        const tatami::Options& opt)
+    const {
+        auto id = record(row, true, true, AccessTraceSelection::BLOCK, block_start, block_length, nullptr);
+        return wrap_sparse<true>(my_matrix->sparse(row, oracle, block_start, block_length, opt), id, oracle);
+    }
+
+    std::unique_ptr<tatami::OracularSparseExtractor<Value_, Index_> > sparse(
+        bool row,
+        std::shared_ptr<const tatami::Oracle<Index_> > oracle,
+        tatami::VectorPtr<Index_> indices_ptr,
+        const tatami::Options& opt)
+    const {
+        auto id = record(row, true, true, AccessTraceSelection::INDEX, 0, 0, indices_ptr);
+        return wrap_sparse<true>(my_matrix->sparse(row, oracle, std::move(indices_ptr), opt), id, oracle);
+    }
+};
+
+/**
+ * @brief Record the chunk reads for a `CustomDenseChunkedMatrix`.
+ *
+ * This wraps an existing `CustomDenseChunkedMatrixManager` and records each call to its workspaces' `extract()` methods in an `AccessRecorder`.
+ * Calls to `extract_many()` are forwarded to the wrapped workspace and each request is recorded as a separate chunk read.
+ * Direct access via `chunk_data()` is not recorded as it does not involve any extraction.
+ *
+ * @tparam ChunkValue_ Numeric type of the data values in each chunk.
+ * @tparam Index_ Integer type of the row/column indices.
+ */
+template<typename ChunkValue_, typename Index_>
+class RecordedDenseChunkedMatrixManager final : public CustomDenseChunkedMatrixManager<ChunkValue_, Index_> {
+public:
+    /**
+     * @param manager Manager to be wrapped.
+     * @param recorder Recorder for the chunk reads.
+     */
+    RecordedDenseChunkedMatrixManager(std::shared_ptr<const CustomDenseChunkedMatrixManager<ChunkValue_, Index_> > manager, std::shared_ptr<AccessRecorder<Index_> > recorder) :
+        my_manager(std::move(manager)), my_recorder(std::move(recorder)) {}
+
+private:
+    std::shared_ptr<const CustomDenseChunkedMatrixManager<ChunkValue_, Index_> > my_manager;
+    std::shared_ptr<AccessRecorder<Index_> > my_recorder;
+
+public:
+    std::unique_ptr<CustomDenseChunkedMatrixWorkspace<ChunkValue_, Index_> > new_workspace() const {
+        return std::make_unique<RecordedMatrix_internal::RecordedDenseWorkspace<ChunkValue_, Index_> >(my_manager->new_workspace(), *my_recorder);
+    }
+
+    bool prefer_rows() const {
+        return my_manager->prefer_rows();
+    }
+
+    const ChunkDimensionStats<Index_>& row_stats() const {
+        return my_manager->row_stats();
+    }
+
+    const ChunkDimensionStats<Index_>& column_stats() const {
+        return my_manager->column_stats();
+    }
+
+    bool supports_chunk_data(bool row) const {
+        return my_manager->supports_chunk_data(row);
+    }
+
+    const ChunkValue_* chunk_data(Index_ chunk_row_id, Index_ chunk_column_id, bool row) const {
+        return my_manager->chunk_data(chunk_row_id, chunk_column_id, row);
+    }
+};
+
+/**
+ * @brief Record the chunk reads for a `CustomSparseChunkedMatrix`.
+ *
+ * This wraps an existing `CustomSparseChunkedMatrixManager` and records each call to its workspaces' `extract()` methods in an `AccessRecorder`.
+ *
+ * @tparam ChunkValue_ Numeric type of the data values in each chunk.
+ * @tparam Index_ Integer type of the row/column indices.
+ */
+template<typename ChunkValue_, typename Index_>
+class RecordedSparseChunkedMatrixManager final : public CustomSparseChunkedMatrixManager<ChunkValue_, Index_> {
+public:
+    /**
+     * @param manager Manager to be wrapped.
+     * @param recorder Recorder for the chunk reads.
+     */
+    RecordedSparseChunkedMatrixManager(std::shared_ptr<const CustomSparseChunkedMatrixManager<ChunkValue_, Index_> > manager, std::shared_ptr<AccessRecorder<Index_> > recorder) :
+        my_manager(std::move(manager)), my_recorder(std::move(recorder)) {}
+
+private:
+    std::shared_ptr<const CustomSparseChunkedMatrixManager<ChunkValue_, Index_> > my_manager;
+    std::shared_ptr<AccessRecorder<Index_> > my_recorder;
+
+public:
+    std::unique_ptr<CustomSparseChunkedMatrixWorkspace<ChunkValue_, Index_> > new_workspace() const {
+        return std::make_unique<RecordedMatrix_internal::RecordedSparseWorkspace<ChunkValue_, Index_> >(my_manager->new_workspace(), *my_recorder);
+    }
+
+    bool prefer_rows() const {
+        return my_manager->prefer_rows();
+    }
+
+    const ChunkDimensionStats<Index_>& row_stats() const {
+        return my_manager->row_stats();
+    }
+
+    const ChunkDimensionStats<Index_>& column_stats() const {
+        return my_manager->column_stats();
+    }
+
+    bool has_chunk_nonzeros() const {
+        return my_manager->has_chunk_nonzeros();
+    }
+
+    std::size_t chunk_nonzeros(Index_ chunk_row_id, Index_ chunk_column_id) const {
+        return my_manager->chunk_nonzeros(chunk_row_id, chunk_column_id);
+    }
+};
+
+/**
+ * Replay an `AccessTrace` against a `CustomDenseChunkedMatrix` with the specified options, see `replay_access_trace()` for details.
+ * This is intended for comparing different settings, e.g., `CustomDenseChunkedMatrixOptions::maximum_cache_size` or `CustomDenseChunkedMatrixOptions::cache_subset`, for the same access pattern.
+ * The cache counters are always recorded regardless of `CustomDenseChunkedMatrixOptions::record_cache_counters`.
+ *
+ * The timings are obtained by replaying the trace directly against `manager`, so they do not include the cost of recording each chunk read.
+ * The number of chunk reads is then obtained from a second, untimed replay where `manager` is wrapped in a `RecordedDenseChunkedMatrixManager`.
+ * This doubles the total cost of the call but keeps the recorder's locking out of the reported timings.
+ *
+ * @tparam Value_ Numeric type of the matrix values.
+ * @tparam Index_ Integer type of the row/column indices.
+ * @tparam ChunkValue_ Numeric type of the data values in each chunk.
+ *
+ * @param trace Trace of the access pattern.
+ * @param manager Manager of the chunks.
+ * @param options Options for the `CustomDenseChunkedMatrix`.
+ *
+ * @return Timings, counters and the number of chunk reads for the replay.
+ */
+template<typename Value_, typename Index_, typename ChunkValue_>
+AccessTraceReplayResult replay_dense_chunked_access_trace(
+    const AccessTrace<Index_>& trace,
+    std::shared_ptr<const CustomDenseChunkedMatrixManager<ChunkValue_, Index_> > manager,
+    CustomDenseChunkedMatrixOptions options)
+{
+    options.record_cache_counters = true;
+    CustomDenseChunkedMatrix<Value_, Index_, ChunkValue_, const CustomDenseChunkedMatrixManager<ChunkValue_, Index_> > mat(manager, options);
+    auto output = replay_access_trace(trace, mat);
+
+    // Counting the chunk reads in a separate untimed pass, so that the recorder doesn't contribute to the timings.
+    auto recorder = std::make_shared<AccessRecorder<Index_> >(trace.nrow, trace.ncol);
+    auto recorded = std::make_shared<RecordedDenseChunkedMatrixManager<ChunkValue_, Index_> >(std::move(manager), recorder);
+    CustomDenseChunkedMatrix<Value_, Index_, ChunkValue_> recorded_mat(std::move(recorded), options);
+    replay_access_trace(trace, recorded_mat);
+    output.num_chunk_reads = recorder->get_num_chunk_reads();
+    return output;
+}
+
+/**
+ * Replay an `AccessTrace` against a `CustomSparseChunkedMatrix` with the specified options, see `replay_access_trace()` for details.
+ * This is intended for comparing different settings, e.g., `CustomSparseChunkedMatrixOptions::maximum_cache_size` or `CustomSparseChunkedMatrixOptions::cache_subset`, for the same access pattern.
+ * The cache counters are always recorded regardless of `CustomSparseChunkedMatrixOptions::record_cache_counters`.
+ *
+ * The timings are obtained by replaying the trace directly against `manager`, so they do not include the cost of recording each chunk read.
+ * The number of chunk reads is then obtained from a second, untimed replay where `manager` is wrapped in a `RecordedSparseChunkedMatrixManager`.
+ * This doubles the total cost of the call but keeps the recorder's locking out of the reported timings.
+ *
+ * @tparam Value_ Numeric type of the matrix values.
+ * @tparam Index_ Integer type of the row/column indices.
+ * @tparam ChunkValue_ Numeric type of the data values in each chunk.
+ *
+ * @param trace Trace of the access pattern.
+ * @param manager Manager of the chunks.
+ * @param options Options for the `CustomSparseChunkedMatrix`.
+ *
+ * @return Timings, counters and the number of chunk reads for the replay.
+ */
+template<typename Value_, typename Index_, typename ChunkValue_>
+AccessTraceReplayResult replay_sparse_chunked_access_trace(
+    const AccessTrace<Index_>& trace,
+    std::shared_ptr<const CustomSparseChunkedMatrixManager<ChunkValue_, Index_> > manager,
+    CustomSparseChunkedMatrixOptions options)
+{
+    options.record_cache_counters = true;
+    CustomSparseChunkedMatrix<Value_, Index_, ChunkValue_, const CustomSparseChunkedMatrixManager<ChunkValue_, Index_> > mat(manager, options);
+    auto output = replay_access_trace(trace, mat);
+
+    // Counting the chunk reads in a separate untimed pass, so that the recorder doesn't contribute to the timings.
+    auto recorder = std::make_shared<AccessRecorder<Index_> >(trace.nrow, trace.ncol);
+    auto recorded = std::make_shared<RecordedSparseChunkedMatrixManager<ChunkValue_, Index_> >(std::move(manager), recorder);
+    CustomSparseChunkedMatrix<Value_, Index_, ChunkValue_> recorded_mat(std::move(recorded), options);
+    replay_access_trace(trace, recorded_mat);
+    output.num_chunk_reads = recorder->get_num_chunk_reads();
+    return output;
+}
+
+}
+
+#endif
@@ -0,0 +1,241 @@
+#ifndef TATAMI_CHUNKED_SLAB_CACHE_ADVISOR_HPP
+#define TATAMI_CHUNKED_SLAB_CACHE_ADVISOR_HPP
+
+#include "ChunkDimensionStats.hpp"
+
+#include <vector>
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+
+#include "tatami/tatami.hpp"
+#include "sanisizer/sanisizer.hpp"
+
+/**
+ * @file SlabCacheAdvisor.hpp
+ * @brief Choose the cache size from an oracle's predictions.
+ */
+
+namespace tatami_chunked {
+
+/**
+ * @brief Options for `SlabCacheAdvisor`.
+ */
+struct SlabCacheAdvisorOptions {
+    /**
+     * Maximum number of predictions to scan from the oracle.
+     * Only the first `maximum_predictions` predictions are used to compute the hit rates, which bounds the up-front cost for very long oracles.
+     * If zero, all predictions are scanned.
+     */
+    tatami::PredictionIndex maximum_predictions = 100000;
+};
+
+/**
+ * @brief Advise on the cache size from an oracle's predictions.
+ *
+ * Given the predictions from a `tatami::Oracle`, this class computes the expected hit rate of a slab cache for each possible number of slabs in the cache.
+ * Each prediction is mapped to its slab, i.e., the chunk along the target dimension that contains the predicted element.
+ * We then compute the reuse distance for each request, i.e., the number of distinct other slabs that were requested since the last request for the same slab.
+ * A request is a hit for a cache of size \f$n\f$ if its reuse distance is less than \f$n\f$.
+ *
+ * These hit rates are exact for `LruSlabCache` and a reasonable approximation for the oracle-aware caches like `OracularSlabCache`.
+ * The hit rate is a non-decreasing function of the cache size, so we can find the smallest cache that achieves a target hit rate.
+ * This is most useful for avoiding overly large caches when the access pattern only revisits a few slabs at a time, e.g., consecutive or blockwise iteration.
+ * Consecutive requests for the same slab are collapsed before computing the reuse distances,
+ * which requires \f$O(N + T \log T)\f$ time and \f$O(T)\f$ memory for \f$N\f$ predictions with \f$T\f$ transitions between slabs.
+ *
+ * @tparam Index_ Integer type of the dimension extents, see the template parameter of the same name in `SlabCacheStats`.
+ */
+template<typename Index_>
+class SlabCacheAdvisor {
+public:
+    /**
+     * @param oracle Oracle for the predicted accesses along the target dimension.
+     * @param stats Statistics for the chunks along the target dimension.
+     * For example, if we were iterating through rows of a matrix, `stats` would describe the chunking of the rows.
+     * @param options Further options.
+     */
+    SlabCacheAdvisor(const tatami::Oracle<Index_>& oracle, const ChunkDimensionStats<Index_>& stats, const SlabCacheAdvisorOptions& options) {
+        my_num_requests = oracle.total();
+        if (options.maximum_predictions) {
+            my_num_requests = std::min(my_num_requests, options.maximum_predictions);
+        }
+        if (my_num_requests == 0 || stats.chunk_length == 0) {
+            my_num_requests = 0;
+            return;
+        }
+
+        // Runs of requests to the same slab are extremely common and don't change the distances of other slabs,
+        // so we only need to track the time of each transition to a different slab.
+        std::size_t num_transitions = 0;
+        Index_ last_slab = 0;
+        for (tatami::PredictionIndex p = 0; p < my_num_requests; ++p) {
+            Index_ slab = oracle.get(p) / stats.chunk_length;
+            if (num_transitions == 0 || slab != last_slab) {
+                ++num_transitions;
+                last_slab = slab;
+            }
+        }
+
+        // The distance is the number of distinct slabs in between consecutive requests for the same slab,
+        // computed by tracking the time of the latest request for each slab in a Fenwick tree.
+        std::vector<std::size_t> last_time(sanisizer::cast<std::size_t>(stats.num_chunks));
+        std::vector<std::size_t> tree(num_transitions + 1);
+        auto tree_mark = [&](std::size_t pos) -> void {
+            for (; pos < tree.size(); pos += pos & (~pos + 1)) {
+                ++tree[pos];
+            }
+        };
+        auto tree_unmark = [&](std::size_t pos) -> void {
+            for (; pos < tree.size(); pos += pos & (~pos + 1)) {
+                --tree[pos];
+            }
+        };
+        auto tree_sum = [&](std::size_t pos) -> std::size_t {
+            std::size_t output = 0;
+            for (; pos > 0; pos -= pos & (~pos + 1)) {
+                output += tree[pos];
+            }
+            return output;
+        };
+
+        std::vector<tatami::PredictionIndex> histogram;
+        std::size_t time = 0; // times are 1-based so that zero means that the slab was never requested.
+
+        for (tatami::PredictionIndex p = 0; p < my_num_requests; ++p) {
+            Index_ slab = oracle.get(p) / stats.chunk_length;
+
+            // Repeated requests within a run are always hits for any non-empty cache.
+            if (time && slab == last_slab) {
+                ++my_total_hits;
+                if (histogram.empty()) {
+                    histogram.push_back(0);
+                }
+                ++histogram.front();
+                continue;
+            }
+
+            ++time;
+            auto& previous = last_time[slab];
+            if (previous) {
+                std::size_t distance = tree_sum(time - 1) - tree_sum(previous);
+                if (histogram.size() <= distance) {
+                    histogram.resize(distance + 1);
+                }
+                ++histogram[distance];
+                ++my_total_hits;
+                tree_unmark(previous);
+            } else {
+                ++my_num_distinct;
+            }
+
+            tree_mark(time);
+            previous = time;
+            last_slab = slab;
+        }
+
+        // Converting to the cumulative number of hits for each cache size.
+        my_cumulative_hits.reserve(histogram.size());
+        tatami::PredictionIndex accumulated = 0;
+        for (auto h : histogram) {
+            accumulated += h;
+            my_cumulative_hits.push_back(accumulated);
+        }
+    }
+
+private:
+    tatami::PredictionIndex my_num_requests = 0;
+    tatami::PredictionIndex my_total_hits = 0;
+    Index_ my_num_distinct = 0;
+    std::vector<tatami::PredictionIndex> my_cumulative_hits;
+
+    double to_rate(tatami::PredictionIndex hits) const {
+        return my_num_requests ? static_cast<double>(hits) / static_cast<double>(my_num_requests) : 0.0;
+    }
+
+public:
+    /**
+     * @return Number of predictions that were scanned.
+     */
+    tatami::PredictionIndex get_num_requests() const {
+        return my_num_requests;
+    }
+
+    /**
+     * @return Number of distinct slabs that were requested.
+     * A cache of this size will never need to evict a slab.
+     */
+    Index_ get_num_distinct_slabs() const {
+        return my_num_distinct;
+    }
+
+    /**
+     * @param max_slabs Maximum number of slabs in the cache.
+     * @return Proportion of requests that are hits for a cache of size `max_slabs`.
+     */
+    double get_hit_rate(Index_ max_slabs) const {
+        if (max_slabs == 0 || my_cumulative_hits.empty()) {
+            return 0;
+        }
+        std::size_t limit = std::min(sanisizer::cast<std::size_t>(max_slabs), my_cumulative_hits.size());
+        return to_rate(my_cumulative_hits[limit - 1]);
+    }
+
+    /**
+     * @return Highest possible hit rate for any cache size.
+     * This is less than 1 as the first request for each slab is always a miss.
+     */
+    double get_maximum_hit_rate() const {
+        return to_rate(my_total_hits);
+    }
+
+    /**
+     * @param target_hit_rate Target hit rate, between 0 and 1.
+     * If this is greater than `get_maximum_hit_rate()`, the maximum hit rate is used instead.
+     * @return Smallest number of slabs in the cache that achieves `target_hit_rate`.
+     * This is always at least 1 if there is at least one request, so that consecutive requests for the same slab can be served from the cache.
+     */
+    Index_ advise(double target_hit_rate) const {
+        if (my_num_requests == 0) {
+            return 0;
+        }
+
+        // Hits are integers, so we round up the target; the small tolerance protects against round-off when the target is one of our own hit rates.
+        auto target_hits = std::ceil(target_hit_rate * static_cast<double>(my_num_requests) - 1e-8);
+        auto it = std::lower_bound(my_cumulative_hits.begin(), my_cumulative_hits.end(), target_hits, [](tatami::PredictionIndex hits, double target) -> bool {
+            return static_cast<double>(hits) < target;
+        });
+        return finalize_advice(it);
+    }
+
+    /**
+     * @param max_slabs Maximum number of slabs in the cache.
+     * @return Smallest number of slabs in the cache that achieves the same hit rate as a cache of size `max_slabs`.
+     * This is no greater than `max_slabs`.
+     * It is always at least 1 if there is at least one request and `max_slabs` is positive.
+     */
+    Index_ shrink(Index_ max_slabs) const {
+        if (my_num_requests == 0 || max_slabs == 0) {
+            return 0;
+        }
+        if (my_cumulative_hits.empty()) {
+            return 1;
+        }
+        std::size_t limit = std::min(sanisizer::cast<std::size_t>(max_slabs), my_cumulative_hits.size());
+        auto it = std::lower_bound(my_cumulative_hits.begin(), my_cumulative_hits.begin() + limit, my_cumulative_hits[limit - 1]);
+        return finalize_advice(it);
+    }
+
+private:
+    template<class Iterator_>
+    Index_ finalize_advice(Iterator_ it) const {
+        if (it == my_cumulative_hits.end()) {
+            return std::max(sanisizer::cast<Index_>(my_cumulative_hits.size()), static_cast<Index_>(1));
+        }
+        return sanisizer::cast<Index_>(it - my_cumulative_hits.begin()) + 1;
+    }
+};
+
+}
+
+#endif
@@ -0,0 +1,151 @@
+#ifndef TATAMI_CHUNKED_SLAB_CACHE_COUNTERS_HPP
+#define TATAMI_CHUNKED_SLAB_CACHE_COUNTERS_HPP
+
+#include <chrono>
+#include <type_traits>
+#include <cstdint>
+#include <cstddef>
+
+/**
+ * @file SlabCacheCounters.hpp
+ * @brief Counters for slab cache activity.
+ */
+
+namespace tatami_chunked {
+
+/**
+ * @brief Counters for slab cache activity.
+ *
+ * These counters are recorded by `LruSlabCache`, `OracularSlabCache` and friends when their `record_counters_` template parameter is `true`.
+ * They are intended to guide the choice of cache size for a dataset and access pattern, e.g., via `CustomDenseChunkedMatrixOptions::maximum_cache_size`.
+ */
+struct SlabCacheCounters {
+    /**
+     * Number of requests that were served by a slab that was already in the cache.
+     * For the oracle-aware caches, this includes requests for slabs that were prefetched in an earlier populate cycle.
+     */
+    std::size_t hits = 0;
+
+    /**
+     * Number of requests that required a call to `populate()` before they could be served.
+     * For `LruSlabCache`, this is the same as `slabs_populated`;
+     * for the oracle-aware caches, this is the number of populate cycles that were triggered by a request.
+     */
+    std::size_t misses = 0;
+
+    /**
+     * Number of slabs that were removed from the cache.
+     * For `LruSlabCache`, this is the number of slabs that were evicted to make room for other slabs;
+     * for the oracle-aware caches, this is the number of slabs that were not carried over into the next populate cycle.
+     */
+    std::size_t evictions = 0;
+
+    /**
+     * Number of calls to `populate()`.
+     */
+    std::size_t populate_calls = 0;
+
+    /**
+     * Total number of slabs that were populated across all calls to `populate()`.
+     */
+    std::size_t slabs_populated = 0;
+
+    /**
+     * Number of slabs that were carried over from one populate cycle to the next without being re-populated.
+     * This is always zero for `LruSlabCache`.
+     */
+    std::size_t slabs_reused = 0;
+
+    /**
+     * Total time spent in `populate()`, in nanoseconds.
+     * For `OracularAsyncSlabCache`, this includes the time spent in the background thread.
+     */
+    std::uint64_t populate_nanoseconds = 0;
+
+    /**
+     * @return Average number of slabs populated in each call to `populate()`.
+     */
+    double slabs_per_populate() const {
+        return populate_calls ? static_cast<double>(slabs_populated) / static_cast<double>(populate_calls) : 0.0;
+    }
+
+    /**
+     * @return Proportion of requests that were hits.
+     */
+    double hit_rate() const {
+        auto total = hits + misses;
+        return total ? static_cast<double>(hits) / static_cast<double>(total) : 0.0;
+    }
+
+    /**
+     * @param other Counters to be added to this object, e.g., from another extractor.
+     * @return Reference to this object after adding `other`.
+     */
+    SlabCacheCounters& operator+=(const SlabCacheCounters& other) {
+        hits += other.hits;
+        misses += other.misses;
+        evictions += other.evictions;
+        populate_calls += other.populate_calls;
+        slabs_populated += other.slabs_populated;
+        slabs_reused += other.slabs_reused;
+        populate_nanoseconds += other.populate_nanoseconds;
+        return *this;
+    }
+};
+
+/**
+ * @brief Interface for reporting slab cache counters.
+ *
+ * Extractors created by `CustomDenseChunkedMatrix` and `CustomSparseChunkedMatrix` implement this interface if `record_cache_counters = true` in their options.
+ * Callers can then `dynamic_cast` the extractor to a `SlabCacheCountersReporter` to obtain the counters for its cache.
+ * Note that this interface is not available for sparse extractors from a `CustomDenseChunkedMatrix`,
+ * as these are created by wrapping a dense extractor with **tatami**'s sparsified extractors.
+ */
+class SlabCacheCountersReporter {
+public:
+    /**
+     * @cond
+     */
+    virtual ~SlabCacheCountersReporter() = default;
+    /**
+     * @endcond
+     */
+
+    /**
+     * @return Counters for the cache used by this extractor.
+     * All counters are zero if the extractor does not use a cache, i.e., the cache cannot hold a single slab.
+     */
+    virtual SlabCacheCounters get_slab_cache_counters() const = 0;
+};
+
+/**
+ * @cond
+ */
+// Using a bool as a placeholder when counters are not recorded, so that nothing needs to be stored or updated.
+template<bool record_counters_>
+using MaybeSlabCacheCounters = typename std::conditional<record_counters_, SlabCacheCounters, bool>::type;
+
+template<bool record_counters_, class Function_>
+void record_populate(MaybeSlabCacheCounters<record_counters_>& counters, std::size_t num_slabs, Function_ fun) {
+    if constexpr(record_counters_) {
+        auto start = std::chrono::steady_clock::now();
+        fun();
+        counters.populate_nanoseconds += std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start).count();
+        ++counters.populate_calls;
+        counters.slabs_populated += num_slabs;
+    } else {
+        fun();
+    }
+}
+
+struct NoSlabCacheCountersReporter {};
+
+template<bool record_counters_>
+using MaybeSlabCacheCountersReporter = typename std::conditional<record_counters_, SlabCacheCountersReporter, NoSlabCacheCountersReporter>::type;
+/**
+ * @endcond
+ */
+
+}
+
+#endif
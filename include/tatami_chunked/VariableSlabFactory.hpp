@@ -0,0 +1,422 @@
+#ifndef TATAMI_CHUNKED_VARIABLE_SLAB_FACTORY_HPP
+#define TATAMI_CHUNKED_VARIABLE_SLAB_FACTORY_HPP
+
+#include "utils.hpp"
+
+#include <vector>
+#include <algorithm>
+#include <utility>
+#include <cstddef>
+
+#include "sanisizer/sanisizer.hpp"
+
+/**
+ * @file VariableSlabFactory.hpp
+ * @brief Arena-backed factories for variable-size slabs.
+ */
+
+namespace tatami_chunked {
+
+/**
+ * @cond
+ */
+namespace VariableSlabFactory_internal {
+
+// Moving a run of 'n' elements to 'dest', which is always at or before 'src' in the same pool (or in a different pool).
+template<typename Type_, typename Count_>
+Type_* move_run(Type_* src, Count_ n, Type_* dest) {
+    if (src != dest) {
+        std::copy(src, src + n, dest);
+    }
+    return dest;
+}
+
+// Sorting the reused slabs by their position in the arena, so that compaction only ever moves contents towards the start of the arena.
+template<typename Id_, typename SlabIndex_, class Slab_, class Start_>
+void sort_by_start(std::vector<std::pair<Id_, SlabIndex_> >& to_reuse, const std::vector<Slab_>& all_slabs, Start_ start) {
+    std::sort(to_reuse.begin(), to_reuse.end(), [&](const std::pair<Id_, SlabIndex_>& left, const std::pair<Id_, SlabIndex_>& right) -> bool {
+        return start(all_slabs[left.second]) < start(all_slabs[right.second]);
+    });
+}
+
+}
+/**
+ * @endcond
+ */
+
+/**
+ * @brief Arena-backed factory for variable-size dense slabs.
+ *
+ * @tparam Value_ Type of the data in each slab.
+ * @tparam Size_ Integer type for the slab sizes, in terms of the number of data elements.
+ * This should be the same as the `Size_` used in the `OracularVariableSlabCache`.
+ *
+ * This class is intended to be used with an `OracularVariableSlabCache`.
+ * It allocates a single arena of `max_size` elements and carves out each slab from that arena in `allocate()`, which should be called at the start of each `populate()` cycle.
+ * Slabs that are re-used from the previous cycle are compacted towards the start of the arena based on their actual sizes,
+ * and each new slab receives the remaining space according to its upper size.
+ * This guarantees that the memory usage is no greater than `max_size` elements (unless a single slab is larger than `max_size`),
+ * while avoiding a separate heap allocation for each slab.
+ */
+template<typename Value_, typename Size_>
+class DenseVariableSlabFactory {
+public:
+    /**
+     * @param max_size Maximum total size of all slabs, in terms of the number of data elements.
+     * This should be the same as the `max_size` used in the `OracularVariableSlabCache` constructor.
+     */
+    DenseVariableSlabFactory(Size_ max_size) : my_pool(sanisizer::cast<I<decltype(my_pool.size())> >(max_size)) {}
+
+    /**
+     * @cond
+     */
+    // Delete the copy constructors as we're passing out pointers.
+    DenseVariableSlabFactory(const DenseVariableSlabFactory&) = delete;
+    DenseVariableSlabFactory& operator=(const DenseVariableSlabFactory&) = delete;
+
+    // Move constructors are okay though.
+    DenseVariableSlabFactory(DenseVariableSlabFactory&&) = default;
+    DenseVariableSlabFactory& operator=(DenseVariableSlabFactory&&) = default;
+    /**
+     * @endcond
+     */
+
+private:
+    std::vector<Value_> my_pool;
+
+public:
+    /**
+     * @brief Variable-size dense slab.
+     */
+    struct Slab {
+        /**
+         * Pointer to a buffer with `size` addressable data elements.
+         * This is only valid after `allocate()` is called on the slab.
+         */
+        Value_* data = NULL;
+
+        /**
+         * Size of the slab, in terms of the number of data elements.
+         * After `allocate()`, this is set to the upper size of a newly populated slab.
+         * Callers may reduce this to the actual size of the slab after populating its contents, so that only the actual size is retained upon compaction.
+         */
+        Size_ size = 0;
+    };
+
+    /**
+     * @return A new slab with no memory.
+     * This should be used in the `create` function of `OracularVariableSlabCache::next()`.
+     */
+    Slab create() const {
+        return Slab();
+    }
+
+    /**
+     * Allocate memory for all slabs in the next populate cycle of the `OracularVariableSlabCache`.
+     * This should be called inside the `populate` function of `OracularVariableSlabCache::next()`, before any of the slabs in `to_populate` are filled.
+     *
+     * @tparam Id_ Type of the slab identifier.
+     * @tparam SlabIndex_ Integer type of the slab index.
+     * @tparam Upper_ Function to compute the upper size of a slab.
+     *
+     * @param to_populate Slabs to be populated, as supplied to the `populate` function.
+     * @param to_reuse Slabs to be re-used, as supplied to the `populate` function.
+     * This may be re-ordered by this method.
+     * @param all_slabs All slabs in the cache, as supplied to the `populate` function.
+     * @param upper_size Function that accepts an `Id_` and returns the upper size of the corresponding slab.
+     * This should be the same as the `upper_size` function used in `OracularVariableSlabCache::next()`.
+     *
+     * For each slab in `to_reuse`, the contents are retained but may be moved to a different position in the arena.
+     * For each slab in `to_populate`, `Slab::data` is set to an address with `upper_size()` elements and `Slab::size` is set to `upper_size()`.
+     * Pointers to the contents of any other slabs are invalidated.
+     */
+    template<typename Id_, typename SlabIndex_, class Upper_>
+    void allocate(
+        const std::vector<std::pair<Id_, SlabIndex_> >& to_populate,
+        std::vector<std::pair<Id_, SlabIndex_> >& to_reuse,
+        std::vector<Slab>& all_slabs,
+        Upper_ upper_size)
+    {
+        typedef I<decltype(my_pool.size())> PoolSize;
+        PoolSize required = 0;
+        for (const auto& r : to_reuse) {
+            required = sanisizer::sum<PoolSize>(required, all_slabs[r.second].size);
+        }
+        for (const auto& p : to_populate) {
+            required = sanisizer::sum<PoolSize>(required, upper_size(p.first));
+        }
+
+        // Only reallocating if a single slab exceeds the arena, e.g., if the cache was requested to be smaller than a slab.
+        std::vector<Value_> replacement;
+        auto pool_ptr = my_pool.data();
+        if (required > my_pool.size()) {
+            replacement.resize(required);
+            pool_ptr = replacement.data();
+        }
+
+        VariableSlabFactory_internal::sort_by_start(to_reuse, all_slabs, [](const Slab& slab) -> const Value_* { return slab.data; });
+        PoolSize position = 0;
+        for (const auto& r : to_reuse) {
+            auto& slab = all_slabs[r.second];
+            slab.data = VariableSlabFactory_internal::move_run(slab.data, slab.size, pool_ptr + position);
+            position += slab.size;
+        }
+
+        for (const auto& p : to_populate) {
+            auto& slab = all_slabs[p.second];
+            slab.size = upper_size(p.first);
+            slab.data = pool_ptr + position;
+            position += slab.size;
+        }
+
+        if (!replacement.empty()) {
+            my_pool.swap(replacement);
+        }
+    }
+
+    /**
+     * @return Number of data elements in the arena.
+     */
+    std::size_t capacity() const {
+        return my_pool.size();
+    }
+};
+
+/**
+ * @brief Arena-backed factory for variable-size sparse slabs.
+ *
+ * @tparam Value_ Type of the data in each slab.
+ * @tparam Index_ Integer type of the dimension extent and the type of the indices in each slab.
+ * @tparam Size_ Integer type for the slab sizes, in terms of the number of structural non-zeros.
+ * This should be the same as the `Size_` used in the `OracularVariableSlabCache`.
+ * @tparam Count_ Integer type for counting structural non-zeros.
+ * This should be large enough to store the extent of the non-target dimension of the slab.
+ *
+ * This class is intended to be used with an `OracularVariableSlabCache`, where the size of each slab is defined as its number of structural non-zeros.
+ * It allocates two arenas (for values and indices) of `max_size` elements and carves out each slab from those arenas in `allocate()`, which should be called at the start of each `populate()` cycle.
+ * Each newly populated slab receives `capacity` elements of each arena for each element of the target dimension.
+ * Once a slab is re-used in a subsequent cycle, its contents are compacted so that each element of the target dimension only occupies `Slab::number` elements of each arena.
+ * This allows the cache to hold more slabs when they contain fewer non-zeros, while guaranteeing that the memory usage is no greater than `max_size` elements of each type
+ * (unless a single slab is larger than `max_size`) and avoiding a separate heap allocation for each slab.
+ *
+ * Slabs have the same layout as those from `SparseSlabFactory`, so they can be used interchangeably in code that fills or reads slabs.
+ */
+template<typename Value_, typename Index_, typename Size_, typename Count_ = Index_>
+class SparseVariableSlabFactory {
+public:
+    /**
+     * @param target_dim Extent of the target dimension of each slab.
+     * @param max_size Maximum total number of structural non-zeros across all slabs.
+     * This should be the same as the `max_size` used in the `OracularVariableSlabCache` constructor.
+     * @param needs_value Whether the values of the structural non-zeros should be cached.
+     * @param needs_index Whether the indices of the structural non-zeros should be cached.
+     */
+    SparseVariableSlabFactory(Index_ target_dim, Size_ max_size, bool needs_value, bool needs_index) :
+        my_target_dim(target_dim),
+        my_needs_value(needs_value),
+        my_needs_index(needs_index)
+    {
+        if (needs_value) {
+            my_value_pool.resize(sanisizer::cast<I<decltype(my_value_pool.size())> >(max_size));
+        }
+        if (needs_index) {
+            my_index_pool.resize(sanisizer::cast<I<decltype(my_index_pool.size())> >(max_size));
+        }
+    }
+
+    /**
+     * @cond
+     */
+    // Delete the copy constructors as we're passing out pointers.
+    SparseVariableSlabFactory(const SparseVariableSlabFactory&) = delete;
+    SparseVariableSlabFactory& operator=(const SparseVariableSlabFactory&) = delete;
+
+    // Move constructors are okay though.
+    SparseVariableSlabFactory(SparseVariableSlabFactory&&) = default;
+    SparseVariableSlabFactory& operator=(SparseVariableSlabFactory&&) = default;
+    /**
+     * @endcond
+     */
+
+private:
+    Index_ my_target_dim;
+    bool my_needs_value, my_needs_index;
+    std::vector<Value_> my_value_pool;
+    std::vector<Index_> my_index_pool;
+
+    // Each slab's counts are allocated separately, as we don't know the maximum number of slabs in advance.
+    // This is fine as the counts are small and only allocated once per slab in create(), not in each populate cycle.
+    std::vector<std::vector<Count_> > my_number_pools;
+
+public:
+    /**
+     * @brief Variable-size sparse slab.
+     */
+    struct Slab {
+        /**
+         * Vector of pointers of length equal to `target_dim`.
+         * Each pointer corresponds to an element of the target dimension of the slab,
+         * and refers to an array with `capacity` addressable elements after `allocate()` is called.
+         * Each pointer should be used to store the values of the structural non-zeros for that dimension element.
+         *
+         * Alternatively, this vector may be empty if `needs_value = false` in the `SparseVariableSlabFactory` constructor.
+         */
+        std::vector<Value_*> values;
+
+        /**
+         * Vector of pointers of length equal to `target_dim`.
+         * Each pointer corresponds to an element of the target dimension of the slab,
+         * and refers to an array with `capacity` addressable elements after `allocate()` is called.
+         * Each pointer should be used to store the indices of the structural non-zeros for that dimension element.
+         *
+         * Alternatively, this vector may be empty if `needs_index = false` in the `SparseVariableSlabFactory` constructor.
+         */
+        std::vector<Index_*> indices;
+
+        /**
+         * Pointer to an array with `target_dim` addressable elements.
+         * Each value stores the number of non-zero elements for each element of the target dimension of the slab,
+         * i.e., the number of entries that are filled in the corresponding arrays of `values` and `indices`.
+         * On creation, all entries of this array are set to zero.
+         */
+        Count_* number = NULL;
+    };
+
+    /**
+     * @return A new slab with no memory for its values or indices.
+     * This should be used in the `create` function of `OracularVariableSlabCache::next()`.
+     */
+    Slab create() {
+        Slab output;
+        my_number_pools.emplace_back(my_target_dim);
+        output.number = my_number_pools.back().data();
+        if (my_needs_value) {
+            output.values.resize(my_target_dim);
+        }
+        if (my_needs_index) {
+            output.indices.resize(my_target_dim);
+        }
+        return output;
+    }
+
+    /**
+     * @param slab A populated slab.
+     * @return Actual size of the slab, i.e., the total number of structural non-zeros.
+     * This can be used in the `actual_size` function of `OracularVariableSlabCache::next()`.
+     */
+    Size_ actual_size(const Slab& slab) const {
+        Size_ total = 0;
+        for (Index_ p = 0; p < my_target_dim; ++p) {
+            total += slab.number[p];
+        }
+        return total;
+    }
+
+    /**
+     * Allocate memory for all slabs in the next populate cycle of the `OracularVariableSlabCache`.
+     * This should be called inside the `populate` function of `OracularVariableSlabCache::next()`, before any of the slabs in `to_populate` are filled.
+     *
+     * @tparam Id_ Type of the slab identifier.
+     * @tparam SlabIndex_ Integer type of the slab index.
+     * @tparam Capacity_ Function to compute the capacity of a slab.
+     *
+     * @param to_populate Slabs to be populated, as supplied to the `populate` function.
+     * @param to_reuse Slabs to be re-used, as supplied to the `populate` function.
+     * This may be re-ordered by this method.
+     * @param all_slabs All slabs in the cache, as supplied to the `populate` function.
+     * @param capacity Function that accepts an `Id_` and returns the maximum number of structural non-zeros for any element of the target dimension in the corresponding slab, as a `Count_`.
+     * The product of `target_dim` and the capacity should be equal to the `upper_size` of the slab in `OracularVariableSlabCache::next()`.
+     *
+     * For each slab in `to_reuse`, the contents are retained but may be moved to a different position in the arenas.
+     * For each slab in `to_populate`, each pointer in `Slab::values` and `Slab::indices` refers to an array with `capacity()` addressable elements, and all entries of `Slab::number` are set to zero.
+     * Pointers to the contents of any other slabs are invalidated.
+     */
+    template<typename Id_, typename SlabIndex_, class Capacity_>
+    void allocate(
+        const std::vector<std::pair<Id_, SlabIndex_> >& to_populate,
+        std::vector<std::pair<Id_, SlabIndex_> >& to_reuse,
+        std::vector<Slab>& all_slabs,
+        Capacity_ capacity)
+    {
+        typedef I<decltype(my_value_pool.size())> PoolSize;
+        PoolSize required = 0;
+        for (const auto& r : to_reuse) {
+            required = sanisizer::sum<PoolSize>(required, actual_size(all_slabs[r.second]));
+        }
+        for (const auto& p : to_populate) {
+            required = sanisizer::sum<PoolSize>(required, sanisizer::product<PoolSize>(my_target_dim, capacity(p.first)));
+        }
+
+        // Only reallocating if a single slab exceeds the arena, e.g., if the cache was requested to be smaller than a slab.
+        std::vector<Value_> value_replacement;
+        std::vector<Index_> index_replacement;
+        auto vpool_ptr = my_value_pool.data();
+        auto ipool_ptr = my_index_pool.data();
+        if (my_needs_value && required > my_value_pool.size()) {
+            value_replacement.resize(required);
+            vpool_ptr = value_replacement.data();
+        }
+        if (my_needs_index && required > my_index_pool.size()) {
+            index_replacement.resize(required);
+            ipool_ptr = index_replacement.data();
+        }
+
+        // Within each slab, the target dimension elements are always laid out in increasing order,
+        // so sorting by the first element is enough to ensure that we only move contents towards the start of the arena.
+        if (my_target_dim == 0) {
+            ; // no contents to move.
+        } else if (my_needs_value) {
+            VariableSlabFactory_internal::sort_by_start(to_reuse, all_slabs, [&](const Slab& slab) -> const Value_* { return slab.values.front(); });
+        } else if (my_needs_index) {
+            VariableSlabFactory_internal::sort_by_start(to_reuse, all_slabs, [&](const Slab& slab) -> const Index_* { return slab.indices.front(); });
+        }
+
+        PoolSize position = 0;
+        for (const auto& r : to_reuse) {
+            auto& slab = all_slabs[r.second];
+            for (Index_ p = 0; p < my_target_dim; ++p) {
+                auto num = slab.number[p];
+                if (my_needs_value) {
+                    slab.values[p] = VariableSlabFactory_internal::move_run(slab.values[p], num, vpool_ptr + position);
+                }
+                if (my_needs_index) {
+                    slab.indices[p] = VariableSlabFactory_internal::move_run(slab.indices[p], num, ipool_ptr + position);
+                }
+                position += num;
+            }
+        }
+
+        for (const auto& pop : to_populate) {
+            auto& slab = all_slabs[pop.second];
+            auto cap = capacity(pop.first);
+            for (Index_ p = 0; p < my_target_dim; ++p) {
+                if (my_needs_value) {
+                    slab.values[p] = vpool_ptr + position;
+                }
+                if (my_needs_index) {
+                    slab.indices[p] = ipool_ptr + position;
+                }
+                position += cap;
+            }
+            std::fill_n(slab.number, my_target_dim, 0);
+        }
+
+        if (!value_replacement.empty()) {
+            my_value_pool.swap(value_replacement);
+        }
+        if (!index_replacement.empty()) {
+            my_index_pool.swap(index_replacement);
+        }
+    }
+
+    /**
+     * @return Number of structural non-zeros that can be stored in each arena.
+     */
+    std::size_t capacity() const {
+        return std::max(my_value_pool.size(), my_index_pool.size());
+    }
+};
+
+}
+
+#endif
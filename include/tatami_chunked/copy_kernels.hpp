@@ -0,0 +1,139 @@
+#ifndef TATAMI_CHUNKED_COPY_KERNELS_HPP
+#define TATAMI_CHUNKED_COPY_KERNELS_HPP
+
+#include <algorithm>
+#include <type_traits>
+#include <cstdint>
+#include <cstddef>
+
+// Explicit x86 kernels are compiled with function-level target attributes and selected at runtime,
+// so no special compiler flags are required and the scalar fallback is always available.
+// Users can define TATAMI_CHUNKED_NO_SIMD to only use the scalar fallback.
+#if !defined(TATAMI_CHUNKED_NO_SIMD) && (defined(__GNUC__) || defined(__clang__)) && (defined(__x86_64__) || defined(__i386__))
+#define TATAMI_CHUNKED_X86_SIMD
+#include <immintrin.h>
+#endif
+
+/**
+ * @cond
+ */
+namespace tatami_chunked {
+
+// Instruction sets for the copy kernels, in increasing order of width.
+enum class SimdLevel : char { NONE, AVX2, AVX512 };
+
+inline SimdLevel get_simd_level() {
+#ifdef TATAMI_CHUNKED_X86_SIMD
+    static const SimdLevel level = []() -> SimdLevel {
+        __builtin_cpu_init();
+        if (__builtin_cpu_supports("avx512f")) {
+            return SimdLevel::AVX512;
+        } else if (__builtin_cpu_supports("avx2")) {
+            return SimdLevel::AVX2;
+        } else {
+            return SimdLevel::NONE;
+        }
+    }();
+    return level;
+#else
+    return SimdLevel::NONE;
+#endif
+}
+
+namespace copy_kernels_internal {
+
+template<typename Type_>
+constexpr bool is_int32 = std::is_integral<Type_>::value && std::is_signed<Type_>::value && sizeof(Type_) == 4;
+
+#ifdef TATAMI_CHUNKED_X86_SIMD
+
+// We use the masked variants of the intrinsics with an all-ones mask and a zeroed source,
+// as the unmasked variants trigger spurious -Wmaybe-uninitialized warnings in some GCC versions.
+
+/*** Conversions to double ***/
+
+__attribute__((target("avx2"))) inline void convert_avx2(const float* src, std::size_t n, double* dest) {
+    std::size_t i = 0;
+    for (; i + 8 <= n; i += 8) {
+        _mm256_storeu_pd(dest + i, _mm256_cvtps_pd(_mm_loadu_ps(src + i)));
+        _mm256_storeu_pd(dest + i + 4, _mm256_cvtps_pd(_mm_loadu_ps(src + i + 4)));
+    }
+    for (; i < n; ++i) {
+        dest[i] = src[i];
+    }
+}
+
+__attribute__((target("avx2"))) inline void convert_avx2(const std::int32_t* src, std::size_t n, double* dest) {
+    std::size_t i = 0;
+    for (; i + 8 <= n; i += 8) {
+        _mm256_storeu_pd(dest + i, _mm256_cvtepi32_pd(_mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i))));
+        _mm256_storeu_pd(dest + i + 4, _mm256_cvtepi32_pd(_mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i + 4))));
+    }
+    for (; i < n; ++i) {
+        dest[i] = src[i];
+    }
+}
+
+__attribute__((target("avx512f"))) inline void convert_avx512(const float* src, std::size_t n, double* dest) {
+    std::size_t i = 0;
+    for (; i + 16 <= n; i += 16) {
+        _mm512_storeu_pd(dest + i, _mm512_maskz_cvtps_pd(0xFF, _mm256_loadu_ps(src + i)));
+        _mm512_storeu_pd(dest + i + 8, _mm512_maskz_cvtps_pd(0xFF, _mm256_loadu_ps(src + i + 8)));
+    }
+    for (; i < n; ++i) {
+        dest[i] = src[i];
+    }
+}
+
+__attribute__((target("avx512f"))) inline void convert_avx512(const std::int32_t* src, std::size_t n, double* dest) {
+    std::size_t i = 0;
+    for (; i + 16 <= n; i += 16) {
+        _mm512_storeu_pd(dest + i, _mm512_maskz_cvtepi32_pd(0xFF, _mm256_loadu_si256(reinterpret_cast<const __m256i*>(src + i))));
+        _mm512_storeu_pd(dest + i + 8, _mm512_maskz_cvtepi32_pd(0xFF, _mm256_loadu_si256(reinterpret_cast<const __m256i*>(src + i + 8))));
+    }
+    for (; i < n; ++i) {
+        dest[i] = src[i];
+    }
+}
+
+#endif
+
+}
+
+// Copy 'n' values from 'src' to 'dest', converting from In_ to Out_.
+// This uses explicit SIMD kernels for the common conversions of float or 32-bit integer chunks to double-precision output;
+// all other conversions use std::copy_n, which is already a memmove for identical types and is auto-vectorized by the compiler for most others.
+template<typename In_, typename Out_>
+void convert_copy_n(const In_* src, std::size_t n, Out_* dest, [[maybe_unused]] SimdLevel level = get_simd_level()) {
+#ifdef TATAMI_CHUNKED_X86_SIMD
+    if constexpr(std::is_same<Out_, double>::value && (std::is_same<In_, float>::value || copy_kernels_internal::is_int32<In_>)) {
+        typedef typename std::conditional<std::is_same<In_, float>::value, float, std::int32_t>::type Cast;
+        auto cast_src = reinterpret_cast<const Cast*>(src);
+        if (level == SimdLevel::AVX512) {
+            copy_kernels_internal::convert_avx512(cast_src, n, dest);
+            return;
+        } else if (level == SimdLevel::AVX2) {
+            copy_kernels_internal::convert_avx2(cast_src, n, dest);
+            return;
+        }
+    }
+#endif
+    std::copy_n(src, n, dest);
+}
+
+// Set 'dest[i] = src[indices[i]]' for 'i' in [0, n).
+// We deliberately avoid the hardware gather instructions, as their gain over this scalar loop is small
+// and they are subject to microcode mitigations (e.g., for Gather Data Sampling) that can make them much slower.
+template<typename Value_, typename Index_>
+void gather_copy_n(const Value_* src, const Index_* indices, std::size_t n, Value_* dest) {
+    for (std::size_t i = 0; i < n; ++i) {
+        dest[i] = src[indices[i]];
+    }
+}
+
+}
+/**
+ * @endcond
+ */
+
+#endif
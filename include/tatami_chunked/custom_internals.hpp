@@ -6,13 +6,18 @@
 #include "SparseSlabFactory.hpp"
 #include "OracularSlabCache.hpp"
 #include "OracularSubsettedSlabCache.hpp"
+#include "OracularAsyncSlabCache.hpp"
+#include "OracularBeladySlabCache.hpp"
 #include "ChunkDimensionStats.hpp"
+#include "SlabCacheStats.hpp"
+#include "SlabCacheAdvisor.hpp"
 #include "utils.hpp"
 
 #include <vector>
 #include <type_traits>
 #include <algorithm>
 #include <tuple>
+#include <cstddef>
 
 #include "sanisizer/sanisizer.hpp"
 
@@ -20,6 +25,50 @@ namespace tatami_chunked {
 
 namespace CustomChunkedMatrix_internal {
 
+/*************************
+ *** Oracular variants ***
+ *************************/
+
+// Choice of cache to use when an oracle is available.
+// VARIABLE is only used for sparse matrices, where the slabs are sized by their number of non-zeros.
+// COMPACT is only used for sparse matrices with a CompactSparseSlabFactory, and also applies to myopic extraction with an LRU cache.
+enum class OracularMode : char { REGULAR, SUBSETTED, ASYNC, BELADY, VARIABLE, COMPACT };
+
+// Compact slabs (see CompactSparseSlabFactory) are extracted into a padded buffer and then copied into their own storage.
+template<class Slab_, typename = void>
+struct IsCompactSlab : std::false_type {};
+
+template<class Slab_>
+struct IsCompactSlab<Slab_, std::void_t<decltype(Slab_::pointers)> > : std::true_type {};
+
+// Slab identifiers are always chunk indices less than the number of chunks on the target dimension, so we can use direct lookups.
+template<OracularMode oracular_mode_, typename Index_, class Slab_, bool record_counters_>
+using OracularCache = typename std::conditional<oracular_mode_ == OracularMode::SUBSETTED,
+      OracularSubsettedSlabCache<Index_, Index_, Slab_, true, record_counters_>,
+      typename std::conditional<oracular_mode_ == OracularMode::ASYNC,
+          OracularAsyncSlabCache<Index_, Index_, Slab_, true, record_counters_>,
+          typename std::conditional<oracular_mode_ == OracularMode::BELADY,
+              OracularBeladySlabCache<Index_, Index_, Slab_, true, record_counters_>,
+              OracularSlabCache<Index_, Index_, Slab_, false, true, record_counters_>
+          >::type
+      >::type
+>::type;
+
+// Only the Belady cache scans ahead of the current populate cycle, so its lookahead is bounded to limit memory usage.
+template<OracularMode oracular_mode_, typename Index_, class Slab_, bool record_counters_>
+OracularCache<oracular_mode_, Index_, Slab_, record_counters_> create_oracular_cache(
+    std::shared_ptr<const tatami::Oracle<Index_> > oracle,
+    Index_ max_slabs,
+    Index_ num_ids,
+    [[maybe_unused]] tatami::PredictionIndex belady_max_lookahead)
+{
+    if constexpr(oracular_mode_ == OracularMode::BELADY) {
+        return OracularCache<oracular_mode_, Index_, Slab_, record_counters_>(std::move(oracle), max_slabs, num_ids, belady_max_lookahead);
+    } else {
+        return OracularCache<oracular_mode_, Index_, Slab_, record_counters_>(std::move(oracle), max_slabs, num_ids);
+    }
+}
+
 /******************
  *** Workspaces ***
  ******************/
@@ -85,15 +134,53 @@ public:
 template<bool sparse_, class ChunkValue_, typename Index_> 
 class ChunkCoordinator {
 public:
-    ChunkCoordinator(ChunkDimensionStats<Index_> row_stats, ChunkDimensionStats<Index_> col_stats) :
+    ChunkCoordinator(
+        ChunkDimensionStats<Index_> row_stats,
+        ChunkDimensionStats<Index_> col_stats,
+        std::vector<std::size_t> chunk_nonzeros = std::vector<std::size_t>(),
+        tatami::PredictionIndex belady_max_lookahead = 0
+    ) :
         my_row_stats(std::move(row_stats)),
-        my_col_stats(std::move(col_stats))
-    {}
+        my_col_stats(std::move(col_stats)),
+        my_chunk_nonzeros(std::move(chunk_nonzeros)),
+        my_belady_max_lookahead(belady_max_lookahead)
+    {
+        if (!my_chunk_nonzeros.empty()) {
+            my_max_row_slab_nonzeros = compute_max_slab_nonzeros(true);
+            my_max_column_slab_nonzeros = compute_max_slab_nonzeros(false);
+        }
+    }
 
 private:
     ChunkDimensionStats<Index_> my_row_stats;
     ChunkDimensionStats<Index_> my_col_stats;
 
+    // Number of non-zeros (or an upper bound) in each chunk, in row-major order of the chunk grid.
+    // This is empty if the counts are not available.
+    std::vector<std::size_t> my_chunk_nonzeros;
+
+    // Stored here so that all oracular cores can access it when constructing an OracularBeladySlabCache.
+    tatami::PredictionIndex my_belady_max_lookahead;
+
+    // Largest number of non-zeros (or an upper bound) across all chunks of any row/column slab.
+    // Only used if the counts are available.
+    std::size_t my_max_row_slab_nonzeros = 0;
+    std::size_t my_max_column_slab_nonzeros = 0;
+
+    std::size_t compute_max_slab_nonzeros(bool row) const {
+        std::size_t output = 0;
+        Index_ num_target_chunks = get_target_num_chunks(row);
+        Index_ num_non_target_chunks = (row ? my_col_stats.num_chunks : my_row_stats.num_chunks);
+        for (Index_ i = 0; i < num_target_chunks; ++i) {
+            std::size_t current = 0;
+            for (Index_ j = 0; j < num_non_target_chunks; ++j) {
+                current += get_chunk_nonzeros(row, i, j);
+            }
+            output = std::max(output, current);
+        }
+        return output;
+    }
+
 public:
     // Number of chunks along the rows is equal to the number of chunks for
     // each column, and vice versa; hence the flipped definitions.
@@ -130,6 +217,14 @@ public:
         }
     }
 
+    Index_ get_target_num_chunks(bool row) const {
+        if (row) {
+            return my_row_stats.num_chunks;
+        } else {
+            return my_col_stats.num_chunks;
+        }
+    }
+
     Index_ get_target_chunkdim(bool row) const {
         if (row) {
             return my_row_stats.chunk_length;
@@ -151,6 +246,56 @@ public:
         return get_chunk_length(row ? my_row_stats : my_col_stats, chunk_id);
     }
 
+    tatami::PredictionIndex get_belady_max_lookahead() const {
+        return my_belady_max_lookahead;
+    }
+
+    bool has_chunk_nonzeros() const {
+        return !my_chunk_nonzeros.empty();
+    }
+
+    std::size_t get_chunk_nonzeros(bool row, Index_ target_chunk_id, Index_ non_target_chunk_id) const {
+        if (row) {
+            return my_chunk_nonzeros[static_cast<std::size_t>(target_chunk_id) * static_cast<std::size_t>(my_col_stats.num_chunks) + static_cast<std::size_t>(non_target_chunk_id)];
+        } else {
+            return my_chunk_nonzeros[static_cast<std::size_t>(non_target_chunk_id) * static_cast<std::size_t>(my_col_stats.num_chunks) + static_cast<std::size_t>(target_chunk_id)];
+        }
+    }
+
+    // Only valid if has_chunk_nonzeros() is true.
+    std::size_t get_max_slab_nonzeros(bool row) const {
+        return (row ? my_max_row_slab_nonzeros : my_max_column_slab_nonzeros);
+    }
+
+    // Chunks with no non-zeros are skipped without calling the workspace's extract() method,
+    // which is safe as the slab's counts have already been zeroed before extraction.
+    bool is_empty_chunk(Index_ chunk_row_id, Index_ chunk_column_id) const {
+        return !my_chunk_nonzeros.empty() && my_chunk_nonzeros[static_cast<std::size_t>(chunk_row_id) * static_cast<std::size_t>(my_col_stats.num_chunks) + static_cast<std::size_t>(chunk_column_id)] == 0;
+    }
+
+    // Maximum number of non-zeros for any element of the target dimension in a slab, given the number of requested elements in each non-target chunk.
+    // Each element can contain no more non-zeros from a chunk than the chunk itself, or than the number of requested elements in that chunk.
+    Index_ get_slab_capacity(bool row, Index_ target_chunk_id, const std::vector<Index_>& non_target_overlaps) const {
+        Index_ capacity = 0;
+        Index_ num_non_target_chunks = non_target_overlaps.size();
+        for (Index_ j = 0; j < num_non_target_chunks; ++j) {
+            auto overlap = non_target_overlaps[j];
+            if (overlap) {
+                capacity += static_cast<Index_>(std::min(static_cast<std::size_t>(overlap), get_chunk_nonzeros(row, target_chunk_id, j)));
+            }
+        }
+        return capacity;
+    }
+
+    // Shrinking the cache to the smallest number of slabs that achieves the same hit rate for the oracle's predictions.
+    // The advisor only considers the hit rate, so we keep at least 'min_slabs' to preserve any prefetching, parallel or batched population across slabs.
+    void shrink_slab_cache(bool row, const tatami::Oracle<Index_>& oracle, Index_ min_slabs, SlabCacheStats<Index_>& stats) const {
+        if (stats.max_slabs_in_cache > min_slabs) {
+            SlabCacheAdvisor<Index_> advisor(oracle, row ? my_row_stats : my_col_stats, SlabCacheAdvisorOptions());
+            stats.max_slabs_in_cache = std::max(advisor.shrink(stats.max_slabs_in_cache), min_slabs);
+        }
+    }
+
 private:
     template<class ExtractFunction_>
     void extract_non_target_block(
@@ -177,7 +322,9 @@ private:
             // No need to protect against a zero length, as it should be impossible
             // here (otherwise, start_chunk_index == end_chunk_index and we'd never iterate).
             if constexpr(sparse_) {
-                extract(row_id, col_id, from, len, non_target_start_pos);
+                if (!is_empty_chunk(row_id, col_id)) {
+                    extract(row_id, col_id, from, len, non_target_start_pos);
+                }
             } else {
                 extract(row_id, col_id, from, len);
             }
@@ -205,14 +352,21 @@ private:
             Index_ non_target_start_pos = non_target_chunk_id * non_target_chunkdim;
             Index_ non_target_end_pos = std::min(non_target_dim - non_target_start_pos, non_target_chunkdim) + non_target_start_pos; // this convoluted method avoids overflow.
 
+            auto row_id = (row ? target_chunk_id : non_target_chunk_id);
+            auto col_id = (row ? non_target_chunk_id : target_chunk_id);
+            if constexpr(sparse_) {
+                if (is_empty_chunk(row_id, col_id)) {
+                    iIt = std::lower_bound(iIt, iEnd, non_target_end_pos);
+                    continue;
+                }
+            }
+
             chunk_indices_buffer.clear();
             do {
                 chunk_indices_buffer.push_back(*iIt - non_target_start_pos);
                 ++iIt;
             } while (iIt != iEnd && *iIt < non_target_end_pos);
 
-            auto row_id = (row ? target_chunk_id : non_target_chunk_id);
-            auto col_id = (row ? non_target_chunk_id : target_chunk_id);
             if constexpr(sparse_) {
                 extract(row_id, col_id, chunk_indices_buffer, non_target_start_pos);
             } else {
@@ -285,6 +439,22 @@ public:
 
         } else {
             auto final_slab_ptr = final_slab.data;
+
+            // Writing directly into the final slab if the workspace supports it, otherwise we go through a temporary buffer.
+            if (chunk_workspace.supports_extract_single()) {
+                extract_non_target_block(
+                    row,
+                    target_chunk_id,
+                    non_target_block_start,
+                    non_target_block_length, 
+                    [&](Index_ row_id, Index_ column_id, Index_ from, Index_ len) -> void {
+                        chunk_workspace.extract_single(row_id, column_id, row, target_chunk_offset, from, len, final_slab_ptr);
+                        final_slab_ptr += len;
+                    }
+                );
+                return std::make_pair(&final_slab, static_cast<Index_>(0));
+            }
+
             auto tmp_buffer_ptr = tmp_work.data();
             typedef I<decltype(tmp_work.size())> Size;
 
@@ -376,6 +546,21 @@ public:
 
         } else {
             auto final_slab_ptr = final_slab.data;
+
+            if (chunk_workspace.supports_extract_single()) {
+                extract_non_target_index(
+                    row,
+                    target_chunk_id,
+                    non_target_indices,
+                    chunk_indices_buffer,
+                    [&](Index_ row_id, Index_ column_id, const std::vector<Index_>& chunk_indices) -> void {
+                        chunk_workspace.extract_single(row_id, column_id, row, target_chunk_offset, chunk_indices, final_slab_ptr);
+                        final_slab_ptr += chunk_indices.size();
+                    }
+                );
+                return std::make_pair(&final_slab, static_cast<Index_>(0));
+            }
+
             auto tmp_buffer_ptr = tmp_work.data();
             typedef I<decltype(tmp_work.size())> Size;
 
@@ -407,9 +592,24 @@ public:
         return std::make_pair(&final_slab, static_cast<Index_>(0));
     }
 
+    // Extract all elements of the target dimension in a single chunk, using a contiguous block on the non_target dimension.
+    template<class ChunkWorkspace_, class Request_>
+    void fetch_whole_slab(
+        bool row,
+        Index_ target_chunk_id,
+        Index_ non_target_block_start, 
+        Index_ non_target_block_length, 
+        Slab& slab, 
+        ChunkWorkspace_& chunk_workspace,
+        std::vector<Request_>& request_buffer)
+    const {
+        fetch_block(row, target_chunk_id, static_cast<Index_>(0), get_target_chunkdim(row, target_chunk_id), non_target_block_start, non_target_block_length, slab, chunk_workspace, &request_buffer);
+    }
+
 private:
     // Extract a contiguous block of the target dimension, using a contiguous block on the non_target dimension.
-    template<class ChunkWorkspace_>
+    // For dense chunks, 'request_buffer' should point to a buffer for the requests to extract_many(), which is re-used across calls.
+    template<class ChunkWorkspace_, class Slab_, class Request_ = std::nullptr_t>
     void fetch_block(
         bool row,
         Index_ target_chunk_id, 
@@ -417,8 +617,9 @@ private:
         Index_ target_chunk_length, 
         Index_ non_target_block_start, 
         Index_ non_target_block_length, 
-        Slab& slab, 
-        ChunkWorkspace_& chunk_workspace)
+        Slab_& slab, 
+        ChunkWorkspace_& chunk_workspace,
+        [[maybe_unused]] std::vector<Request_>* request_buffer = NULL)
     const {
         if constexpr(sparse_) {
             std::fill_n(slab.number, get_target_chunkdim(row), 0);
@@ -446,33 +647,50 @@ private:
             );
 
         } else {
-            auto slab_ptr = slab.data;
-
-            extract_non_target_block(
-                row,
-                target_chunk_id,
-                non_target_block_start,
-                non_target_block_length, 
-                [&](Index_ row_id, Index_ column_id, Index_ from, Index_ len) -> void {
-                    chunk_workspace.extract(
-                        row_id,
-                        column_id,
-                        row,
-                        target_chunk_offset,
-                        target_chunk_length,
-                        from,
-                        len,
-                        slab_ptr,
-                        non_target_block_length
-                    );
-                    slab_ptr += len;
-                }
-            );
+            auto& requests = *request_buffer;
+            requests.clear();
+            add_block_requests(row, target_chunk_id, target_chunk_offset, target_chunk_length, non_target_block_start, non_target_block_length, slab.data, requests);
+            if (!requests.empty()) {
+                chunk_workspace.extract_many(row, requests);
+            }
         }
     }
 
+    // Add a request for each chunk that is needed to fill a dense slab with a contiguous block of the target dimension and a contiguous block on the non_target dimension.
+    template<class Request_>
+    void add_block_requests(
+        bool row,
+        Index_ target_chunk_id, 
+        Index_ target_chunk_offset, 
+        Index_ target_chunk_length, 
+        Index_ non_target_block_start, 
+        Index_ non_target_block_length, 
+        ChunkValue_* slab_ptr,
+        std::vector<Request_>& requests)
+    const {
+        extract_non_target_block(
+            row,
+            target_chunk_id,
+            non_target_block_start,
+            non_target_block_length, 
+            [&](Index_ row_id, Index_ column_id, Index_ from, Index_ len) -> void {
+                Request_ req;
+                req.chunk_row_id = row_id;
+                req.chunk_column_id = column_id;
+                req.target_start = target_chunk_offset;
+                req.target_length = target_chunk_length;
+                req.non_target_start = from;
+                req.non_target_length = len;
+                req.output = slab_ptr;
+                req.stride = non_target_block_length;
+                requests.push_back(req);
+                slab_ptr += len;
+            }
+        );
+    }
+
     // Extract a contiguous block of the target dimension, using an indexed subset on the non_target dimension.
-    template<class ChunkWorkspace_>
+    template<class ChunkWorkspace_, class Slab_>
     void fetch_block(
         bool row,
         Index_ target_chunk_id, 
@@ -480,7 +698,7 @@ private:
         Index_ target_chunk_length, 
         const std::vector<Index_>& non_target_indices, 
         std::vector<Index_>& chunk_indices_buffer,
-        Slab& slab, 
+        Slab_& slab, 
         ChunkWorkspace_& chunk_workspace)
     const {
         if constexpr(sparse_) {
@@ -650,116 +868,338 @@ private:
 
 public:
     // Obtain the slab containing the 'i'-th element of the target dimension.
-    template<class ChunkWorkspace_, class Cache_, class Factory_>
-    std::pair<const Slab*, Index_> fetch_myopic(
+    // 'request_buffer' is only required for dense chunks, see fetch_block().
+    template<class ChunkWorkspace_, class Cache_, class Factory_, class Request_ = std::nullptr_t>
+    std::pair<const typename Factory_::Slab*, Index_> fetch_myopic(
         bool row,
         Index_ i, 
         Index_ block_start,
         Index_ block_length,
         ChunkWorkspace_& chunk_workspace,
         Cache_& cache,
-        Factory_& factory)
+        Factory_& factory,
+        std::vector<Request_>* request_buffer = NULL)
     const {
         Index_ target_chunkdim = get_target_chunkdim(row);
         Index_ target_chunk_id = i / target_chunkdim;
         Index_ target_chunk_offset = i % target_chunkdim;
         auto& out = cache.find(
             target_chunk_id,
-            /* create = */ [&]() -> Slab {
+            /* create = */ [&]() -> typename Factory_::Slab {
                 return factory.create();
             },
-            /* populate = */ [&](Index_ id, Slab& slab) -> void {
-                fetch_block(row, id, 0, get_target_chunkdim(row, id), block_start, block_length, slab, chunk_workspace);
+            /* populate = */ [&](Index_ id, typename Factory_::Slab& slab) -> void {
+                fill_slab(factory, slab, []() -> Index_ { return 0; }, [&](auto& target) -> void {
+                    fetch_block(row, id, 0, get_target_chunkdim(row, id), block_start, block_length, target, chunk_workspace, request_buffer);
+                });
             }
         );
         return std::make_pair(&out, target_chunk_offset);
     }
 
-    template<class ChunkWorkspace_, class Cache_, class Factory_>
-    std::pair<const Slab*, Index_> fetch_myopic(
+    // 'request_buffer' is ignored as indexed extraction does not use extract_many(), but we accept it for consistency with the block overload.
+    template<class ChunkWorkspace_, class Cache_, class Factory_, class Request_ = std::nullptr_t>
+    std::pair<const typename Factory_::Slab*, Index_> fetch_myopic(
         bool row,
         Index_ i, 
         const std::vector<Index_>& indices,
         std::vector<Index_>& tmp_indices,
         ChunkWorkspace_& chunk_workspace,
         Cache_& cache,
-        Factory_& factory)
+        Factory_& factory,
+        [[maybe_unused]] std::vector<Request_>* request_buffer = NULL)
     const {
         Index_ target_chunkdim = get_target_chunkdim(row);
         Index_ target_chunk_id = i / target_chunkdim;
         Index_ target_chunk_offset = i % target_chunkdim;
         auto& out = cache.find(
             target_chunk_id,
-            /* create = */ [&]() -> Slab {
+            /* create = */ [&]() -> typename Factory_::Slab {
                 return factory.create();
             },
-            /* populate = */ [&](Index_ id, Slab& slab) -> void {
-                fetch_block(row, id, 0, get_target_chunkdim(row, id), indices, tmp_indices, slab, chunk_workspace);
+            /* populate = */ [&](Index_ id, typename Factory_::Slab& slab) -> void {
+                fill_slab(factory, slab, []() -> Index_ { return 0; }, [&](auto& target) -> void {
+                    fetch_block(row, id, 0, get_target_chunkdim(row, id), indices, tmp_indices, target, chunk_workspace);
+                });
             }
         );
         return std::make_pair(&out, target_chunk_offset);
     }
 
+private:
+    // Populate each slab in 'to_populate' with 'fun', spreading the slabs across threads if multiple workspaces are available.
+    // Each thread gets its own workspace and its own buffer for the chunk indices.
+    template<class Entry_, class WorkspacePtr_, class Function_>
+    static void populate_parallel(
+        std::vector<Entry_>& to_populate,
+        std::vector<WorkspacePtr_>& chunk_workspaces,
+        std::vector<Index_>& chunk_indices_buffer,
+        Function_ fun)
+    {
+        auto num_populate = to_populate.size();
+        auto num_threads = chunk_workspaces.size();
+        if (num_threads <= 1 || num_populate <= 1) {
+            for (auto& p : to_populate) {
+                fun(p, *(chunk_workspaces.front()), chunk_indices_buffer);
+            }
+            return;
+        }
+
+        num_threads = std::min(num_threads, num_populate);
+        std::vector<std::vector<Index_> > extra_buffers(num_threads - 1);
+        tatami::parallelize([&](int t, I<decltype(num_populate)> start, I<decltype(num_populate)> length) -> void {
+            auto& buffer = (t == 0 ? chunk_indices_buffer : extra_buffers[t - 1]);
+            auto& workspace = *(chunk_workspaces[t]);
+            for (I<decltype(num_populate)> i = start, end = start + length; i < end; ++i) {
+                fun(to_populate[i], workspace, buffer);
+            }
+        }, num_populate, static_cast<int>(num_threads)); // cast is safe as num_threads is no greater than the requested number of threads.
+    }
+
+    // Fill a slab via 'fill', which should accept the slab (or the factory's buffer for compact slabs) and extract the relevant contents into it.
+    // 'thread' should return the index of the workspace used for extraction, to choose the buffer for compact slabs.
+    template<class Factory_, class Thread_, class Fill_>
+    static void fill_slab(Factory_& factory, typename Factory_::Slab& slab, Thread_ thread, Fill_ fill) {
+        if constexpr(IsCompactSlab<typename Factory_::Slab>::value) {
+            auto& buffer = factory.get_buffer(thread());
+            fill(buffer);
+            factory.compact(buffer, slab);
+        } else {
+            fill(slab);
+        }
+    }
+
+    template<class WorkspacePtr_, class ChunkWorkspace_>
+    static Index_ find_workspace(const std::vector<WorkspacePtr_>& chunk_workspaces, const ChunkWorkspace_& chunk_workspace) {
+        Index_ t = 0;
+        while (&*(chunk_workspaces[t]) != &chunk_workspace) {
+            ++t;
+        }
+        return t;
+    }
+
+    // Choose the request buffer that is paired with 'chunk_workspace', if any buffers were supplied.
+    template<class WorkspacePtr_, class ChunkWorkspace_, class Request_>
+    static std::vector<Request_>* find_request_buffer(
+        const std::vector<WorkspacePtr_>& chunk_workspaces,
+        const ChunkWorkspace_& chunk_workspace,
+        std::vector<std::vector<Request_> >* request_buffers)
+    {
+        if (request_buffers == NULL) {
+            return NULL;
+        }
+        return &((*request_buffers)[find_workspace(chunk_workspaces, chunk_workspace)]);
+    }
+
 public:
-    template<class ChunkWorkspace_, class Cache_, class Factory_>
-    std::pair<const Slab*, Index_> fetch_oracular(
+    // 'request_buffers' is only required for dense chunks and should contain one buffer for each entry of 'chunk_workspaces', see fetch_block().
+    template<class WorkspacePtr_, class Cache_, class Factory_, class Request_ = std::nullptr_t>
+    std::pair<const typename Factory_::Slab*, Index_> fetch_oracular(
         bool row,
         Index_ block_start,
         Index_ block_length,
-        ChunkWorkspace_& chunk_workspace,
+        std::vector<WorkspacePtr_>& chunk_workspaces,
         Cache_& cache,
-        Factory_& factory)
+        Factory_& factory,
+        std::vector<std::vector<Request_> >* request_buffers = NULL)
     const {
         Index_ target_chunkdim = get_target_chunkdim(row);
         return cache.next(
             /* identify = */ [&](Index_ i) -> std::pair<Index_, Index_> {
                 return std::pair<Index_, Index_>(i / target_chunkdim, i % target_chunkdim);
             },
-            /* create = */ [&]() -> Slab {
+            /* create = */ [&]() -> typename Factory_::Slab {
                 return factory.create();
             },
-            /* populate =*/ [&](std::vector<std::pair<Index_, Slab*> >& to_populate) -> void {
-                for (auto& p : to_populate) {
-                    fetch_block(row, p.first, 0, get_target_chunkdim(row, p.first), block_start, block_length, *(p.second), chunk_workspace);
+            // Capturing by value as this may be called after we return, see OracularAsyncSlabCache.
+            /* populate =*/ [this,row,block_start,block_length,wrks=&chunk_workspaces,fac=&factory,reqs=request_buffers](std::vector<std::pair<Index_, typename Factory_::Slab*> >& to_populate) -> void {
+                if constexpr(!sparse_) {
+                    // Without parallelization, we can extract the chunks for all slabs in a single call.
+                    if (wrks->size() <= 1) {
+                        auto& chunk_workspace = *(wrks->front());
+                        auto& requests = reqs->front();
+                        requests.clear();
+                        for (const auto& p : to_populate) {
+                            add_block_requests(row, p.first, 0, get_target_chunkdim(row, p.first), block_start, block_length, p.second->data, requests);
+                        }
+                        if (!requests.empty()) {
+                            chunk_workspace.extract_many(row, requests);
+                        }
+                        return;
+                    }
                 }
+
+                std::vector<Index_> unused;
+                populate_parallel(to_populate, *wrks, unused, [&](std::pair<Index_, typename Factory_::Slab*>& p, auto& chunk_workspace, std::vector<Index_>&) -> void {
+                    fill_slab(*fac, *(p.second), [&]() -> Index_ { return find_workspace(*wrks, chunk_workspace); }, [&](auto& target) -> void {
+                        fetch_block(row, p.first, 0, get_target_chunkdim(row, p.first), block_start, block_length, target, chunk_workspace, find_request_buffer(*wrks, chunk_workspace, reqs));
+                    });
+                });
             }
         );
     }
 
-    template<class ChunkWorkspace_, class Cache_, class Factory_>
-    std::pair<const Slab*, Index_> fetch_oracular(
+    // 'request_buffers' is ignored, see the comments for fetch_myopic().
+    template<class WorkspacePtr_, class Cache_, class Factory_, class Request_ = std::nullptr_t>
+    std::pair<const typename Factory_::Slab*, Index_> fetch_oracular(
         bool row,
         const std::vector<Index_>& indices,
         std::vector<Index_>& chunk_indices_buffer,
-        ChunkWorkspace_& chunk_workspace,
+        std::vector<WorkspacePtr_>& chunk_workspaces,
         Cache_& cache,
-        Factory_& factory)
+        Factory_& factory,
+        [[maybe_unused]] std::vector<std::vector<Request_> >* request_buffers = NULL)
     const {
         Index_ target_chunkdim = get_target_chunkdim(row);
         return cache.next(
             /* identify = */ [&](Index_ i) -> std::pair<Index_, Index_> {
                 return std::pair<Index_, Index_>(i / target_chunkdim, i % target_chunkdim);
             },
-            /* create = */ [&]() -> Slab {
+            /* create = */ [&]() -> typename Factory_::Slab {
                 return factory.create();
             },
-            /* populate =*/ [&](std::vector<std::pair<Index_, Slab*> >& to_populate) -> void {
-                for (auto& p : to_populate) {
-                    fetch_block(row, p.first, 0, get_target_chunkdim(row, p.first), indices, chunk_indices_buffer, *(p.second), chunk_workspace);
+            // Capturing by value as this may be called after we return, see OracularAsyncSlabCache.
+            /* populate =*/ [this,row,idx=&indices,buffer=&chunk_indices_buffer,wrks=&chunk_workspaces,fac=&factory](std::vector<std::pair<Index_, typename Factory_::Slab*> >& to_populate) -> void {
+                populate_parallel(to_populate, *wrks, *buffer, [&](std::pair<Index_, typename Factory_::Slab*>& p, auto& chunk_workspace, std::vector<Index_>& chunk_indices) -> void {
+                    fill_slab(*fac, *(p.second), [&]() -> Index_ { return find_workspace(*wrks, chunk_workspace); }, [&](auto& target) -> void {
+                        fetch_block(row, p.first, 0, get_target_chunkdim(row, p.first), *idx, chunk_indices, target, chunk_workspace);
+                    });
+                });
+            }
+        );
+    }
+
+public:
+    // Variable-size slabs, where the size of each slab is defined as its number of structural non-zeros.
+    // Each new slab is allocated with enough space for the entire non-target block in each element of the target dimension,
+    // or for the number of non-zeros in the overlapping chunks if the per-chunk counts are available;
+    // this is compacted to the actual number of non-zeros by the factory if the slab is re-used in a later populate cycle.
+    template<class WorkspacePtr_, class Cache_, class Factory_>
+    std::pair<const typename Factory_::Slab*, Index_> fetch_oracular_variable(
+        bool row,
+        Index_ block_start,
+        Index_ block_length,
+        std::vector<WorkspacePtr_>& chunk_workspaces,
+        Cache_& cache,
+        Factory_& factory)
+    const {
+        return fetch_oracular_variable_internal(
+            row,
+            block_length,
+            chunk_workspaces,
+            cache,
+            factory,
+            [&](Index_ id, typename Factory_::Slab& slab, auto& chunk_workspace, std::vector<Index_>&) -> void {
+                fetch_block(row, id, 0, get_target_chunkdim(row, id), block_start, block_length, slab, chunk_workspace);
+            },
+            [&](std::vector<Index_>& overlaps) -> void {
+                if (block_length) {
+                    Index_ non_target_chunkdim = get_non_target_chunkdim(row);
+                    Index_ block_end = block_start + block_length;
+                    for (Index_ j = block_start / non_target_chunkdim; j < static_cast<Index_>(overlaps.size()); ++j) {
+                        Index_ chunk_start = j * non_target_chunkdim;
+                        if (chunk_start >= block_end) {
+                            break;
+                        }
+                        Index_ chunk_end = chunk_start + std::min(non_target_chunkdim, static_cast<Index_>(block_end - chunk_start));
+                        overlaps[j] = chunk_end - std::max(chunk_start, block_start);
+                    }
                 }
             }
         );
     }
 
+    template<class WorkspacePtr_, class Cache_, class Factory_>
+    std::pair<const typename Factory_::Slab*, Index_> fetch_oracular_variable(
+        bool row,
+        const std::vector<Index_>& indices,
+        std::vector<Index_>& chunk_indices_buffer,
+        std::vector<WorkspacePtr_>& chunk_workspaces,
+        Cache_& cache,
+        Factory_& factory)
+    const {
+        return fetch_oracular_variable_internal(
+            row,
+            static_cast<Index_>(indices.size()),
+            chunk_workspaces,
+            cache,
+            factory,
+            [&](Index_ id, typename Factory_::Slab& slab, auto& chunk_workspace, std::vector<Index_>& chunk_indices) -> void {
+                fetch_block(row, id, 0, get_target_chunkdim(row, id), indices, chunk_indices, slab, chunk_workspace);
+            },
+            [&](std::vector<Index_>& overlaps) -> void {
+                Index_ non_target_chunkdim = get_non_target_chunkdim(row);
+                for (auto x : indices) {
+                    ++overlaps[x / non_target_chunkdim];
+                }
+            },
+            &chunk_indices_buffer
+        );
+    }
+
+private:
+    template<class WorkspacePtr_, class Cache_, class Factory_, class Fetch_, class Overlap_>
+    std::pair<const typename Factory_::Slab*, Index_> fetch_oracular_variable_internal(
+        bool row,
+        Index_ non_target_length,
+        std::vector<WorkspacePtr_>& chunk_workspaces,
+        Cache_& cache,
+        Factory_& factory,
+        Fetch_ fetch,
+        Overlap_ overlap,
+        std::vector<Index_>* chunk_indices_buffer = NULL)
+    const {
+        typedef typename Factory_::Slab VariableSlab;
+        Index_ target_chunkdim = get_target_chunkdim(row);
+
+        // If the per-chunk counts are available, the capacity is tightened to the number of non-zeros in the overlapping chunks.
+        // The overlaps are only computed when the cache actually needs the slab sizes, i.e., at the start of each populate cycle.
+        std::vector<Index_> overlaps;
+        auto capacity = [&](Index_ id) -> Index_ {
+            if (!has_chunk_nonzeros()) {
+                return non_target_length;
+            }
+            if (overlaps.empty()) {
+                overlaps.resize(row ? my_col_stats.num_chunks : my_row_stats.num_chunks);
+                overlap(overlaps);
+            }
+            return get_slab_capacity(row, id, overlaps);
+        };
+
+        return cache.next(
+            /* identify = */ [&](Index_ i) -> std::pair<Index_, Index_> {
+                return std::pair<Index_, Index_>(i / target_chunkdim, i % target_chunkdim);
+            },
+            /* upper_size = */ [&](Index_ id) -> std::size_t {
+                return sanisizer::product_unsafe<std::size_t>(target_chunkdim, capacity(id)); // already checked when computing the SlabCacheStats.
+            },
+            /* actual_size = */ [&](Index_, const VariableSlab& slab) -> std::size_t {
+                return factory.actual_size(slab);
+            },
+            /* create = */ [&]() -> VariableSlab {
+                return factory.create();
+            },
+            /* populate = */ [&](auto& to_populate, auto& to_reuse, std::vector<VariableSlab>& all_slabs) -> void {
+                factory.allocate(to_populate, to_reuse, all_slabs, capacity);
+                std::vector<Index_> unused;
+                populate_parallel(to_populate, chunk_workspaces, (chunk_indices_buffer ? *chunk_indices_buffer : unused), [&](const auto& p, auto& chunk_workspace, std::vector<Index_>& chunk_indices) -> void {
+                    fetch(p.first, all_slabs[p.second], chunk_workspace, chunk_indices);
+                });
+            }
+        );
+    }
+
 public:
-    template<class ChunkWorkspace_, class Cache_, class Factory_>
+    // 'request_buffers' is only required for dense chunks, see fetch_oracular().
+    template<class WorkspacePtr_, class Cache_, class Factory_, class Request_ = std::nullptr_t>
     std::pair<const Slab*, Index_> fetch_oracular_subsetted(
         bool row,
         Index_ block_start,
         Index_ block_length,
-        ChunkWorkspace_& chunk_workspace,
+        std::vector<WorkspacePtr_>& chunk_workspaces,
         Cache_& cache,
-        Factory_& factory)
+        Factory_& factory,
+        std::vector<std::vector<Request_> >* request_buffers = NULL)
     const {
         Index_ target_chunkdim = get_target_chunkdim(row);
         return cache.next(
@@ -770,34 +1210,37 @@ public:
                 return factory.create();
             },
             /* populate =*/ [&](std::vector<std::tuple<Index_, Slab*, const OracularSubsettedSlabCacheSelectionDetails<Index_>*> >& in_need) -> void {
-                for (const auto& p : in_need) {
+                std::vector<Index_> unused;
+                populate_parallel(in_need, chunk_workspaces, unused, [&](const auto& p, auto& chunk_workspace, std::vector<Index_>&) -> void {
                     auto id = std::get<0>(p);
                     auto ptr = std::get<1>(p);
                     auto sub = std::get<2>(p);
                     switch (sub->selection) {
                         case OracularSubsettedSlabCacheSelectionType::FULL:
-                            fetch_block(row, id, 0, get_target_chunkdim(row, id), block_start, block_length, *ptr, chunk_workspace);
+                            fetch_block(row, id, 0, get_target_chunkdim(row, id), block_start, block_length, *ptr, chunk_workspace, find_request_buffer(chunk_workspaces, chunk_workspace, request_buffers));
                             break;
                         case OracularSubsettedSlabCacheSelectionType::BLOCK:
-                            fetch_block(row, id, sub->block_start, sub->block_length, block_start, block_length, *ptr, chunk_workspace);
+                            fetch_block(row, id, sub->block_start, sub->block_length, block_start, block_length, *ptr, chunk_workspace, find_request_buffer(chunk_workspaces, chunk_workspace, request_buffers));
                             break;
                         case OracularSubsettedSlabCacheSelectionType::INDEX:
                             fetch_index(row, id, sub->indices, block_start, block_length, *ptr, chunk_workspace);
                             break;
                     }
-                }
+                });
             }
         );
     }
 
-    template<class ChunkWorkspace_, class Cache_, class Factory_>
+    // 'request_buffers' is ignored, see the comments for fetch_myopic().
+    template<class WorkspacePtr_, class Cache_, class Factory_, class Request_ = std::nullptr_t>
     std::pair<const Slab*, Index_> fetch_oracular_subsetted(
         bool row,
         const std::vector<Index_>& indices,
         std::vector<Index_>& chunk_indices_buffer,
-        ChunkWorkspace_& chunk_workspace,
+        std::vector<WorkspacePtr_>& chunk_workspaces,
         Cache_& cache,
-        Factory_& factory)
+        Factory_& factory,
+        [[maybe_unused]] std::vector<std::vector<Request_> >* request_buffers = NULL)
     const {
         Index_ target_chunkdim = get_target_chunkdim(row);
         return cache.next(
@@ -808,22 +1251,22 @@ public:
                 return factory.create();
             },
             /* populate =*/ [&](std::vector<std::tuple<Index_, Slab*, const OracularSubsettedSlabCacheSelectionDetails<Index_>*> >& in_need) -> void {
-                for (const auto& p : in_need) {
+                populate_parallel(in_need, chunk_workspaces, chunk_indices_buffer, [&](const auto& p, auto& chunk_workspace, std::vector<Index_>& chunk_indices) -> void {
                     auto id = std::get<0>(p);
                     auto ptr = std::get<1>(p);
                     auto sub = std::get<2>(p);
                     switch (sub->selection) {
                         case OracularSubsettedSlabCacheSelectionType::FULL:
-                            fetch_block(row, id, 0, get_target_chunkdim(row, id), indices, chunk_indices_buffer, *ptr, chunk_workspace);
+                            fetch_block(row, id, 0, get_target_chunkdim(row, id), indices, chunk_indices, *ptr, chunk_workspace);
                             break;
                         case OracularSubsettedSlabCacheSelectionType::BLOCK:
-                            fetch_block(row, id, sub->block_start, sub->block_length, indices, chunk_indices_buffer, *ptr, chunk_workspace);
+                            fetch_block(row, id, sub->block_start, sub->block_length, indices, chunk_indices, *ptr, chunk_workspace);
                             break;
                         case OracularSubsettedSlabCacheSelectionType::INDEX:
-                            fetch_index(row, id, sub->indices, indices, chunk_indices_buffer, *ptr, chunk_workspace);
+                            fetch_index(row, id, sub->indices, indices, chunk_indices, *ptr, chunk_workspace);
                             break;
                     }
-                }
+                });
             }
         );
     }
@@ -0,0 +1,146 @@
+#ifndef TATAMI_CHUNKED_ID_MAP_HPP
+#define TATAMI_CHUNKED_ID_MAP_HPP
+
+#include "utils.hpp"
+
+#include <unordered_map>
+#include <vector>
+#include <utility>
+#include <type_traits>
+#include <cstddef>
+
+#include "sanisizer/sanisizer.hpp"
+
+/**
+ * @cond
+ */
+namespace tatami_chunked {
+
+// Drop-in replacement for the subset of the std::unordered_map interface used by the slab caches,
+// for use when the identifiers are known to be non-negative integers less than 'num_ids'.
+// Lookups are a single array access instead of a hash computation and bucket traversal.
+template<typename Id_, typename Value_>
+class DirectIdMap {
+public:
+    DirectIdMap(Id_ num_ids) : my_positions(sanisizer::cast<typename std::vector<Id_>::size_type>(num_ids), num_ids), my_num_ids(num_ids) {}
+
+    DirectIdMap() = default;
+
+private:
+    // Positions of each identifier in 'my_entries', or 'my_num_ids' if the identifier is absent.
+    // We can use Id_ here as the number of entries cannot exceed 'my_num_ids'.
+    std::vector<Id_> my_positions;
+    Id_ my_num_ids = 0;
+
+    typedef std::vector<std::pair<Id_, Value_> > Entries;
+    Entries my_entries;
+
+public:
+    typedef typename Entries::iterator iterator;
+    typedef typename Entries::const_iterator const_iterator;
+
+    iterator begin() {
+        return my_entries.begin();
+    }
+
+    iterator end() {
+        return my_entries.end();
+    }
+
+    const_iterator begin() const {
+        return my_entries.begin();
+    }
+
+    const_iterator end() const {
+        return my_entries.end();
+    }
+
+    auto size() const {
+        return my_entries.size();
+    }
+
+    bool empty() const {
+        return my_entries.empty();
+    }
+
+    template<typename Size_>
+    void reserve(Size_ n) {
+        my_entries.reserve(n);
+    }
+
+public:
+    iterator find(Id_ id) {
+        auto pos = my_positions[id];
+        if (pos == my_num_ids) {
+            return my_entries.end();
+        }
+        return my_entries.begin() + pos;
+    }
+
+    const_iterator find(Id_ id) const {
+        auto pos = my_positions[id];
+        if (pos == my_num_ids) {
+            return my_entries.end();
+        }
+        return my_entries.begin() + pos;
+    }
+
+    Value_& operator[](Id_ id) {
+        auto& pos = my_positions[id];
+        if (pos == my_num_ids) {
+            pos = my_entries.size(); // no need to cast, as this must be less than num_ids.
+            my_entries.emplace_back(id, Value_());
+        }
+        return my_entries[pos].second;
+    }
+
+    // Swap-and-pop, so this invalidates iterators to the last entry.
+    void erase(iterator it) {
+        my_positions[it->first] = my_num_ids;
+        auto& last = my_entries.back();
+        if (&(*it) != &last) {
+            *it = std::move(last);
+            my_positions[it->first] = it - my_entries.begin();
+        }
+        my_entries.pop_back();
+    }
+
+    void erase(Id_ id) {
+        auto it = find(id);
+        if (it != my_entries.end()) {
+            erase(it);
+        }
+    }
+
+    void clear() {
+        for (const auto& entry : my_entries) {
+            my_positions[entry.first] = my_num_ids;
+        }
+        my_entries.clear();
+    }
+
+    void swap(DirectIdMap& other) {
+        my_positions.swap(other.my_positions);
+        std::swap(my_num_ids, other.my_num_ids);
+        my_entries.swap(other.my_entries);
+    }
+};
+
+template<bool direct_, typename Id_, typename Value_>
+using IdMap = typename std::conditional<direct_, DirectIdMap<Id_, Value_>, std::unordered_map<Id_, Value_> >::type;
+
+template<bool direct_, typename Value_, typename Id_>
+IdMap<direct_, Id_, Value_> create_id_map([[maybe_unused]] Id_ num_ids) {
+    if constexpr(direct_) {
+        return DirectIdMap<Id_, Value_>(num_ids);
+    } else {
+        return IdMap<direct_, Id_, Value_>();
+    }
+}
+
+}
+/**
+ * @endcond
+ */
+
+#endif
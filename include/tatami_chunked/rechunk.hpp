@@ -0,0 +1,245 @@
+#ifndef TATAMI_CHUNKED_RECHUNK_HPP
+#define TATAMI_CHUNKED_RECHUNK_HPP
+
+#include "ChunkDimensionStats.hpp"
+
+#include <vector>
+#include <memory>
+#include <stdexcept>
+#include <algorithm>
+#include <type_traits>
+#include <cstddef>
+
+#include "tatami/tatami.hpp"
+#include "sanisizer/sanisizer.hpp"
+
+/**
+ * @file rechunk.hpp
+ * @brief Stream a matrix into chunks.
+ */
+
+namespace tatami_chunked {
+
+/**
+ * @cond
+ */
+namespace rechunk_internal {
+
+template<typename Index_>
+void check_chunk_dimensions(Index_ NR, Index_ NC, Index_ chunk_nrow, Index_ chunk_ncol) {
+    if ((NR > 0 && chunk_nrow <= 0) || (NC > 0 && chunk_ncol <= 0)) {
+        throw std::runtime_error("chunk dimensions should be positive for a non-empty matrix");
+    }
+}
+
+}
+/**
+ * @endcond
+ */
+
+/**
+ * @brief Options for `rechunk_dense()`.
+ */
+struct RechunkDenseOptions {
+    /**
+     * Whether to visit the chunks in row-major order of the chunk grid, i.e., all chunks in the first row of the grid, then all chunks in the second row, and so on.
+     * If `true`, the matrix is read in strips of `chunk_nrow` consecutive rows; otherwise, it is read in strips of `chunk_ncol` consecutive columns.
+     * Setting this to `false` may be more efficient if the input matrix prefers column access.
+     */
+    bool row_major_chunks = true;
+
+    /**
+     * Whether the contents of each chunk should be stored in row-major order.
+     * If `false`, the contents are stored in column-major order.
+     */
+    bool row_major_contents = true;
+};
+
+/**
+ * Stream the contents of a `tatami::Matrix` into dense chunks.
+ * The matrix is read in strips that span a single row (or column) of the chunk grid, so only one strip needs to be held in memory at any time.
+ * Each strip is extracted with a `tatami::ConsecutiveOracle` so that the input matrix can optimize its own data retrieval, e.g., by caching or prefetching.
+ *
+ * @tparam ChunkValue_ Numeric type of the data values in each chunk.
+ * @tparam Value_ Numeric type of the matrix values.
+ * @tparam Index_ Integer type of the row/column indices.
+ * @tparam Function_ Function to be called on each chunk.
+ *
+ * @param matrix Matrix to be rechunked.
+ * @param chunk_nrow Number of rows in each chunk.
+ * This should be positive if `matrix` has a non-zero number of rows.
+ * @param chunk_ncol Number of columns in each chunk.
+ * This should be positive if `matrix` has a non-zero number of columns.
+ * @param fun Function that accepts `(Index_ chunk_row_id, Index_ chunk_column_id, const ChunkValue_* contents)`,
+ * where `contents` points to an array of length `chunk_nrow * chunk_ncol` containing the contents of the chunk at `(chunk_row_id, chunk_column_id)` in the chunk grid.
+ * Chunks at the edges of the matrix are padded with zeros.
+ * `contents` is only valid for the duration of each call.
+ * @param options Further options.
+ */
+template<typename ChunkValue_, typename Value_, typename Index_, class Function_>
+void rechunk_dense(const tatami::Matrix<Value_, Index_>& matrix, Index_ chunk_nrow, Index_ chunk_ncol, Function_ fun, const RechunkDenseOptions& options) {
+    Index_ NR = matrix.nrow(), NC = matrix.ncol();
+    rechunk_internal::check_chunk_dimensions(NR, NC, chunk_nrow, chunk_ncol);
+
+    bool by_row = options.row_major_chunks;
+    ChunkDimensionStats<Index_> band_stats(by_row ? NR : NC, by_row ? chunk_nrow : chunk_ncol);
+    ChunkDimensionStats<Index_> other_stats(by_row ? NC : NR, by_row ? chunk_ncol : chunk_nrow);
+    Index_ other_dim = other_stats.dimension_extent;
+
+    // Values are converted to ChunkValue_ as soon as they are extracted, to reduce memory usage when ChunkValue_ is smaller than Value_.
+    std::vector<ChunkValue_> strip(sanisizer::product<typename std::vector<ChunkValue_>::size_type>(band_stats.chunk_length, other_dim));
+    std::vector<Value_> buffer;
+    if constexpr(!std::is_same<Value_, ChunkValue_>::value) {
+        buffer.resize(other_dim);
+    }
+    std::vector<ChunkValue_> chunk(sanisizer::product<typename std::vector<ChunkValue_>::size_type>(chunk_nrow, chunk_ncol));
+    auto ext = matrix.dense(by_row, std::make_shared<tatami::ConsecutiveOracle<Index_> >(0, band_stats.dimension_extent), tatami::Options());
+
+    for (Index_ b = 0; b < band_stats.num_chunks; ++b) {
+        Index_ band_length = get_chunk_length(band_stats, b);
+        for (Index_ t = 0; t < band_length; ++t) {
+            auto dest = strip.data() + sanisizer::product_unsafe<std::size_t>(t, other_dim);
+            if constexpr(std::is_same<Value_, ChunkValue_>::value) {
+                auto ptr = ext->fetch(dest);
+                tatami::copy_n(ptr, other_dim, dest);
+            } else {
+                auto ptr = ext->fetch(buffer.data());
+                std::copy_n(ptr, other_dim, dest);
+            }
+        }
+
+        for (Index_ k = 0; k < other_stats.num_chunks; ++k) {
+            std::fill(chunk.begin(), chunk.end(), 0);
+            Index_ other_start = k * other_stats.chunk_length;
+            Index_ other_length = get_chunk_length(other_stats, k);
+
+            for (Index_ t = 0; t < band_length; ++t) {
+                auto src = strip.data() + sanisizer::product_unsafe<std::size_t>(t, other_dim) + static_cast<std::size_t>(other_start);
+                for (Index_ u = 0; u < other_length; ++u) {
+                    std::size_t r = (by_row ? t : u), c = (by_row ? u : t);
+                    std::size_t offset = (options.row_major_contents ? r * static_cast<std::size_t>(chunk_ncol) + c : c * static_cast<std::size_t>(chunk_nrow) + r);
+                    chunk[offset] = src[u];
+                }
+            }
+
+            if (by_row) {
+                fun(b, k, static_cast<const ChunkValue_*>(chunk.data()));
+            } else {
+                fun(k, b, static_cast<const ChunkValue_*>(chunk.data()));
+            }
+        }
+    }
+}
+
+/**
+ * @brief Options for `rechunk_sparse()`.
+ */
+struct RechunkSparseOptions {
+    /**
+     * Whether to visit the chunks in row-major order of the chunk grid, see `RechunkDenseOptions::row_major_chunks` for details.
+     */
+    bool row_major_chunks = true;
+};
+
+/**
+ * Stream the contents of a `tatami::Matrix` into sparse chunks.
+ * The matrix is read in strips that span a single row (or column) of the chunk grid, so only the non-zero elements of one strip need to be held in memory at any time.
+ * Each strip is extracted with a `tatami::ConsecutiveOracle` so that the input matrix can optimize its own data retrieval, e.g., by caching or prefetching.
+ *
+ * @tparam ChunkValue_ Numeric type of the data values in each chunk.
+ * @tparam Value_ Numeric type of the matrix values.
+ * @tparam Index_ Integer type of the row/column indices.
+ * @tparam Function_ Function to be called on each chunk.
+ *
+ * @param matrix Matrix to be rechunked.
+ * @param chunk_nrow Number of rows in each chunk.
+ * This should be positive if `matrix` has a non-zero number of rows.
+ * @param chunk_ncol Number of columns in each chunk.
+ * This should be positive if `matrix` has a non-zero number of columns.
+ * @param fun Function that accepts `(Index_ chunk_row_id, Index_ chunk_column_id, const std::vector<std::size_t>& pointers, const std::vector<Index_>& indices, const std::vector<ChunkValue_>& values)`,
+ * containing the contents of the chunk at `(chunk_row_id, chunk_column_id)` in compressed sparse row format.
+ * `pointers` has length equal to the number of rows in the chunk plus 1 (without any padding for chunks at the edges of the matrix),
+ * while `indices` contains the column indices of the non-zero elements relative to the start of the chunk, sorted within each row.
+ * These vectors are only valid for the duration of each call.
+ * @param options Further options.
+ */
+template<typename ChunkValue_, typename Value_, typename Index_, class Function_>
+void rechunk_sparse(const tatami::Matrix<Value_, Index_>& matrix, Index_ chunk_nrow, Index_ chunk_ncol, Function_ fun, const RechunkSparseOptions& options) {
+    Index_ NR = matrix.nrow(), NC = matrix.ncol();
+    rechunk_internal::check_chunk_dimensions(NR, NC, chunk_nrow, chunk_ncol);
+
+    bool by_row = options.row_major_chunks;
+    ChunkDimensionStats<Index_> band_stats(by_row ? NR : NC, by_row ? chunk_nrow : chunk_ncol);
+    ChunkDimensionStats<Index_> other_stats(by_row ? NC : NR, by_row ? chunk_ncol : chunk_nrow);
+    Index_ other_dim = other_stats.dimension_extent;
+
+    // Non-zero elements of the current strip, partitioned by chunk.
+    // For each element, we store its row and column within the chunk.
+    auto strip_rows = sanisizer::create<std::vector<std::vector<Index_> > >(other_stats.num_chunks);
+    auto strip_cols = sanisizer::create<std::vector<std::vector<Index_> > >(other_stats.num_chunks);
+    auto strip_values = sanisizer::create<std::vector<std::vector<ChunkValue_> > >(other_stats.num_chunks);
+
+    std::vector<std::size_t> pointers;
+    std::vector<Index_> indices;
+    std::vector<ChunkValue_> values;
+
+    auto vbuffer = sanisizer::create<std::vector<Value_> >(other_dim);
+    auto ibuffer = sanisizer::create<std::vector<Index_> >(other_dim);
+    auto ext = matrix.sparse(by_row, std::make_shared<tatami::ConsecutiveOracle<Index_> >(0, band_stats.dimension_extent), tatami::Options());
+
+    for (Index_ b = 0; b < band_stats.num_chunks; ++b) {
+        Index_ band_length = get_chunk_length(band_stats, b);
+        for (Index_ t = 0; t < band_length; ++t) {
+            auto range = ext->fetch(vbuffer.data(), ibuffer.data());
+            for (Index_ i = 0; i < range.number; ++i) {
+                Index_ k = range.index[i] / other_stats.chunk_length;
+                Index_ u = range.index[i] - k * other_stats.chunk_length;
+                strip_rows[k].push_back(by_row ? t : u);
+                strip_cols[k].push_back(by_row ? u : t);
+                strip_values[k].push_back(range.value[i]);
+            }
+        }
+
+        for (Index_ k = 0; k < other_stats.num_chunks; ++k) {
+            Index_ chunk_row_id = (by_row ? b : k);
+            Index_ chunk_nrow_actual = (by_row ? band_length : get_chunk_length(other_stats, k));
+            const auto& rows = strip_rows[k];
+            const auto& cols = strip_cols[k];
+            const auto& vals = strip_values[k];
+
+            // Counting sort by row to obtain the compressed sparse row format.
+            // This is stable, so columns remain sorted within each row as they were added in increasing order of the column index.
+            std::size_t nnz = rows.size();
+            pointers.clear();
+            pointers.resize(sanisizer::sum<std::size_t>(chunk_nrow_actual, 1));
+            for (auto r : rows) {
+                ++pointers[r + 1];
+            }
+            for (Index_ r = 0; r < chunk_nrow_actual; ++r) {
+                pointers[r + 1] += pointers[r];
+            }
+
+            indices.resize(nnz);
+            values.resize(nnz);
+            for (std::size_t i = 0; i < nnz; ++i) {
+                auto& pos = pointers[rows[i]];
+                indices[pos] = cols[i];
+                values[pos] = vals[i];
+                ++pos;
+            }
+            for (Index_ r = chunk_nrow_actual; r > 0; --r) {
+                pointers[r] = pointers[r - 1];
+            }
+            pointers[0] = 0;
+
+            fun(chunk_row_id, (by_row ? k : b), static_cast<const std::vector<std::size_t>&>(pointers), static_cast<const std::vector<Index_>&>(indices), static_cast<const std::vector<ChunkValue_>&>(values));
+            strip_rows[k].clear();
+            strip_cols[k].clear();
+            strip_values[k].clear();
+        }
+    }
+}
+
+}
+
+#endif
@@ -7,16 +7,29 @@
  */
 
 #include "LruSlabCache.hpp"
+#include "ConcurrentLruSlabCache.hpp"
 #include "OracularSlabCache.hpp"
 #include "OracularVariableSlabCache.hpp"
 #include "OracularSubsettedSlabCache.hpp"
+#include "OracularAsyncSlabCache.hpp"
+#include "OracularBeladySlabCache.hpp"
 
 #include "SlabCacheStats.hpp"
+#include "SlabCacheCounters.hpp"
+#include "SlabCacheAdvisor.hpp"
+#include "ChunkShapeAdvisor.hpp"
 #include "DenseSlabFactory.hpp"
 #include "SparseSlabFactory.hpp"
+#include "VariableSlabFactory.hpp"
+#include "CompactSparseSlabFactory.hpp"
 
 #include "CustomDenseChunkedMatrix.hpp"
 #include "CustomSparseChunkedMatrix.hpp"
+#include "ChunkCodec.hpp"
+#include "CompressedChunkedMatrixManager.hpp"
+#include "rechunk.hpp"
+#include "AccessTrace.hpp"
+#include "RecordedChunkedMatrix.hpp"
 
 /**
  * @namespace tatami_chunked
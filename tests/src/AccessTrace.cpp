@@ -0,0 +1,215 @@
+#include <gtest/gtest.h>
+#include "tatami/tatami.hpp"
+#include "tatami_test/tatami_test.hpp"
+
+#include "tatami_chunked/RecordedChunkedMatrix.hpp"
+#include "tatami_chunked/CompressedChunkedMatrixManager.hpp"
+
+#include <vector>
+#include <memory>
+#include <fstream>
+#include <numeric>
+#include <iterator>
+
+class AccessTraceTest : public ::testing::Test {
+protected:
+    inline static int NR = 50, NC = 40;
+    inline static std::shared_ptr<tatami::Matrix<double, int> > ref;
+    inline static std::shared_ptr<const tatami_chunked::ChunkCodec> codec;
+    inline static std::shared_ptr<tatami_chunked::CompressedDenseChunkedMatrixManager<double, int> > manager;
+    inline static tatami_chunked::AccessTrace<int> trace;
+
+    static void SetUpTestSuite() {
+        auto full = tatami_test::simulate_vector<double>(NR * NC, tatami_test::SimulateVectorOptions());
+        ref.reset(new tatami::DenseRowMatrix<double, int>(NR, NC, std::move(full)));
+        codec.reset(new tatami_chunked::UncompressedChunkCodec);
+        manager.reset(new tatami_chunked::CompressedDenseChunkedMatrixManager<double, int>(codec, tatami_chunked::compress_dense_chunks<double>(*ref, 10, 8, *codec)));
+
+        auto recorder = std::make_shared<tatami_chunked::AccessRecorder<int> >(NR, NC);
+        auto recorded_manager = std::make_shared<tatami_chunked::RecordedDenseChunkedMatrixManager<double, int> >(manager, recorder);
+        auto inner = std::make_shared<tatami_chunked::CustomDenseChunkedMatrix<double, int, double> >(recorded_manager, tatami_chunked::CustomDenseChunkedMatrixOptions());
+        tatami_chunked::RecordedMatrix<double, int> mat(inner, recorder);
+
+        // Consecutive rows in the first chunk row, which involves one read for each of the 5 chunk columns.
+        {
+            auto ext = mat.dense(true, tatami::Options());
+            auto rext = ref->dense(true, tatami::Options());
+            for (int r = 0; r < 10; ++r) {
+                EXPECT_EQ(tatami_test::fetch(*ext, r, NC), tatami_test::fetch(*rext, r, NC));
+            }
+        }
+
+        // Columns 5-14 span two chunk columns and rows 10-29 span two chunk rows.
+        {
+            auto ext = mat.dense(false, std::make_shared<tatami::ConsecutiveOracle<int> >(5, 10), 10, 20, tatami::Options());
+            auto rext = ref->dense(false, 10, 20, tatami::Options());
+            for (int c = 5; c < 15; ++c) {
+                EXPECT_EQ(tatami_test::fetch(*ext, 20), tatami_test::fetch(*rext, c, 20));
+            }
+        }
+
+        // Indices span the first and last chunk columns, for two different chunk rows.
+        {
+            auto indices = std::make_shared<std::vector<int> >(std::vector<int>{ 1, 5, 33 });
+            auto ext = mat.sparse(true, indices, tatami::Options());
+            auto rext = ref->sparse(true, indices, tatami::Options());
+            std::vector<double> vbuffer(3), rvbuffer(3);
+            std::vector<int> ibuffer(3), ribuffer(3);
+            for (int r : { 45, 2 }) {
+                auto observed = ext->fetch(r, vbuffer.data(), ibuffer.data());
+                auto expected = rext->fetch(r, rvbuffer.data(), ribuffer.data());
+                ASSERT_EQ(observed.number, expected.number);
+                EXPECT_EQ(std::vector<double>(observed.value, observed.value + observed.number), std::vector<double>(expected.value, expected.value + expected.number));
+                EXPECT_EQ(std::vector<int>(observed.index, observed.index + observed.number), std::vector<int>(expected.index, expected.index + expected.number));
+            }
+        }
+
+        trace = recorder->get_trace();
+    }
+};
+
+TEST_F(AccessTraceTest, Record) {
+    EXPECT_EQ(trace.nrow, NR);
+    EXPECT_EQ(trace.ncol, NC);
+    ASSERT_EQ(trace.extractors.size(), 3);
+
+    const auto& first = trace.extractors[0];
+    EXPECT_TRUE(first.row);
+    EXPECT_FALSE(first.sparse);
+    EXPECT_FALSE(first.oracle);
+    EXPECT_EQ(first.selection, tatami_chunked::AccessTraceSelection::FULL);
+    EXPECT_EQ(first.fetches, std::vector<int>({ 0, 1, 2, 3, 4, 5, 6, 7, 8, 9 }));
+
+    const auto& second = trace.extractors[1];
+    EXPECT_FALSE(second.row);
+    EXPECT_FALSE(second.sparse);
+    EXPECT_TRUE(second.oracle);
+    EXPECT_EQ(second.selection, tatami_chunked::AccessTraceSelection::BLOCK);
+    EXPECT_EQ(second.block_start, 10);
+    EXPECT_EQ(second.block_length, 20);
+    EXPECT_EQ(second.fetches, std::vector<int>({ 5, 6, 7, 8, 9, 10, 11, 12, 13, 14 }));
+
+    const auto& third = trace.extractors[2];
+    EXPECT_TRUE(third.row);
+    EXPECT_TRUE(third.sparse);
+    EXPECT_FALSE(third.oracle);
+    EXPECT_EQ(third.selection, tatami_chunked::AccessTraceSelection::INDEX);
+    EXPECT_EQ(third.indices, std::vector<int>({ 1, 5, 33 }));
+    EXPECT_EQ(third.fetches, std::vector<int>({ 45, 2 }));
+
+    EXPECT_EQ(trace.chunk_reads.size(), 5 + 4 + 4);
+    for (int c = 0; c < 5; ++c) {
+        EXPECT_EQ(trace.chunk_reads[c].chunk_row_id, 0);
+        EXPECT_EQ(trace.chunk_reads[c].chunk_column_id, c);
+        EXPECT_TRUE(trace.chunk_reads[c].row);
+    }
+    for (int i = 5; i < 9; ++i) {
+        EXPECT_FALSE(trace.chunk_reads[i].row);
+        EXPECT_LT(trace.chunk_reads[i].chunk_column_id, 2);
+    }
+}
+
+TEST_F(AccessTraceTest, SaveLoad) {
+    auto path = ::testing::TempDir() + "/tatami_chunked_trace_test.bin";
+    tatami_chunked::save_access_trace(trace, path);
+    auto reloaded = tatami_chunked::load_access_trace<int>(path);
+
+    EXPECT_EQ(reloaded.nrow, trace.nrow);
+    EXPECT_EQ(reloaded.ncol, trace.ncol);
+    ASSERT_EQ(reloaded.extractors.size(), trace.extractors.size());
+    for (std::size_t e = 0; e < trace.extractors.size(); ++e) {
+        const auto& obs = reloaded.extractors[e];
+        const auto& exp = trace.extractors[e];
+        EXPECT_EQ(obs.row, exp.row);
+        EXPECT_EQ(obs.sparse, exp.sparse);
+        EXPECT_EQ(obs.oracle, exp.oracle);
+        EXPECT_EQ(obs.selection, exp.selection);
+        if (exp.selection == tatami_chunked::AccessTraceSelection::BLOCK) {
+            EXPECT_EQ(obs.block_start, exp.block_start);
+            EXPECT_EQ(obs.block_length, exp.block_length);
+        }
+        EXPECT_EQ(obs.indices, exp.indices);
+        EXPECT_EQ(obs.fetches, exp.fetches);
+    }
+
+    ASSERT_EQ(reloaded.chunk_reads.size(), trace.chunk_reads.size());
+    for (std::size_t r = 0; r < trace.chunk_reads.size(); ++r) {
+        EXPECT_EQ(reloaded.chunk_reads[r].chunk_row_id, trace.chunk_reads[r].chunk_row_id);
+        EXPECT_EQ(reloaded.chunk_reads[r].chunk_column_id, trace.chunk_reads[r].chunk_column_id);
+        EXPECT_EQ(reloaded.chunk_reads[r].row, trace.chunk_reads[r].row);
+    }
+
+    // Checking that runs of consecutive indices are compressed.
+    tatami_chunked::AccessTrace<int> long_trace;
+    long_trace.nrow = 100000;
+    long_trace.ncol = 10;
+    long_trace.extractors.resize(1);
+    long_trace.extractors.front().fetches.resize(100000);
+    std::iota(long_trace.extractors.front().fetches.begin(), long_trace.extractors.front().fetches.end(), 0);
+    tatami_chunked::save_access_trace(long_trace, path);
+    {
+        std::ifstream input(path, std::ios::binary | std::ios::ate);
+        EXPECT_LT(static_cast<long long>(input.tellg()), 100);
+    }
+    auto long_reloaded = tatami_chunked::load_access_trace<int>(path);
+    EXPECT_EQ(long_reloaded.extractors.front().fetches, long_trace.extractors.front().fetches);
+}
+
+TEST_F(AccessTraceTest, Replay) {
+    auto cached = tatami_chunked::replay_dense_chunked_access_trace<double, int, double>(trace, manager, tatami_chunked::CustomDenseChunkedMatrixOptions());
+    EXPECT_EQ(cached.num_fetches, 22);
+    EXPECT_EQ(cached.num_chunk_reads, trace.chunk_reads.size());
+    EXPECT_GT(cached.counters.hits, 0);
+    EXPECT_GT(cached.counters.misses, 0);
+
+    // Without a cache, every fetch needs to read its chunks again.
+    tatami_chunked::CustomDenseChunkedMatrixOptions opt;
+    opt.maximum_cache_size = 0;
+    opt.require_minimum_cache = false;
+    auto uncached = tatami_chunked::replay_dense_chunked_access_trace<double, int, double>(trace, manager, opt);
+    EXPECT_EQ(uncached.num_fetches, 22);
+    EXPECT_EQ(uncached.num_chunk_reads, 10 * 5 + 10 * 2 + 2 * 2);
+    EXPECT_EQ(uncached.counters.hits, 0);
+
+    // Replaying against a sparse chunked matrix.
+    auto sparse_manager = std::make_shared<tatami_chunked::CompressedSparseChunkedMatrixManager<double, int> >(codec, tatami_chunked::compress_sparse_chunks<double>(*ref, 10, 8, *codec));
+    auto sparse = tatami_chunked::replay_sparse_chunked_access_trace<double, int, double>(trace, sparse_manager, tatami_chunked::CustomSparseChunkedMatrixOptions());
+    EXPECT_EQ(sparse.num_fetches, 22);
+    EXPECT_EQ(sparse.num_chunk_reads, trace.chunk_reads.size());
+
+    // Replaying against any matrix.
+    auto generic = tatami_chunked::replay_access_trace(trace, *ref);
+    EXPECT_EQ(generic.num_fetches, 22);
+    EXPECT_EQ(generic.num_chunk_reads, 0);
+}
+
+TEST_F(AccessTraceTest, Errors) {
+    tatami::DenseRowMatrix<double, int> wrong(NC, NR, std::vector<double>(NR * NC));
+    tatami_test::throws_error([&]() {
+        tatami_chunked::replay_access_trace(trace, wrong);
+    }, "dimensions");
+
+    auto path = ::testing::TempDir() + "/tatami_chunked_trace_error.bin";
+    {
+        std::ofstream output(path, std::ios::binary | std::ios::trunc);
+        output << "FOOBAR";
+    }
+    tatami_test::throws_error([&]() {
+        tatami_chunked::load_access_trace<int>(path);
+    }, "not an access trace");
+
+    // Truncating a valid file.
+    tatami_chunked::save_access_trace(trace, path);
+    std::vector<char> contents;
+    {
+        std::ifstream input(path, std::ios::binary);
+        contents.assign(std::istreambuf_iterator<char>(input), std::istreambuf_iterator<char>());
+    }
+    {
+        std::ofstream output(path, std::ios::binary | std::ios::trunc);
+        output.write(contents.data(), contents.size() - 5);
+    }
+    tatami_test::throws_error([&]() {
+        tatami_chunked::load_access_trace<int>(path);
+    }, "unexpected end");
+}
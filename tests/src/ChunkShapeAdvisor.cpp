@@ -0,0 +1,157 @@
+#include <gtest/gtest.h>
+#include "tatami/tatami.hpp"
+#include "tatami_test/tatami_test.hpp"
+#include "tatami_chunked/ChunkShapeAdvisor.hpp"
+
+#include <vector>
+#include <memory>
+
+static tatami_chunked::ChunkShapeWorkloadPass<int> create_pass(bool row, int start, int length) {
+    tatami_chunked::ChunkShapeWorkloadPass<int> pass;
+    pass.row = row;
+    pass.oracle.reset(new tatami::ConsecutiveOracle<int>(start, length));
+    return pass;
+}
+
+TEST(ChunkShapeAdvisor, CostConsecutive) {
+    tatami_chunked::ChunkShapeAdvisorOptions opt;
+    opt.element_size = 1;
+    opt.extract_overhead = 10;
+
+    // Iterating over all rows means that each chunk is read exactly once.
+    std::vector<tatami_chunked::ChunkShapeWorkloadPass<int> > workload{ create_pass(true, 0, 100) };
+    auto cost = tatami_chunked::compute_chunk_shape_cost<int>(100, 50, 10, 20, workload, opt);
+    EXPECT_EQ(cost.chunk_nrow, 10);
+    EXPECT_EQ(cost.chunk_ncol, 20);
+    EXPECT_EQ(cost.num_extract_calls, 30);
+    EXPECT_EQ(cost.bytes_read, 30 * 200);
+    EXPECT_EQ(cost.cost, 30 * 200 + 30 * 10);
+    EXPECT_EQ(cost.cache_footprint, 100 * 50); // the cache is big enough to hold all slabs.
+
+    // Same for the columns.
+    workload.front().row = false;
+    workload.front().oracle.reset(new tatami::ConsecutiveOracle<int>(0, 50));
+    cost = tatami_chunked::compute_chunk_shape_cost<int>(100, 50, 10, 20, workload, opt);
+    EXPECT_EQ(cost.num_extract_calls, 30);
+    EXPECT_EQ(cost.bytes_read, 30 * 200);
+
+    // Weights are respected.
+    workload.front().weight = 2.5;
+    cost = tatami_chunked::compute_chunk_shape_cost<int>(100, 50, 10, 20, workload, opt);
+    EXPECT_EQ(cost.num_extract_calls, 75);
+}
+
+TEST(ChunkShapeAdvisor, CostLongPass) {
+    tatami_chunked::ChunkShapeAdvisorOptions opt;
+    opt.element_size = 1;
+
+    // All predictions are used, even for passes that are longer than the default limit of the SlabCacheAdvisor.
+    std::vector<tatami_chunked::ChunkShapeWorkloadPass<int> > workload{ create_pass(true, 0, 250000) };
+    workload.front().weight = 2;
+    auto cost = tatami_chunked::compute_chunk_shape_cost<int>(250000, 10, 100, 4, workload, opt);
+    EXPECT_EQ(cost.num_extract_calls, 2500 * 3 * 2);
+    EXPECT_EQ(cost.bytes_read, 2500 * 3 * 2 * 400);
+}
+
+TEST(ChunkShapeAdvisor, CostSubset) {
+    tatami_chunked::ChunkShapeAdvisorOptions opt;
+    opt.element_size = 1;
+
+    // Block spanning columns 15-34 overlaps with the first and second chunks.
+    auto pass = create_pass(true, 0, 100);
+    pass.non_target_block_start = 15;
+    pass.non_target_block_length = 20;
+    std::vector<tatami_chunked::ChunkShapeWorkloadPass<int> > workload{ pass };
+    auto cost = tatami_chunked::compute_chunk_shape_cost<int>(100, 50, 10, 20, workload, opt);
+    EXPECT_EQ(cost.num_extract_calls, 20);
+    EXPECT_EQ(cost.cache_footprint, 100 * 20);
+
+    // Block extending to the end of the dimension.
+    workload.front().non_target_block_length.reset();
+    cost = tatami_chunked::compute_chunk_shape_cost<int>(100, 50, 10, 20, workload, opt);
+    EXPECT_EQ(cost.num_extract_calls, 30);
+    EXPECT_EQ(cost.cache_footprint, 100 * 35);
+
+    // Indices overlapping with the first and third chunks.
+    workload.front().non_target_indices = std::vector<int>{ 1, 5, 19, 41, 48 };
+    cost = tatami_chunked::compute_chunk_shape_cost<int>(100, 50, 10, 20, workload, opt);
+    EXPECT_EQ(cost.num_extract_calls, 20);
+    EXPECT_EQ(cost.cache_footprint, 100 * 5);
+
+    workload.front().non_target_indices = std::vector<int>{ 1, 25, 41 };
+    cost = tatami_chunked::compute_chunk_shape_cost<int>(100, 50, 10, 20, workload, opt);
+    EXPECT_EQ(cost.num_extract_calls, 30);
+}
+
+TEST(ChunkShapeAdvisor, CostSmallCache) {
+    tatami_chunked::ChunkShapeAdvisorOptions opt;
+    opt.element_size = 1;
+    opt.maximum_cache_size = 0;
+
+    // Cycling through the rows twice; with the minimum cache, each slab is re-read on the second cycle.
+    auto pass = create_pass(true, 0, 100);
+    std::vector<int> predictions;
+    for (int rep = 0; rep < 2; ++rep) {
+        for (int r = 0; r < 100; ++r) {
+            predictions.push_back(r);
+        }
+    }
+    pass.oracle.reset(new tatami::FixedVectorOracle<int>(std::move(predictions)));
+    std::vector<tatami_chunked::ChunkShapeWorkloadPass<int> > workload{ pass };
+
+    auto cost = tatami_chunked::compute_chunk_shape_cost<int>(100, 50, 10, 20, workload, opt);
+    EXPECT_EQ(cost.num_extract_calls, 60);
+    EXPECT_EQ(cost.cache_footprint, 10 * 50);
+
+    // Without the minimum cache, every request is a miss.
+    opt.require_minimum_cache = false;
+    cost = tatami_chunked::compute_chunk_shape_cost<int>(100, 50, 10, 20, workload, opt);
+    EXPECT_EQ(cost.num_extract_calls, 600);
+    EXPECT_EQ(cost.cache_footprint, 0);
+}
+
+TEST(ChunkShapeAdvisor, Advise) {
+    tatami_chunked::ChunkShapeAdvisorOptions opt;
+    opt.element_size = 1;
+    opt.maximum_cache_size = 1000;
+    opt.extract_overhead = 100;
+
+    // Row access favors chunks that span all columns, but the cache limits the number of rows.
+    std::vector<tatami_chunked::ChunkShapeWorkloadPass<int> > workload{ create_pass(true, 0, 100) };
+    auto best = tatami_chunked::advise_chunk_shape<int>(100, 50, {}, {}, workload, opt);
+    EXPECT_EQ(best.chunk_ncol, 50);
+    EXPECT_EQ(best.chunk_nrow, 16);
+    EXPECT_LE(best.cache_footprint, opt.maximum_cache_size);
+
+    // Column access favors the opposite.
+    workload.front().row = false;
+    workload.front().oracle.reset(new tatami::ConsecutiveOracle<int>(0, 50));
+    best = tatami_chunked::advise_chunk_shape<int>(100, 50, {}, {}, workload, opt);
+    EXPECT_EQ(best.chunk_nrow, 100);
+    EXPECT_EQ(best.chunk_ncol, 8);
+
+    // Mixed access needs a compromise.
+    workload.push_back(create_pass(true, 0, 100));
+    best = tatami_chunked::advise_chunk_shape<int>(100, 50, {}, {}, workload, opt);
+    EXPECT_LE(best.cache_footprint, opt.maximum_cache_size);
+    EXPECT_LT(best.chunk_nrow, 100);
+    EXPECT_LT(best.chunk_ncol, 50);
+
+    // Only considering the supplied candidates.
+    best = tatami_chunked::advise_chunk_shape<int>(100, 50, { 5, 7 }, { 3 }, workload, opt);
+    EXPECT_TRUE(best.chunk_nrow == 5 || best.chunk_nrow == 7);
+    EXPECT_EQ(best.chunk_ncol, 3);
+
+    // Falling back to the smallest footprint if nothing fits.
+    best = tatami_chunked::advise_chunk_shape<int>(100, 50, { 50, 100 }, { 25, 50 }, workload, opt);
+    EXPECT_EQ(best.chunk_nrow, 50);
+    EXPECT_EQ(best.chunk_ncol, 25);
+    EXPECT_GT(best.cache_footprint, opt.maximum_cache_size);
+}
+
+TEST(ChunkShapeAdvisor, Errors) {
+    std::vector<tatami_chunked::ChunkShapeWorkloadPass<int> > workload;
+    tatami_test::throws_error([&]() {
+        tatami_chunked::compute_chunk_shape_cost<int>(10, 10, 0, 5, workload, tatami_chunked::ChunkShapeAdvisorOptions());
+    }, "positive");
+}
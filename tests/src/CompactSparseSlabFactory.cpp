@@ -0,0 +1,119 @@
+#include <gtest/gtest.h>
+#include "tatami_chunked/CompactSparseSlabFactory.hpp"
+
+#include <vector>
+
+TEST(CompactSparseSlabFactory, Basic) {
+    typedef tatami_chunked::CompactSparseSlabFactory<double, int, int> Factory;
+    int target_dim = 10, non_target_dim = 8;
+
+    for (int needs : { 0, 1, 2 }) {
+        bool needs_value = needs != 1;
+        bool needs_index = needs != 0;
+        Factory factory(target_dim, non_target_dim, needs_value, needs_index, 2);
+
+        auto expected_number = [&](int id, int p) -> int {
+            return (id * 7 + p) % non_target_dim;
+        };
+
+        std::vector<typename Factory::Slab> slabs;
+        for (int id = 0; id < 5; ++id) {
+            slabs.push_back(factory.create());
+            const auto& slab = slabs.back();
+            EXPECT_EQ(slab.pointers, std::vector<std::size_t>(target_dim + 1));
+            EXPECT_TRUE(slab.values.empty());
+            EXPECT_TRUE(slab.indices.empty());
+        }
+
+        // Re-using the same slabs across multiple rounds, with alternating buffers.
+        for (int round = 0; round < 3; ++round) {
+            for (int id = 0; id < 5; ++id) {
+                int shifted = id + round * 5;
+                auto& buffer = factory.get_buffer(id % 2);
+                for (int p = 0; p < target_dim; ++p) {
+                    auto num = expected_number(shifted, p);
+                    for (int k = 0; k < num; ++k) {
+                        if (needs_value) {
+                            buffer.values[p][k] = shifted * 100 + p * 10 + k;
+                        }
+                        if (needs_index) {
+                            buffer.indices[p][k] = k * 2;
+                        }
+                    }
+                    buffer.number[p] = num;
+                }
+                factory.compact(buffer, slabs[id]);
+            }
+
+            for (int id = 0; id < 5; ++id) {
+                int shifted = id + round * 5;
+                const auto& slab = slabs[id];
+                ASSERT_EQ(slab.pointers.size(), static_cast<std::size_t>(target_dim + 1));
+                EXPECT_EQ(slab.pointers[0], static_cast<std::size_t>(0));
+
+                for (int p = 0; p < target_dim; ++p) {
+                    auto start = slab.pointers[p], end = slab.pointers[p + 1];
+                    ASSERT_EQ(end - start, static_cast<std::size_t>(expected_number(shifted, p)));
+                    for (std::size_t k = 0; k < end - start; ++k) {
+                        if (needs_value) {
+                            EXPECT_EQ(slab.values[start + k], shifted * 100 + p * 10 + k);
+                        }
+                        if (needs_index) {
+                            EXPECT_EQ(slab.indices[start + k], static_cast<int>(k * 2));
+                        }
+                    }
+                }
+
+                auto total = slab.pointers[target_dim];
+                EXPECT_EQ(slab.values.size(), needs_value ? total : 0);
+                EXPECT_EQ(slab.indices.size(), needs_index ? total : 0);
+            }
+        }
+    }
+}
+
+TEST(CompactSparseSlabFactory, Empty) {
+    typedef tatami_chunked::CompactSparseSlabFactory<double, int, int> Factory;
+    Factory factory(5, 10, true, true);
+
+    auto slab = factory.create();
+    auto& buffer = factory.get_buffer(0);
+    std::fill_n(buffer.number, 5, 0);
+    factory.compact(buffer, slab);
+    EXPECT_EQ(slab.pointers, std::vector<std::size_t>(6));
+    EXPECT_TRUE(slab.values.empty());
+    EXPECT_TRUE(slab.indices.empty());
+}
+
+TEST(CompactSparseSlabFactory, Reserved) {
+    typedef tatami_chunked::CompactSparseSlabFactory<double, int, int> Factory;
+    Factory factory(5, 10, true, true, 1, 20);
+
+    auto slab = factory.create();
+    EXPECT_GE(slab.values.capacity(), static_cast<std::size_t>(20));
+    EXPECT_GE(slab.indices.capacity(), static_cast<std::size_t>(20));
+    auto vptr = slab.values.data();
+    auto iptr = slab.indices.data();
+
+    // Compacting within the reserved capacity doesn't reallocate.
+    auto& buffer = factory.get_buffer(0);
+    for (int p = 0; p < 5; ++p) {
+        for (int k = 0; k < 4; ++k) {
+            buffer.values[p][k] = p * 10 + k;
+            buffer.indices[p][k] = k;
+        }
+        buffer.number[p] = 4;
+    }
+    factory.compact(buffer, slab);
+    EXPECT_EQ(slab.values.size(), static_cast<std::size_t>(20));
+    EXPECT_EQ(slab.indices.size(), static_cast<std::size_t>(20));
+    EXPECT_EQ(slab.values.data(), vptr);
+    EXPECT_EQ(slab.indices.data(), iptr);
+    EXPECT_EQ(slab.values[19], 43);
+
+    // Nothing is reserved for values or indices that are not needed.
+    Factory nfactory(5, 10, false, true, 1, 20);
+    auto nslab = nfactory.create();
+    EXPECT_EQ(nslab.values.capacity(), static_cast<std::size_t>(0));
+    EXPECT_GE(nslab.indices.capacity(), static_cast<std::size_t>(20));
+}
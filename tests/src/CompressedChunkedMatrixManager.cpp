@@ -0,0 +1,180 @@
+#include <gtest/gtest.h>
+#include "tatami/tatami.hpp"
+#include "tatami_test/tatami_test.hpp"
+
+#include "tatami_chunked/CompressedChunkedMatrixManager.hpp"
+
+#include <string>
+#include <vector>
+#include <memory>
+
+static std::vector<std::string> available_codecs() {
+    std::vector<std::string> output{ "none" };
+#ifdef TATAMI_CHUNKED_USE_ZLIB
+    output.push_back("zlib");
+#endif
+#ifdef TATAMI_CHUNKED_USE_ZSTD
+    output.push_back("zstd");
+#endif
+#ifdef TATAMI_CHUNKED_USE_LZ4
+    output.push_back("lz4");
+#endif
+    return output;
+}
+
+static std::shared_ptr<const tatami_chunked::ChunkCodec> create_codec([[maybe_unused]] const std::string& name) {
+#ifdef TATAMI_CHUNKED_USE_ZLIB
+    if (name == "zlib") {
+        return std::make_shared<tatami_chunked::ZlibChunkCodec>();
+    }
+#endif
+#ifdef TATAMI_CHUNKED_USE_ZSTD
+    if (name == "zstd") {
+        return std::make_shared<tatami_chunked::ZstdChunkCodec>();
+    }
+#endif
+#ifdef TATAMI_CHUNKED_USE_LZ4
+    if (name == "lz4") {
+        return std::make_shared<tatami_chunked::Lz4ChunkCodec>();
+    }
+#endif
+    return std::make_shared<tatami_chunked::UncompressedChunkCodec>();
+}
+
+class CompressedChunkedMatrixManagerTest : public ::testing::TestWithParam<std::tuple<std::pair<int, int>, std::string> > {
+protected:
+    inline static int NR = 89, NC = 61;
+};
+
+TEST_P(CompressedChunkedMatrixManagerTest, Dense) {
+    auto param = GetParam();
+    auto chunkdim = std::get<0>(param);
+    auto codec = create_codec(std::get<1>(param));
+
+    auto full = tatami_test::simulate_vector<double>(NR * NC, tatami_test::SimulateVectorOptions());
+    tatami::DenseRowMatrix<double, int> ref(NR, NC, std::move(full));
+
+    auto store = tatami_chunked::compress_dense_chunks<double>(ref, chunkdim.first, chunkdim.second, *codec);
+    EXPECT_EQ(store.offsets.size(), store.sizes.size() + 1);
+    auto manager = std::make_shared<tatami_chunked::CompressedDenseChunkedMatrixManager<double, int> >(codec, std::move(store));
+    EXPECT_EQ(manager->row_stats().dimension_extent, NR);
+    EXPECT_EQ(manager->column_stats().chunk_length, chunkdim.second);
+
+    tatami_chunked::CustomDenseChunkedMatrixOptions opt;
+    opt.maximum_cache_size = NR * NC * 4;
+    tatami_chunked::CustomDenseChunkedMatrix<double, int, double, tatami_chunked::CompressedDenseChunkedMatrixManager<double, int> > mat(manager, opt);
+    tatami_test::TestAccessOptions topt;
+    tatami_test::test_full_access(mat, ref, topt);
+    tatami_test::test_block_access(mat, ref, 0.15, 0.6, topt);
+    tatami_test::test_indexed_access(mat, ref, 0.05, 0.2, topt);
+
+    // Works without any caching, where each extract() call requires decompression.
+    opt.maximum_cache_size = 0;
+    tatami_chunked::CustomDenseChunkedMatrix<double, int, double> mat0(manager, opt);
+    tatami_test::test_full_access(mat0, ref, topt);
+
+    // Without even the minimum cache, each element of the target dimension is extracted directly via extract_single().
+    opt.require_minimum_cache = false;
+    tatami_chunked::CustomDenseChunkedMatrix<double, int, double> solo(manager, opt);
+    tatami_test::test_full_access(solo, ref, topt);
+    tatami_test::test_block_access(solo, ref, 0.15, 0.6, topt);
+    tatami_test::test_indexed_access(solo, ref, 0.05, 0.2, topt);
+}
+
+TEST_P(CompressedChunkedMatrixManagerTest, Sparse) {
+    auto param = GetParam();
+    auto chunkdim = std::get<0>(param);
+    auto codec = create_codec(std::get<1>(param));
+
+    auto full = tatami_test::simulate_compressed_sparse<double, int>(NR, NC, [&]{
+        tatami_test::SimulateCompressedSparseOptions opt;
+        opt.density = 0.15;
+        return opt;
+    }());
+    tatami::CompressedSparseRowMatrix<double, int> ref(NR, NC, std::move(full.data), std::move(full.index), std::move(full.indptr));
+
+    auto store = tatami_chunked::compress_sparse_chunks<double>(ref, chunkdim.first, chunkdim.second, *codec);
+    EXPECT_EQ(store.nonzeros.size(), store.sizes.size());
+    auto manager = std::make_shared<tatami_chunked::CompressedSparseChunkedMatrixManager<double, int> >(codec, std::move(store));
+
+    tatami_chunked::CustomSparseChunkedMatrixOptions opt;
+    opt.maximum_cache_size = NR * NC * 4;
+    tatami_chunked::CustomSparseChunkedMatrix<double, int, double, tatami_chunked::CompressedSparseChunkedMatrixManager<double, int> > mat(manager, opt);
+    tatami_test::TestAccessOptions topt;
+    tatami_test::test_full_access(mat, ref, topt);
+    tatami_test::test_block_access(mat, ref, 0.15, 0.6, topt);
+    tatami_test::test_indexed_access(mat, ref, 0.05, 0.2, topt);
+
+    opt.maximum_cache_size = 0;
+    tatami_chunked::CustomSparseChunkedMatrix<double, int, double> mat0(manager, opt);
+    tatami_test::test_full_access(mat0, ref, topt);
+
+    // Per-chunk counts are used to size the variable-size slabs.
+    EXPECT_TRUE(manager->has_chunk_nonzeros());
+    opt.maximum_cache_size = NR * NC * 4;
+    opt.variable_slab_size = true;
+    tatami_chunked::CustomSparseChunkedMatrix<double, int, double> vmat(manager, opt);
+    topt.use_oracle = true;
+    tatami_test::test_full_access(vmat, ref, topt);
+    tatami_test::test_block_access(vmat, ref, 0.15, 0.6, topt);
+    tatami_test::test_indexed_access(vmat, ref, 0.05, 0.2, topt);
+}
+
+INSTANTIATE_TEST_SUITE_P(
+    CompressedChunkedMatrixManager,
+    CompressedChunkedMatrixManagerTest,
+    ::testing::Combine(
+        ::testing::Values( // chunk dimensions
+            std::make_pair(1, 61),
+            std::make_pair(17, 1),
+            std::make_pair(10, 13)
+        ),
+        ::testing::ValuesIn(available_codecs())
+    )
+);
+
+TEST(CompressedChunkedMatrixManager, Errors) {
+    auto codec = std::make_shared<tatami_chunked::UncompressedChunkCodec>();
+    tatami::DenseRowMatrix<double, int> ref(10, 10, std::vector<double>(100));
+    auto store = tatami_chunked::compress_dense_chunks<double>(ref, 5, 5, *codec);
+
+    tatami_test::throws_error([&]() {
+        auto copy = store;
+        copy.offsets.pop_back();
+        tatami_chunked::CompressedDenseChunkedMatrixManager<double, int> manager(codec, std::move(copy));
+    }, "number of chunks plus 1");
+
+    tatami_test::throws_error([&]() {
+        auto copy = store;
+        copy.sizes.pop_back();
+        tatami_chunked::CompressedDenseChunkedMatrixManager<double, int> manager(codec, std::move(copy));
+    }, "number of chunks");
+
+    tatami_test::throws_error([&]() {
+        auto copy = store;
+        copy.data.pop_back();
+        tatami_chunked::CompressedDenseChunkedMatrixManager<double, int> manager(codec, std::move(copy));
+    }, "span the entirety");
+
+    tatami_test::throws_error([&]() {
+        auto copy = store;
+        copy.nonzeros.resize(1);
+        tatami_chunked::CompressedDenseChunkedMatrixManager<double, int> manager(codec, std::move(copy));
+    }, "'nonzeros'");
+
+    tatami_test::throws_error([&]() {
+        tatami_chunked::CompressedDenseChunkedMatrixManager<float, int> manager(codec, store);
+    }, "full chunk");
+
+    tatami_test::throws_error([&]() {
+        tatami_chunked::compress_dense_chunks<double>(ref, 0, 5, *codec);
+    }, "positive");
+
+    // Mismatch in the decompressed size is caught by the codec.
+    auto copy = store;
+    copy.sizes.front() += 1;
+    std::vector<unsigned char> buffer(copy.sizes.front());
+    tatami_test::throws_error([&]() {
+        codec->decompress(copy.data.data(), copy.offsets[1], buffer.data(), buffer.size());
+    }, "unexpected size");
+}
@@ -0,0 +1,222 @@
+#include <gtest/gtest.h>
+#include "tatami_chunked/ConcurrentLruSlabCache.hpp"
+
+#include <atomic>
+#include <thread>
+#include <vector>
+#include <random>
+#include <stdexcept>
+#include <tuple>
+#include <chrono>
+#include <algorithm>
+
+TEST(ConcurrentLruSlabCache, Basic) {
+    // Using a single shard so that the LRU ordering is the same as LruSlabCache.
+    tatami_chunked::ConcurrentLruSlabCache<int, std::pair<int, int> > cache(3, 1);
+    EXPECT_EQ(cache.get_max_slabs(), 3);
+    EXPECT_EQ(cache.get_num_slabs(), 0);
+    EXPECT_EQ(cache.get_num_shards(), 1);
+
+    int counter = 0;
+    auto creator = []() -> std::pair<int, int> {
+        return std::pair<int, int>(0, 0);
+    };
+    auto populator = [&](int i, std::pair<int, int>& chunk) -> void {
+        chunk.first = i;
+        chunk.second = counter;
+        ++counter;
+        return;
+    };
+
+    auto check = [&](int id, int expected) -> void {
+        auto out = cache.find(id, creator, populator);
+        EXPECT_TRUE(out);
+        EXPECT_EQ(out->first, id);
+        EXPECT_EQ(out->second, expected);
+    };
+
+    check(10, 0); // new allocation
+    check(20, 1); // new allocation
+    EXPECT_EQ(cache.get_num_slabs(), 2);
+    check(10, 0); // retrieve from cache.
+    check(30, 2); // new allocation, now we're full.
+    EXPECT_EQ(cache.get_num_slabs(), 3);
+    check(20, 1); // retrieve from cache.
+    check(10, 0); // retrieve from cache.
+    check(40, 3); // evict the LRU chunk (i.e., 30) and fill with 40.
+    check(10, 0); // retrieve from cache, as 10 is still present.
+    check(30, 4); // evict the LRU chunk (i.e., 20).
+    check(20, 5); // evict the LRU chunk (i.e., 40).
+    check(10, 0); // retrieve from cache.
+    EXPECT_EQ(cache.get_num_slabs(), 3);
+}
+
+TEST(ConcurrentLruSlabCache, Pinned) {
+    tatami_chunked::ConcurrentLruSlabCache<int, int> cache(2, 1);
+
+    int counter = 0;
+    auto creator = []() -> int { return 0; };
+    auto populator = [&](int, int& slab) -> void {
+        slab = counter;
+        ++counter;
+    };
+
+    auto first = cache.find(10, creator, populator);
+    auto second = cache.find(20, creator, populator);
+    EXPECT_EQ(*first, 0);
+    EXPECT_EQ(*second, 1);
+
+    {
+        // Slab 10 is the LRU slab but it is pinned, so slab 20 is evicted once released.
+        second.release();
+        EXPECT_FALSE(second);
+        auto third = cache.find(30, creator, populator);
+        EXPECT_EQ(*third, 2);
+        EXPECT_EQ(*first, 0);
+    }
+
+    // Both slabs are pinned, so an extra slab is temporarily created.
+    {
+        auto third = cache.find(30, creator, populator);
+        EXPECT_EQ(*third, 2);
+        auto fourth = cache.find(40, creator, populator);
+        EXPECT_EQ(*fourth, 3);
+        EXPECT_EQ(cache.get_num_slabs(), 3);
+    }
+    EXPECT_EQ(cache.get_num_slabs(), 2);
+
+    // Slab 10 is still present.
+    first.release();
+    EXPECT_EQ(*cache.find(10, creator, populator), 0);
+    EXPECT_EQ(cache.get_num_slabs(), 2);
+}
+
+TEST(ConcurrentLruSlabCache, Error) {
+    tatami_chunked::ConcurrentLruSlabCache<int, int> cache(2, 1);
+    auto creator = []() -> int { return 0; };
+
+    EXPECT_THROW(cache.find(10, creator, [](int, int&) -> void { throw std::runtime_error("failed"); }), std::runtime_error);
+
+    // Failed slab is considered to be missing.
+    int counter = 0;
+    auto populator = [&](int i, int& slab) -> void {
+        slab = i;
+        ++counter;
+    };
+    EXPECT_EQ(*cache.find(10, creator, populator), 10);
+    EXPECT_EQ(*cache.find(10, creator, populator), 10);
+    EXPECT_EQ(counter, 1);
+    EXPECT_EQ(cache.get_num_slabs(), 1);
+}
+
+TEST(ConcurrentLruSlabCache, Shards) {
+    tatami_chunked::ConcurrentLruSlabCache<int, int> cache(5, 3);
+    EXPECT_EQ(cache.get_num_shards(), 3);
+
+    tatami_chunked::ConcurrentLruSlabCache<int, int> capped(2, 10);
+    EXPECT_EQ(capped.get_num_shards(), 2);
+
+    // With the identity hash, each shard gets every third ID.
+    auto creator = []() -> int { return 0; };
+    auto populator = [](int i, int& slab) -> void { slab = i; };
+    for (int i = 0; i < 30; ++i) {
+        EXPECT_EQ(*cache.find(i, creator, populator), i);
+    }
+    EXPECT_EQ(cache.get_num_slabs(), 5);
+}
+
+class ConcurrentLruSlabCacheStressTest : public ::testing::TestWithParam<std::tuple<int, int> > {};
+
+TEST_P(ConcurrentLruSlabCacheStressTest, Stressed) {
+    auto param = GetParam();
+    auto cache_size = std::get<0>(param);
+    auto num_shards = std::get<1>(param);
+    tatami_chunked::ConcurrentLruSlabCache<int, std::vector<int> > cache(cache_size, num_shards);
+
+    // Each ID is populated by at most one thread at a time.
+    constexpr int num_ids = 50;
+    std::vector<std::atomic<int> > active(num_ids);
+    std::atomic<bool> overlap(false);
+    std::atomic<int> npopulated(0);
+
+    auto creator = []() -> std::vector<int> {
+        return std::vector<int>(10);
+    };
+    auto populator = [&](int i, std::vector<int>& slab) -> void {
+        if (active[i]++) {
+            overlap = true;
+        }
+        std::fill(slab.begin(), slab.end(), i);
+        std::this_thread::yield();
+        --active[i];
+        ++npopulated;
+    };
+
+    std::vector<std::thread> workers;
+    constexpr int num_threads = 4;
+    std::vector<int> failures(num_threads);
+    for (int t = 0; t < num_threads; ++t) {
+        workers.emplace_back([&,t]() -> void {
+            std::mt19937_64 rng(t * 100 + cache_size);
+            for (int r = 0; r < 2000; ++r) {
+                int id = rng() % num_ids;
+                auto handle = cache.find(id, creator, populator);
+                for (auto x : *handle) {
+                    failures[t] += (x != id);
+                }
+            }
+        });
+    }
+    for (auto& w : workers) {
+        w.join();
+    }
+
+    for (auto f : failures) {
+        EXPECT_EQ(f, 0);
+    }
+    EXPECT_FALSE(overlap.load());
+    EXPECT_LE(cache.get_num_slabs(), static_cast<std::size_t>(cache_size));
+}
+
+TEST(ConcurrentLruSlabCache, PopulateOnce) {
+    // All threads miss on the same slab, but only one of them should populate it.
+    tatami_chunked::ConcurrentLruSlabCache<int, int> cache(10);
+    std::atomic<int> npopulated(0);
+    std::atomic<bool> go(false);
+
+    auto creator = []() -> int { return 0; };
+    auto populator = [&](int i, int& slab) -> void {
+        ++npopulated;
+        std::this_thread::sleep_for(std::chrono::milliseconds(20));
+        slab = i;
+    };
+
+    std::vector<std::thread> workers;
+    std::vector<int> results(8);
+    for (int t = 0; t < 8; ++t) {
+        workers.emplace_back([&,t]() -> void {
+            while (!go.load()) {
+                std::this_thread::yield();
+            }
+            results[t] = *cache.find(42, creator, populator);
+        });
+    }
+    go = true;
+    for (auto& w : workers) {
+        w.join();
+    }
+
+    EXPECT_EQ(npopulated.load(), 1);
+    for (auto r : results) {
+        EXPECT_EQ(r, 42);
+    }
+}
+
+INSTANTIATE_TEST_SUITE_P(
+    ConcurrentLruSlabCache,
+    ConcurrentLruSlabCacheStressTest,
+    ::testing::Combine(
+        ::testing::Values(1, 3, 10, 60), // max cache size
+        ::testing::Values(1, 4) // number of shards
+    )
+);
@@ -4,6 +4,9 @@
 
 #include "tatami_chunked/CustomDenseChunkedMatrix.hpp"
 
+#include <atomic>
+#include <numeric>
+
 typedef double ChunkValue_;
 typedef int Index_;
 
@@ -14,7 +17,7 @@ struct MockDenseChunkData {
 
 class MockDenseChunkWorkspace final : public tatami_chunked::CustomDenseChunkedMatrixWorkspace<ChunkValue_, Index_> {
 public:
-    MockDenseChunkWorkspace(const MockDenseChunkData& data) : my_data(data) {}
+    MockDenseChunkWorkspace(const MockDenseChunkData& data, bool single = false) : my_data(data), my_single(single) {}
 
     void extract(
         Index_ chunk_row,
@@ -137,16 +140,44 @@ public:
         }
     }
 
+    bool supports_extract_single() const {
+        return my_single;
+    }
+
+    void extract_single(Index_ chunk_row, Index_ chunk_column, bool row, Index_ target, Index_ non_target_start, Index_ non_target_length, ChunkValue_* output) {
+        const auto& curchunk = my_data.chunks[chunk_row * my_data.col_stats.num_chunks + chunk_column];
+        for (Index_ nidx = 0; nidx < non_target_length; ++nidx) {
+            output[nidx] = curchunk[single_offset(row, target, nidx + non_target_start)];
+        }
+    }
+
+    void extract_single(Index_ chunk_row, Index_ chunk_column, bool row, Index_ target, const std::vector<Index_>& non_target_indices, ChunkValue_* output) {
+        const auto& curchunk = my_data.chunks[chunk_row * my_data.col_stats.num_chunks + chunk_column];
+        auto ntsize = non_target_indices.size();
+        for (decltype(ntsize) nidx = 0; nidx < ntsize; ++nidx) {
+            output[nidx] = curchunk[single_offset(row, target, non_target_indices[nidx])];
+        }
+    }
+
 private:
     const MockDenseChunkData& my_data;
+    bool my_single;
+
+    std::size_t single_offset(bool row, Index_ target, Index_ non_target) const {
+        if (row) {
+            return static_cast<std::size_t>(target) * static_cast<std::size_t>(my_data.col_stats.chunk_length) + static_cast<std::size_t>(non_target);
+        } else {
+            return static_cast<std::size_t>(non_target) * static_cast<std::size_t>(my_data.col_stats.chunk_length) + static_cast<std::size_t>(target);
+        }
+    }
 };
 
 class MockDenseChunkManager final : public tatami_chunked::CustomDenseChunkedMatrixManager<ChunkValue_, Index_> {
 public:
-    MockDenseChunkManager(MockDenseChunkData data) : my_data(std::move(data)) {}
+    MockDenseChunkManager(MockDenseChunkData data, bool direct = false, bool single = false) : my_data(std::move(data)), my_direct(direct), my_single(single) {}
 
     std::unique_ptr<tatami_chunked::CustomDenseChunkedMatrixWorkspace<ChunkValue_, Index_> > new_workspace() const {
-        return std::make_unique<MockDenseChunkWorkspace>(my_data);
+        return std::make_unique<MockDenseChunkWorkspace>(my_data, my_single);
     }
 
     bool prefer_rows() const {
@@ -161,8 +192,23 @@ public:
         return my_data.col_stats;
     }
 
+    const MockDenseChunkData& data() const {
+        return my_data;
+    }
+
+    // Chunks are stored in row-major format, so we can only provide direct access for row extraction.
+    bool supports_chunk_data(bool row) const {
+        return my_direct && row;
+    }
+
+    const ChunkValue_* chunk_data(Index_ chunk_row, Index_ chunk_column, bool) const {
+        return my_data.chunks[chunk_row * my_data.col_stats.num_chunks + chunk_column].data();
+    }
+
 private:
     MockDenseChunkData my_data; 
+    bool my_direct;
+    bool my_single;
 };
 
 struct CustomDenseChunkedMatrixCore {
@@ -173,7 +219,7 @@ struct CustomDenseChunkedMatrixCore {
     > SimulationParameters;
 
 protected:
-    inline static std::unique_ptr<tatami::Matrix<double, int> > ref, simple_mat, subset_mat;
+    inline static std::unique_ptr<tatami::Matrix<double, int> > ref, simple_mat, subset_mat, async_mat, parallel_mat, shared_mat, counted_mat, shrunk_mat, shrunk_async_mat, shrunk_parallel_mat, belady_mat, belady_window_mat, direct_mat, single_mat;
     inline static SimulationParameters last_params;
 
     static void assemble(const SimulationParameters& params) {
@@ -232,6 +278,48 @@ protected:
 
         opt.cache_subset = true;
         subset_mat.reset(new tatami_chunked::CustomDenseChunkedMatrix<double, int, double>(manager, opt));
+
+        opt.cache_subset = false;
+        opt.async_populate = true;
+        async_mat.reset(new tatami_chunked::CustomDenseChunkedMatrix<double, int, double>(manager, opt));
+
+        opt.async_populate = false;
+        opt.num_populate_threads = 3;
+        parallel_mat.reset(new tatami_chunked::CustomDenseChunkedMatrix<double, int, double>(manager, opt));
+
+        opt.num_populate_threads = 1;
+        opt.shared_cache_size = cache_size;
+        shared_mat.reset(new tatami_chunked::CustomDenseChunkedMatrix<double, int, double>(manager, opt));
+
+        opt.shared_cache_size = 0;
+        opt.record_cache_counters = true;
+        counted_mat.reset(new tatami_chunked::CustomDenseChunkedMatrix<double, int, double>(manager, opt));
+
+        opt.shrink_cache_with_oracle = true;
+        shrunk_mat.reset(new tatami_chunked::CustomDenseChunkedMatrix<double, int, double>(manager, opt));
+
+        opt.async_populate = true;
+        shrunk_async_mat.reset(new tatami_chunked::CustomDenseChunkedMatrix<double, int, double>(manager, opt));
+
+        opt.async_populate = false;
+        opt.num_populate_threads = 3;
+        shrunk_parallel_mat.reset(new tatami_chunked::CustomDenseChunkedMatrix<double, int, double>(manager, opt));
+
+        opt.num_populate_threads = 1;
+        opt.record_cache_counters = false;
+        opt.shrink_cache_with_oracle = false;
+        opt.belady_eviction = true;
+        belady_mat.reset(new tatami_chunked::CustomDenseChunkedMatrix<double, int, double>(manager, opt));
+
+        opt.belady_max_lookahead = 3;
+        belady_window_mat.reset(new tatami_chunked::CustomDenseChunkedMatrix<double, int, double>(manager, opt));
+
+        opt.belady_eviction = false;
+        auto direct_manager = std::make_shared<MockDenseChunkManager>(manager->data(), true);
+        direct_mat.reset(new tatami_chunked::CustomDenseChunkedMatrix<double, int, double>(direct_manager, opt));
+
+        auto single_manager = std::make_shared<MockDenseChunkManager>(manager->data(), false, true);
+        single_mat.reset(new tatami_chunked::CustomDenseChunkedMatrix<double, int, double>(single_manager, opt));
     }
 };
 
@@ -252,6 +340,15 @@ TEST_P(CustomDenseChunkedMatrixFullTest, Basic) {
     EXPECT_FALSE(simple_mat->is_sparse());
     tatami_test::test_full_access(*simple_mat, *ref, opts);
     tatami_test::test_full_access(*subset_mat, *ref, opts);
+    tatami_test::test_full_access(*async_mat, *ref, opts);
+    tatami_test::test_full_access(*parallel_mat, *ref, opts);
+    tatami_test::test_full_access(*shared_mat, *ref, opts);
+    tatami_test::test_full_access(*counted_mat, *ref, opts);
+    tatami_test::test_full_access(*shrunk_mat, *ref, opts);
+    tatami_test::test_full_access(*belady_mat, *ref, opts);
+    tatami_test::test_full_access(*belady_window_mat, *ref, opts);
+    tatami_test::test_full_access(*direct_mat, *ref, opts);
+    tatami_test::test_full_access(*single_mat, *ref, opts);
 }
 
 INSTANTIATE_TEST_SUITE_P(
@@ -294,6 +391,15 @@ TEST_P(CustomDenseChunkedMatrixBlockTest, Basic) {
     auto block = std::get<2>(tparam);
     tatami_test::test_block_access(*simple_mat, *ref, block.first, block.second, opt);
     tatami_test::test_block_access(*subset_mat, *ref, block.first, block.second, opt);
+    tatami_test::test_block_access(*async_mat, *ref, block.first, block.second, opt);
+    tatami_test::test_block_access(*parallel_mat, *ref, block.first, block.second, opt);
+    tatami_test::test_block_access(*shared_mat, *ref, block.first, block.second, opt);
+    tatami_test::test_block_access(*counted_mat, *ref, block.first, block.second, opt);
+    tatami_test::test_block_access(*shrunk_mat, *ref, block.first, block.second, opt);
+    tatami_test::test_block_access(*belady_mat, *ref, block.first, block.second, opt);
+    tatami_test::test_block_access(*belady_window_mat, *ref, block.first, block.second, opt);
+    tatami_test::test_block_access(*direct_mat, *ref, block.first, block.second, opt);
+    tatami_test::test_block_access(*single_mat, *ref, block.first, block.second, opt);
 }
 
 INSTANTIATE_TEST_SUITE_P(
@@ -342,6 +448,15 @@ TEST_P(CustomDenseChunkedMatrixIndexTest, Basic) {
     auto index = std::get<2>(tparam);
     tatami_test::test_indexed_access(*simple_mat, *ref, index.first, index.second, opt);
     tatami_test::test_indexed_access(*subset_mat, *ref, index.first, index.second, opt);
+    tatami_test::test_indexed_access(*async_mat, *ref, index.first, index.second, opt);
+    tatami_test::test_indexed_access(*parallel_mat, *ref, index.first, index.second, opt);
+    tatami_test::test_indexed_access(*shared_mat, *ref, index.first, index.second, opt);
+    tatami_test::test_indexed_access(*counted_mat, *ref, index.first, index.second, opt);
+    tatami_test::test_indexed_access(*shrunk_mat, *ref, index.first, index.second, opt);
+    tatami_test::test_indexed_access(*belady_mat, *ref, index.first, index.second, opt);
+    tatami_test::test_indexed_access(*belady_window_mat, *ref, index.first, index.second, opt);
+    tatami_test::test_indexed_access(*direct_mat, *ref, index.first, index.second, opt);
+    tatami_test::test_indexed_access(*single_mat, *ref, index.first, index.second, opt);
 }
 
 INSTANTIATE_TEST_SUITE_P(
@@ -372,3 +487,516 @@ INSTANTIATE_TEST_SUITE_P(
         )
     )
 );
+
+/*******************************************************/
+
+class CountingDenseChunkManager final : public tatami_chunked::CustomDenseChunkedMatrixManager<ChunkValue_, Index_> {
+public:
+    CountingDenseChunkManager(MockDenseChunkData data) : my_manager(std::move(data)) {}
+
+    class Workspace final : public tatami_chunked::CustomDenseChunkedMatrixWorkspace<ChunkValue_, Index_> {
+    public:
+        Workspace(std::unique_ptr<tatami_chunked::CustomDenseChunkedMatrixWorkspace<ChunkValue_, Index_> > inner, std::atomic<int>& counter, std::atomic<int>& batches) :
+            my_inner(std::move(inner)), my_counter(counter), my_batches(batches) {}
+
+        void extract(Index_ r, Index_ c, bool row, Index_ ts, Index_ tl, Index_ ns, Index_ nl, ChunkValue_* output, Index_ stride) {
+            ++my_counter;
+            my_inner->extract(r, c, row, ts, tl, ns, nl, output, stride);
+        }
+
+        void extract(Index_ r, Index_ c, bool row, Index_ ts, Index_ tl, const std::vector<Index_>& ni, ChunkValue_* output, Index_ stride) {
+            ++my_counter;
+            my_inner->extract(r, c, row, ts, tl, ni, output, stride);
+        }
+
+        void extract(Index_ r, Index_ c, bool row, const std::vector<Index_>& ti, Index_ ns, Index_ nl, ChunkValue_* output, Index_ stride) {
+            ++my_counter;
+            my_inner->extract(r, c, row, ti, ns, nl, output, stride);
+        }
+
+        void extract(Index_ r, Index_ c, bool row, const std::vector<Index_>& ti, const std::vector<Index_>& ni, ChunkValue_* output, Index_ stride) {
+            ++my_counter;
+            my_inner->extract(r, c, row, ti, ni, output, stride);
+        }
+
+        void extract_many(bool row, const std::vector<ChunkRequest>& requests) {
+            ++my_batches;
+            tatami_chunked::CustomDenseChunkedMatrixWorkspace<ChunkValue_, Index_>::extract_many(row, requests);
+        }
+
+    private:
+        std::unique_ptr<tatami_chunked::CustomDenseChunkedMatrixWorkspace<ChunkValue_, Index_> > my_inner;
+        std::atomic<int>& my_counter;
+        std::atomic<int>& my_batches;
+    };
+
+    std::unique_ptr<tatami_chunked::CustomDenseChunkedMatrixWorkspace<ChunkValue_, Index_> > new_workspace() const {
+        return std::make_unique<Workspace>(my_manager.new_workspace(), counter, batches);
+    }
+
+    bool prefer_rows() const {
+        return my_manager.prefer_rows();
+    }
+
+    const tatami_chunked::ChunkDimensionStats<Index_>& row_stats() const {
+        return my_manager.row_stats();
+    }
+
+    const tatami_chunked::ChunkDimensionStats<Index_>& column_stats() const {
+        return my_manager.column_stats();
+    }
+
+    mutable std::atomic<int> counter = 0;
+    mutable std::atomic<int> batches = 0;
+
+private:
+    MockDenseChunkManager my_manager;
+};
+
+class CustomDenseChunkedMatrixSharedCacheTest : public ::testing::Test {
+protected:
+    inline static int NR = 97, NC = 53, CR = 10, CC = 7;
+
+    static std::shared_ptr<CountingDenseChunkManager> create_manager(const tatami::Matrix<double, int>& ref) {
+        MockDenseChunkData data;
+        data.row_stats = tatami_chunked::ChunkDimensionStats<Index_>(NR, CR);
+        data.col_stats = tatami_chunked::ChunkDimensionStats<Index_>(NC, CC);
+        data.chunks.resize(data.row_stats.num_chunks * data.col_stats.num_chunks);
+
+        auto ext = ref.dense_row();
+        std::vector<double> buffer(NC);
+        for (int r = 0; r < NR; ++r) {
+            auto ptr = ext->fetch(r, buffer.data());
+            int rchunk = r / CR, roffset = r % CR;
+            for (int c = 0; c < NC; ++c) {
+                auto& contents = data.chunks[rchunk * data.col_stats.num_chunks + c / CC];
+                contents.resize(CR * CC);
+                contents[roffset * CC + c % CC] = ptr[c];
+            }
+        }
+
+        return std::make_shared<CountingDenseChunkManager>(std::move(data));
+    }
+};
+
+TEST_F(CustomDenseChunkedMatrixSharedCacheTest, Reuse) {
+    auto full = tatami_test::simulate_vector<double>(NR * NC, tatami_test::SimulateVectorOptions());
+    tatami::DenseRowMatrix<double, int> ref(NR, NC, std::move(full));
+    auto manager = create_manager(ref);
+    int num_chunks = manager->row_stats().num_chunks * manager->column_stats().num_chunks;
+
+    tatami_chunked::CustomDenseChunkedMatrixOptions opt;
+    opt.maximum_cache_size = 0;
+    opt.require_minimum_cache = false;
+    opt.shared_cache_size = NR * NC * sizeof(double) * 2; // enough to hold everything.
+    tatami_chunked::CustomDenseChunkedMatrix<double, int, double> mat(manager, opt);
+
+    // Each chunk is only extracted once, even across extractors and dimensions.
+    tatami_test::test_full_access(mat, ref, tatami_test::TestAccessOptions());
+    EXPECT_EQ(manager->counter.load(), num_chunks);
+
+    auto ext = mat.dense_column(std::vector<int>{ 0, 5, 10, 22, 50 });
+    auto ref_ext = ref.dense_column(std::vector<int>{ 0, 5, 10, 22, 50 });
+    for (int c = 0; c < NC; ++c) {
+        EXPECT_EQ(tatami_test::fetch(*ext, c, 5), tatami_test::fetch(*ref_ext, c, 5));
+    }
+    EXPECT_EQ(manager->counter.load(), num_chunks);
+
+    // Works correctly with multiple threads.
+    std::vector<std::vector<double> > results(NR);
+    tatami::parallelize([&](int, int start, int length) -> void {
+        auto ext = mat.dense_row();
+        for (int r = start, end = start + length; r < end; ++r) {
+            results[r] = tatami_test::fetch(*ext, r, NC);
+        }
+    }, NR, 3);
+
+    auto rext = ref.dense_row();
+    for (int r = 0; r < NR; ++r) {
+        EXPECT_EQ(results[r], tatami_test::fetch(*rext, r, NC));
+    }
+    EXPECT_EQ(manager->counter.load(), num_chunks);
+}
+
+TEST_F(CustomDenseChunkedMatrixSharedCacheTest, Eviction) {
+    auto full = tatami_test::simulate_vector<double>(NR * NC, tatami_test::SimulateVectorOptions());
+    tatami::DenseRowMatrix<double, int> ref(NR, NC, std::move(full));
+    auto manager = create_manager(ref);
+
+    tatami_chunked::CustomDenseChunkedMatrixOptions opt;
+    opt.maximum_cache_size = 0;
+    opt.require_minimum_cache = false;
+    opt.shared_cache_size = CR * CC * sizeof(double) * 3; // only 3 chunks.
+
+    tatami_chunked::CustomDenseChunkedMatrix<double, int, double> mat(manager, opt);
+    tatami_test::test_full_access(mat, ref, tatami_test::TestAccessOptions());
+
+    opt.shared_cache_size = CR * CC * sizeof(double) - 1; // not enough for a single chunk, so it's just ignored.
+    tatami_chunked::CustomDenseChunkedMatrix<double, int, double> mat2(manager, opt);
+    tatami_test::test_full_access(mat2, ref, tatami_test::TestAccessOptions());
+}
+
+class CustomDenseChunkedMatrixBatchedTest : public CustomDenseChunkedMatrixSharedCacheTest {};
+
+TEST_F(CustomDenseChunkedMatrixBatchedTest, Myopic) {
+    auto full = tatami_test::simulate_vector<double>(NR * NC, tatami_test::SimulateVectorOptions());
+    tatami::DenseRowMatrix<double, int> ref(NR, NC, std::move(full));
+    auto manager = create_manager(ref);
+    int num_row_chunks = manager->row_stats().num_chunks;
+    int num_col_chunks = manager->column_stats().num_chunks;
+
+    tatami_chunked::CustomDenseChunkedMatrix<double, int, double> mat(manager, tatami_chunked::CustomDenseChunkedMatrixOptions());
+    auto ext = mat.dense_row();
+    auto rext = ref.dense_row();
+    for (int r = 0; r < NR; ++r) {
+        EXPECT_EQ(tatami_test::fetch(*ext, r, NC), tatami_test::fetch(*rext, r, NC));
+    }
+
+    // All chunks for each slab are requested in a single call.
+    EXPECT_EQ(manager->batches.load(), num_row_chunks);
+    EXPECT_EQ(manager->counter.load(), num_row_chunks * num_col_chunks);
+
+    // Indexed extraction along the non-target dimension doesn't use batched requests.
+    std::vector<int> indices { 1, 10, 20, 30 };
+    auto iext = mat.dense_row(indices);
+    auto riext = ref.dense_row(indices);
+    for (int r = 0; r < NR; ++r) {
+        EXPECT_EQ(tatami_test::fetch(*iext, r, indices.size()), tatami_test::fetch(*riext, r, indices.size()));
+    }
+    EXPECT_EQ(manager->batches.load(), num_row_chunks);
+}
+
+TEST_F(CustomDenseChunkedMatrixBatchedTest, Oracular) {
+    auto full = tatami_test::simulate_vector<double>(NR * NC, tatami_test::SimulateVectorOptions());
+    tatami::DenseRowMatrix<double, int> ref(NR, NC, std::move(full));
+    auto manager = create_manager(ref);
+    int num_row_chunks = manager->row_stats().num_chunks;
+    int num_col_chunks = manager->column_stats().num_chunks;
+
+    std::vector<int> predictions(NR);
+    std::iota(predictions.begin(), predictions.end(), 0);
+
+    // All slabs fit into the cache, so all chunks are requested in a single call.
+    tatami_chunked::CustomDenseChunkedMatrix<double, int, double> mat(manager, tatami_chunked::CustomDenseChunkedMatrixOptions());
+    auto ext = mat.dense_row(std::make_shared<tatami::FixedViewOracle<int> >(predictions.data(), predictions.size()), 5, 30);
+    auto rext = ref.dense_row(5, 30);
+    for (int r = 0; r < NR; ++r) {
+        EXPECT_EQ(tatami_test::fetch(*ext, 30), tatami_test::fetch(*rext, r, 30));
+    }
+    EXPECT_EQ(manager->batches.load(), 1);
+    EXPECT_EQ(manager->counter.load(), num_row_chunks * 5); // columns 5 to 34 span 5 column chunks.
+
+    // With parallel populates, each slab is requested separately.
+    tatami_chunked::CustomDenseChunkedMatrixOptions opt;
+    opt.num_populate_threads = 3;
+    tatami_chunked::CustomDenseChunkedMatrix<double, int, double> pmat(manager, opt);
+    auto pext = pmat.dense_row(std::make_shared<tatami::FixedViewOracle<int> >(predictions.data(), predictions.size()));
+    auto prext = ref.dense_row();
+    for (int r = 0; r < NR; ++r) {
+        EXPECT_EQ(tatami_test::fetch(*pext, NC), tatami_test::fetch(*prext, r, NC));
+    }
+    EXPECT_EQ(manager->batches.load(), 1 + num_row_chunks);
+    EXPECT_EQ(manager->counter.load(), num_row_chunks * 5 + num_row_chunks * num_col_chunks);
+}
+
+/*******************************************************/
+
+TEST(CustomDenseChunkedMatrix, Direct) {
+    int NR = 97, NC = 23, CR = 10;
+    auto full = tatami_test::simulate_vector<double>(NR * NC, tatami_test::SimulateVectorOptions());
+    tatami::DenseRowMatrix<double, int> ref(NR, NC, full);
+
+    // Each chunk spans the full width of the matrix.
+    MockDenseChunkData data;
+    data.row_stats = tatami_chunked::ChunkDimensionStats<Index_>(NR, CR);
+    data.col_stats = tatami_chunked::ChunkDimensionStats<Index_>(NC, NC);
+    for (int r = 0; r < data.row_stats.num_chunks; ++r) {
+        std::vector<double> contents(CR * NC);
+        int rstart = r * CR, rlen = std::min(CR, NR - rstart);
+        std::copy_n(full.begin() + rstart * NC, rlen * NC, contents.begin());
+        data.chunks.push_back(std::move(contents));
+    }
+
+    auto manager = std::make_shared<MockDenseChunkManager>(std::move(data), true);
+    tatami_chunked::CustomDenseChunkedMatrix<double, int, double> mat(manager, tatami_chunked::CustomDenseChunkedMatrixOptions());
+    tatami_test::test_full_access(mat, ref, tatami_test::TestAccessOptions());
+    tatami_test::test_block_access(mat, ref, 0.2, 0.5, tatami_test::TestAccessOptions());
+
+    // Pointers are returned directly from the manager's chunks.
+    std::vector<double> buffer(std::max(NR, NC));
+    {
+        auto ext = mat.dense_row();
+        for (int r = 0; r < NR; ++r) {
+            auto ptr = ext->fetch(r, buffer.data());
+            EXPECT_NE(ptr, buffer.data());
+            EXPECT_EQ(std::vector<double>(ptr, ptr + NC), std::vector<double>(full.begin() + r * NC, full.begin() + (r + 1) * NC));
+        }
+    }
+
+    {
+        std::vector<int> predictions { 95, 3, 50, 51, 12, 0 };
+        auto ext = mat.dense_row(std::make_shared<tatami::FixedViewOracle<int> >(predictions.data(), predictions.size()), 5, 10);
+        for (auto r : predictions) {
+            auto ptr = ext->fetch(buffer.data());
+            EXPECT_NE(ptr, buffer.data());
+            EXPECT_EQ(std::vector<double>(ptr, ptr + 10), std::vector<double>(full.begin() + r * NC + 5, full.begin() + r * NC + 15));
+        }
+    }
+
+    // Falls back to the usual extraction for columns, where the manager does not support direct access.
+    {
+        auto ext = mat.dense_column();
+        auto rext = ref.dense_column();
+        for (int c = 0; c < NC; ++c) {
+            auto ptr = ext->fetch(c, buffer.data());
+            EXPECT_EQ(ptr, buffer.data());
+            EXPECT_EQ(std::vector<double>(ptr, ptr + NR), tatami_test::fetch(*rext, c, NR));
+        }
+    }
+}
+
+/*******************************************************/
+
+template<typename Value_>
+static void compare_slab(const tatami_chunked::CustomDenseChunkedMatrixSlab<Value_, int>& slab, const tatami::Matrix<double, int>& ref, bool row) {
+    ASSERT_GE(slab.stride, static_cast<std::size_t>(slab.non_target_length));
+    auto rext = ref.dense(row, slab.non_target_start, slab.non_target_length, tatami::Options());
+    for (int p = 0; p < slab.target_length; ++p) {
+        auto expected = tatami_test::fetch(*rext, slab.target_start + p, slab.non_target_length);
+        auto ptr = slab.data + static_cast<std::size_t>(p) * slab.stride;
+        std::vector<double> observed(ptr, ptr + slab.non_target_length);
+        EXPECT_EQ(observed, expected);
+    }
+}
+
+TEST(CustomDenseChunkedMatrix, Slabs) {
+    int NR = 97, NC = 23, CR = 10, CC = 7;
+    auto full = tatami_test::simulate_vector<double>(NR * NC, tatami_test::SimulateVectorOptions());
+    tatami::DenseRowMatrix<double, int> ref(NR, NC, full);
+
+    MockDenseChunkData data;
+    data.row_stats = tatami_chunked::ChunkDimensionStats<Index_>(NR, CR);
+    data.col_stats = tatami_chunked::ChunkDimensionStats<Index_>(NC, CC);
+    for (int r = 0; r < data.row_stats.num_chunks; ++r) {
+        for (int c = 0; c < data.col_stats.num_chunks; ++c) {
+            std::vector<double> contents(CR * CC);
+            int rstart = r * CR, rlen = std::min(CR, NR - rstart);
+            int cstart = c * CC, clen = std::min(CC, NC - cstart);
+            for (int r2 = 0; r2 < rlen; ++r2) {
+                std::copy_n(full.begin() + (rstart + r2) * NC + cstart, clen, contents.begin() + r2 * CC);
+            }
+            data.chunks.push_back(std::move(contents));
+        }
+    }
+
+    auto manager = std::make_shared<MockDenseChunkManager>(data);
+    tatami_chunked::CustomDenseChunkedMatrix<double, int, double> mat(manager, tatami_chunked::CustomDenseChunkedMatrixOptions());
+
+    for (bool row : { true, false }) {
+        auto ext = mat.dense_slabs(row);
+        EXPECT_EQ(ext->num_slabs(), row ? data.row_stats.num_chunks : data.col_stats.num_chunks);
+        int last_end = 0;
+        for (int s = 0; s < ext->num_slabs(); ++s) {
+            auto slab = ext->fetch(s);
+            EXPECT_EQ(slab.target_start, last_end);
+            EXPECT_EQ(slab.non_target_start, 0);
+            EXPECT_EQ(slab.non_target_length, row ? NC : NR);
+            compare_slab(slab, ref, row);
+            last_end += slab.target_length;
+        }
+        EXPECT_EQ(last_end, row ? NR : NC);
+
+        // Blocks spanning multiple chunks.
+        auto bext = mat.dense_slabs(row, 5, 12);
+        for (int s = 0; s < bext->num_slabs(); ++s) {
+            compare_slab(bext->fetch(s), ref, row);
+        }
+
+        // Empty blocks are also fine.
+        auto eext = mat.dense_slabs(row, 3, 0);
+        auto empty = eext->fetch(1);
+        EXPECT_EQ(empty.non_target_length, 0);
+    }
+
+    // Converting to a different type.
+    tatami_chunked::CustomDenseChunkedMatrix<float, int, double> fmat(manager, tatami_chunked::CustomDenseChunkedMatrixOptions());
+    {
+        auto ext = fmat.dense_slabs(true, 2, 15);
+        for (int s = 0; s < ext->num_slabs(); ++s) {
+            auto slab = ext->fetch(s);
+            auto rext = ref.dense_row(2, 15);
+            for (int p = 0; p < slab.target_length; ++p) {
+                auto expected = tatami_test::fetch(*rext, slab.target_start + p, 15);
+                auto ptr = slab.data + static_cast<std::size_t>(p) * slab.stride;
+                for (int q = 0; q < 15; ++q) {
+                    EXPECT_EQ(ptr[q], static_cast<float>(expected[q]));
+                }
+            }
+        }
+    }
+
+    // Pointing directly into the chunks if the block lies within a single chunk.
+    auto direct_manager = std::make_shared<MockDenseChunkManager>(data, true);
+    tatami_chunked::CustomDenseChunkedMatrix<double, int, double> dmat(direct_manager, tatami_chunked::CustomDenseChunkedMatrixOptions());
+    {
+        auto ext = dmat.dense_slabs(true, 8, 5);
+        for (int s = 0; s < ext->num_slabs(); ++s) {
+            auto slab = ext->fetch(s);
+            EXPECT_EQ(slab.stride, static_cast<std::size_t>(CC));
+            EXPECT_EQ(slab.data, direct_manager->chunk_data(s, 1, true) + 1);
+            compare_slab(slab, ref, true);
+        }
+
+        auto mext = dmat.dense_slabs(true, 5, 5);
+        for (int s = 0; s < mext->num_slabs(); ++s) {
+            auto slab = mext->fetch(s);
+            EXPECT_EQ(slab.stride, static_cast<std::size_t>(5));
+            compare_slab(slab, ref, true);
+        }
+    }
+
+    // Works with a shared cache.
+    tatami_chunked::CustomDenseChunkedMatrixOptions sopt;
+    sopt.shared_cache_size = NR * NC * sizeof(double);
+    tatami_chunked::CustomDenseChunkedMatrix<double, int, double> smat(manager, sopt);
+    for (bool row : { true, false }) {
+        auto ext = smat.dense_slabs(row, 4, 11);
+        for (int s = 0; s < ext->num_slabs(); ++s) {
+            compare_slab(ext->fetch(s), ref, row);
+        }
+    }
+}
+
+class CustomDenseChunkedMatrixCountersTest : public ::testing::Test, public CustomDenseChunkedMatrixCore {
+protected:
+    void SetUp() {
+        assemble({ { 100, 50 }, { 10, 10 }, 0.1 }); // cache can only hold one row slab.
+    }
+};
+
+TEST_F(CustomDenseChunkedMatrixCountersTest, Myopic) {
+    auto ext = counted_mat->dense_row();
+    std::vector<double> buffer(50);
+    for (int r = 0; r < 100; ++r) {
+        ext->fetch(r, buffer.data());
+    }
+
+    auto reporter = dynamic_cast<const tatami_chunked::SlabCacheCountersReporter*>(ext.get());
+    ASSERT_TRUE(reporter != NULL);
+    auto counters = reporter->get_slab_cache_counters();
+    EXPECT_EQ(counters.misses, 10);
+    EXPECT_EQ(counters.hits, 90);
+    EXPECT_EQ(counters.evictions, 9);
+    EXPECT_EQ(counters.populate_calls, 10);
+    EXPECT_EQ(counters.slabs_populated, 10);
+    EXPECT_EQ(counters.slabs_reused, 0);
+    EXPECT_EQ(counters.hit_rate(), 0.9);
+
+    // Going back to a previous slab is a miss.
+    ext->fetch(0, buffer.data());
+    EXPECT_EQ(reporter->get_slab_cache_counters().misses, 11);
+
+    // Not available if we didn't ask for it.
+    auto simple_ext = simple_mat->dense_row();
+    EXPECT_TRUE(dynamic_cast<const tatami_chunked::SlabCacheCountersReporter*>(simple_ext.get()) == NULL);
+}
+
+TEST_F(CustomDenseChunkedMatrixCountersTest, Oracular) {
+    auto ext = counted_mat->dense_row(std::make_shared<tatami::ConsecutiveOracle<int> >(0, 100));
+    std::vector<double> buffer(50);
+    for (int r = 0; r < 100; ++r) {
+        ext->fetch(buffer.data());
+    }
+
+    auto reporter = dynamic_cast<const tatami_chunked::SlabCacheCountersReporter*>(ext.get());
+    ASSERT_TRUE(reporter != NULL);
+    auto counters = reporter->get_slab_cache_counters();
+    EXPECT_EQ(counters.misses, 10);
+    EXPECT_EQ(counters.hits, 90);
+    EXPECT_EQ(counters.evictions, 9);
+    EXPECT_EQ(counters.populate_calls, 10);
+    EXPECT_EQ(counters.slabs_populated, 10);
+    EXPECT_EQ(counters.slabs_per_populate(), 1);
+}
+
+class CustomDenseChunkedMatrixShrinkTest : public ::testing::Test, public CustomDenseChunkedMatrixCore {
+protected:
+    void SetUp() {
+        assemble({ { 100, 50 }, { 10, 10 }, 1 }); // cache can hold all row slabs.
+    }
+};
+
+TEST_F(CustomDenseChunkedMatrixShrinkTest, Consecutive) {
+    std::vector<double> buffer(50);
+    auto oracle = std::make_shared<tatami::ConsecutiveOracle<int> >(0, 100);
+
+    // Without shrinking, the cache holds all slabs so everything is loaded in a single populate cycle.
+    auto ext = counted_mat->dense_row(oracle);
+    for (int r = 0; r < 100; ++r) {
+        ext->fetch(buffer.data());
+    }
+    auto counters = dynamic_cast<const tatami_chunked::SlabCacheCountersReporter*>(ext.get())->get_slab_cache_counters();
+    EXPECT_EQ(counters.populate_calls, 1);
+    EXPECT_EQ(counters.slabs_populated, 10);
+
+    // With shrinking, the cache only holds the minimum of two slabs as each slab is never revisited.
+    auto sext = shrunk_mat->dense_row(oracle);
+    auto rext = ref->dense_row();
+    std::vector<double> rbuffer(50);
+    for (int r = 0; r < 100; ++r) {
+        auto ptr = sext->fetch(buffer.data());
+        auto expected = rext->fetch(r, rbuffer.data());
+        ASSERT_EQ(std::vector<double>(ptr, ptr + 50), std::vector<double>(expected, expected + 50));
+    }
+    auto scounters = dynamic_cast<const tatami_chunked::SlabCacheCountersReporter*>(sext.get())->get_slab_cache_counters();
+    EXPECT_EQ(scounters.populate_calls, 5);
+    EXPECT_EQ(scounters.slabs_populated, 10);
+    EXPECT_EQ(scounters.misses, 5);
+}
+
+TEST_F(CustomDenseChunkedMatrixShrinkTest, Populate) {
+    std::vector<double> buffer(50);
+    auto oracle = std::make_shared<tatami::ConsecutiveOracle<int> >(0, 100);
+
+    // Shrinking still leaves enough slabs for prefetching, so only the first cycle is a miss.
+    auto aext = shrunk_async_mat->dense_row(oracle);
+    for (int r = 0; r < 100; ++r) {
+        aext->fetch(buffer.data());
+    }
+    auto acounters = dynamic_cast<const tatami_chunked::SlabCacheCountersReporter*>(aext.get())->get_slab_cache_counters();
+    EXPECT_EQ(acounters.misses, 1);
+    EXPECT_EQ(acounters.slabs_populated, 10);
+
+    // Similarly, each cycle still contains one slab per thread for parallel population.
+    auto pext = shrunk_parallel_mat->dense_row(oracle);
+    auto rext = ref->dense_row();
+    std::vector<double> rbuffer(50);
+    for (int r = 0; r < 100; ++r) {
+        auto ptr = pext->fetch(buffer.data());
+        auto expected = rext->fetch(r, rbuffer.data());
+        ASSERT_EQ(std::vector<double>(ptr, ptr + 50), std::vector<double>(expected, expected + 50));
+    }
+    auto pcounters = dynamic_cast<const tatami_chunked::SlabCacheCountersReporter*>(pext.get())->get_slab_cache_counters();
+    EXPECT_EQ(pcounters.populate_calls, 4);
+    EXPECT_EQ(pcounters.slabs_populated, 10);
+}
+
+TEST_F(CustomDenseChunkedMatrixShrinkTest, Revisited) {
+    // Alternating between two slabs means that the cache needs to hold both of them.
+    std::vector<int> predictions;
+    for (int r = 0; r < 10; ++r) {
+        predictions.push_back(r);
+        predictions.push_back(r + 50);
+    }
+    auto oracle = std::make_shared<tatami::FixedVectorOracle<int> >(std::move(predictions));
+
+    std::vector<double> buffer(50);
+    auto ext = shrunk_mat->dense_row(oracle);
+    for (int i = 0; i < 20; ++i) {
+        ext->fetch(buffer.data());
+    }
+    auto counters = dynamic_cast<const tatami_chunked::SlabCacheCountersReporter*>(ext.get())->get_slab_cache_counters();
+    EXPECT_EQ(counters.populate_calls, 1);
+    EXPECT_EQ(counters.slabs_populated, 2);
+    EXPECT_EQ(counters.misses, 1);
+}
@@ -3,6 +3,7 @@
 #include "tatami_test/tatami_test.hpp"
 
 #include "tatami_chunked/CustomSparseChunkedMatrix.hpp"
+#include "tatami_chunked/RecordedChunkedMatrix.hpp"
 
 typedef double ChunkValue_;
 typedef int Index_;
@@ -21,10 +22,16 @@ struct MockSparseChunkData {
 
 class MockSparseChunkWorkspace final : public tatami_chunked::CustomSparseChunkedMatrixWorkspace<ChunkValue_, Index_> {
 public:
-    MockSparseChunkWorkspace(const MockSparseChunkData& data) : my_data(data) {}
+    // If 'check_capacity = true', we check that each extract() call respects the capacity implied by the manager's reported counts,
+    // where 'extra_nonzeros' is the padding added to each count by the manager.
+    MockSparseChunkWorkspace(const MockSparseChunkData& data, bool check_capacity = false, std::size_t extra_nonzeros = 0) :
+        my_data(data), my_check_capacity(check_capacity), my_extra_nonzeros(extra_nonzeros) {}
 
 private:
     const MockSparseChunkData& my_data;
+    bool my_check_capacity;
+    std::size_t my_extra_nonzeros;
+    std::vector<Index_> my_number_before;
 
     // Allocation to allow for O(1) mapping of requested indices to sparse indices.
     // This mimics what is done in the indexed sparse extractors in tatami proper.
@@ -175,6 +182,46 @@ private:
         }
     }
 
+    void snapshot_number(Index_ chunk_row_id, Index_ chunk_column_id, bool row, const Index_* output_number) {
+        if (my_check_capacity) {
+            auto extent = (row ? tatami_chunked::get_chunk_length(my_data.row_stats, chunk_row_id) : tatami_chunked::get_chunk_length(my_data.col_stats, chunk_column_id));
+            my_number_before.assign(output_number, output_number + extent);
+        }
+    }
+
+    // When the manager reports its counts, the space after output_number[p] is only guaranteed to hold the chunk's reported non-zeros,
+    // or the number of requested non-target elements if this is smaller. We check that we never store more than this,
+    // and that this space does not run into the storage for the next target element if the slab is packed contiguously.
+    template<typename Pointer_>
+    void check_capacity_spacing(const std::vector<Pointer_>& outputs, std::size_t capacity) {
+        for (std::size_t p = 0; p + 1 < outputs.size(); ++p) {
+            if (outputs[p] < outputs[p + 1]) {
+                EXPECT_LE(static_cast<std::size_t>(my_number_before[p]) + capacity, static_cast<std::size_t>(outputs[p + 1] - outputs[p]));
+            }
+        }
+    }
+
+    void check_capacity(
+        Index_ chunk_row_id,
+        Index_ chunk_column_id,
+        std::size_t non_target_count,
+        const std::vector<ChunkValue_*>& output_values,
+        const std::vector<Index_*>& output_indices,
+        const Index_* output_number)
+    {
+        if (!my_check_capacity) {
+            return;
+        }
+
+        const auto& chunk = my_data.chunks[chunk_row_id * my_data.col_stats.num_chunks + chunk_column_id];
+        std::size_t capacity = std::min(non_target_count, chunk.values.size() + my_extra_nonzeros);
+        for (std::size_t p = 0; p < my_number_before.size(); ++p) {
+            EXPECT_LE(static_cast<std::size_t>(output_number[p] - my_number_before[p]), capacity);
+        }
+        check_capacity_spacing(output_values, capacity);
+        check_capacity_spacing(output_indices, capacity);
+    }
+
 public:
     void extract(
         Index_ chunk_row_id,
@@ -190,6 +237,7 @@ public:
         Index_ shift)
     {
         const auto& current_chunk = my_data.chunks[chunk_row_id * my_data.col_stats.num_chunks + chunk_column_id];
+        snapshot_number(chunk_row_id, chunk_column_id, row, output_number);
         Index_ target_end = target_start + target_length;
         Index_ non_target_end = non_target_start + non_target_length;
 
@@ -205,6 +253,8 @@ public:
                 fill_secondary<true>(s, current_chunk, target_start, target_end, target_chunkdim, output_values, output_indices, output_number, shift);
             }
         }
+
+        check_capacity(chunk_row_id, chunk_column_id, non_target_length, output_values, output_indices, output_number);
     }
 
     void extract(
@@ -220,6 +270,7 @@ public:
         Index_ shift)
     {
         const auto& current_chunk = my_data.chunks[chunk_row_id * my_data.col_stats.num_chunks + chunk_column_id];
+        snapshot_number(chunk_row_id, chunk_column_id, row, output_number);
         Index_ target_end = target_start + target_length;
 
         if (row) {
@@ -240,6 +291,8 @@ public:
                 fill_secondary<true>(s, current_chunk, target_start, target_end, target_chunkdim, output_values, output_indices, output_number, shift);
             }
         }
+
+        check_capacity(chunk_row_id, chunk_column_id, non_target_indices.size(), output_values, output_indices, output_number);
     }
 
     void extract(
@@ -255,6 +308,7 @@ public:
         Index_ shift)
     {
         const auto& current_chunk = my_data.chunks[chunk_row_id * my_data.col_stats.num_chunks + chunk_column_id];
+        snapshot_number(chunk_row_id, chunk_column_id, row, output_number);
         Index_ non_target_end = non_target_start + non_target_length;
 
         if (row) {
@@ -275,6 +329,8 @@ public:
             }
             reset_remap(target_indices);
         }
+
+        check_capacity(chunk_row_id, chunk_column_id, non_target_length, output_values, output_indices, output_number);
     }
 
     void extract(
@@ -289,6 +345,7 @@ public:
         Index_ shift)
     {
         const auto& current_chunk = my_data.chunks[chunk_row_id * my_data.col_stats.num_chunks + chunk_column_id];
+        snapshot_number(chunk_row_id, chunk_column_id, row, output_number);
 
         if (row) {
             // non_target_indices is guaranteed to be non-empty, see contracts below.
@@ -314,15 +371,19 @@ public:
             }
             reset_remap(target_indices);
         }
+
+        check_capacity(chunk_row_id, chunk_column_id, non_target_indices.size(), output_values, output_indices, output_number);
     }
 };
 
 class MockSparseChunkManager final : public tatami_chunked::CustomSparseChunkedMatrixManager<ChunkValue_, Index_> {
 public:
-    MockSparseChunkManager(MockSparseChunkData data) : my_data(std::move(data)) {}
+    // 'extra_nonzeros' is added to each reported count, to mimic managers that only report an upper bound.
+    MockSparseChunkManager(MockSparseChunkData data, bool report_nonzeros = false, std::size_t extra_nonzeros = 0) :
+        my_data(std::move(data)), my_report_nonzeros(report_nonzeros), my_extra_nonzeros(extra_nonzeros) {}
 
     std::unique_ptr<tatami_chunked::CustomSparseChunkedMatrixWorkspace<ChunkValue_, Index_> > new_workspace() const {
-        return std::make_unique<MockSparseChunkWorkspace>(my_data);
+        return std::make_unique<MockSparseChunkWorkspace>(my_data, /* check_capacity = */ my_report_nonzeros, my_extra_nonzeros);
     }
 
     bool prefer_rows() const {
@@ -337,10 +398,59 @@ public:
         return my_data.col_stats;
     }
 
+    bool has_chunk_nonzeros() const {
+        return my_report_nonzeros;
+    }
+
+    std::size_t chunk_nonzeros(Index_ chunk_row_id, Index_ chunk_column_id) const {
+        return my_data.chunks[chunk_row_id * my_data.col_stats.num_chunks + chunk_column_id].values.size() + my_extra_nonzeros;
+    }
+
 private:
     MockSparseChunkData my_data; 
+    bool my_report_nonzeros;
+    std::size_t my_extra_nonzeros;
 };
 
+static MockSparseChunkData create_mock_data(const tatami::Matrix<double, int>& ref, std::pair<int, int> chunkdim) {
+    std::pair<int, int> matdim(ref.nrow(), ref.ncol());
+    MockSparseChunkData data;
+    data.row_stats = tatami_chunked::ChunkDimensionStats<Index_>(matdim.first, chunkdim.first);
+    data.col_stats = tatami_chunked::ChunkDimensionStats<Index_>(matdim.second, chunkdim.second);
+    data.chunks.resize(data.row_stats.num_chunks * data.col_stats.num_chunks);
+
+    for (int r = 0; r < data.row_stats.num_chunks; ++r) {
+        for (int c = 0; c < data.col_stats.num_chunks; ++c) {
+            auto cstart = c * chunkdim.second;
+            auto cend = std::min(cstart + chunkdim.second, matdim.second);
+            auto clen = cend - cstart;
+
+            auto rstart = r * chunkdim.first;
+            auto rend = std::min(rstart + chunkdim.first, matdim.first);
+            auto rlen = rend - rstart;
+
+            MockSparseChunk chunk;
+            chunk.indptrs.resize(1);
+            auto ext = ref.sparse_row(cstart, clen);
+            std::vector<double> vbuffer(clen);
+            std::vector<int> ibuffer(clen);
+
+            for (int r2 = 0; r2 < rlen; ++r2) {
+                auto range = ext->fetch(r2 + rstart, vbuffer.data(), ibuffer.data());
+                chunk.values.insert(chunk.values.end(), range.value, range.value + range.number);
+                for (int i = 0; i < range.number; ++i) {
+                    chunk.indices.push_back(range.index[i] - cstart);
+                }
+                chunk.indptrs.push_back(chunk.indptrs.back() + range.number);
+            }
+
+            auto offset = r * data.col_stats.num_chunks + c;
+            data.chunks[offset] = std::move(chunk);
+        }
+    }
+    return data;
+}
+
 class CustomSparseChunkedMatrixCore {
 public:
     typedef std::tuple<
@@ -350,7 +460,7 @@ public:
     > SimulationParameters;
 
 protected:
-    inline static std::unique_ptr<tatami::Matrix<double, int> > ref, simple_mat, subset_mat;
+    inline static std::unique_ptr<tatami::Matrix<double, int> > ref, simple_mat, subset_mat, async_mat, parallel_mat, counted_mat, shrunk_mat, shrunk_async_mat, shrunk_parallel_mat, belady_mat, belady_window_mat, variable_mat, variable_counted_mat, nonzero_mat, compact_mat, compact_counted_mat, compact_nonzero_mat;
     inline static SimulationParameters last_params;
 
     static void assemble(const SimulationParameters& params) {
@@ -380,51 +490,72 @@ protected:
             std::move(full.indptr)
         ));
 
-        MockSparseChunkData data;
-        data.row_stats = tatami_chunked::ChunkDimensionStats<Index_>(matdim.first, chunkdim.first);
-        data.col_stats = tatami_chunked::ChunkDimensionStats<Index_>(matdim.second, chunkdim.second);
-        data.chunks.resize(data.row_stats.num_chunks * data.col_stats.num_chunks);
-
-        for (int r = 0; r < data.row_stats.num_chunks; ++r) {
-            for (int c = 0; c < data.col_stats.num_chunks; ++c) {
-                auto cstart = c * chunkdim.second;
-                auto cend = std::min(cstart + chunkdim.second, matdim.second);
-                auto clen = cend - cstart;
-
-                auto rstart = r * chunkdim.first;
-                auto rend = std::min(rstart + chunkdim.first, matdim.first);
-                auto rlen = rend - rstart;
-
-                MockSparseChunk chunk;
-                chunk.indptrs.resize(1);
-                auto ext = ref->sparse_row(cstart, clen);
-                std::vector<double> vbuffer(clen);
-                std::vector<int> ibuffer(clen);
-
-                for (int r2 = 0; r2 < rlen; ++r2) {
-                    auto range = ext->fetch(r2 + rstart, vbuffer.data(), ibuffer.data());
-                    chunk.values.insert(chunk.values.end(), range.value, range.value + range.number);
-                    for (int i = 0; i < range.number; ++i) {
-                        chunk.indices.push_back(range.index[i] - cstart);
-                    }
-                    chunk.indptrs.push_back(chunk.indptrs.back() + range.number);
-                }
-
-                auto offset = r * data.col_stats.num_chunks + c;
-                data.chunks[offset] = std::move(chunk);
-            }
-        }
+        auto data = create_mock_data(*ref, chunkdim);
 
         tatami_chunked::CustomSparseChunkedMatrixOptions opt;
         std::size_t cache_size = static_cast<double>(matdim.first) * static_cast<double>(matdim.second) * cache_fraction * static_cast<double>(sizeof(double) + sizeof(int));
         opt.maximum_cache_size = cache_size;
         opt.require_minimum_cache = (cache_size > 0);
 
+        auto nonzero_manager = std::make_shared<MockSparseChunkManager>(data, /* report_nonzeros = */ true);
         auto manager = std::make_shared<MockSparseChunkManager>(std::move(data));
         simple_mat.reset(new tatami_chunked::CustomSparseChunkedMatrix<double, int, double>(manager, opt));
 
         opt.cache_subset = true;
         subset_mat.reset(new tatami_chunked::CustomSparseChunkedMatrix<double, int, double>(manager, opt));
+
+        opt.cache_subset = false;
+        opt.async_populate = true;
+        async_mat.reset(new tatami_chunked::CustomSparseChunkedMatrix<double, int, double>(manager, opt));
+
+        opt.async_populate = false;
+        opt.num_populate_threads = 3;
+        parallel_mat.reset(new tatami_chunked::CustomSparseChunkedMatrix<double, int, double>(manager, opt));
+
+        opt.num_populate_threads = 1;
+        opt.record_cache_counters = true;
+        counted_mat.reset(new tatami_chunked::CustomSparseChunkedMatrix<double, int, double>(manager, opt));
+
+        opt.shrink_cache_with_oracle = true;
+        shrunk_mat.reset(new tatami_chunked::CustomSparseChunkedMatrix<double, int, double>(manager, opt));
+
+        opt.async_populate = true;
+        shrunk_async_mat.reset(new tatami_chunked::CustomSparseChunkedMatrix<double, int, double>(manager, opt));
+
+        opt.async_populate = false;
+        opt.num_populate_threads = 3;
+        shrunk_parallel_mat.reset(new tatami_chunked::CustomSparseChunkedMatrix<double, int, double>(manager, opt));
+
+        opt.num_populate_threads = 1;
+        opt.record_cache_counters = false;
+        opt.shrink_cache_with_oracle = false;
+        opt.belady_eviction = true;
+        belady_mat.reset(new tatami_chunked::CustomSparseChunkedMatrix<double, int, double>(manager, opt));
+
+        opt.belady_max_lookahead = 3;
+        belady_window_mat.reset(new tatami_chunked::CustomSparseChunkedMatrix<double, int, double>(manager, opt));
+
+        opt.belady_eviction = false;
+        opt.variable_slab_size = true;
+        variable_mat.reset(new tatami_chunked::CustomSparseChunkedMatrix<double, int, double>(manager, opt));
+
+        opt.record_cache_counters = true;
+        variable_counted_mat.reset(new tatami_chunked::CustomSparseChunkedMatrix<double, int, double>(manager, opt));
+
+        opt.record_cache_counters = false;
+        nonzero_mat.reset(new tatami_chunked::CustomSparseChunkedMatrix<double, int, double>(nonzero_manager, opt));
+
+        opt.variable_slab_size = false;
+        opt.compact_slabs = true;
+        opt.num_populate_threads = 3;
+        compact_mat.reset(new tatami_chunked::CustomSparseChunkedMatrix<double, int, double>(manager, opt));
+
+        opt.num_populate_threads = 1;
+        opt.record_cache_counters = true;
+        compact_counted_mat.reset(new tatami_chunked::CustomSparseChunkedMatrix<double, int, double>(manager, opt));
+
+        opt.record_cache_counters = false;
+        compact_nonzero_mat.reset(new tatami_chunked::CustomSparseChunkedMatrix<double, int, double>(std::move(nonzero_manager), opt));
     }
 };
 
@@ -445,6 +576,18 @@ TEST_P(CustomSparseChunkedMatrixFullTest, Basic) {
     EXPECT_TRUE(simple_mat->is_sparse());
     tatami_test::test_full_access(*simple_mat, *ref, opt);
     tatami_test::test_full_access(*subset_mat, *ref, opt);
+    tatami_test::test_full_access(*async_mat, *ref, opt);
+    tatami_test::test_full_access(*parallel_mat, *ref, opt);
+    tatami_test::test_full_access(*counted_mat, *ref, opt);
+    tatami_test::test_full_access(*shrunk_mat, *ref, opt);
+    tatami_test::test_full_access(*belady_mat, *ref, opt);
+    tatami_test::test_full_access(*belady_window_mat, *ref, opt);
+    tatami_test::test_full_access(*variable_mat, *ref, opt);
+    tatami_test::test_full_access(*variable_counted_mat, *ref, opt);
+    tatami_test::test_full_access(*nonzero_mat, *ref, opt);
+    tatami_test::test_full_access(*compact_mat, *ref, opt);
+    tatami_test::test_full_access(*compact_counted_mat, *ref, opt);
+    tatami_test::test_full_access(*compact_nonzero_mat, *ref, opt);
 }
 
 INSTANTIATE_TEST_SUITE_P(
@@ -487,6 +630,18 @@ TEST_P(CustomSparseChunkedMatrixBlockTest, Basic) {
     auto block = std::get<2>(tparam);
     tatami_test::test_block_access(*simple_mat, *ref, block.first, block.second, opt);
     tatami_test::test_block_access(*subset_mat, *ref, block.first, block.second, opt);
+    tatami_test::test_block_access(*async_mat, *ref, block.first, block.second, opt);
+    tatami_test::test_block_access(*parallel_mat, *ref, block.first, block.second, opt);
+    tatami_test::test_block_access(*counted_mat, *ref, block.first, block.second, opt);
+    tatami_test::test_block_access(*shrunk_mat, *ref, block.first, block.second, opt);
+    tatami_test::test_block_access(*belady_mat, *ref, block.first, block.second, opt);
+    tatami_test::test_block_access(*belady_window_mat, *ref, block.first, block.second, opt);
+    tatami_test::test_block_access(*variable_mat, *ref, block.first, block.second, opt);
+    tatami_test::test_block_access(*variable_counted_mat, *ref, block.first, block.second, opt);
+    tatami_test::test_block_access(*nonzero_mat, *ref, block.first, block.second, opt);
+    tatami_test::test_block_access(*compact_mat, *ref, block.first, block.second, opt);
+    tatami_test::test_block_access(*compact_counted_mat, *ref, block.first, block.second, opt);
+    tatami_test::test_block_access(*compact_nonzero_mat, *ref, block.first, block.second, opt);
 }
 
 INSTANTIATE_TEST_SUITE_P(
@@ -535,6 +690,18 @@ TEST_P(CustomSparseChunkedMatrixIndexTest, Basic) {
     auto index = std::get<2>(tparam);
     tatami_test::test_indexed_access(*simple_mat, *ref, index.first, index.second, opt);
     tatami_test::test_indexed_access(*subset_mat, *ref, index.first, index.second, opt);
+    tatami_test::test_indexed_access(*async_mat, *ref, index.first, index.second, opt);
+    tatami_test::test_indexed_access(*parallel_mat, *ref, index.first, index.second, opt);
+    tatami_test::test_indexed_access(*counted_mat, *ref, index.first, index.second, opt);
+    tatami_test::test_indexed_access(*shrunk_mat, *ref, index.first, index.second, opt);
+    tatami_test::test_indexed_access(*belady_mat, *ref, index.first, index.second, opt);
+    tatami_test::test_indexed_access(*belady_window_mat, *ref, index.first, index.second, opt);
+    tatami_test::test_indexed_access(*variable_mat, *ref, index.first, index.second, opt);
+    tatami_test::test_indexed_access(*variable_counted_mat, *ref, index.first, index.second, opt);
+    tatami_test::test_indexed_access(*nonzero_mat, *ref, index.first, index.second, opt);
+    tatami_test::test_indexed_access(*compact_mat, *ref, index.first, index.second, opt);
+    tatami_test::test_indexed_access(*compact_counted_mat, *ref, index.first, index.second, opt);
+    tatami_test::test_indexed_access(*compact_nonzero_mat, *ref, index.first, index.second, opt);
 }
 
 INSTANTIATE_TEST_SUITE_P(
@@ -565,3 +732,377 @@ INSTANTIATE_TEST_SUITE_P(
         )
     )
 );
+
+/*******************************************************/
+
+class CustomSparseChunkedMatrixCountersTest : public ::testing::Test, public CustomSparseChunkedMatrixCore {
+protected:
+    void SetUp() {
+        assemble({ { 100, 50 }, { 10, 10 }, 0.1 }); // cache can only hold one row slab.
+    }
+};
+
+TEST_F(CustomSparseChunkedMatrixCountersTest, Myopic) {
+    auto ext = counted_mat->sparse_row();
+    std::vector<double> vbuffer(50);
+    std::vector<int> ibuffer(50);
+    for (int r = 0; r < 100; ++r) {
+        ext->fetch(r, vbuffer.data(), ibuffer.data());
+    }
+
+    auto reporter = dynamic_cast<const tatami_chunked::SlabCacheCountersReporter*>(ext.get());
+    ASSERT_TRUE(reporter != NULL);
+    auto counters = reporter->get_slab_cache_counters();
+    EXPECT_EQ(counters.misses, 10);
+    EXPECT_EQ(counters.hits, 90);
+    EXPECT_EQ(counters.evictions, 9);
+    EXPECT_EQ(counters.populate_calls, 10);
+    EXPECT_EQ(counters.slabs_populated, 10);
+
+    // Also available for the densified extractors.
+    auto dext = counted_mat->dense_row();
+    EXPECT_TRUE(dynamic_cast<const tatami_chunked::SlabCacheCountersReporter*>(dext.get()) != NULL);
+
+    // Not available if we didn't ask for it.
+    auto simple_ext = simple_mat->sparse_row();
+    EXPECT_TRUE(dynamic_cast<const tatami_chunked::SlabCacheCountersReporter*>(simple_ext.get()) == NULL);
+}
+
+TEST_F(CustomSparseChunkedMatrixCountersTest, Oracular) {
+    auto ext = counted_mat->sparse_row(std::make_shared<tatami::ConsecutiveOracle<int> >(0, 100));
+    std::vector<double> vbuffer(50);
+    std::vector<int> ibuffer(50);
+    for (int r = 0; r < 100; ++r) {
+        ext->fetch(vbuffer.data(), ibuffer.data());
+    }
+
+    auto reporter = dynamic_cast<const tatami_chunked::SlabCacheCountersReporter*>(ext.get());
+    ASSERT_TRUE(reporter != NULL);
+    auto counters = reporter->get_slab_cache_counters();
+    EXPECT_EQ(counters.misses, 10);
+    EXPECT_EQ(counters.hits, 90);
+    EXPECT_EQ(counters.evictions, 9);
+    EXPECT_EQ(counters.populate_calls, 10);
+    EXPECT_EQ(counters.slabs_populated, 10);
+}
+
+TEST_F(CustomSparseChunkedMatrixCountersTest, Variable) {
+    auto ext = variable_counted_mat->sparse_row(std::make_shared<tatami::ConsecutiveOracle<int> >(0, 100));
+    std::vector<double> vbuffer(50);
+    std::vector<int> ibuffer(50);
+    for (int r = 0; r < 100; ++r) {
+        ext->fetch(vbuffer.data(), ibuffer.data());
+    }
+
+    auto reporter = dynamic_cast<const tatami_chunked::SlabCacheCountersReporter*>(ext.get());
+    ASSERT_TRUE(reporter != NULL);
+    auto counters = reporter->get_slab_cache_counters();
+    EXPECT_EQ(counters.misses, 10);
+    EXPECT_EQ(counters.hits, 90);
+    EXPECT_EQ(counters.slabs_populated, 10);
+}
+
+TEST_F(CustomSparseChunkedMatrixCountersTest, Compact) {
+    std::vector<double> vbuffer(50);
+    std::vector<int> ibuffer(50);
+
+    // The cache is too small for both the padded buffer and a compact slab, so we fall back to padded slabs and the cache behavior should be unchanged.
+    auto mext = compact_counted_mat->sparse_row();
+    for (int r = 0; r < 100; ++r) {
+        mext->fetch(r, vbuffer.data(), ibuffer.data());
+    }
+    auto mcounters = dynamic_cast<const tatami_chunked::SlabCacheCountersReporter*>(mext.get())->get_slab_cache_counters();
+    EXPECT_EQ(mcounters.misses, 10);
+    EXPECT_EQ(mcounters.hits, 90);
+
+    auto oext = compact_counted_mat->sparse_row(std::make_shared<tatami::ConsecutiveOracle<int> >(0, 100));
+    for (int r = 0; r < 100; ++r) {
+        oext->fetch(vbuffer.data(), ibuffer.data());
+    }
+    auto ocounters = dynamic_cast<const tatami_chunked::SlabCacheCountersReporter*>(oext.get())->get_slab_cache_counters();
+    EXPECT_EQ(ocounters.misses, 10);
+    EXPECT_EQ(ocounters.hits, 90);
+    EXPECT_EQ(ocounters.slabs_populated, 10);
+}
+
+class CustomSparseChunkedMatrixShrinkTest : public ::testing::Test, public CustomSparseChunkedMatrixCore {
+protected:
+    void SetUp() {
+        assemble({ { 100, 50 }, { 10, 10 }, 1 }); // cache can hold all row slabs.
+    }
+};
+
+TEST_F(CustomSparseChunkedMatrixShrinkTest, Consecutive) {
+    auto oracle = std::make_shared<tatami::ConsecutiveOracle<int> >(0, 100);
+    std::vector<double> vbuffer(50);
+    std::vector<int> ibuffer(50);
+
+    auto ext = counted_mat->sparse_row(oracle);
+    for (int r = 0; r < 100; ++r) {
+        ext->fetch(vbuffer.data(), ibuffer.data());
+    }
+    auto counters = dynamic_cast<const tatami_chunked::SlabCacheCountersReporter*>(ext.get())->get_slab_cache_counters();
+    EXPECT_EQ(counters.populate_calls, 1);
+    EXPECT_EQ(counters.slabs_populated, 10);
+
+    // The minimum of two slabs is enough as each slab is never revisited.
+    auto sext = shrunk_mat->sparse_row(oracle);
+    for (int r = 0; r < 100; ++r) {
+        sext->fetch(vbuffer.data(), ibuffer.data());
+    }
+    auto scounters = dynamic_cast<const tatami_chunked::SlabCacheCountersReporter*>(sext.get())->get_slab_cache_counters();
+    EXPECT_EQ(scounters.populate_calls, 5);
+    EXPECT_EQ(scounters.slabs_populated, 10);
+    EXPECT_EQ(scounters.misses, 5);
+}
+
+TEST_F(CustomSparseChunkedMatrixShrinkTest, Populate) {
+    auto oracle = std::make_shared<tatami::ConsecutiveOracle<int> >(0, 100);
+    std::vector<double> vbuffer(50);
+    std::vector<int> ibuffer(50);
+
+    // Shrinking still leaves enough slabs for prefetching, so only the first cycle is a miss.
+    auto aext = shrunk_async_mat->sparse_row(oracle);
+    for (int r = 0; r < 100; ++r) {
+        aext->fetch(vbuffer.data(), ibuffer.data());
+    }
+    auto acounters = dynamic_cast<const tatami_chunked::SlabCacheCountersReporter*>(aext.get())->get_slab_cache_counters();
+    EXPECT_EQ(acounters.misses, 1);
+    EXPECT_EQ(acounters.slabs_populated, 10);
+
+    // Similarly, each cycle still contains one slab per thread for parallel population.
+    auto pext = shrunk_parallel_mat->sparse_row(oracle);
+    for (int r = 0; r < 100; ++r) {
+        pext->fetch(vbuffer.data(), ibuffer.data());
+    }
+    auto pcounters = dynamic_cast<const tatami_chunked::SlabCacheCountersReporter*>(pext.get())->get_slab_cache_counters();
+    EXPECT_EQ(pcounters.populate_calls, 4);
+    EXPECT_EQ(pcounters.slabs_populated, 10);
+}
+
+TEST(CustomSparseChunkedMatrix, EmptyChunks) {
+    // Every second chunk is empty, in a checkerboard pattern.
+    int NR = 60, NC = 40;
+    std::vector<double> contents(NR * NC);
+    for (int r = 0; r < NR; ++r) {
+        for (int c = 0; c < NC; ++c) {
+            if ((r / 10 + c / 10) % 2 == 0 && (r * 7 + c) % 3 == 0) {
+                contents[r * NC + c] = r + c + 1;
+            }
+        }
+    }
+    tatami::DenseRowMatrix<double, int> ref(NR, NC, std::move(contents));
+
+    auto data = create_mock_data(ref, { 10, 10 });
+    auto manager = std::make_shared<MockSparseChunkManager>(data, /* report_nonzeros = */ true);
+    tatami_chunked::CustomSparseChunkedMatrixOptions opt;
+    tatami_chunked::CustomSparseChunkedMatrix<double, int, double> mat(manager, opt);
+
+    tatami_test::TestAccessOptions topt;
+    tatami_test::test_full_access(mat, ref, topt);
+    tatami_test::test_block_access(mat, ref, 0.15, 0.6, topt);
+    tatami_test::test_indexed_access(mat, ref, 0.05, 0.2, topt);
+
+    // Also works for the single-element extraction without any cache.
+    opt.maximum_cache_size = 0;
+    opt.require_minimum_cache = false;
+    tatami_chunked::CustomSparseChunkedMatrix<double, int, double> solo(manager, opt);
+    tatami_test::test_full_access(solo, ref, topt);
+    tatami_test::test_block_access(solo, ref, 0.15, 0.6, topt);
+    tatami_test::test_indexed_access(solo, ref, 0.05, 0.2, topt);
+
+    // Empty chunks are never read from the manager.
+    auto count_reads = [&](std::shared_ptr<const tatami_chunked::CustomSparseChunkedMatrixManager<double, int> > inner) -> std::size_t {
+        auto recorder = std::make_shared<tatami_chunked::AccessRecorder<int> >(NR, NC);
+        auto recorded = std::make_shared<tatami_chunked::RecordedSparseChunkedMatrixManager<double, int> >(std::move(inner), recorder);
+        tatami_chunked::CustomSparseChunkedMatrix<double, int, double> rmat(std::move(recorded), tatami_chunked::CustomSparseChunkedMatrixOptions());
+        auto ext = rmat.sparse_row();
+        std::vector<double> vbuffer(NC);
+        std::vector<int> ibuffer(NC);
+        for (int r = 0; r < NR; ++r) {
+            ext->fetch(r, vbuffer.data(), ibuffer.data());
+        }
+        return recorder->get_num_chunk_reads();
+    };
+    EXPECT_EQ(count_reads(manager), 12);
+    EXPECT_EQ(count_reads(std::make_shared<MockSparseChunkManager>(data)), 24);
+
+    // Empty chunks that report a non-zero upper bound are still read, as only a count of zero allows a chunk to be skipped.
+    auto padded_manager = std::make_shared<MockSparseChunkManager>(std::move(data), /* report_nonzeros = */ true, /* extra_nonzeros = */ 1);
+    EXPECT_EQ(count_reads(padded_manager), 24);
+
+    opt.maximum_cache_size = 10 * NC * (sizeof(double) + sizeof(int)) * 2;
+    opt.require_minimum_cache = true;
+    opt.variable_slab_size = true;
+    tatami_chunked::CustomSparseChunkedMatrix<double, int, double> padded(padded_manager, opt);
+    tatami_test::test_full_access(padded, ref, topt);
+    tatami_test::test_block_access(padded, ref, 0.15, 0.6, topt);
+    tatami_test::test_indexed_access(padded, ref, 0.05, 0.2, topt);
+}
+
+TEST(CustomSparseChunkedMatrix, VariableSlabSize) {
+    // Only the first column contains non-zeros, so each row slab has at most 10 non-zeros.
+    int NR = 100, NC = 50;
+    std::vector<double> contents(NR * NC);
+    for (int r = 0; r < NR; ++r) {
+        contents[r * NC] = r + 1;
+    }
+    tatami::DenseRowMatrix<double, int> ref(NR, NC, std::move(contents));
+
+    auto data = create_mock_data(ref, { 10, 10 });
+    auto nonzero_manager = std::make_shared<MockSparseChunkManager>(data, /* report_nonzeros = */ true);
+    auto manager = std::make_shared<MockSparseChunkManager>(std::move(data));
+
+    tatami_chunked::CustomSparseChunkedMatrixOptions opt;
+    opt.maximum_cache_size = 10 * NC * (sizeof(double) + sizeof(int)); // enough for one padded row slab.
+    opt.variable_slab_size = true;
+    opt.record_cache_counters = true;
+
+    auto oracle = std::make_shared<tatami::ConsecutiveOracle<int> >(0, NR);
+    std::vector<double> vbuffer(NC);
+    std::vector<int> ibuffer(NC);
+    auto run = [&](auto ext) -> tatami_chunked::SlabCacheCounters {
+        for (int r = 0; r < NR; ++r) {
+            auto out = ext->fetch(r, vbuffer.data(), ibuffer.data());
+            EXPECT_EQ(out.number, 1);
+            EXPECT_EQ(out.value[0], r + 1);
+        }
+        return dynamic_cast<const tatami_chunked::SlabCacheCountersReporter*>(ext.get())->get_slab_cache_counters();
+    };
+
+    // Without the chunk counts, each new slab reserves space for all columns, so only one slab fits in each populate cycle.
+    tatami_chunked::CustomSparseChunkedMatrix<double, int, double> mat(manager, opt);
+    auto counters = run(mat.sparse_row(oracle));
+    EXPECT_EQ(counters.populate_calls, 10);
+    EXPECT_EQ(counters.slabs_populated, 10);
+
+    // With the chunk counts, each new slab only reserves space for its 10 non-zeros, so five slabs fit in each cycle.
+    tatami_chunked::CustomSparseChunkedMatrix<double, int, double> nonzero_mat(nonzero_manager, opt);
+    auto ncounters = run(nonzero_mat.sparse_row(oracle));
+    EXPECT_EQ(ncounters.populate_calls, 2);
+    EXPECT_EQ(ncounters.slabs_populated, 10);
+
+    // Myopic extraction ignores the option and uses the usual LRU cache.
+    auto mcounters = run(nonzero_mat.sparse_row());
+    EXPECT_EQ(mcounters.misses, 10);
+    EXPECT_EQ(mcounters.hits, 90);
+
+    // If a single padded slab doesn't fit, we fall back to uncached extraction, even though the non-zeros would have fit.
+    opt.maximum_cache_size -= 1;
+    opt.require_minimum_cache = false;
+    tatami_chunked::CustomSparseChunkedMatrix<double, int, double> solo_mat(nonzero_manager, opt);
+    auto scounters = run(solo_mat.sparse_row(oracle));
+    EXPECT_EQ(scounters.populate_calls, 0);
+    EXPECT_EQ(scounters.misses, 0);
+}
+
+TEST(CustomSparseChunkedMatrix, VariableSlabCapacity) {
+    // Each row of each chunk has a different number of non-zeros, so the capacity of each slab differs from its padded size.
+    int NR = 60, NC = 40;
+    std::vector<double> contents(NR * NC);
+    for (int r = 0; r < NR; ++r) {
+        for (int c = 0; c < NC; ++c) {
+            if ((r + c) % 7 == 0 || (r % 10 == 0 && c < 20)) {
+                contents[r * NC + c] = r * NC + c + 1;
+            }
+        }
+    }
+    tatami::DenseRowMatrix<double, int> ref(NR, NC, std::move(contents));
+
+    // The mock workspace checks that it never writes past the space implied by the reported counts.
+    auto data = create_mock_data(ref, { 10, 10 });
+    auto manager = std::make_shared<MockSparseChunkManager>(std::move(data), /* report_nonzeros = */ true);
+
+    tatami_chunked::CustomSparseChunkedMatrixOptions opt;
+    opt.maximum_cache_size = 10 * NC * (sizeof(double) + sizeof(int)) * 2;
+    opt.variable_slab_size = true;
+    tatami_chunked::CustomSparseChunkedMatrix<double, int, double> mat(manager, opt);
+
+    tatami_test::TestAccessOptions topt;
+    topt.use_oracle = true;
+    for (auto use_row : { true, false }) {
+        topt.use_row = use_row;
+        tatami_test::test_full_access(mat, ref, topt);
+        tatami_test::test_block_access(mat, ref, 0.2, 0.5, topt);
+        tatami_test::test_indexed_access(mat, ref, 0.1, 0.3, topt);
+    }
+}
+
+TEST(CustomSparseChunkedMatrix, CompactSlabBudget) {
+    // Only the first column contains non-zeros, so each row slab has at most 10 non-zeros.
+    int NR = 100, NC = 50;
+    std::vector<double> contents(NR * NC);
+    for (int r = 0; r < NR; ++r) {
+        contents[r * NC] = r + 1;
+    }
+    tatami::DenseRowMatrix<double, int> ref(NR, NC, std::move(contents));
+
+    auto data = create_mock_data(ref, { 10, 10 });
+    auto nonzero_manager = std::make_shared<MockSparseChunkManager>(data, /* report_nonzeros = */ true);
+    auto manager = std::make_shared<MockSparseChunkManager>(std::move(data));
+
+    std::size_t padded_slab_size = 10 * NC * (sizeof(double) + sizeof(int));
+    tatami_chunked::CustomSparseChunkedMatrixOptions opt;
+    opt.maximum_cache_size = padded_slab_size * 2;
+    opt.record_cache_counters = true;
+
+    // Cycling through all row slabs twice.
+    std::vector<int> order;
+    for (int round = 0; round < 2; ++round) {
+        for (int r = 0; r < NR; r += 10) {
+            order.push_back(r);
+        }
+    }
+
+    std::vector<double> vbuffer(NC);
+    std::vector<int> ibuffer(NC);
+    auto run_myopic = [&](const tatami::Matrix<double, int>& mat) -> tatami_chunked::SlabCacheCounters {
+        auto ext = mat.sparse_row();
+        for (auto r : order) {
+            auto out = ext->fetch(r, vbuffer.data(), ibuffer.data());
+            EXPECT_EQ(out.number, 1);
+            EXPECT_EQ(out.value[0], r + 1);
+        }
+        return dynamic_cast<const tatami_chunked::SlabCacheCountersReporter*>(ext.get())->get_slab_cache_counters();
+    };
+
+    tatami_chunked::CustomSparseChunkedMatrix<double, int, double> padded_mat(manager, opt);
+    EXPECT_EQ(run_myopic(padded_mat).misses, 20);
+
+    // Without the chunk counts, the padded buffer takes up the space of one padded slab.
+    opt.compact_slabs = true;
+    tatami_chunked::CustomSparseChunkedMatrix<double, int, double> compact_mat(manager, opt);
+    EXPECT_EQ(run_myopic(compact_mat).misses, 20);
+
+    // With the chunk counts, all compact slabs fit in the space left over by the padded buffer.
+    tatami_chunked::CustomSparseChunkedMatrix<double, int, double> nonzero_mat(nonzero_manager, opt);
+    auto ncounters = run_myopic(nonzero_mat);
+    EXPECT_EQ(ncounters.misses, 10);
+    EXPECT_EQ(ncounters.hits, 10);
+
+    // Each populating thread needs its own padded buffer.
+    auto oracle = std::make_shared<tatami::ConsecutiveOracle<int> >(0, NR);
+    auto run_oracular = [&](const tatami::Matrix<double, int>& mat) -> tatami_chunked::SlabCacheCounters {
+        auto ext = mat.sparse_row(oracle);
+        for (int r = 0; r < NR; ++r) {
+            auto out = ext->fetch(r, vbuffer.data(), ibuffer.data());
+            EXPECT_EQ(out.number, 1);
+            EXPECT_EQ(out.value[0], r + 1);
+        }
+        return dynamic_cast<const tatami_chunked::SlabCacheCountersReporter*>(ext.get())->get_slab_cache_counters();
+    };
+
+    opt.maximum_cache_size = padded_slab_size * 4;
+    opt.num_populate_threads = 3;
+    tatami_chunked::CustomSparseChunkedMatrix<double, int, double> parallel_mat(nonzero_manager, opt);
+    auto pcounters = run_oracular(parallel_mat);
+    EXPECT_EQ(pcounters.populate_calls, 1);
+    EXPECT_EQ(pcounters.slabs_populated, 10);
+
+    // Falling back to padded slabs if the buffers leave no space for any compact slabs.
+    opt.maximum_cache_size = padded_slab_size * 3;
+    tatami_chunked::CustomSparseChunkedMatrix<double, int, double> fallback_mat(nonzero_manager, opt);
+    auto fcounters = run_oracular(fallback_mat);
+    EXPECT_EQ(fcounters.populate_calls, 4);
+    EXPECT_EQ(fcounters.slabs_populated, 10);
+}
@@ -1,6 +1,10 @@
 #include <gtest/gtest.h>
 #include "tatami_chunked/LruSlabCache.hpp"
 
+#include <random>
+#include <vector>
+#include <algorithm>
+
 TEST(LruSlabCache, Basic) {
     tatami_chunked::LruSlabCache<int, std::pair<int, int> > cache(3);
     EXPECT_EQ(cache.get_max_slabs(), 3);
@@ -108,3 +112,55 @@ TEST(LruSlabCache, Solo) {
     EXPECT_EQ(out.second, 2);
 }
 
+class LruSlabCacheStressTest : public ::testing::TestWithParam<int> {};
+
+TEST_P(LruSlabCacheStressTest, Stressed) {
+    auto cache_size = GetParam();
+    tatami_chunked::LruSlabCache<int, std::pair<int, int> > cache(cache_size);
+
+    // Reference implementation of the LRU policy, with the most recently used slab at the back.
+    std::vector<std::pair<int, int> > reference;
+
+    int counter = 0;
+    auto creator = []() -> std::pair<int, int> {
+        return std::pair<int, int>(0, 0); 
+    };
+    auto populator = [&](int i, std::pair<int, int>& chunk) -> void {
+        chunk.first = i;
+        chunk.second = counter;
+        ++counter;
+    };
+
+    std::mt19937_64 rng(cache_size);
+    for (int r = 0; r < 10000; ++r) {
+        int id = rng() % 50;
+        if (r % 3 == 0) {
+            id *= 1000; // some spread to check the hashing.
+        }
+
+        auto it = std::find_if(reference.begin(), reference.end(), [&](const std::pair<int, int>& x) -> bool { return x.first == id; });
+        int expected;
+        if (it != reference.end()) {
+            expected = it->second;
+            reference.erase(it);
+        } else {
+            expected = counter;
+            if (reference.size() == static_cast<std::size_t>(cache_size)) {
+                reference.erase(reference.begin());
+            }
+        }
+        reference.emplace_back(id, expected);
+
+        const auto& out = cache.find(id, creator, populator);
+        EXPECT_EQ(out.first, id);
+        EXPECT_EQ(out.second, expected);
+    }
+
+    EXPECT_EQ(cache.get_num_slabs(), reference.size());
+}
+
+INSTANTIATE_TEST_SUITE_P(
+    LruSlabCache,
+    LruSlabCacheStressTest,
+    ::testing::Values(1, 2, 3, 7, 20, 100) // max cache size
+);
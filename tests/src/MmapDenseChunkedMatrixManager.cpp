@@ -0,0 +1,136 @@
+#include <gtest/gtest.h>
+#include "tatami/tatami.hpp"
+#include "tatami_test/tatami_test.hpp"
+
+#include "tatami_chunked/MmapDenseChunkedMatrixManager.hpp"
+
+#include <fstream>
+#include <string>
+#include <vector>
+
+class MmapDenseChunkedMatrixManagerTest : public ::testing::TestWithParam<std::tuple<std::pair<int, int>, bool, bool> > {
+protected:
+    inline static int NR = 97, NC = 53;
+
+    static std::shared_ptr<tatami::Matrix<double, int> > create_reference() {
+        auto full = tatami_test::simulate_vector<double>(NR * NC, tatami_test::SimulateVectorOptions());
+        return std::make_shared<tatami::DenseRowMatrix<double, int> >(NR, NC, std::move(full));
+    }
+};
+
+TEST_P(MmapDenseChunkedMatrixManagerTest, Basic) {
+    auto param = GetParam();
+    auto chunkdim = std::get<0>(param);
+    tatami_chunked::MmapDenseChunkedFileOptions fopt;
+    fopt.row_major_chunks = std::get<1>(param);
+    fopt.row_major_contents = std::get<2>(param);
+
+    auto ref = create_reference();
+    auto path = ::testing::TempDir() + "/tatami_chunked_mmap_test.bin";
+    tatami_chunked::write_mmap_dense_chunked_file<float>(path, *ref, chunkdim.first, chunkdim.second, fopt);
+
+    // Comparing to a reference with the same precision.
+    std::vector<double> rounded(NR * NC);
+    auto rext = ref->dense_row();
+    for (int r = 0; r < NR; ++r) {
+        auto ptr = rext->fetch(r, rounded.data() + r * NC);
+        for (int c = 0; c < NC; ++c) {
+            rounded[r * NC + c] = static_cast<float>(ptr[c]);
+        }
+    }
+    tatami::DenseRowMatrix<double, int> fref(NR, NC, std::move(rounded));
+
+    auto manager = std::make_shared<tatami_chunked::MmapDenseChunkedMatrixManager<float, int> >(path, tatami_chunked::MmapDenseChunkedMatrixManagerOptions());
+    EXPECT_EQ(manager->row_stats().dimension_extent, NR);
+    EXPECT_EQ(manager->row_stats().chunk_length, chunkdim.first);
+    EXPECT_EQ(manager->column_stats().dimension_extent, NC);
+    EXPECT_EQ(manager->column_stats().chunk_length, chunkdim.second);
+    EXPECT_EQ(manager->prefer_rows(), fopt.row_major_chunks);
+    EXPECT_EQ(manager->supports_chunk_data(true), fopt.row_major_contents);
+    EXPECT_EQ(manager->supports_chunk_data(false), !fopt.row_major_contents);
+
+    tatami_chunked::CustomDenseChunkedMatrixOptions opt;
+    opt.maximum_cache_size = NR * NC; // a bit less than the full matrix.
+    tatami_chunked::CustomDenseChunkedMatrix<double, int, float, tatami_chunked::MmapDenseChunkedMatrixManager<float, int> > mat(manager, opt);
+    tatami_test::TestAccessOptions topt;
+    tatami_test::test_full_access(mat, fref, topt);
+    tatami_test::test_block_access(mat, fref, 0.2, 0.55, topt);
+    tatami_test::test_indexed_access(mat, fref, 0.1, 0.3, topt);
+
+    // Direct access works when the value types are the same.
+    tatami_chunked::CustomDenseChunkedMatrix<float, int, float> fmat(manager, opt);
+    auto fext = fmat.dense(fopt.row_major_contents, 0, 1, tatami::Options());
+    auto ffext = fref.dense(fopt.row_major_contents, 0, 1, tatami::Options());
+    for (int i = 0, end = (fopt.row_major_contents ? NR : NC); i < end; ++i) {
+        float buffer;
+        auto ptr = fext->fetch(i, &buffer);
+        EXPECT_NE(ptr, &buffer);
+        EXPECT_EQ(*ptr, tatami_test::fetch(*ffext, i, 1)[0]);
+    }
+
+    // Same results with the other advice.
+    tatami_chunked::MmapDenseChunkedMatrixManagerOptions mopt;
+    mopt.random_access = true;
+    mopt.will_need = true;
+    auto manager2 = std::make_shared<tatami_chunked::MmapDenseChunkedMatrixManager<float, int> >(path, mopt);
+    tatami_chunked::CustomDenseChunkedMatrix<double, int, float> mat2(manager2, opt);
+    tatami_test::test_full_access(mat2, fref, topt);
+
+    // Same results without any cache, where each element of the target dimension is extracted directly via extract_single().
+    opt.maximum_cache_size = 0;
+    opt.require_minimum_cache = false;
+    tatami_chunked::CustomDenseChunkedMatrix<double, int, float> solo(manager, opt);
+    tatami_test::test_full_access(solo, fref, topt);
+    tatami_test::test_block_access(solo, fref, 0.2, 0.55, topt);
+    tatami_test::test_indexed_access(solo, fref, 0.1, 0.3, topt);
+}
+
+INSTANTIATE_TEST_SUITE_P(
+    MmapDenseChunkedMatrixManager,
+    MmapDenseChunkedMatrixManagerTest,
+    ::testing::Combine(
+        ::testing::Values( // chunk dimensions
+            std::make_pair(1, 53),
+            std::make_pair(20, 1),
+            std::make_pair(11, 13)
+        ),
+        ::testing::Values(true, false), // row-major chunks
+        ::testing::Values(true, false) // row-major contents
+    )
+);
+
+TEST(MmapDenseChunkedMatrixManager, Errors) {
+    auto path = ::testing::TempDir() + "/tatami_chunked_mmap_error.bin";
+    auto write = [&](const std::string& contents) -> void {
+        std::ofstream output(path, std::ios::binary | std::ios::trunc);
+        output << contents;
+    };
+    auto expect_error = [&](const std::string& msg) -> void {
+        tatami_test::throws_error([&]() {
+            tatami_chunked::MmapDenseChunkedMatrixManager<double, int> manager(path, tatami_chunked::MmapDenseChunkedMatrixManagerOptions());
+        }, msg);
+    };
+
+    write("foo");
+    expect_error("too small to contain the header");
+
+    write(std::string(64, 'a'));
+    expect_error("magic string");
+
+    tatami::DenseRowMatrix<double, int> ref(10, 10, std::vector<double>(100));
+    tatami_chunked::write_mmap_dense_chunked_file<float>(path, ref, 5, 5, tatami_chunked::MmapDenseChunkedFileOptions());
+    expect_error("not consistent");
+
+    tatami_chunked::write_mmap_dense_chunked_file<double>(path, ref, 5, 5, tatami_chunked::MmapDenseChunkedFileOptions());
+    std::string contents;
+    {
+        std::ifstream input(path, std::ios::binary);
+        contents.assign(std::istreambuf_iterator<char>(input), std::istreambuf_iterator<char>());
+    }
+    write(contents.substr(0, contents.size() - 1));
+    expect_error("too small to contain all chunks");
+
+    tatami_test::throws_error([&]() {
+        tatami_chunked::MmapDenseChunkedMatrixManager<double, int> manager(path + ".missing", tatami_chunked::MmapDenseChunkedMatrixManagerOptions());
+    }, "failed to open");
+}
@@ -0,0 +1,250 @@
+#include <gtest/gtest.h>
+#include "tatami_chunked/OracularAsyncSlabCache.hpp"
+#include "tatami_test/tatami_test.hpp"
+
+#include <random>
+#include <vector>
+#include <thread>
+#include <stdexcept>
+
+class OracularAsyncSlabCacheTestMethods {
+protected:
+    struct TestSlab {
+        unsigned char chunk_id;
+        int populate_number;
+        int cycle;
+        std::thread::id thread;
+    };
+
+    // Counters are only modified in populate(), which is serialized by the cache.
+    // So it's safe to capture them by reference as long as they outlive the cache.
+    template<class Cache_>
+    auto next(Cache_& cache, int& counter, int& nalloc, int& cycle) {
+        return cache.next(
+            [](int i) -> std::pair<unsigned char, int> {
+                return std::make_pair<unsigned char, int>(i / 10, i % 10);
+            },
+            [&]() -> TestSlab {
+                ++nalloc;
+                return TestSlab();
+            },
+            [&counter,&cycle](std::vector<std::pair<unsigned char, TestSlab*> >& in_need) -> void {
+                EXPECT_FALSE(in_need.empty());
+                for (auto& x : in_need) {
+                    auto& current = *(x.second);
+                    current.chunk_id = x.first;
+                    current.populate_number = counter++;
+                    current.cycle = cycle;
+                    current.thread = std::this_thread::get_id();
+                }
+                ++cycle;
+            }
+        );
+    }
+};
+
+class OracularAsyncSlabCacheTest : public ::testing::Test, public OracularAsyncSlabCacheTestMethods {};
+
+TEST_F(OracularAsyncSlabCacheTest, Consecutive) {
+    std::vector<int> predictions{
+        11, // Cycle 1
+        22,
+        33, // Cycle 2
+        44,
+        55, // Cycle 3
+        66,
+        77, // Cycle 4
+        88,
+        99  // Cycle 5
+    };
+
+    tatami_chunked::OracularAsyncSlabCache<unsigned char, int, TestSlab> cache(std::make_shared<tatami::FixedViewOracle<int> >(predictions.data(), predictions.size()), 4);
+    EXPECT_EQ(cache.get_max_slabs(), 4);
+    EXPECT_EQ(cache.get_num_slabs(), 0);
+
+    int counter = 0;
+    int nalloc = 0;
+    int cycle = 1;
+    auto self = std::this_thread::get_id();
+
+    for (size_t i = 0; i < predictions.size(); ++i) {
+        auto out = next(cache, counter, nalloc, cycle);
+        EXPECT_EQ(out.first->chunk_id, static_cast<unsigned char>(predictions[i] / 10));
+        EXPECT_EQ(out.first->populate_number, i);
+        EXPECT_EQ(out.first->cycle, i / 2 + 1);
+        EXPECT_EQ(out.second, predictions[i] % 10);
+
+        // Only the first cycle is populated in the calling thread.
+        if (i < 2) {
+            EXPECT_EQ(out.first->thread, self);
+        } else {
+            EXPECT_NE(out.first->thread, self);
+        }
+    }
+
+    EXPECT_EQ(nalloc, 4); // respects the max cache size.
+}
+
+TEST_F(OracularAsyncSlabCacheTest, Reuse) {
+    std::vector<int> predictions{
+        11, // Cycle 1
+        22,
+        12,
+        31, // Cycle 2
+        23,
+        34,
+        14, // Cycle 3
+        28,
+        15,
+        45, // Cycle 4
+        16
+    };
+
+    tatami_chunked::OracularAsyncSlabCache<unsigned char, int, TestSlab> cache(std::make_unique<tatami::FixedViewOracle<int> >(predictions.data(), predictions.size()), 4);
+
+    int counter = 0;
+    int nalloc = 0;
+    int cycle = 1;
+
+    for (size_t i = 0; i < 3; ++i) { // 11 to 12.
+        auto out = next(cache, counter, nalloc, cycle);
+        EXPECT_EQ(out.first->chunk_id, static_cast<unsigned char>(predictions[i] / 10));
+        EXPECT_EQ(out.first->cycle, 1);
+        EXPECT_EQ(out.first->populate_number, out.first->chunk_id - 1);
+        EXPECT_EQ(out.second, predictions[i] % 10);
+    }
+
+    for (size_t i = 3; i < 6; ++i) { // 31 to 34.
+        auto out = next(cache, counter, nalloc, cycle);
+        EXPECT_EQ(out.first->chunk_id, static_cast<unsigned char>(predictions[i] / 10));
+        EXPECT_EQ(out.second, predictions[i] % 10);
+        if (out.first->chunk_id == 2) { // shared with the previous cycle.
+            EXPECT_EQ(out.first->populate_number, 1);
+            EXPECT_EQ(out.first->cycle, 1);
+        } else {
+            EXPECT_EQ(out.first->populate_number, 2);
+            EXPECT_EQ(out.first->cycle, 2);
+        }
+    }
+
+    for (size_t i = 6; i < 9; ++i) { // 14 to 15.
+        auto out = next(cache, counter, nalloc, cycle);
+        EXPECT_EQ(out.first->chunk_id, static_cast<unsigned char>(predictions[i] / 10));
+        EXPECT_EQ(out.second, predictions[i] % 10);
+        if (out.first->chunk_id == 2) { // still shared.
+            EXPECT_EQ(out.first->populate_number, 1);
+            EXPECT_EQ(out.first->cycle, 1);
+        } else { // slab 1 was released in cycle 2, so it needs to be reloaded.
+            EXPECT_EQ(out.first->populate_number, 3);
+            EXPECT_EQ(out.first->cycle, 3);
+        }
+    }
+
+    for (size_t i = 9; i < predictions.size(); ++i) { // 45 to 16.
+        auto out = next(cache, counter, nalloc, cycle);
+        EXPECT_EQ(out.first->chunk_id, static_cast<unsigned char>(predictions[i] / 10));
+        EXPECT_EQ(out.second, predictions[i] % 10);
+        if (out.first->chunk_id == 1) {
+            EXPECT_EQ(out.first->populate_number, 3);
+            EXPECT_EQ(out.first->cycle, 3);
+        } else {
+            EXPECT_EQ(out.first->populate_number, 4);
+            EXPECT_EQ(out.first->cycle, 4);
+        }
+    }
+
+    EXPECT_LE(nalloc, 4);
+}
+
+TEST_F(OracularAsyncSlabCacheTest, SoloSlab) {
+    std::vector<int> predictions{ 11, 12, 22, 21, 33, 11, 13 };
+
+    tatami_chunked::OracularAsyncSlabCache<unsigned char, int, TestSlab> cache(std::make_shared<tatami::FixedViewOracle<int> >(predictions.data(), predictions.size()), 1);
+    int counter = 0;
+    int nalloc = 0;
+    int cycle = 1;
+    auto self = std::this_thread::get_id();
+
+    std::vector<int> expected_number { 0, 0, 1, 1, 2, 3, 3 };
+    for (size_t i = 0; i < predictions.size(); ++i) {
+        auto out = next(cache, counter, nalloc, cycle);
+        EXPECT_EQ(out.first->chunk_id, static_cast<unsigned char>(predictions[i] / 10));
+        EXPECT_EQ(out.first->populate_number, expected_number[i]);
+        EXPECT_EQ(out.first->thread, self); // no prefetching is possible.
+        EXPECT_EQ(out.second, predictions[i] % 10);
+    }
+
+    EXPECT_EQ(nalloc, 1);
+}
+
+TEST_F(OracularAsyncSlabCacheTest, Error) {
+    std::vector<int> predictions{ 11, 22, 33, 44 };
+    tatami_chunked::OracularAsyncSlabCache<unsigned char, int, TestSlab> cache(std::make_shared<tatami::FixedViewOracle<int> >(predictions.data(), predictions.size()), 2);
+
+    auto identify = [](int i) -> std::pair<unsigned char, int> {
+        return std::make_pair<unsigned char, int>(i / 10, i % 10);
+    };
+    auto create = []() -> TestSlab {
+        return TestSlab();
+    };
+    auto populate = [](std::vector<std::pair<unsigned char, TestSlab*> >& in_need) -> void {
+        for (auto& x : in_need) {
+            if (x.first == 2) {
+                throw std::runtime_error("failed to load slab 2");
+            }
+            x.second->chunk_id = x.first;
+        }
+    };
+
+    auto out = cache.next(identify, create, populate);
+    EXPECT_EQ(out.first->chunk_id, 1);
+    tatami_test::throws_error([&]() {
+        cache.next(identify, create, populate);
+    }, "failed to load");
+
+    // The cache is poisoned after the failure, rather than returning stale slabs.
+    tatami_test::throws_error([&]() {
+        cache.next(identify, create, populate);
+    }, "failed populate cycle");
+
+    // Same for failures in the synchronous populate cycle.
+    std::vector<int> sync_predictions{ 22, 33 };
+    tatami_chunked::OracularAsyncSlabCache<unsigned char, int, TestSlab> sync_cache(std::make_shared<tatami::FixedViewOracle<int> >(sync_predictions.data(), sync_predictions.size()), 2);
+    tatami_test::throws_error([&]() {
+        sync_cache.next(identify, create, populate);
+    }, "failed to load");
+    tatami_test::throws_error([&]() {
+        sync_cache.next(identify, create, populate);
+    }, "failed populate cycle");
+}
+
+class OracularAsyncSlabCacheStressTest : public ::testing::TestWithParam<int>, public OracularAsyncSlabCacheTestMethods {};
+
+TEST_P(OracularAsyncSlabCacheStressTest, Stressed) {
+    auto cache_size = GetParam();
+
+    std::mt19937_64 rng(cache_size + 1);
+    std::vector<int> predictions(10000);
+    for (size_t i = 0; i < predictions.size(); ++i) {
+        predictions[i] = rng() % 50 + 10;
+    }
+
+    tatami_chunked::OracularAsyncSlabCache<unsigned char, int, TestSlab> cache(std::make_unique<tatami::FixedViewOracle<int> >(predictions.data(), predictions.size()), cache_size);
+    int counter = 0;
+    int nalloc = 0;
+    int cycle = 1;
+
+    for (size_t i = 0; i < predictions.size(); ++i) {
+        auto out = next(cache, counter, nalloc, cycle);
+        EXPECT_EQ(out.first->chunk_id, predictions[i] / 10);
+        EXPECT_EQ(out.second, predictions[i] % 10);
+    }
+
+    EXPECT_LE(nalloc, cache_size);
+}
+
+INSTANTIATE_TEST_SUITE_P(
+    OracularAsyncSlabCache,
+    OracularAsyncSlabCacheStressTest,
+    ::testing::Values(1, 3, 5, 10)  // max cache size
+);
@@ -0,0 +1,190 @@
+#include <gtest/gtest.h>
+#include "tatami_chunked/OracularBeladySlabCache.hpp"
+#include "tatami_chunked/OracularSlabCache.hpp"
+
+#include <random>
+#include <set>
+#include <vector>
+#include <algorithm>
+
+class OracularBeladySlabCacheTestMethods {
+protected:
+    struct TestSlab {
+        unsigned char chunk_id;
+        int populate_number;
+        int cycle;
+    };
+
+    template<class Cache_>
+    auto next(Cache_& cache, int& counter, int& nalloc, int& cycle) {
+        return cache.next(
+            [](int i) -> std::pair<unsigned char, int> {
+                return std::make_pair<unsigned char, int>(i / 10, i % 10);
+            },
+            [&]() -> TestSlab {
+                ++nalloc;
+                return TestSlab();
+            },
+            [&](std::vector<std::pair<unsigned char, TestSlab*> >& in_need) -> void {
+                EXPECT_FALSE(in_need.empty());
+                for (auto& x : in_need) {
+                    auto& current = *(x.second);
+                    current.chunk_id = x.first;
+                    current.populate_number = counter++;
+                    current.cycle = cycle;
+                }
+                ++cycle;
+            }
+        );
+    }
+
+    // Reference implementation of Belady's MIN policy, returning the number of slabs that are loaded.
+    static int reference_loads(const std::vector<int>& predictions, int max_slabs) {
+        std::set<int> cached;
+        int loads = 0;
+        for (size_t i = 0; i < predictions.size(); ++i) {
+            int slab = predictions[i] / 10;
+            if (cached.find(slab) != cached.end()) {
+                continue;
+            }
+            ++loads;
+
+            if (static_cast<int>(cached.size()) == max_slabs) {
+                int victim = -1;
+                size_t farthest = 0;
+                for (auto c : cached) {
+                    size_t next_use = predictions.size();
+                    for (size_t j = i + 1; j < predictions.size(); ++j) {
+                        if (predictions[j] / 10 == c) {
+                            next_use = j;
+                            break;
+                        }
+                    }
+                    if (victim < 0 || next_use > farthest) {
+                        victim = c;
+                        farthest = next_use;
+                    }
+                }
+                cached.erase(victim);
+            }
+            cached.insert(slab);
+        }
+        return loads;
+    }
+};
+
+class OracularBeladySlabCacheTest : public ::testing::Test, public OracularBeladySlabCacheTestMethods {};
+
+TEST_F(OracularBeladySlabCacheTest, Consecutive) {
+    std::vector<int> predictions{ 11, 22, 33, 44, 55, 66, 77, 88, 99 };
+
+    tatami_chunked::OracularBeladySlabCache<unsigned char, int, TestSlab> cache(std::make_shared<tatami::FixedViewOracle<int> >(predictions.data(), predictions.size()), 3);
+    EXPECT_EQ(cache.get_max_slabs(), 3);
+    EXPECT_EQ(cache.get_num_slabs(), 0);
+
+    int counter = 0, nalloc = 0, cycle = 1;
+    for (size_t i = 0; i < 3; ++i) { // 11 to 33 are populated together while the cache is filling up.
+        auto out = next(cache, counter, nalloc, cycle);
+        EXPECT_EQ(out.first->chunk_id, static_cast<unsigned char>(predictions[i] / 10));
+        EXPECT_EQ(out.first->populate_number, i);
+        EXPECT_EQ(out.first->cycle, 1);
+        EXPECT_EQ(out.second, predictions[i] % 10);
+    }
+
+    for (size_t i = 3; i < predictions.size(); ++i) { // afterwards, each slab is populated by itself.
+        auto out = next(cache, counter, nalloc, cycle);
+        EXPECT_EQ(out.first->chunk_id, static_cast<unsigned char>(predictions[i] / 10));
+        EXPECT_EQ(out.first->populate_number, i);
+        EXPECT_EQ(out.first->cycle, i - 1);
+        EXPECT_EQ(out.second, predictions[i] % 10);
+    }
+
+    EXPECT_EQ(nalloc, 3); // respects the max cache size.
+    EXPECT_EQ(cache.get_num_slabs(), 3);
+}
+
+TEST_F(OracularBeladySlabCacheTest, Farthest) {
+    std::vector<int> predictions{
+        11, // slabs 1 and 2 are populated together.
+        22,
+        33, // evicts 2, which is never used again.
+        12,
+        44, // evicts 3, as 1 is used before it.
+        15,
+        36, // evicts 4, which is never used again.
+        17
+    };
+
+    tatami_chunked::OracularBeladySlabCache<unsigned char, int, TestSlab> cache(std::make_shared<tatami::FixedViewOracle<int> >(predictions.data(), predictions.size()), 2);
+    int counter = 0, nalloc = 0, cycle = 1;
+
+    std::vector<int> expected_populate_number { 0, 1, 2, 0, 3, 0, 4, 0 };
+    for (size_t i = 0; i < predictions.size(); ++i) {
+        auto out = next(cache, counter, nalloc, cycle);
+        EXPECT_EQ(out.first->chunk_id, static_cast<unsigned char>(predictions[i] / 10));
+        EXPECT_EQ(out.first->populate_number, expected_populate_number[i]);
+        EXPECT_EQ(out.second, predictions[i] % 10);
+    }
+    EXPECT_EQ(counter, 5);
+    EXPECT_EQ(nalloc, 2);
+}
+
+class OracularBeladySlabCacheStressTest : public ::testing::TestWithParam<std::tuple<int, int> >, public OracularBeladySlabCacheTestMethods {};
+
+TEST_P(OracularBeladySlabCacheStressTest, Stressed) {
+    auto param = GetParam();
+    auto cache_size = std::get<0>(param);
+    auto max_lookahead = std::get<1>(param);
+
+    std::mt19937_64 rng(cache_size * 10 + max_lookahead);
+    std::vector<int> predictions(2000);
+    for (size_t i = 0; i < predictions.size(); ++i) {
+        // Mixing runs of the same slab with random jumps.
+        predictions[i] = (i && rng() % 2 ? predictions[i - 1] : rng() % 200 + 10);
+    }
+
+    tatami_chunked::OracularBeladySlabCache<unsigned char, int, TestSlab, false, true> cache(std::make_unique<tatami::FixedViewOracle<int> >(predictions.data(), predictions.size()), cache_size, 0, max_lookahead);
+    tatami_chunked::OracularBeladySlabCache<unsigned char, int, TestSlab, true, true> dcache(std::make_unique<tatami::FixedViewOracle<int> >(predictions.data(), predictions.size()), cache_size, 25, max_lookahead);
+    int counter = 0, nalloc = 0, cycle = 1;
+    int dcounter = 0, dnalloc = 0, dcycle = 1;
+
+    for (size_t i = 0; i < predictions.size(); ++i) {
+        auto out = next(cache, counter, nalloc, cycle);
+        EXPECT_EQ(out.first->chunk_id, predictions[i] / 10);
+        EXPECT_EQ(out.second, predictions[i] % 10);
+        EXPECT_LE(cache.get_num_slabs(), cache_size);
+
+        auto dout = next(dcache, dcounter, dnalloc, dcycle);
+        EXPECT_EQ(dout.first->chunk_id, out.first->chunk_id);
+    }
+
+    EXPECT_EQ(nalloc, cache_size);
+    const auto& counters = cache.get_counters();
+    EXPECT_EQ(counters.slabs_populated, counter);
+    EXPECT_EQ(counters.hits + counters.misses, predictions.size());
+
+    auto optimal = reference_loads(predictions, cache_size);
+    if (max_lookahead == 0) {
+        EXPECT_EQ(counter, optimal);
+        EXPECT_EQ(dcounter, optimal); // ties may be broken differently, but the number of loaded slabs is the same.
+    } else {
+        EXPECT_GE(counter, optimal);
+    }
+
+    // Comparing to the regular cache.
+    tatami_chunked::OracularSlabCache<unsigned char, int, TestSlab> regular(std::make_unique<tatami::FixedViewOracle<int> >(predictions.data(), predictions.size()), cache_size);
+    int rcounter = 0, rnalloc = 0, rcycle = 1;
+    for (size_t i = 0; i < predictions.size(); ++i) {
+        next(regular, rcounter, rnalloc, rcycle);
+    }
+    EXPECT_LE(optimal, rcounter);
+}
+
+INSTANTIATE_TEST_SUITE_P(
+    OracularBeladySlabCache,
+    OracularBeladySlabCacheStressTest,
+    ::testing::Combine(
+        ::testing::Values(1, 3, 5, 10), // max cache size
+        ::testing::Values(0, 5) // max lookahead
+    )
+);
@@ -0,0 +1,122 @@
+#include <gtest/gtest.h>
+#include "tatami/tatami.hpp"
+#include "tatami_chunked/SlabCacheAdvisor.hpp"
+#include "tatami_chunked/LruSlabCache.hpp"
+
+#include <vector>
+#include <random>
+
+TEST(SlabCacheAdvisor, Consecutive) {
+    tatami::ConsecutiveOracle<int> oracle(0, 100);
+    tatami_chunked::ChunkDimensionStats<int> stats(100, 10);
+    tatami_chunked::SlabCacheAdvisor<int> advisor(oracle, stats, tatami_chunked::SlabCacheAdvisorOptions());
+
+    EXPECT_EQ(advisor.get_num_requests(), 100);
+    EXPECT_EQ(advisor.get_num_distinct_slabs(), 10);
+    EXPECT_EQ(advisor.get_maximum_hit_rate(), 0.9);
+    EXPECT_EQ(advisor.get_hit_rate(0), 0);
+    EXPECT_EQ(advisor.get_hit_rate(1), 0.9);
+    EXPECT_EQ(advisor.get_hit_rate(10), 0.9);
+
+    EXPECT_EQ(advisor.advise(1), 1);
+    EXPECT_EQ(advisor.advise(0), 1);
+    EXPECT_EQ(advisor.shrink(10), 1);
+    EXPECT_EQ(advisor.shrink(0), 0);
+}
+
+TEST(SlabCacheAdvisor, Cyclic) {
+    // Cycling through slabs 0, 1, 2 three times.
+    std::vector<int> predictions;
+    for (int rep = 0; rep < 3; ++rep) {
+        for (int s = 0; s < 3; ++s) {
+            predictions.push_back(s * 10);
+            predictions.push_back(s * 10 + 5);
+        }
+    }
+    tatami::FixedVectorOracle<int> oracle(std::move(predictions));
+    tatami_chunked::ChunkDimensionStats<int> stats(30, 10);
+    tatami_chunked::SlabCacheAdvisor<int> advisor(oracle, stats, tatami_chunked::SlabCacheAdvisorOptions());
+
+    EXPECT_EQ(advisor.get_num_distinct_slabs(), 3);
+    EXPECT_EQ(advisor.get_hit_rate(1), 0.5); // only the second request in each pair.
+    EXPECT_EQ(advisor.get_hit_rate(2), 0.5); // LRU always evicts the next slab.
+    EXPECT_EQ(advisor.get_hit_rate(3), 15.0 / 18);
+    EXPECT_EQ(advisor.get_maximum_hit_rate(), 15.0 / 18);
+
+    EXPECT_EQ(advisor.advise(0.5), 1);
+    EXPECT_EQ(advisor.advise(0.6), 3);
+    EXPECT_EQ(advisor.advise(1), 3);
+    EXPECT_EQ(advisor.shrink(2), 1);
+    EXPECT_EQ(advisor.shrink(3), 3);
+    EXPECT_EQ(advisor.shrink(100), 3);
+}
+
+TEST(SlabCacheAdvisor, MaximumPredictions) {
+    tatami::ConsecutiveOracle<int> oracle(0, 100);
+    tatami_chunked::ChunkDimensionStats<int> stats(100, 10);
+    tatami_chunked::SlabCacheAdvisorOptions opt;
+    opt.maximum_predictions = 25;
+    tatami_chunked::SlabCacheAdvisor<int> advisor(oracle, stats, opt);
+    EXPECT_EQ(advisor.get_num_requests(), 25);
+    EXPECT_EQ(advisor.get_num_distinct_slabs(), 3);
+
+    // Default is bounded.
+    tatami::ConsecutiveOracle<int> long_oracle(0, 200000);
+    tatami_chunked::ChunkDimensionStats<int> long_stats(200000, 100);
+    tatami_chunked::SlabCacheAdvisor<int> long_advisor(long_oracle, long_stats, tatami_chunked::SlabCacheAdvisorOptions());
+    EXPECT_EQ(long_advisor.get_num_requests(), 100000);
+    EXPECT_EQ(long_advisor.get_num_distinct_slabs(), 1000);
+
+    // Unless explicitly disabled.
+    opt.maximum_predictions = 0;
+    tatami_chunked::SlabCacheAdvisor<int> full_advisor(long_oracle, long_stats, opt);
+    EXPECT_EQ(full_advisor.get_num_requests(), 200000);
+    EXPECT_EQ(full_advisor.get_num_distinct_slabs(), 2000);
+}
+
+TEST(SlabCacheAdvisor, Empty) {
+    tatami::ConsecutiveOracle<int> oracle(0, 0);
+    tatami_chunked::ChunkDimensionStats<int> stats(100, 10);
+    tatami_chunked::SlabCacheAdvisor<int> advisor(oracle, stats, tatami_chunked::SlabCacheAdvisorOptions());
+    EXPECT_EQ(advisor.get_num_requests(), 0);
+    EXPECT_EQ(advisor.get_maximum_hit_rate(), 0);
+    EXPECT_EQ(advisor.advise(1), 0);
+    EXPECT_EQ(advisor.shrink(10), 0);
+
+    // Single request.
+    tatami::ConsecutiveOracle<int> oracle2(5, 1);
+    tatami_chunked::SlabCacheAdvisor<int> advisor2(oracle2, stats, tatami_chunked::SlabCacheAdvisorOptions());
+    EXPECT_EQ(advisor2.get_maximum_hit_rate(), 0);
+    EXPECT_EQ(advisor2.advise(1), 1);
+    EXPECT_EQ(advisor2.shrink(10), 1);
+}
+
+TEST(SlabCacheAdvisor, Random) {
+    std::mt19937_64 rng(1234);
+    std::vector<int> predictions(2000);
+    for (auto& p : predictions) {
+        // Mixing local runs with random jumps.
+        p = (rng() % 4 == 0 ? rng() % 500 : (&p == predictions.data() ? 0 : *(&p - 1)));
+    }
+    tatami::FixedViewOracle<int> oracle(predictions.data(), predictions.size());
+    tatami_chunked::ChunkDimensionStats<int> stats(500, 7);
+    tatami_chunked::SlabCacheAdvisor<int> advisor(oracle, stats, tatami_chunked::SlabCacheAdvisorOptions());
+
+    // Comparing against a reference LRU cache.
+    for (int max_slabs = 1; max_slabs <= stats.num_chunks; max_slabs += 5) {
+        tatami_chunked::LruSlabCache<int, int, false, true> cache(max_slabs);
+        for (auto p : predictions) {
+            cache.find(p / stats.chunk_length, []() -> int { return 0; }, [](int, int&) -> void {});
+        }
+        EXPECT_EQ(advisor.get_hit_rate(max_slabs), cache.get_counters().hit_rate());
+
+        auto shrunk = advisor.shrink(max_slabs);
+        EXPECT_LE(shrunk, max_slabs);
+        EXPECT_EQ(advisor.get_hit_rate(shrunk), advisor.get_hit_rate(max_slabs));
+        if (shrunk > 1) {
+            EXPECT_LT(advisor.get_hit_rate(shrunk - 1), advisor.get_hit_rate(max_slabs));
+        }
+
+        EXPECT_EQ(advisor.advise(advisor.get_hit_rate(max_slabs)), shrunk);
+    }
+}
@@ -0,0 +1,169 @@
+#include <gtest/gtest.h>
+#include "tatami_chunked/SlabCacheCounters.hpp"
+#include "tatami_chunked/LruSlabCache.hpp"
+#include "tatami_chunked/OracularSlabCache.hpp"
+#include "tatami_chunked/OracularSubsettedSlabCache.hpp"
+#include "tatami_chunked/OracularVariableSlabCache.hpp"
+#include "tatami_chunked/OracularAsyncSlabCache.hpp"
+
+#include <vector>
+#include <random>
+
+struct SlabCacheCountersTestSlab {
+    int chunk_id = -1;
+};
+
+static std::pair<int, int> identify_counters(int i) {
+    return std::make_pair(i / 10, i % 10);
+}
+
+TEST(SlabCacheCounters, Lru) {
+    tatami_chunked::LruSlabCache<int, SlabCacheCountersTestSlab, false, true> cache(2);
+    int num_populated = 0;
+    for (auto id : std::vector<int>{ 0, 0, 1, 0, 2, 1 }) {
+        cache.find(
+            id,
+            []() -> SlabCacheCountersTestSlab { return SlabCacheCountersTestSlab(); },
+            [&](int i, SlabCacheCountersTestSlab& slab) -> void { slab.chunk_id = i; ++num_populated; }
+        );
+    }
+
+    const auto& counters = cache.get_counters();
+    EXPECT_EQ(counters.hits, 2);
+    EXPECT_EQ(counters.misses, 4);
+    EXPECT_EQ(counters.evictions, 2);
+    EXPECT_EQ(counters.populate_calls, 4);
+    EXPECT_EQ(counters.slabs_populated, num_populated);
+    EXPECT_EQ(counters.slabs_reused, 0);
+    EXPECT_EQ(counters.slabs_per_populate(), 1);
+    EXPECT_EQ(counters.hit_rate(), 1.0 / 3);
+}
+
+// Slabs 0, 1, 0, 2, 1, 0 with 2 slabs in the cache:
+// - The first cycle populates slabs 0 and 1.
+// - The second cycle populates slab 2, reuses slab 1 and evicts slab 0.
+// - The third cycle populates slab 0 and evicts slabs 1 and 2.
+static const std::vector<int> counter_predictions{ 0, 11, 1, 25, 12, 2 };
+
+template<class Counters_>
+static void check_oracular_counters(const Counters_& counters) {
+    EXPECT_EQ(counters.hits, 3);
+    EXPECT_EQ(counters.misses, 3);
+    EXPECT_EQ(counters.evictions, 3);
+    EXPECT_EQ(counters.populate_calls, 3);
+    EXPECT_EQ(counters.slabs_populated, 4);
+    EXPECT_EQ(counters.slabs_reused, 1);
+}
+
+TEST(SlabCacheCounters, Oracular) {
+    tatami_chunked::OracularSlabCache<int, int, SlabCacheCountersTestSlab, false, false, true> cache(std::make_shared<tatami::FixedViewOracle<int> >(counter_predictions.data(), counter_predictions.size()), 2);
+    for (auto p : counter_predictions) {
+        auto out = cache.next(
+            identify_counters,
+            []() -> SlabCacheCountersTestSlab { return SlabCacheCountersTestSlab(); },
+            [](std::vector<std::pair<int, SlabCacheCountersTestSlab*> >& to_populate) -> void {
+                for (auto& x : to_populate) {
+                    x.second->chunk_id = x.first;
+                }
+            }
+        );
+        EXPECT_EQ(out.first->chunk_id, p / 10);
+    }
+    check_oracular_counters(cache.get_counters());
+}
+
+TEST(SlabCacheCounters, Subsetted) {
+    tatami_chunked::OracularSubsettedSlabCache<int, int, SlabCacheCountersTestSlab, false, true> cache(std::make_shared<tatami::FixedViewOracle<int> >(counter_predictions.data(), counter_predictions.size()), 2);
+    for (auto p : counter_predictions) {
+        auto out = cache.next(
+            identify_counters,
+            []() -> SlabCacheCountersTestSlab { return SlabCacheCountersTestSlab(); },
+            [](std::vector<std::tuple<int, SlabCacheCountersTestSlab*, const tatami_chunked::OracularSubsettedSlabCacheSelectionDetails<int>*> >& to_populate) -> void {
+                for (auto& x : to_populate) {
+                    std::get<1>(x)->chunk_id = std::get<0>(x);
+                }
+            }
+        );
+        EXPECT_EQ(out.first->chunk_id, p / 10);
+    }
+    check_oracular_counters(cache.get_counters());
+}
+
+TEST(SlabCacheCounters, Variable) {
+    tatami_chunked::OracularVariableSlabCache<int, int, SlabCacheCountersTestSlab, int, false, true> cache(std::make_shared<tatami::FixedViewOracle<int> >(counter_predictions.data(), counter_predictions.size()), 2);
+    for (auto p : counter_predictions) {
+        auto out = cache.next(
+            identify_counters,
+            [](int) -> int { return 1; },
+            [](int, const SlabCacheCountersTestSlab&) -> int { return 1; },
+            []() -> SlabCacheCountersTestSlab { return SlabCacheCountersTestSlab(); },
+            [](std::vector<std::pair<int, std::size_t> >& to_populate, std::vector<std::pair<int, std::size_t> >&, std::vector<SlabCacheCountersTestSlab>& all_slabs) -> void {
+                for (auto& x : to_populate) {
+                    all_slabs[x.second].chunk_id = x.first;
+                }
+            }
+        );
+        EXPECT_EQ(out.first->chunk_id, p / 10);
+    }
+    check_oracular_counters(cache.get_counters());
+}
+
+TEST(SlabCacheCounters, Async) {
+    std::mt19937_64 rng(42);
+    std::vector<int> predictions(1000);
+    for (auto& p : predictions) {
+        p = rng() % 100;
+    }
+
+    for (int max_slabs : { 1, 2, 4 }) {
+        tatami_chunked::OracularAsyncSlabCache<int, int, SlabCacheCountersTestSlab, false, true> cache(std::make_shared<tatami::FixedViewOracle<int> >(predictions.data(), predictions.size()), max_slabs);
+        for (auto p : predictions) {
+            auto out = cache.next(
+                identify_counters,
+                []() -> SlabCacheCountersTestSlab { return SlabCacheCountersTestSlab(); },
+                [](std::vector<std::pair<int, SlabCacheCountersTestSlab*> >& to_populate) -> void {
+                    for (auto& x : to_populate) {
+                        x.second->chunk_id = x.first;
+                    }
+                }
+            );
+            EXPECT_EQ(out.first->chunk_id, p / 10);
+        }
+
+        // Every request is either a hit or a miss, and every miss involves at least one slab.
+        const auto& counters = cache.get_counters();
+        EXPECT_EQ(counters.hits + counters.misses, predictions.size());
+        EXPECT_GE(counters.slabs_populated, counters.misses);
+        EXPECT_GE(counters.populate_calls, counters.misses);
+        EXPECT_GT(counters.misses, 0);
+        if (max_slabs > 1) {
+            EXPECT_GT(counters.hits, 0);
+        }
+    }
+}
+
+TEST(SlabCacheCounters, Accumulate) {
+    tatami_chunked::SlabCacheCounters first, second;
+    first.hits = 1;
+    first.misses = 2;
+    first.populate_nanoseconds = 100;
+    second.hits = 3;
+    second.evictions = 4;
+    second.slabs_reused = 5;
+    second.populate_calls = 6;
+    second.slabs_populated = 12;
+
+    first += second;
+    EXPECT_EQ(first.hits, 4);
+    EXPECT_EQ(first.misses, 2);
+    EXPECT_EQ(first.evictions, 4);
+    EXPECT_EQ(first.slabs_reused, 5);
+    EXPECT_EQ(first.populate_calls, 6);
+    EXPECT_EQ(first.slabs_populated, 12);
+    EXPECT_EQ(first.populate_nanoseconds, 100);
+    EXPECT_EQ(first.slabs_per_populate(), 2);
+
+    tatami_chunked::SlabCacheCounters empty;
+    EXPECT_EQ(empty.hit_rate(), 0);
+    EXPECT_EQ(empty.slabs_per_populate(), 0);
+}
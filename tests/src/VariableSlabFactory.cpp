@@ -0,0 +1,169 @@
+#include <gtest/gtest.h>
+#include "tatami_chunked/VariableSlabFactory.hpp"
+#include "tatami_chunked/OracularVariableSlabCache.hpp"
+
+#include <random>
+#include <vector>
+#include <memory>
+
+static std::vector<int> simulate_predictions(int n, int max, int seed) {
+    std::mt19937_64 rng(seed);
+    std::vector<int> predictions;
+    predictions.reserve(n);
+    for (int i = 0; i < n; ++i) {
+        predictions.push_back(rng() % max);
+    }
+    return predictions;
+}
+
+TEST(DenseVariableSlabFactory, Basic) {
+    typedef tatami_chunked::DenseVariableSlabFactory<double, int> Factory;
+    auto predictions = simulate_predictions(1000, 200, 42);
+    int max_size = 100;
+    Factory factory(max_size);
+    tatami_chunked::OracularVariableSlabCache<int, int, typename Factory::Slab, int> cache(std::make_shared<tatami::FixedViewOracle<int> >(predictions.data(), predictions.size()), max_size);
+
+    auto upper_size = [](int id) -> int {
+        return 10 + (id % 3) * 5;
+    };
+    auto true_size = [&](int id) -> int {
+        return upper_size(id) - (id % 4) * 2;
+    };
+
+    for (auto p : predictions) {
+        auto out = cache.next(
+            [](int i) -> std::pair<int, int> {
+                return std::make_pair(i / 10, i % 10);
+            },
+            upper_size,
+            [](int, const typename Factory::Slab& slab) -> int {
+                return slab.size;
+            },
+            [&]() -> typename Factory::Slab {
+                return factory.create();
+            },
+            [&](std::vector<std::pair<int, std::size_t> >& to_populate, std::vector<std::pair<int, std::size_t> >& to_reuse, std::vector<typename Factory::Slab>& all_slabs) -> void {
+                factory.allocate(to_populate, to_reuse, all_slabs, upper_size);
+                for (const auto& x : to_populate) {
+                    auto& slab = all_slabs[x.second];
+                    EXPECT_EQ(slab.size, upper_size(x.first));
+                    slab.size = true_size(x.first);
+                    for (int k = 0; k < slab.size; ++k) {
+                        slab.data[k] = x.first * 1000 + k;
+                    }
+                }
+            }
+        );
+
+        // Contents are preserved after compaction and always lie within the arena.
+        int id = p / 10;
+        const auto& slab = *(out.first);
+        ASSERT_EQ(slab.size, true_size(id));
+        for (int k = 0; k < slab.size; ++k) {
+            EXPECT_EQ(slab.data[k], id * 1000 + k);
+        }
+        EXPECT_EQ(factory.capacity(), static_cast<std::size_t>(max_size));
+        EXPECT_LE(cache.get_used_size(), max_size);
+    }
+}
+
+TEST(DenseVariableSlabFactory, TooSmall) {
+    typedef tatami_chunked::DenseVariableSlabFactory<int, int> Factory;
+    Factory factory(5);
+    std::vector<typename Factory::Slab> all_slabs{ factory.create() };
+    std::vector<std::pair<int, std::size_t> > to_populate{ { 0, 0 } }, to_reuse;
+
+    // Arena is expanded to fit a single slab that is larger than the maximum size.
+    factory.allocate(to_populate, to_reuse, all_slabs, [](int) -> int { return 20; });
+    EXPECT_EQ(factory.capacity(), static_cast<std::size_t>(20));
+    std::fill_n(all_slabs[0].data, 20, 1);
+}
+
+TEST(SparseVariableSlabFactory, Basic) {
+    typedef tatami_chunked::SparseVariableSlabFactory<double, int, int> Factory;
+    auto predictions = simulate_predictions(1000, 200, 69);
+    int target_dim = 10, non_target_dim = 8;
+    int max_size = target_dim * non_target_dim * 3;
+
+    for (int needs : { 0, 1, 2 }) {
+        bool needs_value = needs != 1;
+        bool needs_index = needs != 0;
+        Factory factory(target_dim, max_size, needs_value, needs_index);
+        tatami_chunked::OracularVariableSlabCache<int, int, typename Factory::Slab, int> cache(std::make_shared<tatami::FixedViewOracle<int> >(predictions.data(), predictions.size()), max_size);
+
+        auto expected_number = [&](int id, int p) -> int {
+            return (id * 7 + p) % (non_target_dim / 2);
+        };
+
+        int max_slabs = 0;
+        for (auto pred : predictions) {
+            auto out = cache.next(
+                [&](int i) -> std::pair<int, int> {
+                    return std::make_pair(i / target_dim, i % target_dim);
+                },
+                [&](int) -> int {
+                    return target_dim * non_target_dim;
+                },
+                [&](int, const typename Factory::Slab& slab) -> int {
+                    return factory.actual_size(slab);
+                },
+                [&]() -> typename Factory::Slab {
+                    return factory.create();
+                },
+                [&](std::vector<std::pair<int, std::size_t> >& to_populate, std::vector<std::pair<int, std::size_t> >& to_reuse, std::vector<typename Factory::Slab>& all_slabs) -> void {
+                    factory.allocate(to_populate, to_reuse, all_slabs, [&](int) -> int { return non_target_dim; });
+                    for (const auto& x : to_populate) {
+                        auto& slab = all_slabs[x.second];
+                        for (int p = 0; p < target_dim; ++p) {
+                            EXPECT_EQ(slab.number[p], 0);
+                            auto num = expected_number(x.first, p);
+                            for (int k = 0; k < num; ++k) {
+                                if (needs_value) {
+                                    slab.values[p][k] = x.first * 100 + p * 10 + k;
+                                }
+                                if (needs_index) {
+                                    slab.indices[p][k] = k * 2;
+                                }
+                            }
+                            slab.number[p] = num;
+                        }
+                    }
+                }
+            );
+
+            int id = pred / target_dim;
+            const auto& slab = *(out.first);
+            for (int p = 0; p < target_dim; ++p) {
+                ASSERT_EQ(slab.number[p], expected_number(id, p));
+                for (int k = 0; k < slab.number[p]; ++k) {
+                    if (needs_value) {
+                        EXPECT_EQ(slab.values[p][k], id * 100 + p * 10 + k);
+                    }
+                    if (needs_index) {
+                        EXPECT_EQ(slab.indices[p][k], k * 2);
+                    }
+                }
+            }
+            EXPECT_EQ(factory.capacity(), static_cast<std::size_t>(max_size));
+            max_slabs = std::max(max_slabs, static_cast<int>(cache.get_num_slabs()));
+        }
+
+        // More slabs fit in the cache than if each slab used its upper size.
+        EXPECT_GT(max_slabs, 3);
+    }
+}
+
+TEST(SparseVariableSlabFactory, TooSmall) {
+    typedef tatami_chunked::SparseVariableSlabFactory<double, int, int> Factory;
+    Factory factory(5, 10, true, true);
+    std::vector<typename Factory::Slab> all_slabs{ factory.create() };
+    EXPECT_EQ(factory.actual_size(all_slabs[0]), 0);
+
+    std::vector<std::pair<int, std::size_t> > to_populate{ { 0, 0 } }, to_reuse;
+    factory.allocate(to_populate, to_reuse, all_slabs, [](int) -> int { return 4; });
+    EXPECT_EQ(factory.capacity(), static_cast<std::size_t>(20));
+    for (int p = 0; p < 5; ++p) {
+        std::fill_n(all_slabs[0].values[p], 4, 1);
+        std::fill_n(all_slabs[0].indices[p], 4, 1);
+    }
+}
@@ -0,0 +1,82 @@
+#include <gtest/gtest.h>
+#include "tatami_chunked/copy_kernels.hpp"
+
+#include <vector>
+#include <random>
+#include <cstdint>
+#include <cstddef>
+
+// Only testing the instruction sets that are supported by the current machine.
+static std::vector<tatami_chunked::SimdLevel> available_levels() {
+    std::vector<tatami_chunked::SimdLevel> output{ tatami_chunked::SimdLevel::NONE };
+    auto max_level = tatami_chunked::get_simd_level();
+    if (max_level >= tatami_chunked::SimdLevel::AVX2) {
+        output.push_back(tatami_chunked::SimdLevel::AVX2);
+    }
+    if (max_level >= tatami_chunked::SimdLevel::AVX512) {
+        output.push_back(tatami_chunked::SimdLevel::AVX512);
+    }
+    return output;
+}
+
+// Lengths that test the vectorized body and the scalar tail.
+static const std::vector<std::size_t> test_lengths{ 0, 1, 3, 4, 7, 8, 15, 16, 17, 31, 32, 33, 1001 };
+
+template<typename In_, typename Out_>
+void check_convert() {
+    for (auto level : available_levels()) {
+        for (auto n : test_lengths) {
+            std::vector<In_> src(n);
+            for (std::size_t i = 0; i < n; ++i) {
+                src[i] = static_cast<In_>(i * 3) - static_cast<In_>(50);
+            }
+
+            std::vector<Out_> output(n + 1, -1);
+            tatami_chunked::convert_copy_n(src.data(), n, output.data(), level);
+            std::vector<Out_> expected(src.begin(), src.end());
+            expected.push_back(-1); // checking that we don't write past the end.
+            EXPECT_EQ(output, expected);
+        }
+    }
+}
+
+TEST(ConvertCopyN, Basic) {
+    check_convert<float, double>();
+    check_convert<std::int32_t, double>();
+    check_convert<double, double>();
+    check_convert<std::int32_t, float>();
+    check_convert<std::uint16_t, double>();
+}
+
+template<typename Value_, typename Index_>
+void check_gather() {
+    std::mt19937_64 rng(12345);
+    std::vector<Value_> src(2000);
+    for (std::size_t i = 0; i < src.size(); ++i) {
+        src[i] = static_cast<Value_>(i) / 2;
+    }
+
+    for (auto n : test_lengths) {
+        std::vector<Index_> indices(n);
+        for (auto& x : indices) {
+            x = rng() % src.size();
+        }
+
+        std::vector<Value_> output(n + 1, -1);
+        tatami_chunked::gather_copy_n(src.data(), indices.data(), n, output.data());
+        std::vector<Value_> expected;
+        for (auto x : indices) {
+            expected.push_back(src[x]);
+        }
+        expected.push_back(-1);
+        EXPECT_EQ(output, expected);
+    }
+}
+
+TEST(GatherCopyN, Basic) {
+    check_gather<double, std::int32_t>();
+    check_gather<float, std::int32_t>();
+    check_gather<double, std::uint32_t>();
+    check_gather<double, std::int64_t>();
+    check_gather<std::int32_t, std::int32_t>();
+}
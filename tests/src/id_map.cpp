@@ -0,0 +1,248 @@
+#include <gtest/gtest.h>
+#include "tatami_chunked/id_map.hpp"
+#include "tatami_chunked/LruSlabCache.hpp"
+#include "tatami_chunked/OracularSlabCache.hpp"
+#include "tatami_chunked/OracularSubsettedSlabCache.hpp"
+#include "tatami_chunked/OracularVariableSlabCache.hpp"
+#include "tatami_chunked/OracularAsyncSlabCache.hpp"
+
+#include <random>
+#include <vector>
+#include <unordered_map>
+#include <algorithm>
+#include <mutex>
+
+TEST(DirectIdMap, Basic) {
+    tatami_chunked::DirectIdMap<int, double> map(10);
+    EXPECT_TRUE(map.empty());
+    EXPECT_TRUE(map.find(5) == map.end());
+
+    map[5] = 1.5;
+    map[2] = 2.5;
+    map[7] = 3.5;
+    EXPECT_EQ(map.size(), 3);
+    EXPECT_EQ(map.find(2)->second, 2.5);
+
+    // Erasing from the middle moves the last entry into its place.
+    map.erase(map.find(5));
+    EXPECT_EQ(map.size(), 2);
+    EXPECT_TRUE(map.find(5) == map.end());
+    EXPECT_EQ(map.find(7)->second, 3.5);
+    EXPECT_EQ(map.find(2)->second, 2.5);
+
+    tatami_chunked::DirectIdMap<int, double> other(10);
+    other[9] = 4.5;
+    map.swap(other);
+    EXPECT_EQ(map.size(), 1);
+    EXPECT_EQ(map.find(9)->second, 4.5);
+    EXPECT_EQ(other.size(), 2);
+
+    other.clear();
+    EXPECT_TRUE(other.empty());
+    EXPECT_TRUE(other.find(7) == other.end());
+    other[7] = 5.5;
+    EXPECT_EQ(other.find(7)->second, 5.5);
+}
+
+TEST(DirectIdMap, Stressed) {
+    constexpr int num_ids = 50;
+    tatami_chunked::DirectIdMap<int, int> map(num_ids);
+    std::unordered_map<int, int> ref;
+
+    std::mt19937_64 rng(99);
+    for (int r = 0; r < 10000; ++r) {
+        int id = rng() % num_ids;
+        switch (rng() % 4) {
+            case 0: case 1:
+                map[id] = r;
+                ref[id] = r;
+                break;
+            case 2:
+                map.erase(id);
+                ref.erase(id);
+                break;
+            default:
+                if (r % 100 == 0) {
+                    map.clear();
+                    ref.clear();
+                }
+        }
+
+        ASSERT_EQ(map.size(), ref.size());
+        for (const auto& x : map) {
+            auto it = ref.find(x.first);
+            ASSERT_TRUE(it != ref.end());
+            EXPECT_EQ(it->second, x.second);
+        }
+    }
+}
+
+// Checking that the caches behave identically with and without direct lookups.
+// The pairing of slab identifiers to Slab_ instances may differ, but the same slabs should be populated in each cycle.
+class DirectIdCacheTest : public ::testing::TestWithParam<int> {
+protected:
+    struct TestSlab {
+        unsigned char chunk_id = 0;
+    };
+
+    static std::vector<int> create_predictions(int seed) {
+        std::mt19937_64 rng(seed);
+        std::vector<int> predictions(5000);
+        for (auto& p : predictions) {
+            p = rng() % 50 + 10;
+        }
+        return predictions;
+    }
+
+    static std::pair<unsigned char, int> identify(int i) {
+        return std::make_pair<unsigned char, int>(i / 10, i % 10);
+    }
+
+    static constexpr unsigned char num_ids = 6;
+
+    typedef std::vector<std::vector<unsigned char> > History;
+
+    // 'history' and 'lock' should outlive 'cache', as the async cache might still be populating slabs after we return.
+    template<class Cache_>
+    static void run_regular(Cache_& cache, const std::vector<int>& predictions, History& history, std::mutex& lock) {
+        for (auto p : predictions) {
+            auto out = cache.next(
+                identify,
+                []() -> TestSlab { return TestSlab(); },
+                [&history,&lock](std::vector<std::pair<unsigned char, TestSlab*> >& in_need) -> void {
+                    std::vector<unsigned char> ids;
+                    for (auto& x : in_need) {
+                        x.second->chunk_id = x.first;
+                        ids.push_back(x.first);
+                    }
+                    std::sort(ids.begin(), ids.end());
+                    std::lock_guard<std::mutex> lck(lock);
+                    history.push_back(std::move(ids));
+                }
+            );
+            EXPECT_EQ(out.first->chunk_id, p / 10);
+            EXPECT_EQ(out.second, p % 10);
+        }
+    }
+};
+
+TEST_P(DirectIdCacheTest, Lru) {
+    auto cache_size = GetParam();
+    auto predictions = create_predictions(cache_size);
+    tatami_chunked::LruSlabCache<unsigned char, TestSlab> hashed(cache_size);
+    tatami_chunked::LruSlabCache<unsigned char, TestSlab, true> direct(cache_size, num_ids);
+
+    int hashed_count = 0, direct_count = 0;
+    for (auto p : predictions) {
+        auto id = identify(p).first;
+        const auto& hout = hashed.find(id, []() -> TestSlab { return TestSlab(); }, [&](unsigned char i, TestSlab& slab) -> void { slab.chunk_id = i; ++hashed_count; });
+        const auto& dout = direct.find(id, []() -> TestSlab { return TestSlab(); }, [&](unsigned char i, TestSlab& slab) -> void { slab.chunk_id = i; ++direct_count; });
+        EXPECT_EQ(hout.chunk_id, id);
+        EXPECT_EQ(dout.chunk_id, id);
+        EXPECT_EQ(hashed_count, direct_count);
+    }
+}
+
+TEST_P(DirectIdCacheTest, Oracular) {
+    auto cache_size = GetParam();
+    auto predictions = create_predictions(cache_size);
+    History hashed_history, direct_history;
+    std::mutex lock;
+    tatami_chunked::OracularSlabCache<unsigned char, int, TestSlab> hashed(std::make_shared<tatami::FixedViewOracle<int> >(predictions.data(), predictions.size()), cache_size);
+    tatami_chunked::OracularSlabCache<unsigned char, int, TestSlab, false, true> direct(std::make_shared<tatami::FixedViewOracle<int> >(predictions.data(), predictions.size()), cache_size, num_ids);
+    run_regular(hashed, predictions, hashed_history, lock);
+    run_regular(direct, predictions, direct_history, lock);
+    EXPECT_EQ(hashed_history, direct_history);
+}
+
+TEST_P(DirectIdCacheTest, Async) {
+    auto cache_size = GetParam();
+    auto predictions = create_predictions(cache_size);
+    History hashed_history, direct_history;
+    std::mutex lock;
+    {
+        tatami_chunked::OracularAsyncSlabCache<unsigned char, int, TestSlab> hashed(std::make_shared<tatami::FixedViewOracle<int> >(predictions.data(), predictions.size()), cache_size);
+        tatami_chunked::OracularAsyncSlabCache<unsigned char, int, TestSlab, true> direct(std::make_shared<tatami::FixedViewOracle<int> >(predictions.data(), predictions.size()), cache_size, num_ids);
+        run_regular(hashed, predictions, hashed_history, lock);
+        run_regular(direct, predictions, direct_history, lock);
+    } // waiting for all background threads to finish.
+    EXPECT_EQ(hashed_history, direct_history);
+}
+
+TEST_P(DirectIdCacheTest, Subsetted) {
+    auto cache_size = GetParam();
+    auto predictions = create_predictions(cache_size);
+
+    auto run = [&](auto& cache) -> std::vector<std::vector<std::pair<unsigned char, std::vector<int> > > > {
+        std::vector<std::vector<std::pair<unsigned char, std::vector<int> > > > history;
+        for (auto p : predictions) {
+            auto out = cache.next(
+                identify,
+                []() -> TestSlab { return TestSlab(); },
+                [&](std::vector<std::tuple<unsigned char, TestSlab*, const tatami_chunked::OracularSubsettedSlabCacheSelectionDetails<int>*> >& in_need) -> void {
+                    std::vector<std::pair<unsigned char, std::vector<int> > > details;
+                    for (auto& x : in_need) {
+                        std::get<1>(x)->chunk_id = std::get<0>(x);
+                        const auto& subset = *std::get<2>(x);
+                        std::vector<int> summary{ static_cast<int>(subset.selection) };
+                        if (subset.selection == tatami_chunked::OracularSubsettedSlabCacheSelectionType::BLOCK) {
+                            summary.push_back(subset.block_start);
+                            summary.push_back(subset.block_length);
+                        } else if (subset.selection == tatami_chunked::OracularSubsettedSlabCacheSelectionType::INDEX) {
+                            summary.insert(summary.end(), subset.indices.begin(), subset.indices.end());
+                        }
+                        details.emplace_back(std::get<0>(x), std::move(summary));
+                    }
+                    std::sort(details.begin(), details.end());
+                    history.push_back(std::move(details));
+                }
+            );
+            EXPECT_EQ(out.first->chunk_id, p / 10);
+            EXPECT_EQ(out.second, p % 10);
+        }
+        return history;
+    };
+
+    tatami_chunked::OracularSubsettedSlabCache<unsigned char, int, TestSlab> hashed(std::make_shared<tatami::FixedViewOracle<int> >(predictions.data(), predictions.size()), cache_size);
+    tatami_chunked::OracularSubsettedSlabCache<unsigned char, int, TestSlab, true> direct(std::make_shared<tatami::FixedViewOracle<int> >(predictions.data(), predictions.size()), cache_size, num_ids);
+    EXPECT_EQ(run(hashed), run(direct));
+}
+
+TEST_P(DirectIdCacheTest, Variable) {
+    auto cache_size = GetParam();
+    auto predictions = create_predictions(cache_size);
+
+    auto run = [&](auto& cache) -> std::vector<std::vector<unsigned char> > {
+        std::vector<std::vector<unsigned char> > history;
+        for (auto p : predictions) {
+            auto out = cache.next(
+                identify,
+                [](unsigned char i) -> int { return i; },
+                [](unsigned char i, const TestSlab&) -> int { return i; },
+                []() -> TestSlab { return TestSlab(); },
+                [&](std::vector<std::pair<unsigned char, std::size_t> >& in_need, std::vector<std::pair<unsigned char, std::size_t> >&, std::vector<TestSlab>& all_slabs) -> void {
+                    std::vector<unsigned char> ids;
+                    for (auto& x : in_need) {
+                        all_slabs[x.second].chunk_id = x.first;
+                        ids.push_back(x.first);
+                    }
+                    std::sort(ids.begin(), ids.end());
+                    history.push_back(std::move(ids));
+                }
+            );
+            EXPECT_EQ(out.first->chunk_id, p / 10);
+            EXPECT_EQ(out.second, p % 10);
+        }
+        return history;
+    };
+
+    tatami_chunked::OracularVariableSlabCache<unsigned char, int, TestSlab, int> hashed(std::make_shared<tatami::FixedViewOracle<int> >(predictions.data(), predictions.size()), cache_size * 3);
+    tatami_chunked::OracularVariableSlabCache<unsigned char, int, TestSlab, int, true> direct(std::make_shared<tatami::FixedViewOracle<int> >(predictions.data(), predictions.size()), cache_size * 3, num_ids);
+    EXPECT_EQ(run(hashed), run(direct));
+}
+
+INSTANTIATE_TEST_SUITE_P(
+    DirectIdMap,
+    DirectIdCacheTest,
+    ::testing::Values(1, 2, 3, 5, 10) // max cache size
+);
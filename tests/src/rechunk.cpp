@@ -0,0 +1,161 @@
+#include <gtest/gtest.h>
+#include "tatami/tatami.hpp"
+#include "tatami_test/tatami_test.hpp"
+
+#include "tatami_chunked/rechunk.hpp"
+
+#include <vector>
+
+class RechunkTest : public ::testing::TestWithParam<std::tuple<std::pair<int, int>, bool> > {
+protected:
+    inline static int NR = 73, NC = 49;
+};
+
+TEST_P(RechunkTest, Dense) {
+    auto param = GetParam();
+    auto chunkdim = std::get<0>(param);
+    auto full = tatami_test::simulate_vector<double>(NR * NC, tatami_test::SimulateVectorOptions());
+    tatami::DenseRowMatrix<double, int> ref(NR, NC, full);
+
+    for (auto row_major_contents : { true, false }) {
+        tatami_chunked::RechunkDenseOptions opt;
+        opt.row_major_chunks = std::get<1>(param);
+        opt.row_major_contents = row_major_contents;
+
+        // Reconstructing the matrix from the chunks, and checking that each chunk is visited once in the expected order.
+        std::vector<double> observed(NR * NC, -1);
+        std::vector<std::pair<int, int> > visited;
+        tatami_chunked::rechunk_dense<double>(
+            ref,
+            chunkdim.first,
+            chunkdim.second,
+            [&](int chunk_row_id, int chunk_column_id, const double* contents) -> void {
+                visited.emplace_back(chunk_row_id, chunk_column_id);
+                for (int r = 0; r < chunkdim.first; ++r) {
+                    for (int c = 0; c < chunkdim.second; ++c) {
+                        double val = (row_major_contents ? contents[r * chunkdim.second + c] : contents[c * chunkdim.first + r]);
+                        int full_r = chunk_row_id * chunkdim.first + r, full_c = chunk_column_id * chunkdim.second + c;
+                        if (full_r < NR && full_c < NC) {
+                            observed[full_r * NC + full_c] = val;
+                        } else {
+                            EXPECT_EQ(val, 0);
+                        }
+                    }
+                }
+            },
+            opt
+        );
+        EXPECT_EQ(observed, full);
+
+        std::vector<std::pair<int, int> > expected;
+        int num_row_chunks = (NR + chunkdim.first - 1) / chunkdim.first, num_col_chunks = (NC + chunkdim.second - 1) / chunkdim.second;
+        for (int outer = 0, oend = (opt.row_major_chunks ? num_row_chunks : num_col_chunks); outer < oend; ++outer) {
+            for (int inner = 0, iend = (opt.row_major_chunks ? num_col_chunks : num_row_chunks); inner < iend; ++inner) {
+                if (opt.row_major_chunks) {
+                    expected.emplace_back(outer, inner);
+                } else {
+                    expected.emplace_back(inner, outer);
+                }
+            }
+        }
+        EXPECT_EQ(visited, expected);
+    }
+
+    // Conversion to a different type.
+    std::vector<float> fobserved(NR * NC);
+    tatami_chunked::rechunk_dense<float>(
+        ref,
+        chunkdim.first,
+        chunkdim.second,
+        [&](int chunk_row_id, int chunk_column_id, const float* contents) -> void {
+            for (int r = 0; r < chunkdim.first; ++r) {
+                for (int c = 0; c < chunkdim.second; ++c) {
+                    int full_r = chunk_row_id * chunkdim.first + r, full_c = chunk_column_id * chunkdim.second + c;
+                    if (full_r < NR && full_c < NC) {
+                        fobserved[full_r * NC + full_c] = contents[r * chunkdim.second + c];
+                    }
+                }
+            }
+        },
+        tatami_chunked::RechunkDenseOptions()
+    );
+    EXPECT_EQ(fobserved, std::vector<float>(full.begin(), full.end()));
+}
+
+TEST_P(RechunkTest, Sparse) {
+    auto param = GetParam();
+    auto chunkdim = std::get<0>(param);
+    auto simulated = tatami_test::simulate_compressed_sparse<double, int>(NC, NR, [&]{
+        tatami_test::SimulateCompressedSparseOptions opt;
+        opt.density = 0.2;
+        return opt;
+    }());
+    tatami::CompressedSparseColumnMatrix<double, int> ref(NR, NC, std::move(simulated.data), std::move(simulated.index), std::move(simulated.indptr));
+
+    std::vector<double> expected(NR * NC);
+    auto ext = ref.dense_row();
+    for (int r = 0; r < NR; ++r) {
+        auto ptr = ext->fetch(r, expected.data() + r * NC);
+        std::copy_n(ptr, NC, expected.data() + r * NC);
+    }
+
+    tatami_chunked::RechunkSparseOptions opt;
+    opt.row_major_chunks = std::get<1>(param);
+    std::vector<double> observed(NR * NC);
+    int num_chunks = 0;
+    tatami_chunked::rechunk_sparse<double>(
+        ref,
+        chunkdim.first,
+        chunkdim.second,
+        [&](int chunk_row_id, int chunk_column_id, const std::vector<std::size_t>& pointers, const std::vector<int>& indices, const std::vector<double>& values) -> void {
+            ++num_chunks;
+            int row_start = chunk_row_id * chunkdim.first;
+            int nrow = std::min(NR - row_start, chunkdim.first);
+            ASSERT_EQ(pointers.size(), static_cast<std::size_t>(nrow + 1));
+            EXPECT_EQ(pointers.front(), 0);
+            EXPECT_EQ(pointers.back(), indices.size());
+            EXPECT_EQ(values.size(), indices.size());
+
+            for (int r = 0; r < nrow; ++r) {
+                EXPECT_TRUE(std::is_sorted(indices.begin() + pointers[r], indices.begin() + pointers[r + 1]));
+                for (auto i = pointers[r]; i < pointers[r + 1]; ++i) {
+                    EXPECT_LT(indices[i], chunkdim.second);
+                    observed[(row_start + r) * NC + chunk_column_id * chunkdim.second + indices[i]] = values[i];
+                }
+            }
+        },
+        opt
+    );
+    EXPECT_EQ(observed, expected);
+    EXPECT_EQ(num_chunks, ((NR + chunkdim.first - 1) / chunkdim.first) * ((NC + chunkdim.second - 1) / chunkdim.second));
+}
+
+INSTANTIATE_TEST_SUITE_P(
+    Rechunk,
+    RechunkTest,
+    ::testing::Combine(
+        ::testing::Values( // chunk dimensions
+            std::make_pair(1, 49),
+            std::make_pair(73, 1),
+            std::make_pair(10, 7),
+            std::make_pair(100, 100)
+        ),
+        ::testing::Values(true, false) // row-major chunks
+    )
+);
+
+TEST(Rechunk, Errors) {
+    tatami::DenseRowMatrix<double, int> ref(10, 10, std::vector<double>(100));
+    tatami_test::throws_error([&]() {
+        tatami_chunked::rechunk_dense<double>(ref, 0, 5, [&](int, int, const double*) -> void {}, tatami_chunked::RechunkDenseOptions());
+    }, "positive");
+    tatami_test::throws_error([&]() {
+        tatami_chunked::rechunk_sparse<double>(ref, 5, 0, [&](int, int, const std::vector<std::size_t>&, const std::vector<int>&, const std::vector<double>&) -> void {}, tatami_chunked::RechunkSparseOptions());
+    }, "positive");
+
+    // Empty matrices are fine.
+    tatami::DenseRowMatrix<double, int> empty(0, 10, std::vector<double>());
+    int count = 0;
+    tatami_chunked::rechunk_dense<double>(empty, 0, 5, [&](int, int, const double*) -> void { ++count; }, tatami_chunked::RechunkDenseOptions());
+    EXPECT_EQ(count, 0);
+}